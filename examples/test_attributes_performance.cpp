@@ -0,0 +1,149 @@
+#include "BlueMarbleMaps/Core/Attributes.h"
+#include "BlueMarbleMaps/Core/Core.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <new>
+
+using namespace BlueMarble;
+
+// Compares the memory per feature and the evaluation speed of the flat Attributes storage
+// with interned keys against a string keyed std::map (the previous storage). The evaluation
+// reads four color attributes per feature, as the default polygon visualizer does.
+// The global allocation functions are replaced to count live heap bytes, the size of each
+// allocation is stored in a header in front of it.
+
+static std::atomic<size_t> g_heapBytes{0};
+static constexpr size_t HeaderSize = alignof(std::max_align_t);
+
+void* operator new(size_t size)
+{
+    if (auto p = static_cast<char*>(std::malloc(size + HeaderSize)))
+    {
+        *reinterpret_cast<size_t*>(p) = size;
+        g_heapBytes += size;
+        return p + HeaderSize;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    if (!p)
+        return;
+    auto base = static_cast<char*>(p) - HeaderSize;
+    g_heapBytes -= *reinterpret_cast<size_t*>(base);
+    std::free(base);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    operator delete(p);
+}
+
+typedef std::map<std::string, AttributeValue> MapAttributes;
+
+static const char* Names[] = { "NAME", "CONTINENT", "POP_EST", "GDP_MD", "COLOR_R", "COLOR_G", "COLOR_B", "COLOR_A" };
+
+template <typename Container>
+static void fill(Container& attributes, int i)
+{
+    attributes[Names[0]] = AttributeValue("Feature " + std::to_string(i));
+    attributes[Names[1]] = AttributeValue(std::string("Europe"));
+    attributes[Names[2]] = AttributeValue(i*1000);
+    attributes[Names[3]] = AttributeValue(i*0.5);
+    attributes[Names[4]] = AttributeValue(i % 256);
+    attributes[Names[5]] = AttributeValue((i*7) % 256);
+    attributes[Names[6]] = AttributeValue((i*13) % 256);
+    attributes[Names[7]] = AttributeValue(0.5);
+}
+
+static Attributes makeAttributes(int i)
+{
+    Attributes attributes;
+    attributes.set(Names[0], std::string("Feature " + std::to_string(i)));
+    attributes.set(Names[1], std::string("Europe"));
+    attributes.set(Names[2], i*1000);
+    attributes.set(Names[3], i*0.5);
+    attributes.set(Names[4], i % 256);
+    attributes.set(Names[5], (i*7) % 256);
+    attributes.set(Names[6], (i*13) % 256);
+    attributes.set(Names[7], 0.5);
+
+    return attributes;
+}
+
+int main(int argc, char* argv[])
+{
+    int nFeatures = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 20;
+
+    // Map storage
+    size_t bytes = g_heapBytes;
+    std::vector<MapAttributes> mapFeatures(nFeatures);
+    for (int i(0); i<nFeatures; ++i)
+    {
+        fill(mapFeatures[i], i);
+    }
+    double mapBytesPerFeature = double(g_heapBytes - bytes) / nFeatures;
+
+    double mapSum = 0;
+    auto t1 = getTimeStampMs();
+    for (int k(0); k<iterations; ++k)
+    {
+        for (const auto& attributes : mapFeatures)
+        {
+            // Lookup by string, as the visualizers did
+            if (attributes.find("COLOR_R") != attributes.end()) mapSum += std::get<int>(attributes.at("COLOR_R"));
+            if (attributes.find("COLOR_G") != attributes.end()) mapSum += std::get<int>(attributes.at("COLOR_G"));
+            if (attributes.find("COLOR_B") != attributes.end()) mapSum += std::get<int>(attributes.at("COLOR_B"));
+            if (attributes.find("COLOR_A") != attributes.end()) mapSum += std::get<double>(attributes.at("COLOR_A"));
+        }
+    }
+    auto mapMs = getTimeStampMs() - t1;
+    mapFeatures.clear();
+    mapFeatures.shrink_to_fit();
+
+    // Flat storage
+    bytes = g_heapBytes;
+    std::vector<Attributes> flatFeatures(nFeatures);
+    for (int i(0); i<nFeatures; ++i)
+    {
+        flatFeatures[i] = makeAttributes(i);
+    }
+    double flatBytesPerFeature = double(g_heapBytes - bytes) / nFeatures;
+
+    static const AttributeKey ColorR("COLOR_R");
+    static const AttributeKey ColorG("COLOR_G");
+    static const AttributeKey ColorB("COLOR_B");
+    static const AttributeKey ColorA("COLOR_A");
+    double flatSum = 0;
+    t1 = getTimeStampMs();
+    for (int k(0); k<iterations; ++k)
+    {
+        for (const auto& attributes : flatFeatures)
+        {
+            // Lookup by precomputed key
+            if (auto value = attributes.getIf<int>(ColorR)) flatSum += *value;
+            if (auto value = attributes.getIf<int>(ColorG)) flatSum += *value;
+            if (auto value = attributes.getIf<int>(ColorB)) flatSum += *value;
+            if (auto value = attributes.getIf<double>(ColorA)) flatSum += *value;
+        }
+    }
+    auto flatMs = getTimeStampMs() - t1;
+
+    std::cout << "Features: " << nFeatures << ", attributes per feature: " << std::size(Names) << ", iterations: " << iterations << "\n";
+    std::cout << "Map:  " << mapBytesPerFeature << " heap bytes/feature, " << mapMs << " ms evaluation\n";
+    std::cout << "Flat: " << flatBytesPerFeature << " heap bytes/feature, " << flatMs << " ms evaluation\n";
+    std::cout << "Interned keys: " << AttributeKey::count() << "\n";
+
+    if (mapSum != flatSum)
+    {
+        std::cout << "Results differ: " << mapSum << " vs " << flatSum << "\n";
+        return 1;
+    }
+
+    return 0;
+}
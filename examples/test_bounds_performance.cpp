@@ -0,0 +1,111 @@
+#include "BlueMarbleMaps/Core/Feature.h"
+#include "BlueMarbleMaps/Core/Index/QuadTreeIndex.h"
+
+#include <cmath>
+#include <iostream>
+#include <random>
+
+using namespace BlueMarble;
+
+// Measures the effect of the cached geometry bounds on building a quad tree index
+// and on culling features against a view. The first pass computes the bounds of
+// every geometry, following passes use the cached bounds.
+
+static GeometryPtr createGeometry(std::mt19937& rng, int i)
+{
+    std::uniform_real_distribution<double> lng(-170.0, 170.0);
+    std::uniform_real_distribution<double> lat(-80.0, 80.0);
+    std::uniform_real_distribution<double> radius(0.1, 2.0);
+
+    auto createRing = [&]()
+    {
+        Point center(lng(rng), lat(rng));
+        double r = radius(rng);
+        int nPoints = 500;
+        std::vector<Point> points;
+        points.reserve(nPoints);
+        for (int j(0); j<nPoints; ++j)
+        {
+            double angle = 2.0*M_PI*j/nPoints;
+            points.emplace_back(center.x() + r*std::cos(angle), center.y() + r*std::sin(angle));
+        }
+        return points;
+    };
+
+    switch (i % 3)
+    {
+        case 0:
+            return std::make_shared<PolygonGeometry>(createRing());
+        case 1:
+            return std::make_shared<LineGeometry>(createRing());
+        default:
+        {
+            std::vector<PolygonGeometry> polygons;
+            for (int j(0); j<4; ++j)
+                polygons.emplace_back(createRing());
+            return std::make_shared<MultiPolygonGeometry>(polygons);
+        }
+    }
+}
+
+static int cull(const FeatureCollectionPtr& features, const Rectangle& view)
+{
+    int visible = 0;
+    for (const auto& f : *features)
+    {
+        if (f->bounds().overlap(view))
+            ++visible;
+    }
+
+    return visible;
+}
+
+int main()
+{
+    auto crs = Crs::wgs84LngLat();
+    int nFeatures = 20000;
+
+    std::mt19937 rng(1234);
+    auto features = std::make_shared<FeatureCollection>();
+    features->reserve(nFeatures);
+    for (int i(0); i<nFeatures; ++i)
+    {
+        features->add(std::make_shared<Feature>(Id(0, i), crs, createGeometry(rng, i)));
+    }
+
+    auto rootBounds = Rectangle(-180.0, -90.0, 180.0, 90.0);
+    for (int pass(0); pass<2; ++pass)
+    {
+        QuadTreeIndex index(rootBounds);
+        auto t1 = getTimeStampMs();
+        index.build(features);
+        auto elapsed = getTimeStampMs() - t1;
+        std::cout << "Index build (" << (pass == 0 ? "bounds calculated" : "bounds cached") << "): " << elapsed << " ms\n";
+    }
+
+    auto view = Rectangle(-20.0, 30.0, 40.0, 60.0);
+    int iterations = 50;
+    auto t1 = getTimeStampMs();
+    int visible = 0;
+    for (int i(0); i<iterations; ++i)
+    {
+        // Moving the geometries invalidates the bounds
+        for (const auto& f : *features)
+            f->move(Point(0.0, 0.0));
+        visible = cull(features, view);
+    }
+    auto invalidatedMs = getTimeStampMs() - t1;
+
+    t1 = getTimeStampMs();
+    for (int i(0); i<iterations; ++i)
+    {
+        visible = cull(features, view);
+    }
+    auto cachedMs = getTimeStampMs() - t1;
+
+    std::cout << "Culling " << nFeatures << " features (" << visible << " visible), " << iterations << " iterations. "
+              << "Bounds invalidated: " << invalidatedMs << " ms (including move)"
+              << ", bounds cached: " << cachedMs << " ms\n";
+
+    return 0;
+}
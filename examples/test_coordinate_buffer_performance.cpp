@@ -0,0 +1,207 @@
+#include "BlueMarbleMaps/Core/Serialization/GeoJsonSerializer.h"
+#include "BlueMarbleMaps/System/File.h"
+
+#include <cmath>
+#include <iostream>
+#include <random>
+
+using namespace BlueMarble;
+
+// Compares the coordinate storage of line/polygon geometries (CoordinateBuffer, x and y arrays)
+// with the previous storage (std::vector<Point> per ring) for a GeoJson file, e.g. a world
+// countries dataset, or random rings without a file. Reports memory usage and the throughput
+// of a lng/lat to mercator transform. Checks that z values survive building a buffer point by point.
+
+static bool checkZ()
+{
+    bool ok = true;
+    CoordinateBuffer fromPoints({ Point(1, 2, 3), Point(4, 5, 6) });
+    if (!fromPoints.hasZ() || fromPoints.point(0).z() != 3.0 || fromPoints.point(1).z() != 6.0)
+    {
+        std::cout << "Z lost when constructed from points\n";
+        ok = false;
+    }
+
+    LineGeometry line;
+    line.points().push_back(Point(0, 0, 10));
+    line.points().push_back(Point(1, 1, 0));
+    line.points().push_back(Point(2, 2, 20));
+    auto points = line.points();
+    if (points.size() != 3 || points[0].z() != 10.0 || points[1].z() != 0.0 || points[2].z() != 20.0)
+    {
+        std::cout << "Z lost when pushed back\n";
+        ok = false;
+    }
+
+    // Z set after the fact, and gone again when cleared
+    CoordinateBuffer buffer({ Point(1, 2), Point(3, 4) });
+    buffer.setPoint(1, Point(3, 4, 5));
+    if (!buffer.hasZ() || buffer.point(0).z() != 0.0 || buffer.point(1).z() != 5.0)
+    {
+        std::cout << "Z lost when set\n";
+        ok = false;
+    }
+    buffer.clear();
+    buffer.addPart({ Point(1, 2) });
+    if (buffer.hasZ())
+    {
+        std::cout << "Z kept after clear\n";
+        ok = false;
+    }
+
+    return ok;
+}
+
+static void collectBuffers(const GeometryPtr& geometry, std::vector<CoordinateBuffer*>& buffers)
+{
+    switch (geometry->type())
+    {
+        case GeometryType::Line:
+            buffers.push_back(&std::static_pointer_cast<LineGeometry>(geometry)->coordinates());
+            break;
+        case GeometryType::Polygon:
+            buffers.push_back(&std::static_pointer_cast<PolygonGeometry>(geometry)->coordinates());
+            break;
+        case GeometryType::MultiLine:
+            for (auto& line : std::static_pointer_cast<MultiLineGeometry>(geometry)->lines())
+                buffers.push_back(&line.coordinates());
+            break;
+        case GeometryType::MultiPolygon:
+            for (auto& polygon : std::static_pointer_cast<MultiPolygonGeometry>(geometry)->polygons())
+                buffers.push_back(&polygon.coordinates());
+            break;
+        default:
+            break;
+    }
+}
+
+static inline void toMercator(double& x, double& y)
+{
+    constexpr double R = 6378137.0;
+    constexpr double degToRad = M_PI / 180.0;
+    x = R * x * degToRad;
+    y = R * std::log(std::tan(M_PI * 0.25 + y * degToRad * 0.5));
+}
+
+static inline void fromMercator(double& x, double& y)
+{
+    constexpr double R = 6378137.0;
+    constexpr double radToDeg = 180.0 / M_PI;
+    x = x / R * radToDeg;
+    y = (2.0 * std::atan(std::exp(y / R)) - M_PI * 0.5) * radToDeg;
+}
+
+int main(int argc, char* argv[])
+{
+    if (!checkZ())
+    {
+        return 1;
+    }
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 20;
+
+    std::vector<CoordinateBuffer*> buffers;
+    FeatureCollectionPtr features;
+    std::vector<CoordinateBuffer> randomRings;
+    if (argc > 1)
+    {
+        auto file = File(argv[1]);
+        if (!file.isOpen())
+        {
+            std::cout << "Failed to open '" << argv[1] << "'\n";
+            return 1;
+        }
+        features = GeoJsonSerializer::deserialize(JsonValue::fromString(file.asString()));
+        for (const auto& feature : *features)
+        {
+            collectBuffers(feature->geometry(), buffers);
+        }
+    }
+    else
+    {
+        // 20000 rings of 50 to 500 points
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        randomRings.resize(20000);
+        for (auto& buffer : randomRings)
+        {
+            double cx = -170.0 + 340.0*unit(rng), cy = -80.0 + 160.0*unit(rng);
+            int n = 50 + int(unit(rng)*450);
+            std::vector<Point> ring;
+            for (int k(0); k<n; ++k)
+            {
+                double angle = 2.0*M_PI*k/n;
+                ring.emplace_back(cx + std::cos(angle), cy + std::sin(angle));
+            }
+            buffer.addPart(ring);
+            buffers.push_back(&buffer);
+        }
+    }
+
+    // The same coordinates stored as one std::vector<Point> per ring
+    std::vector<std::vector<Point>> rings;
+    size_t nPoints = 0;
+    size_t bufferBytes = 0;
+    for (auto buffer : buffers)
+    {
+        for (size_t part(0); part<buffer->partCount(); ++part)
+        {
+            rings.push_back(buffer->partPoints(part));
+        }
+        nPoints += buffer->size();
+        bufferBytes += sizeof(CoordinateBuffer) + buffer->memoryUsage();
+    }
+    size_t vectorBytes = 0;
+    for (const auto& ring : rings)
+    {
+        vectorBytes += sizeof(std::vector<Point>) + ring.capacity()*sizeof(Point);
+    }
+
+    std::cout << "Features: " << (features ? features->size() : randomRings.size())
+              << ", rings: " << rings.size()
+              << ", points: " << nPoints << "\n";
+    std::cout << "Memory, std::vector<Point>: " << vectorBytes / 1024 << " kB"
+              << ", CoordinateBuffer: " << bufferBytes / 1024 << " kB\n";
+
+    // Transform forth and back such that the coordinates stay in range
+    auto t1 = getTimeStampMs();
+    for (int i(0); i<iterations; ++i)
+    {
+        for (auto& ring : rings)
+        {
+            for (auto& p : ring)
+            {
+                double x = p.x();
+                double y = p.y();
+                toMercator(x, y);
+                p = Point(x, y);
+            }
+            for (auto& p : ring)
+            {
+                double x = p.x();
+                double y = p.y();
+                fromMercator(x, y);
+                p = Point(x, y);
+            }
+        }
+    }
+    auto vectorMs = getTimeStampMs() - t1;
+
+    t1 = getTimeStampMs();
+    for (int i(0); i<iterations; ++i)
+    {
+        for (auto buffer : buffers)
+        {
+            buffer->transform(toMercator);
+            buffer->transform(fromMercator);
+        }
+    }
+    auto bufferMs = getTimeStampMs() - t1;
+
+    double nTransformed = 2.0 * iterations * nPoints;
+    std::cout << "Transform, std::vector<Point>: " << vectorMs << " ms"
+              << " (" << nTransformed / std::max(1.0, (double)vectorMs) / 1000.0 << " Mpts/s)"
+              << ", CoordinateBuffer: " << bufferMs << " ms"
+              << " (" << nTransformed / std::max(1.0, (double)bufferMs) / 1000.0 << " Mpts/s)\n";
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include "BlueMarbleMaps/Core/Feature.h"
+#include "BlueMarbleMaps/Core/FrameArena.h"
+
+#include <atomic>
+#include <iostream>
+#include <new>
+
+using namespace BlueMarble;
+
+// Measures heap allocations and time of a simulated frame that creates short lived point
+// features (as PointVisualizer does for every vertex when hit testing), with and without
+// a FrameArena. The global allocation functions are replaced to count heap allocations.
+
+static std::atomic<size_t> g_heapAllocations{0};
+
+void* operator new(size_t size)
+{
+    ++g_heapAllocations;
+    if (void* p = std::malloc(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+static size_t frame(const FeaturePtr& source, int nVertices)
+{
+    std::vector<FeaturePtr> pointFeatures;
+    pointFeatures.reserve(nVertices);
+    for (int i(0); i<nVertices; ++i)
+    {
+        auto geometry = makeTransient<PointGeometry>(Point(i, i));
+        pointFeatures.push_back(makeTransient<Feature>(source->id(), source->crs(), geometry, source->attributes()));
+    }
+
+    return pointFeatures.size();
+}
+
+int main(int argc, char* argv[])
+{
+    int nVertices = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int frames = argc > 2 ? std::atoi(argv[2]) : 20;
+
+    auto source = std::make_shared<Feature>(Id(0, 0), Crs::wgs84LngLat(), std::make_shared<PointGeometry>(Point(0, 0)));
+
+    for (bool useArena : { false, true })
+    {
+        size_t allocations = g_heapAllocations;
+        size_t arenaAllocations = 0;
+        auto t1 = getTimeStampMs();
+        size_t blockSize = FrameArena::DefaultBlockSize;
+        for (int i(0); i<frames; ++i)
+        {
+            auto arena = useArena ? std::make_shared<FrameArena>(blockSize) : nullptr;
+            FrameArena::Scope scope(arena);
+            frame(source, nVertices);
+            if (arena)
+            {
+                arenaAllocations += arena->allocationCount();
+                blockSize = std::max(blockSize, arena->bytesAllocated()); // As Map::update()
+            }
+        }
+        auto elapsed = getTimeStampMs() - t1;
+        size_t heapAllocations = g_heapAllocations - allocations;
+
+        std::cout << (useArena ? "FrameArena: " : "Heap:       ")
+                  << (double)elapsed / frames << " ms/frame"
+                  << ", heap allocations/frame: " << heapAllocations / frames
+                  << ", arena allocations/frame: " << arenaAllocations / frames << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+#include "BlueMarbleMaps/Core/Core.h"
+#include "BlueMarbleMaps/Core/GeometryPredicates.h"
+#include "BlueMarbleMaps/Utility/Utils.h"
+
+#include <cmath>
+#include <iostream>
+#include <random>
+
+using namespace BlueMarble;
+
+// Microbenchmarks of the batch geometry predicates against the scalar per-object functions:
+// rectangle vs many rectangles (culling), point in polygon for many points (hit testing)
+// and point to polyline distance (line hit testing).
+
+int main(int argc, char* argv[])
+{
+    int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 10;
+
+    std::cout << "Instruction set: " << GeometryPredicates::instructionSet() << "\n";
+    std::mt19937 random(42);
+    std::uniform_real_distribution<double> coordinate(-180.0, 180.0);
+    std::uniform_real_distribution<double> extent(0.0, 2.0);
+    bool ok = true;
+
+    // Rectangle vs many rectangles
+    {
+        std::vector<Rectangle> rectangles;
+        RectangleArrays arrays;
+        for (int i(0); i<n; ++i)
+        {
+            double x = coordinate(random);
+            double y = coordinate(random)*0.5;
+            Rectangle r(x, y, x + extent(random), y + extent(random));
+            rectangles.push_back(r);
+            arrays.push_back(r.xMin(), r.yMin(), r.xMax(), r.yMax());
+        }
+        Rectangle area(-20, -10, 20, 10);
+
+        size_t scalarCount = 0;
+        auto t1 = getTimeStampMs();
+        for (int k(0); k<iterations; ++k)
+            for (const auto& r : rectangles)
+                scalarCount += r.overlap(area) ? 1 : 0;
+        auto scalarMs = getTimeStampMs() - t1;
+
+        size_t batchCount = 0;
+        std::vector<uint32_t> indices;
+        t1 = getTimeStampMs();
+        for (int k(0); k<iterations; ++k)
+        {
+            indices.clear();
+            batchCount += GeometryPredicates::overlapping(area.xMin(), area.yMin(), area.xMax(), area.yMax(), arrays, indices);
+        }
+        auto batchMs = getTimeStampMs() - t1;
+
+        std::cout << "Rectangle overlap (" << n << " rectangles): scalar " << scalarMs << " ms, batch " << batchMs << " ms\n";
+        ok = ok && scalarCount == batchCount;
+    }
+
+    // Point in polygon, many points against a polygon of many vertices
+    {
+        int nVertices = 1000;
+        std::vector<Point> polygon;
+        std::vector<double> x, y;
+        for (int i(0); i<nVertices; ++i)
+        {
+            double angle = 2.0*3.14159265358979323846*i/nVertices;
+            double radius = i % 2 == 0 ? 50.0 : 35.0; // Star shaped
+            polygon.emplace_back(radius*std::cos(angle), radius*std::sin(angle));
+            x.push_back(polygon.back().x());
+            y.push_back(polygon.back().y());
+        }
+        int nPoints = std::max(1, n / 100);
+        std::vector<double> px, py;
+        for (int i(0); i<nPoints; ++i)
+        {
+            px.push_back(coordinate(random)*0.5);
+            py.push_back(coordinate(random)*0.5);
+        }
+
+        size_t scalarCount = 0;
+        auto t1 = getTimeStampMs();
+        for (int k(0); k<iterations; ++k)
+            for (int i(0); i<nPoints; ++i)
+                scalarCount += Utils::pointInsidePolygon(Point(px[i], py[i]), polygon) ? 1 : 0;
+        auto scalarMs = getTimeStampMs() - t1;
+
+        size_t batchCount = 0;
+        std::vector<uint8_t> inside(nPoints);
+        t1 = getTimeStampMs();
+        for (int k(0); k<iterations; ++k)
+        {
+            GeometryPredicates::pointsInPolygon(px.data(), py.data(), nPoints, x.data(), y.data(), nVertices, inside.data());
+            for (auto v : inside)
+                batchCount += v;
+        }
+        auto batchMs = getTimeStampMs() - t1;
+
+        std::cout << "Point in polygon (" << nPoints << " points, " << nVertices << " vertices): scalar " << scalarMs << " ms, batch " << batchMs << " ms\n";
+        // The functions may differ for points exactly on an edge, which random points do not hit
+        ok = ok && scalarCount == batchCount;
+    }
+
+    // Distance to polyline
+    {
+        int nVertices = 1000;
+        std::vector<Point> line;
+        std::vector<double> x, y;
+        for (int i(0); i<nVertices; ++i)
+        {
+            line.emplace_back(coordinate(random), coordinate(random)*0.5);
+            x.push_back(line.back().x());
+            y.push_back(line.back().y());
+        }
+        int nPoints = std::max(1, n / 100);
+        std::vector<Point> points;
+        for (int i(0); i<nPoints; ++i)
+            points.emplace_back(coordinate(random), coordinate(random)*0.5);
+
+        double scalarSum = 0;
+        auto t1 = getTimeStampMs();
+        for (int k(0); k<iterations; ++k)
+        {
+            for (const auto& p : points)
+            {
+                double minDistance = HUGE_VAL;
+                for (int i(0); i+1<nVertices; ++i)
+                    minDistance = std::min(minDistance, Utils::distanceToLine(p, line[i], line[i+1]));
+                scalarSum += minDistance;
+            }
+        }
+        auto scalarMs = getTimeStampMs() - t1;
+
+        double batchSum = 0;
+        t1 = getTimeStampMs();
+        for (int k(0); k<iterations; ++k)
+            for (const auto& p : points)
+                batchSum += GeometryPredicates::distanceToPolyline(p.x(), p.y(), x.data(), y.data(), nVertices);
+        auto batchMs = getTimeStampMs() - t1;
+
+        std::cout << "Distance to polyline (" << nPoints << " points, " << nVertices << " vertices): scalar " << scalarMs << " ms, batch " << batchMs << " ms\n";
+        ok = ok && std::abs(scalarSum - batchSum) <= 1e-9*scalarSum;
+    }
+
+    if (!ok)
+    {
+        std::cout << "Results differ\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include "BlueMarbleMaps/Core/Map.h"
+#include "BlueMarbleMaps/Core/Layer/StandardLayer.h"
+#include "BlueMarbleMaps/Core/DataSets/MemoryDataSet.h"
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace BlueMarble;
+
+// Measures the throughput of headless rendering, in images per second, for a queue of render jobs
+// over a layer of polygons and lines, with no window. The jobs are rendered twice, the second round
+// reuses the layer caches of the first. Writes the first image to headless.png. With "async" the layer
+// reads its features asynchronously, each job then waits for them to load.
+
+static MemoryDataSetPtr createDataSet(int nFeatures)
+{
+    auto dataSet = std::make_shared<MemoryDataSet>();
+    dataSet->initialize(DataSetInitializationType::RightHereRightNow);
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<double> lng(-170.0, 170.0);
+    std::uniform_real_distribution<double> lat(-80.0, 80.0);
+    std::uniform_real_distribution<double> radius(0.5, 8.0);
+
+    for (int i(0); i<nFeatures; ++i)
+    {
+        Point center(lng(rng), lat(rng));
+        double r = radius(rng);
+        int nPoints = 100;
+        std::vector<Point> points;
+        points.reserve(nPoints);
+        for (int j(0); j<nPoints; ++j)
+        {
+            double angle = 2.0*M_PI*j/nPoints;
+            points.emplace_back(center.x() + r*std::cos(angle), center.y() + r*std::sin(angle));
+        }
+
+        if (i % 2 == 0)
+            dataSet->addFeature(dataSet->createFeature(std::make_shared<PolygonGeometry>(points)));
+        else
+            dataSet->addFeature(dataSet->createFeature(std::make_shared<LineGeometry>(points)));
+    }
+
+    return dataSet;
+}
+
+int main(int argc, char* argv[])
+{
+    int nJobs = argc > 1 ? std::atoi(argv[1]) : 50;
+    int size = argc > 2 ? std::atoi(argv[2]) : 512;
+    bool async = argc > 3 && std::string(argv[3]) == "async";
+
+    auto map = std::make_shared<Map>();
+    auto layer = std::make_shared<StandardLayer>(true);
+    layer->addDataSet(createDataSet(2000));
+    layer->asyncRead(async);
+    map->addLayer(layer);
+
+    // Areas of 10 to 60 degrees across
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> lng(-150.0, 150.0);
+    std::uniform_real_distribution<double> lat(-60.0, 60.0);
+    std::uniform_real_distribution<double> extent(10.0, 60.0);
+    std::vector<RenderJob> jobs;
+    for (int i(0); i<nJobs; ++i)
+    {
+        jobs.push_back(RenderJob{ Rectangle(Point(lng(rng), lat(rng)), extent(rng), extent(rng)), size, size });
+    }
+
+    for (const char* round : { "Cold caches", "Warm caches" })
+    {
+        auto t1 = getTimeStampMs();
+        auto images = map->renderToImages(jobs);
+        double seconds = (getTimeStampMs() - t1)/1000.0;
+
+        size_t bytes = 0;
+        int incomplete = 0;
+        for (const auto& image : images)
+        {
+            bytes += image.png.size();
+            incomplete += image.complete ? 0 : 1;
+        }
+        std::cout << round << ": " << images.size() << " images of " << size << "x" << size << " in " << seconds << " s ("
+                  << (seconds > 0 ? images.size()/seconds : 0.0) << " images/s), " << bytes/1024 << " kB of PNG, "
+                  << incomplete << " incomplete\n";
+
+        if (!images.empty())
+        {
+            std::ofstream file("headless.png", std::ios::binary);
+            file.write((const char*)images[0].png.data(), images[0].png.size());
+        }
+    }
+
+    return 0;
+}
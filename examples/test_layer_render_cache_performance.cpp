@@ -0,0 +1,115 @@
+#include "BlueMarbleMaps/Core/Map.h"
+#include "BlueMarbleMaps/Core/Layer/StandardLayer.h"
+#include "BlueMarbleMaps/Core/DataSets/MemoryDataSet.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+using namespace BlueMarble;
+
+// Measures the frame time of panning over a layer of polygons with and without its render cache, no
+// window needed. Checks that the settled frame of the cached layer looks like the one rendered as usual.
+
+static MemoryDataSetPtr createDataSet(int nFeatures)
+{
+    auto dataSet = std::make_shared<MemoryDataSet>();
+    dataSet->initialize(DataSetInitializationType::RightHereRightNow);
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<double> lng(-170.0, 170.0);
+    std::uniform_real_distribution<double> lat(-80.0, 80.0);
+    std::uniform_real_distribution<double> radius(0.5, 8.0);
+
+    for (int i(0); i<nFeatures; ++i)
+    {
+        Point center(lng(rng), lat(rng));
+        double r = radius(rng);
+        int nPoints = 100;
+        std::vector<Point> points;
+        points.reserve(nPoints);
+        for (int j(0); j<nPoints; ++j)
+        {
+            double angle = 2.0*M_PI*j/nPoints;
+            points.emplace_back(center.x() + r*std::cos(angle), center.y() + r*std::sin(angle));
+        }
+        dataSet->addFeature(dataSet->createFeature(std::make_shared<PolygonGeometry>(points)));
+    }
+
+    return dataSet;
+}
+
+// Pans the view a whole number of pixels per frame, returns the milliseconds per frame
+static double pan(const MapPtr& map, int frames, double pixelsPerFrame)
+{
+    auto camera = map->camera();
+    double unitsPerPixel = map->screenToMap(1, 0).x() - map->screenToMap(0, 0).x();
+    auto t1 = getTimeStampMs();
+    for (int k(0); k<frames; ++k)
+    {
+        auto position = camera->translation();
+        camera->setTranslation(Point(position.x() + pixelsPerFrame*unitsPerPixel, position.y(), position.z()));
+        map->update(true);
+    }
+
+    return (getTimeStampMs() - t1)/double(frames);
+}
+
+int main(int argc, char* argv[])
+{
+    int width = argc > 1 ? std::atoi(argv[1]) : 1920;
+    int height = argc > 2 ? std::atoi(argv[2]) : 1080;
+    int frames = argc > 3 ? std::atoi(argv[3]) : 60;
+
+    auto map = std::make_shared<Map>();
+    map->resize(width, height);
+    auto layer = std::make_shared<StandardLayer>(true);
+    layer->addDataSet(createDataSet(5000));
+    layer->asyncRead(false);
+    map->addLayer(layer);
+
+    // North up, looking straight down at the whole world
+    auto camera = map->camera();
+    camera->setTranslation(Point(0.0, 0.0, 300.0));
+    camera->setOrientation(glm::dquat(1.0, 0.0, 0.0, 0.0));
+    map->update(true);
+
+    double directMs = pan(map, frames, 4.0);
+
+    layer->renderCacheEnabled(true);
+    map->update(true);
+    auto t1 = getTimeStampMs();
+    map->update(true); // The view settled, the cache is rendered
+    auto settledMs = getTimeStampMs() - t1;
+    double cachedMs = pan(map, frames, -4.0);
+    map->update(true);
+
+    std::cout << "Panning " << width << "x" << height << ": " << directMs << " ms per frame rendered as usual, "
+              << cachedMs << " ms per frame with the render cache, " << settledMs << " ms for the frame rendering the cache\n";
+
+    // The settled frame from the cache, against the same view rendered as usual
+    auto cached = map->drawable()->getRaster();
+    layer->renderCacheEnabled(false);
+    map->update(true);
+    auto direct = map->drawable()->getRaster();
+
+    const unsigned char* a = (const unsigned char*)cached.data();
+    const unsigned char* b = (const unsigned char*)direct.data();
+    size_t n = size_t(cached.width())*cached.height()*cached.channels();
+    size_t differing = 0;
+    for (size_t i(0); i<n; ++i)
+    {
+        if (std::abs(int(a[i]) - int(b[i])) > 2) // Blending through the cache rounds differently
+        {
+            ++differing;
+        }
+    }
+    if (differing > 0)
+    {
+        std::cout << "Cached frame differs from the one rendered as usual in " << differing << " values\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include "BlueMarbleMaps/Core/Core.h"
+#include "BlueMarbleMaps/Core/LineTessellation.h"
+
+#include <cmath>
+#include <iostream>
+#include <random>
+
+using namespace BlueMarble;
+
+// Measures the throughput of wide line tessellation for a layer of 100k segments with each
+// join and cap style, no GPU needed. Checks the area covered by the triangles of a few simple
+// lines whose outline is known.
+
+static double area(const std::vector<double>& x, const std::vector<double>& y,
+                   const std::vector<LineTessellation::Vertex>& vertices, const std::vector<uint32_t>& indices)
+{
+    double sum = 0.0;
+    for (size_t i(0); i+2<indices.size(); i+=3)
+    {
+        const auto& a = vertices[indices[i]];
+        const auto& b = vertices[indices[i+1]];
+        const auto& c = vertices[indices[i+2]];
+        double ax = x[a.point] + a.offsetX, ay = y[a.point] + a.offsetY;
+        double bx = x[b.point] + b.offsetX, by = y[b.point] + b.offsetY;
+        double cx = x[c.point] + c.offsetX, cy = y[c.point] + c.offsetY;
+        sum += std::abs((bx - ax)*(cy - ay) - (cx - ax)*(by - ay))*0.5;
+    }
+    return sum;
+}
+
+static bool checkArea(const char* name, const std::vector<double>& x, const std::vector<double>& y, bool closed,
+                      const Pen& pen, double expected, double tolerance)
+{
+    std::vector<LineTessellation::Vertex> vertices;
+    std::vector<uint32_t> indices;
+    LineTessellation::tessellate(x.data(), y.data(), x.size(), closed, pen, vertices, indices);
+    double a = area(x, y, vertices, indices);
+    bool ok = std::abs(a - expected) <= tolerance*expected;
+    if (!ok)
+    {
+        std::cout << name << ": area " << a << ", expected " << expected << "\n";
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    int nSegments = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 20;
+    int segmentsPerLine = 100;
+
+    bool ok = true;
+    {
+        Pen pen(Color::black(), 2.0);
+        std::vector<double> x = { 0, 10 }, y = { 0, 0 };
+        ok = checkArea("Butt cap", x, y, false, pen, 20.0, 1e-9) && ok;
+        pen.setCap(Pen::Cap::Square);
+        ok = checkArea("Square cap", x, y, false, pen, 24.0, 1e-9) && ok;
+        // Round caps are polygons within a quarter pixel of the circle
+        Pen widePen(Color::black(), 20.0);
+        widePen.setCap(Pen::Cap::Round);
+        ok = checkArea("Round cap", x, y, false, widePen, 200.0 + M_PI*100.0, 0.03) && ok;
+
+        // Right angle, the miter fills the corner exactly
+        pen.setCap(Pen::Cap::Butt);
+        x = { 0, 10, 10 }; y = { 0, 0, 10 };
+        ok = checkArea("Miter join", x, y, false, pen, 40.0, 1e-9) && ok;
+
+        // Closed square of side 10, outlined from 8 to 12 wide
+        x = { 0, 10, 10, 0 }; y = { 0, 0, 10, 10 };
+        ok = checkArea("Closed miter", x, y, true, pen, 12.0*12.0 - 8.0*8.0, 1e-9) && ok;
+    }
+
+    // Random walk lines in pixels
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> step(-10.0, 10.0);
+    std::vector<std::vector<double>> xs, ys;
+    for (int i(0); i<nSegments/segmentsPerLine; ++i)
+    {
+        std::vector<double> x = { 0.0 }, y = { 0.0 };
+        for (int j(0); j<segmentsPerLine; ++j)
+        {
+            x.push_back(x.back() + step(rng));
+            y.push_back(y.back() + step(rng));
+        }
+        xs.push_back(std::move(x));
+        ys.push_back(std::move(y));
+    }
+
+    struct Style { const char* name; Pen::Join join; Pen::Cap cap; };
+    for (const auto& style : { Style{ "miter/butt", Pen::Join::Miter, Pen::Cap::Butt },
+                               Style{ "bevel/square", Pen::Join::Bevel, Pen::Cap::Square },
+                               Style{ "round/round", Pen::Join::Round, Pen::Cap::Round } })
+    {
+        Pen pen(Color::black(), 4.0);
+        pen.setJoin(style.join);
+        pen.setCap(style.cap);
+
+        std::vector<LineTessellation::Vertex> vertices;
+        std::vector<uint32_t> indices;
+        int64_t t1 = 0;
+        for (int k(0); k<=iterations; ++k)
+        {
+            if (k == 1)
+            {
+                t1 = getTimeStampMs(); // The first round allocates the output
+            }
+            vertices.clear();
+            indices.clear();
+            for (size_t i(0); i<xs.size(); ++i)
+            {
+                LineTessellation::tessellate(xs[i].data(), ys[i].data(), xs[i].size(), false, pen, vertices, indices);
+            }
+        }
+        double ms = (getTimeStampMs() - t1)/double(iterations);
+
+        std::cout << "Joins/caps " << style.name << ": " << ms << " ms for " << xs.size()*segmentsPerLine << " segments ("
+                  << (ms > 0 ? xs.size()*segmentsPerLine/ms/1000.0 : 0.0) << " M segments/s), "
+                  << vertices.size() << " vertices, " << indices.size()/3 << " triangles\n";
+    }
+
+    if (!ok)
+    {
+        std::cout << "Tessellation incorrect\n";
+        return 1;
+    }
+
+    return 0;
+}
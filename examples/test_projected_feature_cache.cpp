@@ -0,0 +1,80 @@
+#include "BlueMarbleMaps/Core/Index/ProjectedFeatureCache.h"
+
+#include <cmath>
+#include <iostream>
+#include <random>
+
+using namespace BlueMarble;
+
+// Measures the cost per frame of presenting lng/lat features in web mercator, projecting
+// every feature each frame (as before) compared with using the ProjectedFeatureCache.
+
+int main(int argc, char* argv[])
+{
+    int nFeatures = argc > 1 ? std::atoi(argv[1]) : 20000;
+    int frames = argc > 2 ? std::atoi(argv[2]) : 20;
+    auto lngLat = Crs::wgs84LngLat();
+    auto mercator = Crs::wgs84MercatorWeb();
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<double> lng(-170.0, 170.0);
+    std::uniform_real_distribution<double> lat(-80.0, 80.0);
+    std::vector<FeaturePtr> features;
+    features.reserve(nFeatures);
+    for (int i(0); i<nFeatures; ++i)
+    {
+        Point center(lng(rng), lat(rng));
+        std::vector<Point> ring;
+        int nPoints = 200;
+        for (int j(0); j<nPoints; ++j)
+        {
+            double angle = 2.0*M_PI*j/nPoints;
+            ring.emplace_back(center.x() + std::cos(angle), center.y() + std::sin(angle));
+        }
+        features.push_back(std::make_shared<Feature>(Id(0, i), lngLat, std::make_shared<PolygonGeometry>(ring)));
+    }
+
+    auto t1 = getTimeStampMs();
+    for (int i(0); i<frames; ++i)
+    {
+        for (const auto& f : features)
+        {
+            auto projected = f->projectTo(mercator);
+        }
+    }
+    auto projectMs = getTimeStampMs() - t1;
+
+    ProjectedFeatureCache cache;
+    t1 = getTimeStampMs();
+    for (const auto& f : features)
+    {
+        cache.projectTo(mercator, f);
+    }
+    auto fillMs = getTimeStampMs() - t1;
+
+    t1 = getTimeStampMs();
+    for (int i(0); i<frames; ++i)
+    {
+        for (const auto& f : features)
+        {
+            auto projected = cache.projectTo(mercator, f);
+        }
+    }
+    auto cachedMs = getTimeStampMs() - t1;
+
+    // Modifying a feature invalidates its cached projection only
+    features[0]->move(Point(1.0, 0.0));
+    size_t misses = cache.misses();
+    for (const auto& f : features)
+    {
+        cache.projectTo(mercator, f);
+    }
+
+    std::cout << "Features: " << nFeatures << ", frames: " << frames << "\n";
+    std::cout << "Projecting every frame: " << (double)projectMs / frames << " ms/frame\n";
+    std::cout << "Cache fill: " << fillMs << " ms, cached: " << (double)cachedMs / frames << " ms/frame"
+              << ", memory: " << cache.memoryUsage() / 1024 << " kB\n";
+    std::cout << "Misses after modifying one feature: " << cache.misses() - misses << "\n";
+
+    return 0;
+}
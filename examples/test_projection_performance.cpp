@@ -0,0 +1,115 @@
+#include "BlueMarbleMaps/CoordinateSystem/Crs.h"
+#include "BlueMarbleMaps/CoordinateSystem/MercatorKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+using namespace BlueMarble;
+
+// Measures the throughput of the batch lng/lat <-> web mercator kernels for each
+// instruction set, compared with projecting one point at a time through Crs::projectTo.
+// Also reports the largest difference to the scalar implementation.
+
+static double maxDifference(const std::vector<double>& a, const std::vector<double>& b)
+{
+    double diff = 0.0;
+    for (size_t i(0); i<a.size(); ++i)
+    {
+        diff = std::max(diff, std::abs(a[i] - b[i]));
+    }
+    return diff;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t nPoints = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 10;
+    constexpr double radius = 6378137.0;
+    using namespace MercatorKernels;
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<double> lng(-180.0, 180.0);
+    std::uniform_real_distribution<double> lat(-85.0, 85.0);
+    std::vector<double> xIn(nPoints), yIn(nPoints);
+    for (size_t i(0); i<nPoints; ++i)
+    {
+        xIn[i] = lng(rng);
+        yIn[i] = lat(rng);
+    }
+
+    // Scalar results as reference
+    std::vector<double> xRef = xIn, yRef = yIn;
+    project(InstructionSet::Scalar, xRef.data(), yRef.data(), nPoints, radius);
+
+    std::cout << "Points: " << nPoints << ", iterations: " << iterations
+              << ", best instruction set: " << toString(bestInstructionSet()) << "\n";
+
+    for (auto instructionSet : { InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::AVX2 })
+    {
+        if (instructionSet > bestInstructionSet())
+        {
+            std::cout << toString(instructionSet) << ": not supported\n";
+            continue;
+        }
+
+        std::vector<double> x, y;
+        int64_t projectMs = 0;
+        int64_t unProjectMs = 0;
+        double projectDiff = 0.0;
+        double roundTripDiff = 0.0;
+        for (int i(0); i<iterations; ++i)
+        {
+            x = xIn;
+            y = yIn;
+            auto t1 = getTimeStampMs();
+            project(instructionSet, x.data(), y.data(), nPoints, radius);
+            projectMs += getTimeStampMs() - t1;
+            projectDiff = std::max(maxDifference(x, xRef), maxDifference(y, yRef));
+
+            t1 = getTimeStampMs();
+            unProject(instructionSet, x.data(), y.data(), nPoints, radius);
+            unProjectMs += getTimeStampMs() - t1;
+            roundTripDiff = std::max(maxDifference(x, xIn), maxDifference(y, yIn));
+        }
+
+        double nTransformed = (double)iterations * nPoints;
+        std::cout << toString(instructionSet) << ": "
+                  << "project " << nTransformed / std::max<int64_t>(1, projectMs) / 1000.0 << " Mpts/s"
+                  << ", unProject " << nTransformed / std::max<int64_t>(1, unProjectMs) / 1000.0 << " Mpts/s"
+                  << ", max difference to scalar: " << projectDiff << " m"
+                  << ", max round trip error: " << roundTripDiff << " deg\n";
+    }
+
+    // One point at a time, as done before the batch api
+    auto lngLat = Crs::wgs84LngLat();
+    auto mercator = Crs::wgs84MercatorWeb();
+    double checksum = 0.0;
+    auto t1 = getTimeStampMs();
+    for (int i(0); i<iterations; ++i)
+    {
+        for (size_t j(0); j<nPoints; ++j)
+        {
+            auto p = lngLat->projectTo(mercator, Point(xIn[j], yIn[j]));
+            checksum += p.y();
+        }
+    }
+    auto pointMs = getTimeStampMs() - t1;
+
+    std::vector<double> x = xIn, y = yIn;
+    t1 = getTimeStampMs();
+    for (int i(0); i<iterations; ++i)
+    {
+        lngLat->projectTo(mercator, x.data(), y.data(), nPoints);
+        mercator->projectTo(lngLat, x.data(), y.data(), nPoints);
+    }
+    auto batchMs = getTimeStampMs() - t1;
+
+    double nTransformed = (double)iterations * nPoints;
+    std::cout << "Crs::projectTo, per point: " << nTransformed / std::max<int64_t>(1, pointMs) / 1000.0 << " Mpts/s"
+              << " (checksum " << checksum << ")"
+              << ", batch: " << 2.0 * nTransformed / std::max<int64_t>(1, batchMs) / 1000.0 << " Mpts/s\n";
+
+    return 0;
+}
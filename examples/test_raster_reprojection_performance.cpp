@@ -0,0 +1,98 @@
+#include "BlueMarbleMaps/Core/RasterWarp.h"
+
+#include <iostream>
+
+using namespace BlueMarble;
+
+// Compares raster reprojection with RasterWarp (separable and grid interpolated mapping)
+// with the previous implementation, inverse projecting and sampling one cell at a time
+// through the Raster accessors. Reports the time and the fraction of differing cells.
+
+static RasterGeometryPtr reProjectPerCell(RasterGeometry& source, const CrsPtr& sourceCrs, const CrsPtr& targetCrs)
+{
+    auto& currRaster = source.raster();
+    auto newBounds = sourceCrs->projectTo(targetCrs, source.bounds());
+    auto newRaster = std::make_shared<RasterGeometry>(Raster(currRaster.width(), currRaster.height(), currRaster.channels()), newBounds);
+
+    for (int i(0); i < currRaster.width(); ++i)
+    {
+        for (int j(0); j < currRaster.height(); ++j)
+        {
+            auto p = newRaster->rasterIndexToPoint(i,j);
+            auto pOld = targetCrs->projectTo(sourceCrs, p);
+            auto ind = source.pointToRasterIndex(pOld);
+            auto color = currRaster.getColorAt(ind.x(), ind.y());
+            newRaster->raster().setColorAt(i,j, color);
+        }
+    }
+
+    return newRaster;
+}
+
+static double differingFraction(RasterGeometry& a, RasterGeometry& b)
+{
+    auto& rasterA = a.raster();
+    auto& rasterB = b.raster();
+    size_t n = (size_t)rasterA.width()*rasterA.height();
+    size_t channels = rasterA.channels();
+    auto dataA = (const unsigned char*)rasterA.data();
+    auto dataB = (const unsigned char*)rasterB.data();
+    size_t differing = 0;
+    for (size_t i(0); i<n; ++i)
+    {
+        for (size_t c(0); c<channels; ++c)
+        {
+            if (dataA[i*channels + c] != dataB[i*channels + c])
+            {
+                ++differing;
+                break;
+            }
+        }
+    }
+
+    return (double)differing / n;
+}
+
+int main(int argc, char* argv[])
+{
+    int size = argc > 1 ? std::atoi(argv[1]) : 4096;
+    auto lngLat = Crs::wgs84LngLat();
+    auto mercator = Crs::wgs84MercatorWeb();
+
+    // A pattern where every cell has its own color
+    auto raster = Raster(size, size, 4);
+    auto data = (unsigned char*)raster.data();
+    for (int j(0); j<size; ++j)
+    {
+        for (int i(0); i<size; ++i)
+        {
+            unsigned char* cell = data + ((size_t)j*size + i)*4;
+            cell[0] = (unsigned char)i;
+            cell[1] = (unsigned char)j;
+            cell[2] = (unsigned char)((i >> 8) ^ (j >> 4));
+            cell[3] = 255;
+        }
+    }
+    auto source = RasterGeometry(std::move(raster), Rectangle(-180.0, -85.0, 180.0, 85.0));
+
+    std::cout << "Raster: " << size << "x" << size << ", lng/lat to web mercator\n";
+
+    auto t1 = getTimeStampMs();
+    auto perCell = reProjectPerCell(source, lngLat, mercator);
+    std::cout << "Per cell: " << getTimeStampMs() - t1 << " ms\n";
+
+    t1 = getTimeStampMs();
+    auto separable = RasterWarp::reProject(source, lngLat, mercator);
+    std::cout << "RasterWarp, separable: " << getTimeStampMs() - t1 << " ms"
+              << ", differing cells: " << 100.0*differingFraction(*perCell, *separable) << " %\n";
+
+    for (int gridStep : { 8, 16, 32 })
+    {
+        t1 = getTimeStampMs();
+        auto grid = RasterWarp::reProject(source, lngLat, mercator, RasterWarp::Method::Grid, gridStep);
+        std::cout << "RasterWarp, grid step " << gridStep << ": " << getTimeStampMs() - t1 << " ms"
+                  << ", differing cells: " << 100.0*differingFraction(*perCell, *grid) << " %\n";
+    }
+
+    return 0;
+}
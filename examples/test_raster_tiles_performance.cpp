@@ -0,0 +1,151 @@
+#include "BlueMarbleMaps/Core/Core.h"
+#include "BlueMarbleMaps/Core/OpenGLDrawable.h"
+#include "BlueMarbleMaps/Utility/Utils.h"
+
+#include "gtc/matrix_transform.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+using namespace BlueMarble;
+
+// Measures the time per frame of drawing a raster larger than the largest texture size with
+// OpenGLDrawable, zooming from the whole raster in to full resolution and panning across it.
+// Reports the tiles uploaded to and evicted from the texture atlas, which stays within its budget, and
+// the frames drawn partly from a coarser level while the uploads per frame are capped.
+// Checks that a checkerboard zoomed out is drawn gray, averaged rather than point sampled.
+// Uses a hidden window, and must run from a directory containing the Shaders/ folder.
+// Runs without a GPU on Mesa llvmpipe: LIBGL_ALWAYS_SOFTWARE=1 ./TestRasterTilesPerformance
+
+int main(int argc, char* argv[])
+{
+    int rasterWidth = argc > 1 ? std::atoi(argv[1]) : 20000;
+    int rasterHeight = argc > 2 ? std::atoi(argv[2]) : 5000;
+    int frames = argc > 3 ? std::atoi(argv[3]) : 200;
+    int uploadsPerFrame = argc > 4 ? std::atoi(argv[4]) : 16;
+    int width = 1024, height = 768;
+
+    if (!glfwInit())
+    {
+        std::cout << "Could not initialize GLFW\n";
+        return 1;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(width, height, "TestRasterTilesPerformance", nullptr, nullptr);
+    if (window == nullptr)
+    {
+        std::cout << "Could not create an OpenGL context\n";
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+
+    // A gradient, one map unit per cell
+    Raster raster(rasterWidth, rasterHeight, 3);
+    auto data = (unsigned char*)raster.data();
+    for (int y(0); y<rasterHeight; ++y)
+    {
+        for (int x(0); x<rasterWidth; ++x)
+        {
+            unsigned char* cell = data + ((size_t)y*rasterWidth + x)*3;
+            cell[0] = (unsigned char)(x*255/rasterWidth);
+            cell[1] = (unsigned char)(y*255/rasterHeight);
+            cell[2] = 128;
+        }
+    }
+    auto geometry = std::make_shared<RasterGeometry>(std::move(raster), Rectangle(0.0, 0.0, rasterWidth, rasterHeight));
+
+    bool ok = true;
+    {
+        OpenGLDrawable drawable(width, height);
+        drawable.rasterMemoryBudget(64*1024*1024);
+        drawable.rasterUploadsPerFrame(uploadsPerFrame);
+        Brush brush(Color::white());
+
+        auto drawFrame = [&](const Rectangle& view, double scale, const RasterGeometryPtr& raster)
+        {
+            drawable.clearBuffer();
+            drawable.setProjectionMatrix(glm::ortho(-0.5*width, 0.5*width, -0.5*height, 0.5*height, -1.0, 1.0));
+            drawable.setViewMatrix(glm::scale(glm::dmat4(1.0), glm::dvec3(scale, scale, 1.0)));
+            drawable.setRenderOrigin(view.center());
+            drawable.beginBatches();
+            drawable.drawRaster(raster, brush, view);
+            drawable.endBatches();
+            glFinish();
+        };
+
+        double worstMs = 0.0;
+        int incompleteFrames = 0;
+        Rectangle view;
+        double scale = 1.0;
+        auto t1 = getTimeStampMs();
+        for (int k(0); k<frames; ++k)
+        {
+            // Zoom in during the first half, pan at full resolution during the second
+            double progress = std::min(1.0, 2.0*k/frames);
+            scale = (double)width/rasterWidth*std::pow((double)rasterWidth/width, progress);
+            double pan = k < frames/2 ? 0.5 : 0.5 + 0.4*(2.0*k/frames - 1.0);
+            view = Rectangle(Point(rasterWidth*pan, rasterHeight*0.5), width/scale, height/scale);
+
+            auto t2 = getTimeStampMs();
+            drawFrame(view, scale, geometry);
+            worstMs = std::max(worstMs, double(getTimeStampMs() - t2));
+            incompleteFrames += drawable.isComplete() ? 0 : 1;
+        }
+        double ms = (getTimeStampMs() - t1) / double(frames);
+        auto stats = drawable.rasterStats();
+
+        // The last view, until all its tiles are uploaded
+        int settleFrames = 0;
+        while (!drawable.isComplete() && settleFrames < 100)
+        {
+            drawFrame(view, scale, geometry);
+            ++settleFrames;
+        }
+
+        std::cout << "Raster: " << rasterWidth << " x " << rasterHeight << ", " << frames << " frames, budget "
+                  << drawable.rasterMemoryBudget()/(1024*1024) << " MB\n";
+        std::cout << ms << " ms/frame, worst frame " << worstMs << " ms, " << stats.uploads << " tile uploads, "
+                  << stats.evictions << " evictions, " << stats.flushes << " flushes\n";
+        std::cout << incompleteFrames << " frames drawn partly coarser (" << drawable.rasterUploadsPerFrame()
+                  << " uploads per frame), " << settleFrames << " frames to complete the last view\n";
+
+        ok = stats.uploads > 0 && drawable.isComplete();
+        if (!ok)
+        {
+            std::cout << "No tiles were uploaded, or the last view was not completed\n";
+        }
+
+        // A checkerboard of single cells, at a level of detail of 8x8 cells per texel
+        int size = 4096;
+        Raster checkerboard(size, size, 1);
+        auto cells = (unsigned char*)checkerboard.data();
+        for (int y(0); y<size; ++y)
+            for (int x(0); x<size; ++x)
+                cells[(size_t)y*size + x] = (x + y) % 2 == 0 ? 255 : 0;
+        auto checkerboardGeometry = std::make_shared<RasterGeometry>(std::move(checkerboard), Rectangle(0.0, 0.0, size, size));
+        Rectangle checkerboardView(Point(size*0.5, size*0.5), width*8.0, height*8.0);
+        do
+        {
+            drawFrame(checkerboardView, 1.0/8.0, checkerboardGeometry);
+        }
+        while (!drawable.isComplete());
+        auto gray = drawable.readPixel(width/2, height/2);
+        std::cout << "Checkerboard zoomed out: " << gray.r() << " (128 when averaged)\n";
+        if (std::abs(gray.r() - 128) > 2)
+        {
+            std::cout << "Downsampled tiles are not averaged\n";
+            ok = false;
+        }
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return ok ? 0 : 1;
+}
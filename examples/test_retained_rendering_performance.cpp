@@ -0,0 +1,167 @@
+#include "BlueMarbleMaps/Core/Core.h"
+#include "BlueMarbleMaps/Core/OpenGLDrawable.h"
+#include "BlueMarbleMaps/Utility/Utils.h"
+
+#include "gtc/matrix_transform.hpp"
+
+#include <cmath>
+#include <iostream>
+#include <random>
+
+using namespace BlueMarble;
+
+// Measures the CPU time per frame of drawing a static set of lines and polygons with OpenGLDrawable,
+// uploading the vertices every frame (batches) against keeping the GPU buffers of unchanged
+// geometries (retained mode), with a pan of the view as the only change between frames.
+// The CPU time is the time spent submitting the geometries to the drawable, the frame time also
+// includes the draw calls and waits for the GPU (glFinish).
+// Checks that retained geometries are drawn in the order they were submitted.
+// Uses a hidden window, and must run from a directory containing the Shaders/ folder.
+// Runs without a GPU on Mesa llvmpipe: LIBGL_ALWAYS_SOFTWARE=1 ./TestRetainedRenderingPerformance
+
+static std::vector<Point> createRing(std::mt19937& rng, const Point& center, double radius, int nPoints)
+{
+    std::uniform_real_distribution<double> jitter(0.7, 1.0);
+    std::vector<Point> points;
+    for (int i(0); i<nPoints; ++i)
+    {
+        double angle = 2.0*M_PI*i/nPoints;
+        double r = radius*jitter(rng);
+        points.emplace_back(center.x() + r*std::cos(angle), center.y() + r*std::sin(angle));
+    }
+    return points;
+}
+
+struct FrameTimes
+{
+    double cpuMs;
+    double frameMs;
+};
+
+static FrameTimes renderFrames(OpenGLDrawable& drawable, const std::vector<PolygonGeometryPtr>& polygons,
+                               const std::vector<LineGeometryPtr>& lines, int frames)
+{
+    Pen pen(Color::blue(), 2.0);
+    Brush brush(Color::red(0.5));
+
+    double cpuMs = 0.0;
+    auto t1 = getTimeStampMs();
+    for (int k(0); k<frames; ++k)
+    {
+        drawable.clearBuffer();
+        glFinish();
+        drawable.setViewMatrix(glm::translate(glm::dmat4(1.0), glm::dvec3(k % 100, 0.0, 0.0)));
+        drawable.beginBatches();
+        auto t2 = getTimeStampMs();
+        for (const auto& polygon : polygons)
+            drawable.drawPolygon(polygon, pen, brush);
+        for (const auto& line : lines)
+            drawable.drawLine(line, pen);
+        cpuMs += getTimeStampMs() - t2;
+        drawable.endBatches();
+        glFinish();
+    }
+    return FrameTimes{ cpuMs / frames, (getTimeStampMs() - t1) / double(frames) };
+}
+
+// A batched square (new every frame) drawn after a retained one covering it, the pixel in the
+// middle has to be from the batched one
+static bool drawsInOrder(OpenGLDrawable& drawable)
+{
+    auto below = std::make_shared<PolygonGeometry>(Rectangle(100.0, 100.0, 200.0, 200.0));
+    Color color;
+    for (int k(0); k<3; ++k)
+    {
+        auto above = std::make_shared<PolygonGeometry>(Rectangle(120.0, 120.0, 180.0, 180.0));
+        drawable.clearBuffer();
+        drawable.setViewMatrix(glm::dmat4(1.0));
+        drawable.beginBatches();
+        drawable.drawPolygon(below, Pen::transparent(), Brush(Color::red()));
+        drawable.drawPolygon(above, Pen::transparent(), Brush(Color::green()));
+        drawable.endBatches();
+        color = drawable.readPixel(150, 150);
+    }
+    return color.g() == 255 && color.r() == 0;
+}
+
+int main(int argc, char* argv[])
+{
+    int nFeatures = argc > 1 ? std::atoi(argv[1]) : 5000;
+    int frames = argc > 2 ? std::atoi(argv[2]) : 100;
+    int width = 1024, height = 768;
+
+    if (!glfwInit())
+    {
+        std::cout << "Could not initialize GLFW\n";
+        return 1;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(width, height, "TestRetainedRenderingPerformance", nullptr, nullptr);
+    if (window == nullptr)
+    {
+        std::cout << "Could not create an OpenGL context\n";
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> coordinate(0.0, 1.0);
+    std::vector<PolygonGeometryPtr> polygons;
+    std::vector<LineGeometryPtr> lines;
+    // Drawn tile by tile, as from a TileLayer
+    const int tileSize = 256;
+    int tilesX = (width + tileSize - 1)/tileSize;
+    int tilesY = (height + tileSize - 1)/tileSize;
+    for (int i(0); i<nFeatures; ++i)
+    {
+        int tile = (int)((long long)i*tilesX*tilesY/nFeatures);
+        Point center(((tile % tilesX) + coordinate(rng))*tileSize, ((tile / tilesX) + coordinate(rng))*tileSize);
+        polygons.push_back(std::make_shared<PolygonGeometry>(createRing(rng, center, 10.0, 50)));
+        lines.push_back(std::make_shared<LineGeometry>(createRing(rng, center, 15.0, 50)));
+    }
+
+    bool ok = true;
+    {
+        OpenGLDrawable drawable(width, height);
+        drawable.setProjectionMatrix(glm::ortho(0.0, double(width), double(height), 0.0, -1.0, 1.0));
+
+        drawable.retainedMode(false);
+        auto batched = renderFrames(drawable, polygons, lines, frames);
+        auto stats = drawable.batchStats();
+
+        drawable.retainedMode(true);
+        renderFrames(drawable, polygons, lines, 2); // Buffers are created the second frame a geometry is drawn
+        auto retainedStats = drawable.retainedStats();
+        auto retained = renderFrames(drawable, polygons, lines, frames);
+        size_t retainedDrawCalls = (drawable.retainedStats().drawCalls - retainedStats.drawCalls)/frames;
+
+        std::cout << "Features: " << nFeatures << " polygons and lines, " << frames << " frames\n";
+        std::cout << "Uploaded every frame: " << batched.cpuMs << " ms CPU, " << batched.frameMs << " ms/frame (" << stats.vertices << " vertices, "
+                  << stats.drawCalls << " draw calls, " << stats.flushes << " flushes, " << stats.waits << " fence waits per frame)\n";
+        std::cout << "Retained: " << retained.cpuMs << " ms CPU, " << retained.frameMs << " ms/frame (" << drawable.retainedCount() << " retained geometries in "
+                  << drawable.retainedStats().pages << " pages, " << retainedDrawCalls << " draw calls per frame)\n";
+
+        ok = drawable.retainedCount() == polygons.size() + lines.size();
+        if (!drawsInOrder(drawable))
+        {
+            std::cout << "Retained and batched geometries were not drawn in the order they were submitted\n";
+            ok = false;
+        }
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    if (!ok)
+    {
+        std::cout << "Retained rendering failed\n";
+        return 1;
+    }
+
+    return 0;
+}
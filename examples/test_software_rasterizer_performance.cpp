@@ -0,0 +1,191 @@
+#include "BlueMarbleMaps/Core/Core.h"
+#include "BlueMarbleMaps/Core/LineTessellation.h"
+#include "BlueMarbleMaps/Core/SoftwareRasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <thread>
+
+using namespace BlueMarble;
+
+// Measures the frame rate of the software rasterizer for 4K frames of polygons and wide lines with 1, 2, 4 ...
+// threads, no window needed. Checks that every thread count gives the same image, and the coverage of a
+// few shapes whose area is known.
+
+static size_t countPixels(const std::vector<uint8_t>& image, int width, int height, uint8_t value)
+{
+    return std::count(image.begin(), image.begin() + size_t(width)*height, value);
+}
+
+static bool checkCoverage()
+{
+    int w = 300, h = 200;
+    std::vector<uint8_t> image(size_t(w)*h*3, 0);
+    SoftwareRasterizer rasterizer(2);
+    rasterizer.setTarget(image.data(), w, h, 3);
+    bool ok = true;
+
+    // Square with a hole, even-odd
+    double x[] = { 10, 60, 60, 10,   20, 40, 40, 20 };
+    double y[] = { 10, 10, 60, 60,   20, 20, 40, 40 };
+    size_t rings[] = { 0, 4, 8 };
+    rasterizer.fillPolygon(x, y, rings, 2, Color::white());
+    rasterizer.flush();
+    size_t n = countPixels(image, w, h, 255);
+    if (n != 50*50 - 20*20)
+    {
+        std::cout << "Polygon with hole: " << n << " pixels, expected " << 50*50 - 20*20 << "\n";
+        ok = false;
+    }
+
+    // Two triangles of opposite orientation making up a square, no gap or double blending on the diagonal
+    std::fill(image.begin(), image.end(), 0);
+    double tx[] = { 0, 30, 30, 0 };
+    double ty[] = { 0, 0, 30, 30 };
+    uint32_t indices[] = { 0, 1, 2,   0, 3, 2 };
+    rasterizer.fillTriangles(tx, ty, indices, 6, Color(255, 255, 255, 0.5));
+    rasterizer.flush();
+    n = countPixels(image, w, h, 128);
+    if (n != 30*30)
+    {
+        std::cout << "Triangle union: " << n << " pixels, expected " << 30*30 << "\n";
+        ok = false;
+    }
+
+    // Shapes across several tiles, spans crossing tile borders
+    std::fill(image.begin(), image.end(), 0);
+    double rx[] = { 10, 250, 250, 10 };
+    double ry[] = { 100, 100, 140, 140 };
+    size_t rectRings[] = { 0, 4 };
+    rasterizer.fillPolygon(rx, ry, rectRings, 1, Color::white());
+    rasterizer.fillTriangles(tx, ty, indices, 6, Color::white()); // Inside tile 0, not overlapping the rectangle
+    double wx[] = { 5, 290, 290, 5 };
+    double wy[] = { 150, 150, 190, 190 };
+    rasterizer.fillTriangles(wx, wy, indices, 6, Color::white());
+    rasterizer.flush();
+    n = countPixels(image, w, h, 255);
+    size_t expected = 240*40 + 30*30 + 285*40;
+    if (n != expected)
+    {
+        std::cout << "Shapes across tiles: " << n << " pixels, expected " << expected << "\n";
+        ok = false;
+    }
+
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    int width = argc > 1 ? std::atoi(argv[1]) : 3840;
+    int height = argc > 2 ? std::atoi(argv[2]) : 2160;
+    int frames = argc > 3 ? std::atoi(argv[3]) : 10;
+    int nPolygons = 20000;
+    int nLines = 5000;
+
+    bool ok = checkCoverage();
+
+    // Random polygons of 5 to 20 points and random walk lines, in pixels
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<double> polygonX, polygonY;
+    std::vector<size_t> polygonOffsets = { 0 };
+    std::vector<Color> polygonColors;
+    for (int i(0); i<nPolygons; ++i)
+    {
+        double cx = unit(rng)*width, cy = unit(rng)*height, r = 5.0 + unit(rng)*60.0;
+        int n = 5 + int(unit(rng)*16);
+        for (int k(0); k<n; ++k)
+        {
+            double angle = 2.0*M_PI*k/n;
+            double radius = r*(0.5 + 0.5*unit(rng));
+            polygonX.push_back(cx + radius*std::cos(angle));
+            polygonY.push_back(cy + radius*std::sin(angle));
+        }
+        polygonOffsets.push_back(polygonX.size());
+        polygonColors.push_back(Color(int(unit(rng)*255), int(unit(rng)*255), int(unit(rng)*255), 0.3 + 0.7*unit(rng)));
+    }
+
+    Pen pen(Color(20, 20, 20, 0.8), 3.0);
+    pen.setJoin(Pen::Join::Round);
+    std::vector<std::vector<double>> lineX, lineY;
+    std::vector<std::vector<uint32_t>> lineIndices;
+    for (int i(0); i<nLines; ++i)
+    {
+        std::vector<double> x = { unit(rng)*width }, y = { unit(rng)*height };
+        for (int k(0); k<20; ++k)
+        {
+            x.push_back(x.back() + (unit(rng) - 0.5)*40.0);
+            y.push_back(y.back() + (unit(rng) - 0.5)*40.0);
+        }
+        std::vector<LineTessellation::Vertex> vertices;
+        std::vector<uint32_t> indices;
+        LineTessellation::tessellate(x.data(), y.data(), x.size(), false, pen, vertices, indices);
+        std::vector<double> vx, vy;
+        for (const auto& vertex : vertices)
+        {
+            vx.push_back(x[vertex.point] + vertex.offsetX);
+            vy.push_back(y[vertex.point] + vertex.offsetY);
+        }
+        lineX.push_back(std::move(vx));
+        lineY.push_back(std::move(vy));
+        lineIndices.push_back(std::move(indices));
+    }
+
+    std::vector<uint8_t> image(size_t(width)*height*4);
+    std::vector<uint8_t> reference;
+    // Up to 4 threads at least, more than the hardware has only shows the overhead
+    unsigned int maxThreads = std::max(4u, std::thread::hardware_concurrency());
+    std::cout << std::thread::hardware_concurrency() << " hardware threads\n";
+    for (unsigned int threads(1); ; threads = std::min(threads*2, maxThreads))
+    {
+        SoftwareRasterizer rasterizer(threads);
+        rasterizer.setTarget(image.data(), width, height, 4);
+        int64_t t1 = 0;
+        for (int k(0); k<=frames; ++k)
+        {
+            if (k == 1)
+            {
+                t1 = getTimeStampMs(); // The first frame allocates the bins
+            }
+            std::fill(image.begin(), image.end(), 255);
+            for (int i(0); i<nPolygons; ++i)
+            {
+                size_t offsets[] = { 0, polygonOffsets[i+1] - polygonOffsets[i] };
+                rasterizer.fillPolygon(polygonX.data() + polygonOffsets[i], polygonY.data() + polygonOffsets[i], offsets, 1, polygonColors[i]);
+            }
+            for (int i(0); i<nLines; ++i)
+            {
+                rasterizer.fillTriangles(lineX[i].data(), lineY[i].data(), lineIndices[i].data(), lineIndices[i].size(), pen.getColor());
+            }
+            rasterizer.flush();
+        }
+        double ms = (getTimeStampMs() - t1)/double(frames);
+
+        std::cout << threads << " threads: " << ms << " ms per " << width << "x" << height << " frame ("
+                  << (ms > 0 ? 1000.0/ms : 0.0) << " fps), " << nPolygons << " polygons, " << nLines << " lines\n";
+
+        if (reference.empty())
+        {
+            reference = image;
+        }
+        else if (image != reference)
+        {
+            std::cout << "Image with " << threads << " threads differs from the one with 1 thread\n";
+            ok = false;
+        }
+        if (threads == maxThreads)
+        {
+            break;
+        }
+    }
+
+    if (!ok)
+    {
+        std::cout << "Rasterization incorrect\n";
+        return 1;
+    }
+
+    return 0;
+}
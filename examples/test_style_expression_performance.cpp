@@ -0,0 +1,111 @@
+#include "BlueMarbleMaps/Core/Core.h"
+#include "BlueMarbleMaps/Core/AttributeVariable.h"
+#include "BlueMarbleMaps/Core/StyleExpression.h"
+
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+using namespace BlueMarble;
+
+// Compares evaluation of a style property written as nested std::function evaluations
+// (as the visualizers are configured today) with the same property as a compiled style
+// expression. The property: width = interpolate(POP_EST) * (TYPE == "city" ? 2 : 1) * viewScale
+// Also checks a feature independent expression evaluated at different view scales from two threads.
+
+int main(int argc, char* argv[])
+{
+    int nFeatures = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int frames = argc > 2 ? std::atoi(argv[2]) : 20;
+
+    std::vector<FeaturePtr> features;
+    features.reserve(nFeatures);
+    for (int i(0); i<nFeatures; ++i)
+    {
+        Attributes attributes;
+        attributes.set("NAME", std::string("Feature " + std::to_string(i)));
+        attributes.set("TYPE", std::string(i % 3 == 0 ? "city" : "town"));
+        attributes.set("POP_EST", double(i % 1000)*1e4);
+        features.push_back(std::make_shared<Feature>(Id(0, i), Crs::wgs84LngLat(), std::make_shared<PointGeometry>(Point(i, i)), attributes));
+    }
+    Attributes updateAttributes;
+    updateAttributes.set(UpdateAttributeKeys::UpdateViewScale, 0.5);
+
+    // Nested functions, string lookups at each level
+    DoubleEvaluation population = IndirectDoubleAttributeVariable("POP_EST", 0.0);
+    DoubleEvaluation baseWidth = [population](const FeaturePtr& f, Attributes& u) mutable
+    {
+        double pop = population(f, u);
+        return std::clamp(1.0 + (pop - 1e5)/(1e7 - 1e5)*3.0, 1.0, 4.0);
+    };
+    DoubleEvaluation typeFactor = [](const FeaturePtr& f, Attributes&)
+    {
+        if (f->attributes().contains("TYPE") && f->attributes().get<std::string>("TYPE") == "city")
+            return 2.0;
+        return 1.0;
+    };
+    DoubleEvaluation functionWidth = [baseWidth, typeFactor](const FeaturePtr& f, Attributes& u) mutable
+    {
+        return baseWidth(f, u)*typeFactor(f, u)*u.get<double>(UpdateAttributeKeys::UpdateViewScale);
+    };
+
+    // Compiled expression
+    auto expression = StyleExpression::interpolate(StyleExpression::attribute("POP_EST"), {{ 1e5, 1.0 }, { 1e7, 4.0 }})
+                    * StyleExpression::match("TYPE", {{ std::string("city"), 2.0 }}, 1.0)
+                    * StyleExpression::viewScale();
+    CompiledStyleExpression compiled(expression);
+
+    double functionSum = 0;
+    auto t1 = getTimeStampMs();
+    for (int k(0); k<frames; ++k)
+        for (const auto& f : features)
+            functionSum += functionWidth(f, updateAttributes);
+    auto functionMs = getTimeStampMs() - t1;
+
+    double compiledSum = 0;
+    t1 = getTimeStampMs();
+    for (int k(0); k<frames; ++k)
+        for (const auto& f : features)
+            compiledSum += compiled(f, updateAttributes);
+    auto compiledMs = getTimeStampMs() - t1;
+
+    // Feature independent expression, constant folded and evaluated once per view scale
+    CompiledStyleExpression constant(StyleExpression::constant(10.0) / 2.0 * StyleExpression::viewScale());
+    double constantSum = 0;
+    t1 = getTimeStampMs();
+    for (int k(0); k<frames; ++k)
+        for (const auto& f : features)
+            constantSum += constant(f, updateAttributes);
+    auto constantMs = getTimeStampMs() - t1;
+
+    std::cout << "Features: " << nFeatures << ", frames: " << frames << "\n";
+    std::cout << "std::function chain:     " << functionMs << " ms\n";
+    std::cout << "Compiled, per feature:   " << compiledMs << " ms (" << compiled.instructionCount() << " instructions)\n";
+    std::cout << "Feature independent:     " << constantMs << " ms (" << constant.instructionCount() << " instructions)\n";
+
+    // Each thread at its own view scale, sharing the cache of the expression
+    std::atomic<int> wrongValues(0);
+    auto evaluateAt = [&](double scale)
+    {
+        Attributes threadUpdateAttributes;
+        threadUpdateAttributes.set(UpdateAttributeKeys::UpdateViewScale, scale);
+        for (int k(0); k<frames; ++k)
+            for (const auto& f : features)
+                if (constant(f, threadUpdateAttributes) != 5.0*scale)
+                    ++wrongValues;
+    };
+    std::thread other(evaluateAt, 2.0);
+    evaluateAt(0.25);
+    other.join();
+
+    auto differs = [](double a, double b) { return std::abs(a - b) > 1e-6*std::abs(a); };
+    if (differs(functionSum, compiledSum) || differs(constantSum, 5.0*0.5*nFeatures*frames) || wrongValues > 0)
+    {
+        std::cout << "Results differ: " << functionSum << ", " << compiledSum << ", " << constantSum
+                  << ", " << wrongValues << " wrong values from two threads\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include "BlueMarbleMaps/Core/Core.h"
+#include "BlueMarbleMaps/Core/OpenGLDrawable.h"
+#include "BlueMarbleMaps/Utility/Utils.h"
+
+#include "gtc/matrix_transform.hpp"
+
+#include <iostream>
+#include <random>
+
+using namespace BlueMarble;
+
+// Measures the time per frame of drawing a point layer of circle symbols with OpenGLDrawable:
+// one drawCircle per point (a ring of vertices through the batches) against drawSymbols, which
+// only fills the instance array and draws one shared circle mesh per instance.
+// Uses a hidden window, and must run from a directory containing the Shaders/ folder.
+// Runs without a GPU on Mesa llvmpipe: LIBGL_ALWAYS_SOFTWARE=1 ./TestSymbolInstancingPerformance
+
+int main(int argc, char* argv[])
+{
+    int nPoints = argc > 1 ? std::atoi(argv[1]) : 200000;
+    int frames = argc > 2 ? std::atoi(argv[2]) : 20;
+    int width = 1024, height = 768;
+
+    if (!glfwInit())
+    {
+        std::cout << "Could not initialize GLFW\n";
+        return 1;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(width, height, "TestSymbolInstancingPerformance", nullptr, nullptr);
+    if (window == nullptr)
+    {
+        std::cout << "Could not create an OpenGL context\n";
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> xCoordinate(0.0, width);
+    std::uniform_real_distribution<double> yCoordinate(0.0, height);
+    std::uniform_real_distribution<double> heading(0.0, 360.0);
+    std::vector<SymbolInstance> symbols;
+    for (int i(0); i<nPoints; ++i)
+    {
+        symbols.push_back(SymbolInstance{ Point(xCoordinate(rng), yCoordinate(rng)), 3.0, heading(rng), Color::red(0.8) });
+    }
+
+    {
+        OpenGLDrawable drawable(width, height);
+        drawable.setProjectionMatrix(glm::ortho(0.0, double(width), double(height), 0.0, -1.0, 1.0));
+
+        auto render = [&](bool instanced)
+        {
+            Brush brush(Color::red(0.8));
+            auto t1 = getTimeStampMs();
+            int64_t submitMs = 0;
+            for (int k(0); k<frames; ++k)
+            {
+                drawable.clearBuffer();
+                drawable.setViewMatrix(glm::translate(glm::dmat4(1.0), glm::dvec3(k % 100, 0.0, 0.0)));
+                drawable.beginBatches();
+                auto t2 = getTimeStampMs();
+                if (instanced)
+                {
+                    drawable.drawSymbols(symbols);
+                }
+                else
+                {
+                    for (const auto& symbol : symbols)
+                        drawable.drawCircle(symbol.position.x(), symbol.position.y(), symbol.size, Pen::transparent(), brush);
+                }
+                submitMs += getTimeStampMs() - t2;
+                drawable.endBatches();
+                glFinish();
+            }
+            double ms = (getTimeStampMs() - t1) / double(frames);
+            std::cout << (instanced ? "Instanced: " : "drawCircle per point: ") << ms << " ms/frame, of which "
+                      << submitMs / double(frames) << " ms on the CPU submitting the points\n";
+        };
+
+        std::cout << "Points: " << nPoints << ", " << frames << " frames\n";
+        render(false);
+        render(true);
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
@@ -0,0 +1,149 @@
+#include "BlueMarbleMaps/Core/Layer/TileLayer.h"
+#include "BlueMarbleMaps/Core/Layer/StandardLayer.h"
+#include "BlueMarbleMaps/Core/DataSets/MemoryDataSet.h"
+#include "BlueMarbleMaps/Core/Drawable.h"
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <thread>
+
+using namespace BlueMarble;
+
+// Parameter sweep over tile sizes (and worker counts) for the TileLayer.
+// Reports the time until all tiles of a view have been loaded, and the approximate
+// memory used by the tile geometries.
+
+// The x, y and z arrays of the buffer, as allocated, and its part offsets
+static size_t coordinateBytes(const CoordinateBuffer& coordinates)
+{
+    return (coordinates.x().capacity() + coordinates.y().capacity() + coordinates.z().capacity())*sizeof(double)
+         + (coordinates.partCount() + 1)*sizeof(size_t);
+}
+
+static size_t geometryBytes(const FeaturePtr& feature)
+{
+    size_t bytes = sizeof(Feature);
+    switch (feature->geometryType())
+    {
+        case GeometryType::Point:
+            bytes += sizeof(PointGeometry);
+            break;
+        case GeometryType::Line:
+            bytes += sizeof(LineGeometry) + coordinateBytes(feature->geometryAsLine()->coordinates());
+            break;
+        case GeometryType::Polygon:
+            bytes += sizeof(PolygonGeometry) + coordinateBytes(feature->geometryAsPolygon()->coordinates());
+            break;
+        case GeometryType::MultiLine:
+            bytes += sizeof(MultiLineGeometry);
+            for (const auto& line : feature->geometryAsMultiLine()->lines())
+                bytes += sizeof(LineGeometry) + coordinateBytes(line.coordinates());
+            break;
+        case GeometryType::MultiPolygon:
+            bytes += sizeof(MultiPolygonGeometry);
+            for (const auto& polygon : feature->geometryAsMultiPolygon()->polygons())
+                bytes += sizeof(PolygonGeometry) + coordinateBytes(polygon.coordinates());
+            break;
+        default:
+            break;
+    }
+
+    return bytes;
+}
+
+static MemoryDataSetPtr createDataSet(int nFeatures)
+{
+    auto dataSet = std::make_shared<MemoryDataSet>();
+    dataSet->initialize(DataSetInitializationType::RightHereRightNow);
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<double> lng(-170.0, 170.0);
+    std::uniform_real_distribution<double> lat(-80.0, 80.0);
+    std::uniform_real_distribution<double> radius(0.5, 8.0);
+
+    for (int i(0); i<nFeatures; ++i)
+    {
+        Point center(lng(rng), lat(rng));
+        double r = radius(rng);
+        int nPoints = 200;
+        std::vector<Point> points;
+        points.reserve(nPoints);
+        for (int j(0); j<nPoints; ++j)
+        {
+            double angle = 2.0*M_PI*j/nPoints;
+            points.emplace_back(center.x() + r*std::cos(angle), center.y() + r*std::sin(angle));
+        }
+
+        if (i % 2 == 0)
+            dataSet->addFeature(dataSet->createFeature(std::make_shared<PolygonGeometry>(points)));
+        else
+            dataSet->addFeature(dataSet->createFeature(std::make_shared<LineGeometry>(points)));
+    }
+
+    return dataSet;
+}
+
+int main()
+{
+    auto crs = Crs::wgs84LngLat();
+    auto dataSet = createDataSet(2000);
+
+    auto layer = std::make_shared<StandardLayer>(false);
+    layer->addDataSet(dataSet);
+    layer->asyncRead(false);
+
+    // View of 1920x1080 pixels
+    double viewWidth = 1920;
+    auto area = Rectangle(-20.0, 30.0, 40.0, 30.0 + 60.0*1080.0/viewWidth);
+    double unitsPerPixel = area.width() / viewWidth;
+    FeatureQuery query;
+    query.area(area);
+    query.scale(Drawable::pixelSize() / crs->globalMetersPerUnit() / unitsPerPixel);
+
+    std::vector<int> tileSizes = { 128, 256, 512, 1024 };
+    std::vector<size_t> workerCounts = { 1, std::max(1u, std::thread::hardware_concurrency()) };
+
+    for (size_t numWorkers : workerCounts)
+    {
+        for (int tileSize : tileSizes)
+        {
+            auto tileLayer = std::make_shared<TileLayer>();
+            tileLayer->addLayer(layer);
+            tileLayer->numWorkers(numWorkers);
+            tileLayer->queueSize(64); // Keep all tile loads of the view
+            tileLayer->tileSize(tileSize);
+
+            auto t1 = getTimeStampMs();
+            tileLayer->prepare(crs, query);
+            while (tileLayer->loadingTileCount() > 0)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                tileLayer->prepare(crs, query); // Reschedules dropped tile loads
+            }
+            auto elapsed = getTimeStampMs() - t1;
+
+            auto features = tileLayer->prepare(crs, query);
+
+            size_t bytes = 0;
+            int nFeatures = 0;
+            features->reset();
+            while (features->moveNext())
+            {
+                bytes += geometryBytes(features->current());
+                ++nFeatures;
+            }
+
+            int nTiles = std::max(1, tileLayer->loadedTileCount());
+            std::cout << "Workers: " << numWorkers
+                      << ", tile size: " << tileSize
+                      << ", tiles: " << nTiles
+                      << ", load time: " << elapsed << " ms"
+                      << ", features: " << nFeatures
+                      << ", memory: " << bytes / 1024 << " kB"
+                      << " (" << bytes / 1024 / nTiles << " kB/tile)\n";
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include "BlueMarbleMaps/Core/Geometry.h"
+#include "BlueMarbleMaps/Core/Triangulation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+using namespace BlueMarble;
+
+// Measures polygon triangulation for growing polygon sizes, a jagged "coastline" ring with
+// a grid of holes, and compares triangulating every frame with the cached triangulation
+// of PolygonGeometry. The triangles are checked to cover the area of the polygon.
+
+static std::vector<Point> createRing(std::mt19937& rng, const Point& center, double radius, int nPoints, bool clockwise)
+{
+    // The radius is a random walk, steps in the order of the vertex spacing
+    double spacing = 2.0*M_PI*radius/nPoints;
+    std::uniform_real_distribution<double> step(-spacing, spacing);
+    std::vector<Point> points;
+    points.reserve(nPoints);
+    double r = radius;
+    for (int i(0); i<nPoints; ++i)
+    {
+        double angle = (clockwise ? -2.0 : 2.0)*M_PI*i/nPoints;
+        r = std::clamp(r + step(rng), 0.8*radius, radius);
+        points.emplace_back(center.x() + r*std::cos(angle), center.y() + r*std::sin(angle));
+    }
+    return points;
+}
+
+static double ringArea(const std::vector<Point>& ring)
+{
+    double area = 0.0;
+    for (size_t i(0), j(ring.size()-1); i<ring.size(); j=i++)
+    {
+        area += (ring[j].x() - ring[i].x())*(ring[j].y() + ring[i].y());
+    }
+    return std::abs(area)*0.5;
+}
+
+int main(int argc, char* argv[])
+{
+    int frames = argc > 1 ? std::atoi(argv[1]) : 20;
+
+    std::mt19937 rng(42);
+    bool ok = true;
+    for (int nOuter : { 1000, 10000, 100000, 1000000 })
+    {
+        // Outer ring of radius 100, "lakes" of radius 5 on a grid well inside it
+        std::vector<std::vector<Point>> rings;
+        rings.push_back(createRing(rng, Point(0, 0), 100.0, nOuter, false));
+        double expectedArea = ringArea(rings[0]);
+        for (int hx(-2); hx<=2; ++hx)
+        {
+            for (int hy(-2); hy<=2; ++hy)
+            {
+                rings.push_back(createRing(rng, Point(hx*20.0, hy*20.0), 5.0, 200, true));
+                expectedArea -= ringArea(rings.back());
+            }
+        }
+        auto polygon = std::make_shared<PolygonGeometry>(rings);
+        size_t nVertices = polygon->coordinates().size();
+
+        // Triangulated every frame, as the drawable did before
+        std::vector<uint32_t> indices;
+        auto t1 = getTimeStampMs();
+        for (int k(0); k<frames; ++k)
+        {
+            indices.clear();
+            Triangulation::triangulate(polygon->coordinates(), indices);
+        }
+        auto everyFrameMs = getTimeStampMs() - t1;
+
+        // Cached by the geometry
+        size_t cachedCount = 0;
+        t1 = getTimeStampMs();
+        for (int k(0); k<frames; ++k)
+        {
+            cachedCount += polygon->triangulation()->size();
+        }
+        auto cachedMs = getTimeStampMs() - t1;
+
+        // The triangles should cover exactly the polygon
+        const auto& x = polygon->coordinates().x();
+        const auto& y = polygon->coordinates().y();
+        double area = 0.0;
+        for (size_t i(0); i+2<indices.size(); i+=3)
+        {
+            uint32_t a = indices[i], b = indices[i+1], c = indices[i+2];
+            area += std::abs((x[b] - x[a])*(y[c] - y[a]) - (x[c] - x[a])*(y[b] - y[a]))*0.5;
+        }
+        bool covered = std::abs(area - expectedArea) <= 1e-9*expectedArea;
+
+        std::cout << "Vertices: " << nVertices << " (" << rings.size() - 1 << " holes), triangles: " << indices.size()/3
+                  << ", every frame " << everyFrameMs/double(frames) << " ms/frame"
+                  << ", cached " << cachedMs/double(frames) << " ms/frame"
+                  << (covered ? "" : ", AREA MISMATCH") << "\n";
+
+        ok = ok && covered && cachedCount == indices.size()*frames;
+    }
+
+    if (!ok)
+    {
+        std::cout << "Triangulation incorrect\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,122 @@
+#include "BlueMarbleMaps/Core/Core.h"
+#include "Platform/OpenGL/Vertice.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace BlueMarble;
+
+// Compares the vertex data of a dense line layer in web mercator meters, streamed every frame as
+// in the batches: the textured Vertice layout with absolute float positions (36 bytes per vertex),
+// against ColorVertex with positions relative to the first point of each line and an RGBA8
+// color (16 bytes). Measures the size and time of building and copying ("uploading") the data
+// of one frame, and the largest position error from the float conversion.
+
+struct Line
+{
+    std::vector<double> x;
+    std::vector<double> y;
+};
+
+int main(int argc, char* argv[])
+{
+    int nLines = argc > 1 ? std::atoi(argv[1]) : 20000;
+    int nVerticesPerLine = argc > 2 ? std::atoi(argv[2]) : 100;
+    int frames = argc > 3 ? std::atoi(argv[3]) : 20;
+
+    // Lines of about a kilometer scattered over 100 km around Stockholm
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> position(-50000.0, 50000.0);
+    std::uniform_real_distribution<double> step(-10.0, 10.0);
+    std::vector<Line> lines(nLines);
+    for (auto& line : lines)
+    {
+        double x = 2010000.0 + position(rng);
+        double y = 8250000.0 + position(rng);
+        for (int i(0); i<nVerticesPerLine; ++i)
+        {
+            x += step(rng);
+            y += step(rng);
+            line.x.push_back(x);
+            line.y.push_back(y);
+        }
+    }
+    size_t nVertices = size_t(nLines)*nVerticesPerLine;
+    double r = 30, g = 144, b = 255, a = 0.8;
+
+    // Previous layout, absolute positions
+    std::vector<Vertice> vertices;
+    std::vector<Vertice> uploaded(nVertices);
+    double absoluteError = 0.0;
+    auto t1 = getTimeStampMs();
+    for (int k(0); k<frames; ++k)
+    {
+        size_t offset = 0;
+        for (const auto& line : lines)
+        {
+            vertices.clear();
+            for (size_t i(0); i<line.x.size(); ++i)
+            {
+                glm::vec3 pos(line.x[i], line.y[i], 0.0);
+                glm::vec4 color((float)r/255, (float)g/255, (float)b/255, (float)a);
+                vertices.push_back(Vertice{ pos, color, glm::vec2(0.0f) });
+            }
+            std::memcpy(uploaded.data() + offset, vertices.data(), sizeof(Vertice)*vertices.size());
+            offset += vertices.size();
+        }
+    }
+    auto absoluteMs = getTimeStampMs() - t1;
+    for (size_t l(0), v(0); l<lines.size(); ++l)
+        for (size_t i(0); i<lines[l].x.size(); ++i, ++v)
+            absoluteError = std::max(absoluteError, std::abs(double(uploaded[v].position.x) - lines[l].x[i]));
+
+    // Compact layout, relative to the first point of each line
+    std::vector<ColorVertex> colorVertices;
+    std::vector<ColorVertex> colorUploaded(nVertices);
+    std::vector<double> originX(nLines);
+    double relativeError = 0.0;
+    t1 = getTimeStampMs();
+    for (int k(0); k<frames; ++k)
+    {
+        size_t offset = 0;
+        for (size_t l(0); l<lines.size(); ++l)
+        {
+            const auto& line = lines[l];
+            double ox = line.x[0], oy = line.y[0];
+            originX[l] = ox;
+            uint32_t color = uint32_t(r) | uint32_t(g) << 8 | uint32_t(b) << 16 | uint32_t(std::lround(a*255.0)) << 24;
+            colorVertices.clear();
+            for (size_t i(0); i<line.x.size(); ++i)
+            {
+                colorVertices.push_back(ColorVertex{ glm::vec3(line.x[i] - ox, line.y[i] - oy, 0.0), color });
+            }
+            std::memcpy(colorUploaded.data() + offset, colorVertices.data(), sizeof(ColorVertex)*colorVertices.size());
+            offset += colorVertices.size();
+        }
+    }
+    auto relativeMs = getTimeStampMs() - t1;
+    for (size_t l(0), v(0); l<lines.size(); ++l)
+        for (size_t i(0); i<lines[l].x.size(); ++i, ++v)
+            relativeError = std::max(relativeError, std::abs(originX[l] + double(colorUploaded[v].position.x) - lines[l].x[i]));
+
+    double absoluteMB = sizeof(Vertice)*nVertices/1e6;
+    double relativeMB = sizeof(ColorVertex)*nVertices/1e6;
+    std::cout << "Vertices: " << nVertices << " in " << nLines << " lines, " << frames << " frames\n";
+    std::cout << "Vertice (" << sizeof(Vertice) << " bytes), absolute: " << absoluteMB << " MB/frame, "
+              << absoluteMs/double(frames) << " ms/frame, max error " << absoluteError << " m\n";
+    std::cout << "ColorVertex (" << sizeof(ColorVertex) << " bytes), relative: " << relativeMB << " MB/frame, "
+              << relativeMs/double(frames) << " ms/frame, max error " << relativeError << " m\n";
+    std::cout << "Upload saved at 60 fps: " << (absoluteMB - relativeMB)*60.0 << " MB/s\n";
+
+    if (sizeof(ColorVertex) != 16 || relativeError > 1e-3)
+    {
+        std::cout << "Unexpected vertex size or precision\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -25,6 +25,8 @@ namespace BlueMarble
             Rectangle bounds();
             Point projectTo(const CrsPtr& crs, const Point& point) const;
             Rectangle projectTo(const CrsPtr& crs, const Rectangle& rect) const;
+            // Projects n coordinates in place, using the batch projection of the projections
+            void projectTo(const CrsPtr& crs, double* x, double* y, size_t n) const;
             template<typename Iter>
             PointCollectionPtr projectTo(const CrsPtr& crs, const Iter& pointsFirst, const Iter& pointsLast)
             {
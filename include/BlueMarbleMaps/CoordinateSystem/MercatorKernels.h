@@ -0,0 +1,227 @@
+#ifndef BLUEMARBLE_MERCATORKERNELS
+#define BLUEMARBLE_MERCATORKERNELS
+
+#include <cstddef>
+
+// Note: this header is included by translation units compiled with extended instruction sets
+// (e.g. -mavx2). Keep it free from other includes, such that no inline functions shared with
+// the rest of the library are compiled with instructions the cpu might not support.
+
+namespace BlueMarble
+{
+    // Batch lng/lat <-> web mercator conversion of coordinate arrays, converted in place.
+    // Vectorized implementations are used when supported by the cpu.
+    namespace MercatorKernels
+    {
+        enum class InstructionSet
+        {
+            Scalar,
+            SSE2,
+            AVX2
+        };
+
+        // The widest instruction set supported by both the build and the cpu
+        InstructionSet bestInstructionSet();
+        const char* toString(InstructionSet instructionSet);
+
+        void project(double* x, double* y, size_t n, double radius);
+        void unProject(double* x, double* y, size_t n, double radius);
+        void project(InstructionSet instructionSet, double* x, double* y, size_t n, double radius);
+        void unProject(InstructionSet instructionSet, double* x, double* y, size_t n, double radius);
+
+        namespace Detail
+        {
+            constexpr double Pi = 3.14159265358979323846;
+            constexpr double MaxLatitude = 85.05112878;
+            constexpr double Ln2 = 6.93147180559945309417e-01;
+            constexpr double Ln2Hi = 6.93147180369123816490e-01;
+            constexpr double Ln2Lo = 1.90821492927058770002e-10;
+            constexpr double Log2e = 1.44269504088896340736;
+            constexpr double Sqrt2 = 1.41421356237309504880;
+            constexpr double RoundMagic = 6755399441055744.0; // 1.5*2^52, adding and subtracting rounds to an integer
+
+            // Implemented by the instruction set specific translation units.
+            // The functions fall back to the scalar implementation if the instruction set was not enabled for the build.
+            bool sse2Compiled();
+            void projectSse2(double* x, double* y, size_t n, double radius);
+            void unProjectSse2(double* x, double* y, size_t n, double radius);
+            bool avx2Compiled();
+            void projectAvx2(double* x, double* y, size_t n, double radius);
+            void unProjectAvx2(double* x, double* y, size_t n, double radius);
+            void projectScalar(double* x, double* y, size_t n, double radius);
+            void unProjectScalar(double* x, double* y, size_t n, double radius);
+
+            // The math below is written for a vector type V providing basic arithmetics and
+            // a few bit level operations (see MercatorKernelsSse2.cpp). The transcendental
+            // functions are polynomial approximations, accurate to a few ulp in the used ranges.
+
+            // sin(x) for |x| <= 1.5 (latitudes of web mercator)
+            template <typename V>
+            inline typename V::T sin(typename V::T x)
+            {
+                // Taylor series up to x^23
+                constexpr double c[] =
+                {
+                    -1.0/6.0, 1.0/120.0, -1.0/5040.0, 1.0/362880.0, -1.0/39916800.0,
+                    1.0/6227020800.0, -1.0/1307674368000.0, 1.0/355687428096000.0,
+                    -1.0/121645100408832000.0, 1.0/51090942171709440000.0,
+                    -1.0/25852016738884976640000.0
+                };
+                auto x2 = V::mul(x, x);
+                auto p = V::set1(c[10]);
+                for (int i=9; i>=0; --i)
+                {
+                    p = V::fma(p, x2, V::set1(c[i]));
+                }
+                return V::fma(V::mul(p, x2), x, x);
+            }
+
+            // exp(x) for |x| <= 700
+            template <typename V>
+            inline typename V::T exp(typename V::T x)
+            {
+                // exp(x) = 2^n * exp(r), |r| <= ln(2)/2
+                auto magic = V::set1(RoundMagic);
+                auto n = V::sub(V::add(V::mul(x, V::set1(Log2e)), magic), magic);
+                auto r = V::sub(V::sub(x, V::mul(n, V::set1(Ln2Hi))), V::mul(n, V::set1(Ln2Lo)));
+
+                // Taylor series up to r^14
+                constexpr double c[] =
+                {
+                    1.0, 1.0, 1.0/2.0, 1.0/6.0, 1.0/24.0, 1.0/120.0, 1.0/720.0, 1.0/5040.0,
+                    1.0/40320.0, 1.0/362880.0, 1.0/3628800.0, 1.0/39916800.0, 1.0/479001600.0,
+                    1.0/6227020800.0, 1.0/87178291200.0
+                };
+                auto p = V::set1(c[14]);
+                for (int i=13; i>=0; --i)
+                {
+                    p = V::fma(p, r, V::set1(c[i]));
+                }
+                return V::mul(p, V::pow2(n));
+            }
+
+            // log(x) for positive, normal x
+            template <typename V>
+            inline typename V::T log(typename V::T x)
+            {
+                // x = 2^e * m, m in (sqrt(2)/2, sqrt(2)]
+                typename V::T m, e;
+                V::frexp(x, m, e);
+                auto larger = V::cmpgt(m, V::set1(Sqrt2));
+                m = V::select(larger, V::mul(m, V::set1(0.5)), m);
+                e = V::select(larger, V::add(e, V::set1(1.0)), e);
+
+                // log(m) = 2*atanh(f), f = (m-1)/(m+1), |f| <= 0.172
+                auto one = V::set1(1.0);
+                auto f = V::div(V::sub(m, one), V::add(m, one));
+                constexpr double c[] =
+                {
+                    1.0, 1.0/3.0, 1.0/5.0, 1.0/7.0, 1.0/9.0, 1.0/11.0,
+                    1.0/13.0, 1.0/15.0, 1.0/17.0, 1.0/19.0, 1.0/21.0, 1.0/23.0
+                };
+                auto f2 = V::mul(f, f);
+                auto p = V::set1(c[11]);
+                for (int i=10; i>=0; --i)
+                {
+                    p = V::fma(p, f2, V::set1(c[i]));
+                }
+                auto logM = V::mul(V::mul(p, f), V::set1(2.0));
+
+                return V::fma(e, V::set1(Ln2), logM);
+            }
+
+            // atan(n/d) for |n| <= d
+            template <typename V>
+            inline typename V::T atan(typename V::T n, typename V::T d)
+            {
+                // Halve the angle twice, atan(x) = 2*atan(x/(1+sqrt(1+x^2))), such that |z| <= tan(pi/16).
+                // With x = n/d, both halvings are done with a single division.
+                auto n2 = V::mul(n, n);
+                auto a = V::add(d, V::sqrt(V::fma(d, d, n2)));
+                auto z = V::div(n, V::add(a, V::sqrt(V::fma(a, a, n2))));
+
+                // Taylor series up to z^23
+                constexpr double c[] =
+                {
+                    1.0, -1.0/3.0, 1.0/5.0, -1.0/7.0, 1.0/9.0, -1.0/11.0,
+                    1.0/13.0, -1.0/15.0, 1.0/17.0, -1.0/19.0, 1.0/21.0, -1.0/23.0
+                };
+                auto z2 = V::mul(z, z);
+                auto p = V::set1(c[11]);
+                for (int i=10; i>=0; --i)
+                {
+                    p = V::fma(p, z2, V::set1(c[i]));
+                }
+                return V::mul(V::mul(p, z), V::set1(4.0));
+            }
+
+            template <typename V>
+            inline void projectBlock(double* xPtr, double* yPtr, double radius)
+            {
+                auto degToRad = V::set1(Pi / 180.0);
+                auto one = V::set1(1.0);
+
+                auto lng = V::load(xPtr);
+                auto lat = V::load(yPtr);
+                lat = V::min(V::max(lat, V::set1(-MaxLatitude)), V::set1(MaxLatitude));
+                auto s = sin<V>(V::mul(lat, degToRad));
+
+                // y = R*log(tan(pi/4 + lat/2)) = R*atanh(sin(lat))
+                auto y = V::mul(V::set1(0.5*radius), log<V>(V::div(V::add(one, s), V::sub(one, s))));
+                auto x = V::mul(V::set1(radius), V::mul(lng, degToRad));
+
+                V::store(xPtr, x);
+                V::store(yPtr, y);
+            }
+
+            template <typename V>
+            inline void unProjectBlock(double* xPtr, double* yPtr, double radius)
+            {
+                auto radToDeg = V::set1(180.0 / Pi);
+                auto one = V::set1(1.0);
+                auto invRadius = V::set1(1.0 / radius);
+
+                // lat = 2*atan(exp(t)) - pi/2 = 2*atan(tanh(t/2)), t = y/R (Gudermannian function)
+                auto t = V::mul(V::load(yPtr), invRadius);
+                t = V::min(V::max(t, V::set1(-40.0)), V::set1(40.0)); // tanh(t/2) is +-1 beyond
+                auto q = exp<V>(t);
+                auto lat = V::mul(V::mul(atan<V>(V::sub(q, one), V::add(q, one)), V::set1(2.0)), radToDeg);
+                auto lng = V::mul(V::mul(V::load(xPtr), invRadius), radToDeg);
+
+                V::store(xPtr, lng);
+                V::store(yPtr, lat);
+            }
+
+            // Runs the block function over the arrays, the remainder is processed in a padded block
+            template <typename V, typename Block>
+            inline void forEachBlock(double* x, double* y, size_t n, double radius, Block&& block)
+            {
+                constexpr size_t W = V::Width;
+                size_t i = 0;
+                for (; i+W <= n; i+=W)
+                {
+                    block(x+i, y+i, radius);
+                }
+
+                if (i < n)
+                {
+                    double xTail[W] = {};
+                    double yTail[W] = {};
+                    for (size_t j=i; j<n; ++j)
+                    {
+                        xTail[j-i] = x[j];
+                        yTail[j-i] = y[j];
+                    }
+                    block(xTail, yTail, radius);
+                    for (size_t j=i; j<n; ++j)
+                    {
+                        x[j] = xTail[j-i];
+                        y[j] = yTail[j-i];
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif /* BLUEMARBLE_MERCATORKERNELS */
@@ -25,6 +25,12 @@ namespace BlueMarble
         static ProjectionPtr longLat();
         virtual Point project(const Point& lngLat, const EllipsoidPtr& ellipsoid) = 0;
         virtual Point unProject(const Point& point, const EllipsoidPtr& ellipsoid) = 0;
+        // Projects/unprojects n coordinates in place. Override with batch implementations, the default
+        // implementations project one point at a time.
+        virtual void projectMany(double* x, double* y, size_t n, const EllipsoidPtr& ellipsoid);
+        virtual void unProjectMany(double* x, double* y, size_t n, const EllipsoidPtr& ellipsoid);
+        // True if projected x only depends on longitude and projected y only on latitude (cylindrical projections)
+        virtual bool isSeparable() const { return false; }
         virtual double globalMetersPerUnit(const EllipsoidPtr& ellipsoid) = 0;                      // meters per unit in the projection
         virtual double localMetersPerUnitAt(const Point& lngLat, const EllipsoidPtr& ellipsoid) = 0; // meters per unit in the projection at a specific point
     };
@@ -35,6 +41,9 @@ namespace BlueMarble
         LongLatProjection() {}
         virtual Point project(const Point& lngLat, const EllipsoidPtr& ellipsoid) override final { return lngLat; };
         virtual Point unProject(const Point& point, const EllipsoidPtr& ellipsoid) override final { return point; };
+        virtual void projectMany(double* /*x*/, double* /*y*/, size_t /*n*/, const EllipsoidPtr& /*ellipsoid*/) override final {};
+        virtual void unProjectMany(double* /*x*/, double* /*y*/, size_t /*n*/, const EllipsoidPtr& /*ellipsoid*/) override final {};
+        virtual bool isSeparable() const override final { return true; }
         virtual double globalMetersPerUnit(const EllipsoidPtr& ellipsoid) override final
         {
             return BMM_PI / 180.0 * ellipsoid->a();
@@ -77,6 +86,11 @@ namespace BlueMarble
             return Point(lon, lat);
         };
 
+        // Vectorized, see MercatorKernels
+        virtual void projectMany(double* x, double* y, size_t n, const EllipsoidPtr& ellipsoid) override final;
+        virtual void unProjectMany(double* x, double* y, size_t n, const EllipsoidPtr& ellipsoid) override final;
+        virtual bool isSeparable() const override final { return true; }
+
         virtual double globalMetersPerUnit(const EllipsoidPtr& ellipsoid) override final
         {
             return 1.0;
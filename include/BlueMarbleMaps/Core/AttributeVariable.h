@@ -107,13 +107,13 @@ namespace BlueMarble
     class IndirectAttributeVariable : public AttributeVariable<T>
     {
         public:
-            IndirectAttributeVariable(const std::string& key)
+            IndirectAttributeVariable(const AttributeKey& key)
                 : m_key(key)
                 , m_defaultValue(T())
                 , m_hasDefaultValue(false)
             {}
 
-            IndirectAttributeVariable(const std::string& key, const T& defaultValue)
+            IndirectAttributeVariable(const AttributeKey& key, const T& defaultValue)
                 : m_key(key)
                 , m_defaultValue(defaultValue)
                 , m_hasDefaultValue(true)
@@ -121,14 +121,14 @@ namespace BlueMarble
 
             bool tryGetValue(const FeaturePtr& f, Attributes& attributes, T& val) override final
             {
-                if (f->attributes().contains(m_key))
+                if (auto value = f->attributes().find(m_key))
                 {
-                    val = f->attributes().get<T>(m_key);
+                    val = std::get<T>(*value);
                     return true;
                 }
-                else if (attributes.contains(m_key))
+                else if (auto value = attributes.find(m_key))
                 {
-                    val = attributes.get<T>(m_key);
+                    val = std::get<T>(*value);
                     return true;
                 }
 
@@ -138,9 +138,9 @@ namespace BlueMarble
             }
 
         private:
-            std::string m_key;
-            T           m_defaultValue;
-            bool        m_hasDefaultValue;
+            AttributeKey    m_key;
+            T               m_defaultValue;
+            bool            m_hasDefaultValue;
     };
     typedef IndirectAttributeVariable<int> IndirectIntegerAttributeVariable;
     typedef IndirectAttributeVariable<double> IndirectDoubleAttributeVariable;
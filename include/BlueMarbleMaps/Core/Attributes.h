@@ -1,27 +1,59 @@
 #ifndef BLUEMARBLE_ATTRIBUTES
 #define BLUEMARBLE_ATTRIBUTES
 
+#include <algorithm>
+#include <cstdint>
 #include <string>
-#include <map>
 #include <variant>
+#include <vector>
 #include <memory>
 #include <iostream>
 
 namespace BlueMarble
 {
+    // Interned attribute key. Key strings are interned in a process wide table, such that keys
+    // are compared and looked up by id. The key ids are shared by all data sets, such that
+    // visualizers can resolve the keys they use once (e.g. as static constants) and use the
+    // key for features of any data set.
+    class AttributeKey
+    {
+        public:
+            inline AttributeKey() : m_id(0) {} // The empty key
+            inline AttributeKey(const std::string& name) : m_id(intern(name)) {}
+            inline AttributeKey(const char* name) : m_id(intern(name)) {}
+
+            inline uint32_t id() const { return m_id; }
+            const std::string& name() const;
+
+            inline bool operator==(const AttributeKey& other) const { return m_id == other.m_id; }
+            inline bool operator!=(const AttributeKey& other) const { return m_id != other.m_id; }
+            inline bool operator<(const AttributeKey& other) const { return m_id < other.m_id; }
+
+            // Number of interned keys
+            static size_t count();
+        private:
+            static uint32_t intern(const std::string& name);
+
+            uint32_t m_id;
+    };
+
     namespace UpdateAttributeKeys
     {
-        const std::string UpdateTimeMs = std::string("__timeMs");
-        const std::string UpdateViewScale = std::string("__updateViewScale");
-        const std::string QuickUpdate = std::string("__quickUpdate");
-        const std::string SelectionUpdate = std::string("__selection");
-        const std::string HoverUpdate = std::string("__hover");
-        const std::string UpdateRequired = std::string("updateRequired__");
+        const AttributeKey UpdateTimeMs = AttributeKey("__timeMs");
+        const AttributeKey UpdateViewScale = AttributeKey("__updateViewScale");
+        const AttributeKey QuickUpdate = AttributeKey("__quickUpdate");
+        const AttributeKey SelectionUpdate = AttributeKey("__selection");
+        const AttributeKey HoverUpdate = AttributeKey("__hover");
+        const AttributeKey UpdateRequired = AttributeKey("updateRequired__");
     };
 
     namespace FeatureAttributeKeys
     {
-        const std::string StartAnimationTimeMs = std::string("__animationTimeMs");
+        const AttributeKey StartAnimationTimeMs = AttributeKey("__animationTimeMs");
+        // Set on the parts of a feature cut into pieces (e.g. by TileLayer): a piece of the fill, only drawn by
+        // polygon visualizers, and the whole feature, drawn by the other visualizers
+        const AttributeKey FillOnly = AttributeKey("__fillOnly");
+        const AttributeKey NoFill = AttributeKey("__noFill");
     };
 
     enum class AttributeValueType
@@ -91,30 +123,47 @@ namespace BlueMarble
     }
 
     
+    // Attribute values of a feature, stored as a flat vector sorted by key id. Lookup with
+    // a precomputed AttributeKey is a binary search over a few entries. Lookup with a string
+    // interns the key first.
     class Attributes
     {
         public:
+            using Entry = std::pair<AttributeKey, AttributeValue>;
+
             inline Attributes()
                 : m_attributes()
             {}
             inline Attributes(std::initializer_list<std::pair<const std::string, AttributeValue>> init)
-                : m_attributes(init)
-            {}
+                : m_attributes()
+            {
+                m_attributes.reserve(init.size());
+                for (const auto& [key, value] : init)
+                {
+                    valueFor(key) = value;
+                }
+            }
             
             template <typename T>
-            inline void set(const std::string& key, const T& value) { m_attributes[key] = value; }
+            inline void set(const AttributeKey& key, const T& value) { valueFor(key) = value; }
             
             template <typename T>
-            inline const T& get(const std::string& key) const {
-                auto it = m_attributes.find(key);
-                if (it != m_attributes.end()) {
-                    return std::get<T>(it->second);
+            inline const T& get(const AttributeKey& key) const {
+                if (auto value = find(key)) {
+                    return std::get<T>(*value);
                 }
-                throw std::runtime_error("Key '" + key + "' not found");
+                throw std::runtime_error("Key '" + key.name() + "' not found");
+            }
+
+            // Returns nullptr if the key is missing or holds another type
+            template <typename T>
+            inline const T* getIf(const AttributeKey& key) const {
+                auto value = find(key);
+                return value ? std::get_if<T>(value) : nullptr;
             }
 
             template <typename T>
-            inline const T& tryGet(const std::string& key) const {
+            inline const T& tryGet(const AttributeKey& key) const {
                 try
                 {
                     return get<T>(key);
@@ -122,17 +171,22 @@ namespace BlueMarble
                 catch(const std::exception& e)
                 {
                     std::cerr << e.what() << '\n';
-                    auto it = m_attributes.find(key);
-                    auto value = it->second;
-                    std::cout << "Tried to get index: " << value.index() << "\n";
+                    auto value = find(key);
+                    std::cout << "Tried to get index: " << (value ? value->index() : std::variant_npos) << "\n";
                     throw e;
                 }
                 
             }
 
-            inline const AttributeValue& val(const std::string& key) { return m_attributes[key]; }
+            inline const AttributeValue& val(const AttributeKey& key) { return valueFor(key); }
 
-            inline bool contains(const std::string& key) const { return m_attributes.find(key) != m_attributes.end(); }
+            // Returns nullptr if the key is missing
+            inline const AttributeValue* find(const AttributeKey& key) const
+            {
+                auto it = lowerBound(key);
+                return it != m_attributes.end() && it->first == key ? &it->second : nullptr;
+            }
+            inline bool contains(const AttributeKey& key) const { return find(key) != nullptr; }
             
             inline size_t size() const { return m_attributes.size(); }
             inline auto begin() const { return m_attributes.begin(); }
@@ -141,7 +195,24 @@ namespace BlueMarble
             // inline auto cend() const { return m_attributes.cend(); }
 
         private:
-            std::map<std::string, AttributeValue>   m_attributes;
+            inline std::vector<Entry>::const_iterator lowerBound(const AttributeKey& key) const
+            {
+                return std::lower_bound(m_attributes.begin(), m_attributes.end(), key, 
+                    [](const Entry& entry, const AttributeKey& key) { return entry.first < key; });
+            }
+
+            // Inserts an empty value if missing
+            inline AttributeValue& valueFor(const AttributeKey& key)
+            {
+                auto it = m_attributes.begin() + (lowerBound(key) - m_attributes.begin());
+                if (it == m_attributes.end() || it->first != key)
+                {
+                    it = m_attributes.insert(it, Entry(key, AttributeValue()));
+                }
+                return it->second;
+            }
+
+            std::vector<Entry>   m_attributes; // Sorted by key id
     };
     typedef std::shared_ptr<Attributes> AttributesPtr;
 
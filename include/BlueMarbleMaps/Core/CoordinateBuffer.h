@@ -0,0 +1,273 @@
+#ifndef BLUEMARBLE_COORDINATEBUFFER
+#define BLUEMARBLE_COORDINATEBUFFER
+
+#include "BlueMarbleMaps/Core/Core.h"
+
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+namespace BlueMarble
+{
+    // Compact coordinate storage for line and polygon geometries. Coordinates are stored
+    // as separate x and y arrays (z only when any point has a z value), and the points are
+    // divided into parts (e.g. the rings of a polygon) by an array of part offsets.
+    class CoordinateBuffer
+    {
+        public:
+            CoordinateBuffer();
+            CoordinateBuffer(const std::vector<Point>& points);
+            CoordinateBuffer(const CoordinateBuffer& other) = default;
+            CoordinateBuffer(CoordinateBuffer&& other);
+            // Assignment results in a version newer than that of both buffers, such that
+            // values cached for the previous content of this buffer are invalidated
+            CoordinateBuffer& operator=(const CoordinateBuffer& other);
+            CoordinateBuffer& operator=(CoordinateBuffer&& other);
+
+            // Points
+            inline size_t size() const { return m_x.size(); }
+            inline bool empty() const { return m_x.empty(); }
+            inline bool hasZ() const { return m_hasZ; }
+            inline Point point(size_t index) const
+            {
+                assert(index < size());
+                return Point(m_x[index], m_y[index], hasZ() ? m_z[index] : 0.0);
+            }
+            void setPoint(size_t index, const Point& point);
+            inline const std::vector<double>& x() const { return m_x; }
+            inline const std::vector<double>& y() const { return m_y; }
+            inline const std::vector<double>& z() const { return m_z; } // Empty if there is no z
+
+            // Parts
+            inline size_t partCount() const { return m_partOffsets.size() - 1; }
+            inline size_t partBegin(size_t part) const { assert(part < partCount()); return m_partOffsets[part]; }
+            inline size_t partEnd(size_t part) const { assert(part < partCount()); return m_partOffsets[part+1]; }
+            inline size_t partSize(size_t part) const { return partEnd(part) - partBegin(part); }
+            std::vector<Point> partPoints(size_t part) const;
+            void addPart(const std::vector<Point>& points = {});
+            void assignPart(size_t part, const std::vector<Point>& points);
+            void removePart(size_t part);
+            // Index is relative to the start of the part
+            void insertPoint(size_t part, size_t index, const Point& point);
+            void erasePoints(size_t part, size_t first, size_t last);
+            void clear();
+            void reserve(size_t nPoints);
+
+            // Bulk operations, looping over the coordinate arrays
+            void move(const Point& delta);
+            template <typename Func>
+            void transform(Func&& func) // func(double& x, double& y)
+            {
+                double* x = m_x.data();
+                double* y = m_y.data();
+                size_t n = m_x.size();
+                for (size_t i(0); i<n; ++i)
+                {
+                    func(x[i], y[i]);
+                }
+                touch();
+            }
+            template <typename Func>
+            void transformArrays(Func&& func) // func(double* x, double* y, size_t n)
+            {
+                func(m_x.data(), m_y.data(), m_x.size());
+                touch();
+            }
+            Rectangle bounds() const;
+            Rectangle partBounds(size_t part) const;
+
+            // Approximate number of bytes allocated for the coordinates
+            size_t memoryUsage() const;
+            // Incremented on every modification
+            inline uint64_t version() const { return m_version; }
+        private:
+            inline void touch() { ++m_version; }
+            void ensureZ(const Point& point);
+            Rectangle rangeBounds(size_t begin, size_t end) const;
+
+            std::vector<double> m_x;
+            std::vector<double> m_y;
+            std::vector<double> m_z;
+            std::vector<size_t> m_partOffsets; // partCount()+1 offsets, starting with 0
+            bool                m_hasZ;        // m_z holds one value per point, set by the first non zero z
+            uint64_t            m_version;
+    };
+
+    // Proxy for a point stored in a CoordinateBuffer, such that point sequences can be modified through operator[]
+    class PointRef
+    {
+        public:
+            inline PointRef(CoordinateBuffer* buffer, size_t index) : m_buffer(buffer), m_index(index) {}
+            inline operator Point() const { return m_buffer->point(m_index); }
+            inline Point get() const { return m_buffer->point(m_index); }
+            inline PointRef& operator=(const Point& point) { m_buffer->setPoint(m_index, point); return *this; }
+            inline PointRef& operator=(const PointRef& other) { return *this = other.get(); }
+            inline void operator+=(const Point& delta) { *this = get() + delta; }
+            inline double x() const { return m_buffer->x()[m_index]; }
+            inline double y() const { return m_buffer->y()[m_index]; }
+            inline double z() const { return get().z(); }
+            inline Point operator+(const Point& other) const { return get() + other; }
+            inline Point operator-(const Point& other) const { return get() - other; }
+        private:
+            CoordinateBuffer* m_buffer;
+            size_t            m_index;
+    };
+
+    // Random access iterator over the points of a part, dereferencing to Point values
+    class PointIterator
+    {
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = Point;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = Point;
+
+            inline PointIterator() : m_buffer(nullptr), m_index(0) {}
+            inline PointIterator(const CoordinateBuffer* buffer, size_t index) : m_buffer(buffer), m_index(index) {}
+            inline Point operator*() const { return m_buffer->point(m_index); }
+            inline Point operator[](difference_type n) const { return m_buffer->point(m_index + n); }
+            inline PointIterator& operator++() { ++m_index; return *this; }
+            inline PointIterator operator++(int) { auto it = *this; ++m_index; return it; }
+            inline PointIterator& operator--() { --m_index; return *this; }
+            inline PointIterator operator--(int) { auto it = *this; --m_index; return it; }
+            inline PointIterator& operator+=(difference_type n) { m_index += n; return *this; }
+            inline PointIterator& operator-=(difference_type n) { m_index -= n; return *this; }
+            inline PointIterator operator+(difference_type n) const { return PointIterator(m_buffer, m_index + n); }
+            inline PointIterator operator-(difference_type n) const { return PointIterator(m_buffer, m_index - n); }
+            inline difference_type operator-(const PointIterator& other) const { return (difference_type)m_index - (difference_type)other.m_index; }
+            inline bool operator==(const PointIterator& other) const { return m_index == other.m_index; }
+            inline bool operator!=(const PointIterator& other) const { return m_index != other.m_index; }
+            inline bool operator<(const PointIterator& other) const { return m_index < other.m_index; }
+            inline bool operator>(const PointIterator& other) const { return m_index > other.m_index; }
+            inline bool operator<=(const PointIterator& other) const { return m_index <= other.m_index; }
+            inline bool operator>=(const PointIterator& other) const { return m_index >= other.m_index; }
+        private:
+            const CoordinateBuffer* m_buffer;
+            size_t                  m_index;
+    };
+
+    // View of one part of a CoordinateBuffer with (most of) the interface of std::vector<Point>.
+    // Keeps code written for std::vector<Point> storage working. Note that copying a view does
+    // not copy the points, convert to std::vector<Point> for a copy.
+    template <typename Buffer>
+    class BasicPointSequence
+    {
+        public:
+            static constexpr bool IsConst = std::is_const_v<Buffer>;
+
+            inline BasicPointSequence(Buffer* buffer, size_t part) : m_buffer(buffer), m_part(part) {}
+            inline BasicPointSequence(const BasicPointSequence& other) = default;
+            template <typename Other, typename = std::enable_if_t<IsConst && !std::is_const_v<Other>>>
+            inline BasicPointSequence(const BasicPointSequence<Other>& other) : m_buffer(&other.buffer()), m_part(other.part()) {}
+
+            // Assignment copies the points
+            inline BasicPointSequence& operator=(const BasicPointSequence& other) { return *this = other.toVector(); }
+            inline BasicPointSequence& operator=(const std::vector<Point>& points) { m_buffer->assignPart(m_part, points); return *this; }
+
+            inline size_t size() const { return m_buffer->partSize(m_part); }
+            inline bool empty() const { return size() == 0; }
+            inline auto operator[](size_t index) const
+            {
+                assert(index < size());
+                if constexpr (IsConst)
+                    return m_buffer->point(m_buffer->partBegin(m_part) + index);
+                else
+                    return PointRef(m_buffer, m_buffer->partBegin(m_part) + index);
+            }
+            inline auto front() const { return (*this)[0]; }
+            inline auto back() const { return (*this)[size()-1]; }
+            inline PointIterator begin() const { return PointIterator(m_buffer, m_buffer->partBegin(m_part)); }
+            inline PointIterator end() const { return PointIterator(m_buffer, m_buffer->partEnd(m_part)); }
+
+            inline void push_back(const Point& point) const { m_buffer->insertPoint(m_part, size(), point); }
+            template <typename... Args>
+            inline void emplace_back(Args&&... args) const { push_back(Point(std::forward<Args>(args)...)); }
+            inline void pop_back() const { m_buffer->erasePoints(m_part, size()-1, size()); }
+            inline void clear() const { m_buffer->erasePoints(m_part, 0, size()); }
+            inline void reserve(size_t /*n*/) const {}
+
+            inline std::vector<Point> toVector() const { return m_buffer->partPoints(m_part); }
+            inline operator std::vector<Point>() const { return toVector(); }
+
+            inline Buffer& buffer() const { return *m_buffer; }
+            inline size_t part() const { return m_part; }
+        private:
+            Buffer* m_buffer;
+            size_t  m_part;
+    };
+    using PointSequence = BasicPointSequence<CoordinateBuffer>;
+    using ConstPointSequence = BasicPointSequence<const CoordinateBuffer>;
+
+    // View of all parts of a CoordinateBuffer with (most of) the interface of std::vector<std::vector<Point>>
+    template <typename Buffer>
+    class BasicRingSequence
+    {
+        public:
+            using Ring = BasicPointSequence<Buffer>;
+
+            class Iterator
+            {
+                public:
+                    using iterator_category = std::forward_iterator_tag;
+                    using value_type = Ring;
+                    using difference_type = std::ptrdiff_t;
+                    using pointer = void;
+                    using reference = Ring;
+
+                    inline Iterator(Buffer* buffer, size_t part) : m_buffer(buffer), m_part(part) {}
+                    inline Ring operator*() const { return Ring(m_buffer, m_part); }
+                    inline Iterator& operator++() { ++m_part; return *this; }
+                    inline Iterator operator++(int) { auto it = *this; ++m_part; return it; }
+                    inline bool operator==(const Iterator& other) const { return m_part == other.m_part; }
+                    inline bool operator!=(const Iterator& other) const { return m_part != other.m_part; }
+                private:
+                    Buffer* m_buffer;
+                    size_t  m_part;
+            };
+
+            inline BasicRingSequence(Buffer* buffer) : m_buffer(buffer) {}
+            inline BasicRingSequence(const BasicRingSequence& other) = default;
+
+            // Assignment copies the rings
+            inline BasicRingSequence& operator=(const BasicRingSequence& other) { return *this = other.toVector(); }
+            inline BasicRingSequence& operator=(const std::vector<std::vector<Point>>& rings)
+            {
+                m_buffer->clear();
+                for (const auto& ring : rings)
+                    m_buffer->addPart(ring);
+                return *this;
+            }
+
+            inline size_t size() const { return m_buffer->partCount(); }
+            inline bool empty() const { return size() == 0; }
+            inline Ring operator[](size_t index) const { assert(index < size()); return Ring(m_buffer, index); }
+            inline Ring front() const { return (*this)[0]; }
+            inline Ring back() const { return (*this)[size()-1]; }
+            inline Iterator begin() const { return Iterator(m_buffer, 0); }
+            inline Iterator end() const { return Iterator(m_buffer, size()); }
+
+            inline void push_back(const std::vector<Point>& ring) const { m_buffer->addPart(ring); }
+            inline void emplace_back(const std::vector<Point>& ring) const { m_buffer->addPart(ring); }
+            inline void pop_back() const { m_buffer->removePart(size()-1); }
+            inline void clear() const { m_buffer->clear(); }
+
+            inline std::vector<std::vector<Point>> toVector() const
+            {
+                std::vector<std::vector<Point>> rings;
+                rings.reserve(size());
+                for (size_t i(0); i<size(); ++i)
+                    rings.push_back(m_buffer->partPoints(i));
+                return rings;
+            }
+            inline operator std::vector<std::vector<Point>>() const { return toVector(); }
+        private:
+            Buffer* m_buffer;
+    };
+    using RingSequence = BasicRingSequence<CoordinateBuffer>;
+    using ConstRingSequence = BasicRingSequence<const CoordinateBuffer>;
+}
+
+#endif /* BLUEMARBLE_COORDINATEBUFFER */
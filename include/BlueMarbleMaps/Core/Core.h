@@ -267,16 +267,12 @@ namespace BlueMarble
             // Checks whether the rectangles overlap: https://www.geeksforgeeks.org/find-two-rectangles-overlap/
             inline bool overlap(const Rectangle& other) const
             {
-                auto l1 = Point(m_xMin, m_yMax);
-                auto r1 = Point(m_xMax, m_yMin);
-                auto l2 = Point(other.m_xMin, other.m_yMax);
-                auto r2 = Point(other.m_xMax, other.m_yMin);
-
-                if (l1.x() > r2.x() || l2.x() > r1.x())
+                // If one rectangle is to the left of the other
+                if (m_xMin > other.m_xMax || other.m_xMin > m_xMax)
                     return false;
 
                 // If one rectangle is above the other
-                if (r1.y() > l2.y() || r2.y() > l1.y())
+                if (m_yMin > other.m_yMax || other.m_yMin > m_yMax)
                     return false;
 
                 return true;
@@ -331,6 +327,29 @@ namespace BlueMarble
                 return Rectangle(xMin, yMin, xMax, yMax);
             }
 
+            // Returns the parts of this rectangle not covered by the other rectangle, as at most
+            // four non overlapping rectangles (full height strips left and right, bottom and top in between).
+            inline std::vector<Rectangle> subtract(const Rectangle& other) const
+            {
+                auto overlapping = intersect(other);
+                if (overlapping.isUndefined())
+                {
+                    return { *this };
+                }
+
+                std::vector<Rectangle> parts;
+                if (overlapping.xMin() > m_xMin)
+                    parts.emplace_back(m_xMin, m_yMin, overlapping.xMin(), m_yMax);
+                if (overlapping.xMax() < m_xMax)
+                    parts.emplace_back(overlapping.xMax(), m_yMin, m_xMax, m_yMax);
+                if (overlapping.yMin() > m_yMin)
+                    parts.emplace_back(overlapping.xMin(), m_yMin, overlapping.xMax(), overlapping.yMin());
+                if (overlapping.yMax() < m_yMax)
+                    parts.emplace_back(overlapping.xMin(), overlapping.yMax(), overlapping.xMax(), m_yMax);
+
+                return parts;
+            }
+
             inline Point minCorner() const
             {
                 return Point(xMin(), yMin());
@@ -19,6 +19,16 @@
 namespace BlueMarble
 {    
     constexpr double dpi96PixelSize = 1.0/96.0 * 0.0254;
+
+    // A point symbol for Drawable::drawSymbols()
+    struct SymbolInstance
+    {
+        Point  position;
+        double size;        // Radius, in map units
+        double rotation;    // Degrees, counter clockwise
+        Color  color;
+    };
+
     class Drawable
     {
         public:
@@ -39,6 +49,9 @@ namespace BlueMarble
             virtual void resize(int width, int height) = 0;
             virtual void drawArc(double cx, double cy, double rx, double ry, double theta, const Pen& pen, const Brush& brush) = 0;
             virtual void drawCircle(double x, double y, double radius, const Pen& pen, const Brush& brush) = 0;
+            // Draws a filled circle symbol per instance, without outline. Meant for large point layers,
+            // drawables that can draw them all in one go (instancing) do so at the end of the batches.
+            virtual void drawSymbols(const std::vector<SymbolInstance>& symbols) = 0;
             virtual void drawLine(const LineGeometryPtr& geometry, const Pen& pen) = 0;
             virtual void drawPolygon(const PolygonGeometryPtr& geometry, const Pen& pen, const Brush& brush) = 0;
             virtual void drawRect(const Point& topLeft, const Point& bottomRight, const Color& color) = 0;
@@ -49,9 +62,17 @@ namespace BlueMarble
             virtual void setPixel(int x, int y, const Color& color) = 0;
             virtual void swapBuffers() = 0;
             virtual void clearBuffer() = 0;
+            // Restricts drawing and clearBuffer() to the rectangle, in pixels from the top left. The buffer keeps its content
+            // outside it between frames, such that a part of the previous frame can be redrawn. Undefined removes the clip.
+            virtual void setClipRect(const Rectangle& pixels) = 0;
             virtual Raster getRaster() = 0;
             virtual void flushCache() = 0;
+            // False when the last frame left work for the following ones, e.g. rasters drawn at a coarser level
+            // until their tiles are uploaded. The map keeps updating until the drawable is complete.
+            virtual bool isComplete() const { return true; }
             virtual RendererImplementation renderer() = 0;
+            // An offscreen drawable with the same renderer, e.g. to render into an image that is drawn onto this one later
+            virtual std::shared_ptr<Drawable> createOffscreen(int width, int height) = 0;
 
             // Static methods
             /* Returns the pixel size of the display in meters */
@@ -0,0 +1,87 @@
+#ifndef BLUEMARBLE_FRAMEARENA
+#define BLUEMARBLE_FRAMEARENA
+
+#include <memory>
+#include <memory_resource>
+
+namespace BlueMarble
+{
+    class FrameArena;
+    typedef std::shared_ptr<FrameArena> FrameArenaPtr;
+
+    // Monotonic arena for short lived objects created during a frame or query, such as
+    // temporary features and geometries. Memory is only released in bulk, when the arena
+    // is destroyed. Objects allocated with makeTransient() keep the arena alive, so an
+    // object outliving the frame is still valid (but keeps the memory of the arena).
+    // Allocation is not thread safe, only the thread that made the arena current allocates from it.
+    class FrameArena
+    {
+        public:
+            static constexpr size_t DefaultBlockSize = 64*1024;
+
+            FrameArena(size_t initialBlockSize = DefaultBlockSize);
+            FrameArena(const FrameArena&) = delete;
+            FrameArena& operator=(const FrameArena&) = delete;
+
+            void* allocate(size_t bytes, size_t alignment);
+            size_t allocationCount() const { return m_allocationCount; }
+            size_t bytesAllocated() const { return m_bytesAllocated; }
+
+            // The arena used by makeTransient() on this thread, nullptr if none
+            static const FrameArenaPtr& current();
+
+            // Makes an arena current for the calling thread during the lifetime of the scope
+            class Scope
+            {
+                public:
+                    Scope(const FrameArenaPtr& arena);
+                    ~Scope();
+                    Scope(const Scope&) = delete;
+                    Scope& operator=(const Scope&) = delete;
+                private:
+                    FrameArenaPtr m_previous;
+            };
+        private:
+            std::pmr::monotonic_buffer_resource m_resource;
+            size_t                              m_allocationCount;
+            size_t                              m_bytesAllocated;
+    };
+
+    // Allocator for std::allocate_shared, sharing ownership of the arena. Deallocation is a no-op.
+    template <typename T>
+    class FrameArenaAllocator
+    {
+        public:
+            using value_type = T;
+
+            FrameArenaAllocator(const FrameArenaPtr& arena) : m_arena(arena) {}
+            template <typename U>
+            FrameArenaAllocator(const FrameArenaAllocator<U>& other) : m_arena(other.arena()) {}
+
+            T* allocate(size_t n) { return static_cast<T*>(m_arena->allocate(n*sizeof(T), alignof(T))); }
+            void deallocate(T* /*p*/, size_t /*n*/) {}
+
+            const FrameArenaPtr& arena() const { return m_arena; }
+            template <typename U>
+            bool operator==(const FrameArenaAllocator<U>& other) const { return m_arena == other.arena(); }
+            template <typename U>
+            bool operator!=(const FrameArenaAllocator<U>& other) const { return m_arena != other.arena(); }
+        private:
+            FrameArenaPtr m_arena;
+    };
+
+    // Creates a short lived object in the current arena of the thread, or on the heap if there is none
+    template <typename T, typename... Args>
+    std::shared_ptr<T> makeTransient(Args&&... args)
+    {
+        const auto& arena = FrameArena::current();
+        if (arena)
+        {
+            return std::allocate_shared<T>(FrameArenaAllocator<T>(arena), std::forward<Args>(args)...);
+        }
+
+        return std::make_shared<T>(std::forward<Args>(args)...);
+    }
+}
+
+#endif /* BLUEMARBLE_FRAMEARENA */
@@ -2,11 +2,14 @@
 #define GEOMETRY
 
 #include "BlueMarbleMaps/Core/Core.h"
+#include "BlueMarbleMaps/Core/CoordinateBuffer.h"
 #include "BlueMarbleMaps/Core/Raster.h"
 #include "BlueMarbleMaps/Utility/Utils.h"
 #include "BlueMarbleMaps/Core/Transform.h"
 #include "BlueMarbleMaps/Core/EngineObject.h"
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <iostream>
@@ -44,12 +47,128 @@ namespace BlueMarble
         }
     }
 
+    // Bounds calculated for a specific version of a geometry. Concurrent readers, e.g. tile loading workers,
+    // may calculate and store the bounds at the same time. The version and bounds are read and written under
+    // a sequence counter (odd while written), a reader seeing it change retries by calculating the bounds.
+    class BoundsCache
+    {
+        public:
+            BoundsCache() : m_sequence(0), m_version(NoVersion), m_isUndefined(true), m_xMin(0), m_yMin(0), m_xMax(0), m_yMax(0) {}
+            BoundsCache(const BoundsCache& other) : BoundsCache() { copyFrom(other); }
+            BoundsCache& operator=(const BoundsCache& other)
+            {
+                if (this != &other)
+                {
+                    copyFrom(other);
+                }
+                return *this;
+            }
+
+            template <typename Func>
+            Rectangle get(uint64_t version, Func&& calculate) const
+            {
+                Rectangle bounds;
+                uint64_t sequence = m_sequence.load(std::memory_order_acquire);
+                if (read(sequence, version, bounds))
+                {
+                    return bounds;
+                }
+
+                bounds = calculate();
+                write(sequence, version, bounds);
+                return bounds;
+            }
+        private:
+            static constexpr uint64_t NoVersion = UINT64_MAX;
+
+            // True if the cached bounds are of the version and were not written in the meantime
+            bool read(uint64_t sequence, uint64_t version, Rectangle& bounds) const
+            {
+                if ((sequence & 1) != 0 || m_version.load(std::memory_order_relaxed) != version)
+                {
+                    return false;
+                }
+                bounds = m_isUndefined.load(std::memory_order_relaxed) ? Rectangle::undefined() :
+                    Rectangle(m_xMin.load(std::memory_order_relaxed), m_yMin.load(std::memory_order_relaxed),
+                              m_xMax.load(std::memory_order_relaxed), m_yMax.load(std::memory_order_relaxed));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                return m_sequence.load(std::memory_order_relaxed) == sequence;
+            }
+            // Skipped when another thread wrote since the sequence was read, or is writing
+            void write(uint64_t sequence, uint64_t version, const Rectangle& bounds) const
+            {
+                if ((sequence & 1) != 0 || !m_sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed))
+                {
+                    return;
+                }
+                std::atomic_thread_fence(std::memory_order_release);
+                m_isUndefined.store(bounds.isUndefined(), std::memory_order_relaxed);
+                m_xMin.store(bounds.xMin(), std::memory_order_relaxed);
+                m_yMin.store(bounds.yMin(), std::memory_order_relaxed);
+                m_xMax.store(bounds.xMax(), std::memory_order_relaxed);
+                m_yMax.store(bounds.yMax(), std::memory_order_relaxed);
+                m_version.store(version, std::memory_order_relaxed);
+                m_sequence.store(sequence + 2, std::memory_order_release);
+            }
+            void copyFrom(const BoundsCache& other)
+            {
+                Rectangle bounds;
+                uint64_t otherSequence = other.m_sequence.load(std::memory_order_acquire);
+                uint64_t version = other.m_version.load(std::memory_order_relaxed);
+                if (!other.read(otherSequence, version, bounds))
+                {
+                    version = NoVersion;
+                }
+                write(m_sequence.load(std::memory_order_acquire), version, bounds);
+            }
+
+            mutable std::atomic<uint64_t> m_sequence;
+            mutable std::atomic<uint64_t> m_version;
+            mutable std::atomic<bool>     m_isUndefined;
+            mutable std::atomic<double>   m_xMin;
+            mutable std::atomic<double>   m_yMin;
+            mutable std::atomic<double>   m_xMax;
+            mutable std::atomic<double>   m_yMax;
+    };
+
+    // Triangle vertex indices calculated for a specific version of a polygon. The indices are shared,
+    // such that a triangulation handed out stays valid when the polygon is modified and retriangulated.
+    class TriangulationCache
+    {
+        public:
+            typedef std::vector<uint32_t> Indices;
+            typedef std::shared_ptr<const Indices> IndicesPtr;
+
+            template <typename Func>
+            IndicesPtr get(uint64_t version, Func&& calculate) const // calculate(Indices&)
+            {
+                auto entry = std::atomic_load_explicit(&m_entry, std::memory_order_acquire);
+                if (entry == nullptr || entry->version != version)
+                {
+                    auto updated = std::make_shared<Entry>();
+                    updated->version = version;
+                    calculate(updated->indices);
+                    entry = updated;
+                    std::atomic_store_explicit(&m_entry, entry, std::memory_order_release);
+                }
+                return IndicesPtr(entry, &entry->indices);
+            }
+        private:
+            struct Entry
+            {
+                uint64_t version;
+                Indices  indices;
+            };
+            mutable std::shared_ptr<const Entry> m_entry;
+    };
+
     class Geometry; // Forward declaration
     typedef std::shared_ptr<Geometry> GeometryPtr;
     class Geometry : public EngineObject
     {
         public:
             virtual GeometryType type() = 0;
+            // Cached by the geometries, only recalculated when version() has changed
             virtual Rectangle calculateBounds() = 0;
             virtual Point center() = 0;
             virtual void move(const Point& delta) = 0;
@@ -57,11 +176,22 @@ namespace BlueMarble
             virtual bool isInside(const Rectangle& bounds) const = 0;
             virtual bool isStrictlyInside(const Rectangle& bounds) const = 0;
             virtual void forEachPoint(const std::function<void(Point&)>& func) = 0;
+            // Calls func with the x and y coordinate arrays of the geometry (once for each part that is stored separately),
+            // allows batch processing such as reprojection. The coordinates can be modified in place.
+            virtual void forEachCoordinateArray(const std::function<void(double* x, double* y, size_t n)>& func) = 0;
             const Transform& getTransForm() { std::cout << "Geometry::getTransForm() Not implemented\n"; throw std::exception(); };
             void setTransForm(const Transform& transform) { std::cout << "Geometry::getTransForm() Not implemented\n"; throw std::exception(); };
+            // Changes whenever the geometry is modified (move, moveTo, forEachPoint, non-const accessors), 
+            // can be used to invalidate values derived from the geometry
+            virtual uint64_t version() const { return m_version; }
         protected:
             Geometry();
             virtual ~Geometry() = default; // { std::cout << "~Geometry()\n"; };
+            inline void touch() { ++m_version; }
+
+            BoundsCache m_boundsCache;
+        private:
+            uint64_t    m_version;
     };
 
 
@@ -74,12 +204,15 @@ namespace BlueMarble
             GeometryType type() override final { return GeometryType::Point; };
             Rectangle calculateBounds() override final { return Rectangle::undefined(); };
             Point center() override final { return m_point; };
-            void move(const Point& delta) override final { m_point += delta; };
-            void moveTo(const Point& point) override final { m_point = point; };
+            void move(const Point& delta) override final { m_point += delta; touch(); };
+            void moveTo(const Point& point) override final { m_point = point; touch(); };
             bool isInside(const Rectangle& bounds) const override final { return bounds.isInside(m_point); };
             bool isStrictlyInside(const Rectangle& bounds) const override final { return isInside(bounds); };
-            void forEachPoint(const std::function<void(Point&)>& func) override final { func(m_point); };
+            void forEachPoint(const std::function<void(Point&)>& func) override final { func(m_point); touch(); };
+            void forEachCoordinateArray(const std::function<void(double* x, double* y, size_t n)>& func) override final;
+            uint64_t version() const override final;
             Point& point() { return m_point; }
+            const Point& point() const { return m_point; }
 
         private:
             Point m_point;
@@ -95,19 +228,24 @@ namespace BlueMarble
             LineGeometry(const Rectangle& rect);
             EngineObjectPtr clone() override final { return std::make_shared<LineGeometry>(*this); };
             GeometryType type() override final { return GeometryType::Line; };
-            Rectangle calculateBounds() override final { return Rectangle::fromPoints(m_points); };
-            Point center() override final { return m_points[m_points.size()%2]; }; // FIXME
+            Rectangle calculateBounds() override final;
+            Point center() override final { return m_coordinates.point(m_coordinates.size()%2); }; // FIXME
             double length() const;
             bool isClosed() const { return m_isClosed; }
             void isClosed(bool closed) { m_isClosed = closed; }
             void move(const Point& delta) override final;
             void moveTo(const Point& point) override final;
-            bool isInside(const Rectangle& bounds) const override final { return bounds.isInside(m_points); }; // FIXME: points might not be inside
-            bool isStrictlyInside(const Rectangle& bounds) const override final { return bounds.allInside(m_points); };
-            void forEachPoint(const std::function<void(Point&)>& func) override final { for(auto& p : m_points) func(p); };
-            std::vector<Point>& points() { return m_points; }
+            bool isInside(const Rectangle& bounds) const override final; // FIXME: points might not be inside
+            bool isStrictlyInside(const Rectangle& bounds) const override final;
+            void forEachPoint(const std::function<void(Point&)>& func) override final;
+            void forEachCoordinateArray(const std::function<void(double* x, double* y, size_t n)>& func) override final { m_coordinates.transformArrays(func); }
+            uint64_t version() const override final { return m_coordinates.version(); }
+            PointSequence points() { return PointSequence(&m_coordinates, 0); }
+            ConstPointSequence points() const { return ConstPointSequence(&m_coordinates, 0); }
+            CoordinateBuffer& coordinates() { return m_coordinates; }
+            const CoordinateBuffer& coordinates() const { return m_coordinates; }
         private:
-            std::vector<Point> m_points;
+            CoordinateBuffer m_coordinates; // A single part
             bool m_isClosed;
     };
     typedef std::shared_ptr<LineGeometry> LineGeometryPtr;
@@ -117,20 +255,18 @@ namespace BlueMarble
     {
         public:
             PolygonGeometry();
-            PolygonGeometry(const PolygonGeometry& other);
             PolygonGeometry(const std::vector<Point>& outerRing);
             PolygonGeometry(const std::vector<std::vector<Point>>& rings);
             PolygonGeometry(const Rectangle& outerRect);
-            PolygonGeometry& operator=(const PolygonGeometry& other);
 
             EngineObjectPtr clone() override final { return std::make_shared<PolygonGeometry>(*this); };
             GeometryType type() override final { return GeometryType::Polygon; };
             Rectangle calculateBounds() override final;
             Point center() override final 
             { 
-                if (m_rings.size() > 0 && outerRing().size() > 0)
+                if (m_coordinates.partCount() > 0 && m_coordinates.partSize(0) > 0)
                 {
-                    return Utils::centroid(outerRing()); 
+                    return Utils::centroid(m_coordinates.partPoints(0)); 
                 }
                 else
                 {
@@ -140,49 +276,23 @@ namespace BlueMarble
             };
             void move(const Point& delta) override final;
             void moveTo(const Point& point) override final;
-            bool isInside(const Rectangle& bounds) const override final 
-            { 
-                // TODO: if the bounds overlap with a polygon but in between nodes, this doesnt work
-                
-                // If any point on the outer ring is inside of the bounds
-                // this Polygon is inside the bounds
-                if (bounds.isInside(outerRing()))
-                    return true;
-
-                // If the center of the bounds is not within the outer ring,
-                // this Polygon is can be inside the bounds since the above 
-                // was false.
-                if (!Utils::pointInsidePolygon(bounds.center(), outerRing()))
-                    return false;
-                
-                // Check whether the bounds are completely inside any of the inner rings.
-                // If it is, this Polygon is not inside the bounds
-                for (size_t i=1; i<m_rings.size(); i++)
-                {
-                    if (Utils::pointInsidePolygon(bounds.center(), m_rings[i])
-                        && !bounds.isInside(m_rings[i]))
-                        return false;
-                }
-
-                return true;
-            };
-            bool isStrictlyInside(const Rectangle& bounds) const override final { return bounds.allInside(outerRing()); };
-            void forEachPoint(const std::function<void(Point&)>& func) override final
-            { 
-                for (auto& ring : m_rings)
-                {
-                    for(auto& p : ring) 
-                    {
-                        func(p);
-                    }
-                }
-            };
-            std::vector<Point>& outerRing() { return m_rings[0]; }
-            const std::vector<Point>& outerRing() const { assert(m_rings.size() > 0); return m_rings[0]; }
-            std::vector<std::vector<Point>>& rings() { return m_rings; };
+            bool isInside(const Rectangle& bounds) const override final;
+            bool isStrictlyInside(const Rectangle& bounds) const override final;
+            void forEachPoint(const std::function<void(Point&)>& func) override final;
+            void forEachCoordinateArray(const std::function<void(double* x, double* y, size_t n)>& func) override final { m_coordinates.transformArrays(func); }
+            uint64_t version() const override final { return m_coordinates.version(); }
+            PointSequence outerRing() { assert(m_coordinates.partCount() > 0); return PointSequence(&m_coordinates, 0); }
+            ConstPointSequence outerRing() const { assert(m_coordinates.partCount() > 0); return ConstPointSequence(&m_coordinates, 0); }
+            RingSequence rings() { return RingSequence(&m_coordinates); };
+            ConstRingSequence rings() const { return ConstRingSequence(&m_coordinates); };
+            CoordinateBuffer& coordinates() { return m_coordinates; }
+            const CoordinateBuffer& coordinates() const { return m_coordinates; }
+            // Triangles covering the polygon (holes excluded), as three indices into coordinates() per triangle.
+            // Triangulated on first use after a modification, copies of the polygon share the result.
+            TriangulationCache::IndicesPtr triangulation() const;
         private:
-            std::vector<std::vector<Point>>     m_rings; // All rings, including outer. TODO: make each ring a LineGeometry
-            Utils::CachableVariable<Rectangle>  m_cachedBounds; // TODO: No obvious gain, remove?
+            CoordinateBuffer   m_coordinates; // One part per ring, the first is the outer ring
+            TriangulationCache m_triangulationCache;
     };
     typedef std::shared_ptr<PolygonGeometry> PolygonGeometryPtr;
 
@@ -195,7 +305,7 @@ namespace BlueMarble
 
             EngineObjectPtr clone() override final { return std::make_shared<MultiPolygonGeometry>(*this); };
             GeometryType type() override final { return GeometryType::MultiPolygon; };
-            Rectangle calculateBounds() override final { return Rectangle(); };
+            Rectangle calculateBounds() override final;
             Point center() override final { return Point(); };
             void move(const Point& delta) override final;
             void moveTo(const Point& point) override final;
@@ -217,8 +327,12 @@ namespace BlueMarble
                 }
                 return true; 
             }; // TODO
-            void forEachPoint(const std::function<void(Point&)>& func) override final { throw std::runtime_error("MultiPolygonGeometry::forEachPoint() Not implemented"); }
+            void forEachPoint(const std::function<void(Point&)>& func) override final;
+            void forEachCoordinateArray(const std::function<void(double* x, double* y, size_t n)>& func) override final;
+            uint64_t version() const override final;
+            // Modifications of the polygons, and adding or removing polygons, change the version
             std::vector<PolygonGeometry>& polygons() { return m_polygons; }
+            const std::vector<PolygonGeometry>& polygons() const { return m_polygons; }
         private:
             std::vector<PolygonGeometry> m_polygons;
     };
@@ -232,10 +346,10 @@ namespace BlueMarble
 
             EngineObjectPtr clone() override final { return std::make_shared<MultiLineGeometry>(*this); }
             GeometryType type() override final { return GeometryType::MultiLine; }
-            Rectangle calculateBounds() override final { return Rectangle(); }
+            Rectangle calculateBounds() override final;
             Point center() override final { return Point(); }
-            void move(const Point& delta) override final {};
-            void moveTo(const Point& point) override final {};
+            void move(const Point& delta) override final;
+            void moveTo(const Point& point) override final;
             bool isInside(const Rectangle& bounds) const override final 
             {  
                 // TODO
@@ -245,8 +359,12 @@ namespace BlueMarble
             { 
                 //TODO
             }
-            void forEachPoint(const std::function<void(Point&)>& func) override final { throw std::runtime_error("MultiLineGeometry::forEachPoint() Not implemented"); }
+            void forEachPoint(const std::function<void(Point&)>& func) override final;
+            void forEachCoordinateArray(const std::function<void(double* x, double* y, size_t n)>& func) override final;
+            uint64_t version() const override final;
+            // Modifications of the lines, and adding or removing lines, change the version
             std::vector<LineGeometry>& lines() { return m_lines; }
+            const std::vector<LineGeometry>& lines() const { return m_lines; }
         private:
             std::vector<LineGeometry> m_lines;
     };
@@ -267,17 +385,21 @@ namespace BlueMarble
             Rectangle calculateBounds() override final { return m_bounds; };
             
             Point center() override final { return Point(); };
-            void move(const Point& delta) override final { m_bounds.offset(delta.x(), delta.y()); }; // Not tested
-            void moveTo(const Point& point) override final { m_bounds.reCenter(point); }; // Not tested
+            void move(const Point& delta) override final { m_bounds.offset(delta.x(), delta.y()); touch(); }; // Not tested
+            void moveTo(const Point& point) override final { m_bounds.reCenter(point); touch(); }; // Not tested
             bool isInside(const Rectangle& /*bounds*/) const override final { return false; }; // TODO
             bool isStrictlyInside(const Rectangle& /*bounds*/) const override final { return false; }; // TODO
             void forEachPoint(const std::function<void(Point&)>& func) override final 
             { 
                 throw std::runtime_error("RasterGeometry::forEachPoint() Not implemented");
             }
+            void forEachCoordinateArray(const std::function<void(double* x, double* y, size_t n)>& func) override final 
+            { 
+                throw std::runtime_error("RasterGeometry::forEachCoordinateArray() Not implemented");
+            }
 
             Rectangle bounds() const { return m_bounds; };
-            void bounds(const Rectangle& bounds) { m_bounds = std::move(bounds); };
+            void bounds(const Rectangle& bounds) { m_bounds = std::move(bounds); touch(); };
             double cellHeight() const { return m_bounds.height() / m_raster.height(); };
             double cellWidth() const { return m_bounds.width() / m_raster.width(); };
 
@@ -0,0 +1,253 @@
+#ifndef BLUEMARBLE_GEOMETRYPREDICATES
+#define BLUEMARBLE_GEOMETRYPREDICATES
+
+#include <cstddef>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Note: this header is included by translation units compiled with extended instruction sets
+// (e.g. -mavx2). Keep it free from other includes of the library, such that no inline functions
+// shared with the rest of the library are compiled with instructions the cpu might not support.
+
+namespace BlueMarble
+{
+    // Rectangles stored as separate coordinate arrays, for the batch predicates below
+    struct RectangleArrays
+    {
+        std::vector<double> xMin;
+        std::vector<double> yMin;
+        std::vector<double> xMax;
+        std::vector<double> yMax;
+
+        inline size_t size() const { return xMin.size(); }
+        inline void push_back(double x0, double y0, double x1, double y1)
+        {
+            xMin.push_back(x0);
+            yMin.push_back(y0);
+            xMax.push_back(x1);
+            yMax.push_back(y1);
+        }
+        inline void clear()
+        {
+            xMin.clear();
+            yMin.clear();
+            xMax.clear();
+            yMax.clear();
+        }
+    };
+
+    // Batch geometry predicates over coordinate arrays (structure of arrays), used for culling
+    // and hit testing. Vectorized implementations (SSE2, AVX2) are used when supported by the cpu.
+    // The rectangle semantics are those of Rectangle, borders are inside.
+    namespace GeometryPredicates
+    {
+        // Appends the indices of the rectangles overlapping the area to outIndices, returns the number appended
+        size_t overlapping(double xMin, double yMin, double xMax, double yMax, const RectangleArrays& rectangles, std::vector<uint32_t>& outIndices);
+
+        // Whether any/all of the points are inside the rectangle
+        bool anyInside(double xMin, double yMin, double xMax, double yMax, const double* x, const double* y, size_t n);
+        bool allInside(double xMin, double yMin, double xMax, double yMax, const double* x, const double* y, size_t n);
+
+        // Whether the point is inside the ring (even-odd rule). The ring is implicitly closed.
+        bool pointInPolygon(double px, double py, const double* x, const double* y, size_t n);
+        // pointInPolygon() for many points, outInside[i] is set to 0 or 1
+        void pointsInPolygon(const double* px, const double* py, size_t count, const double* x, const double* y, size_t n, uint8_t* outInside);
+
+        // Shortest distance from the point to the polyline (n-1 segments), infinity if n is 0
+        double distanceToPolyline(double px, double py, const double* x, const double* y, size_t n);
+
+        // Name of the instruction set used by the predicates
+        const char* instructionSet();
+
+        namespace Detail
+        {
+            // Implemented by the instruction set specific translation units. The Sse2/Avx2 functions
+            // fall back to the scalar implementation if the instruction set was not enabled for the build.
+            // The area is given as { xMin, yMin, xMax, yMax }.
+            bool sse2Compiled();
+            bool avx2Compiled();
+
+            // Writes the indices of the overlapping rectangles to outIndices (room for n), returns the count
+            size_t overlappingScalar(const double* area, const double* xMin, const double* yMin, const double* xMax, const double* yMax, size_t n, uint32_t* outIndices, uint32_t firstIndex = 0);
+            size_t overlappingSse2(const double* area, const double* xMin, const double* yMin, const double* xMax, const double* yMax, size_t n, uint32_t* outIndices);
+            size_t overlappingAvx2(const double* area, const double* xMin, const double* yMin, const double* xMax, const double* yMax, size_t n, uint32_t* outIndices);
+
+            // Index of the first point inside (anyInside) or outside (allInside) the area, n if none
+            size_t firstInsideScalar(const double* area, const double* x, const double* y, size_t n, bool inside);
+            size_t firstInsideSse2(const double* area, const double* x, const double* y, size_t n, bool inside);
+            size_t firstInsideAvx2(const double* area, const double* x, const double* y, size_t n, bool inside);
+
+            // Number of ring edges crossed by a ray from the point in +x direction
+            size_t crossingsScalar(double px, double py, const double* x, const double* y, size_t n);
+            size_t crossingsSse2(double px, double py, const double* x, const double* y, size_t n);
+            size_t crossingsAvx2(double px, double py, const double* x, const double* y, size_t n);
+
+            // Shortest squared distance to the segments (x[i], y[i]) - (x[i+1], y[i+1])
+            double distanceSquaredScalar(double px, double py, const double* x, const double* y, size_t n);
+            double distanceSquaredSse2(double px, double py, const double* x, const double* y, size_t n);
+            double distanceSquaredAvx2(double px, double py, const double* x, const double* y, size_t n);
+
+            // Scalar edge and segment functions, for the remainders of the vectorized loops.
+            // Static, such that each translation unit gets its own copy.
+            static inline bool crosses(double px, double py, double x0, double y0, double x1, double y1)
+            {
+                return ((y0 > py) != (y1 > py)) && px < (x1 - x0)*(py - y0)/(y1 - y0) + x0;
+            }
+
+            static inline double segmentDistanceSquared(double px, double py, double x0, double y0, double x1, double y1)
+            {
+                double dx = x1 - x0;
+                double dy = y1 - y0;
+                double t = ((px - x0)*dx + (py - y0)*dy) / (dx*dx + dy*dy);
+                t = t > 0.0 ? (t < 1.0 ? t : 1.0) : 0.0; // Also handles nan of degenerate segments
+                double ex = px - (x0 + t*dx);
+                double ey = py - (y0 + t*dy);
+                return ex*ex + ey*ey;
+            }
+
+            // The kernels below are written for a vector type V providing basic arithmetics, comparisons
+            // returning lane masks, and movemask() returning one bit per lane (see GeometryPredicatesSse2.cpp).
+            // V::max(a, b) must return b if a is nan, as the SSE/AVX max instructions do.
+
+            template <typename V>
+            inline size_t overlapping(const double* area, const double* xMin, const double* yMin, const double* xMax, const double* yMax, size_t n, uint32_t* outIndices)
+            {
+                constexpr size_t W = V::Width;
+                auto areaXMin = V::set1(area[0]);
+                auto areaYMin = V::set1(area[1]);
+                auto areaXMax = V::set1(area[2]);
+                auto areaYMax = V::set1(area[3]);
+
+                size_t count = 0;
+                size_t i = 0;
+                for (; i+W <= n; i+=W)
+                {
+                    auto x = V::and_(V::cmple(V::load(xMin+i), areaXMax), V::cmple(areaXMin, V::load(xMax+i)));
+                    auto y = V::and_(V::cmple(V::load(yMin+i), areaYMax), V::cmple(areaYMin, V::load(yMax+i)));
+                    int bits = V::movemask(V::and_(x, y));
+                    for (size_t lane=0; bits != 0; ++lane, bits >>= 1)
+                    {
+                        if (bits & 1)
+                            outIndices[count++] = uint32_t(i + lane);
+                    }
+                }
+
+                return count + overlappingScalar(area, xMin+i, yMin+i, xMax+i, yMax+i, n-i, outIndices+count, uint32_t(i));
+            }
+
+            template <typename V>
+            inline size_t firstInside(const double* area, const double* x, const double* y, size_t n, bool inside)
+            {
+                constexpr size_t W = V::Width;
+                constexpr int AllLanes = (1 << W) - 1;
+                auto areaXMin = V::set1(area[0]);
+                auto areaYMin = V::set1(area[1]);
+                auto areaXMax = V::set1(area[2]);
+                auto areaYMax = V::set1(area[3]);
+
+                size_t i = 0;
+                for (; i+W <= n; i+=W)
+                {
+                    auto px = V::load(x+i);
+                    auto py = V::load(y+i);
+                    auto insideX = V::and_(V::cmple(areaXMin, px), V::cmple(px, areaXMax));
+                    auto insideY = V::and_(V::cmple(areaYMin, py), V::cmple(py, areaYMax));
+                    int bits = V::movemask(V::and_(insideX, insideY));
+                    if (!inside)
+                        bits ^= AllLanes;
+                    for (size_t lane=0; bits != 0; ++lane, bits >>= 1)
+                    {
+                        if (bits & 1)
+                            return i + lane;
+                    }
+                }
+
+                return i + firstInsideScalar(area, x+i, y+i, n-i, inside);
+            }
+
+            template <typename V>
+            inline size_t crossings(double px, double py, const double* x, const double* y, size_t n)
+            {
+                if (n < 3)
+                    return 0;
+
+                // Edges (i-1, i), the closing edge (n-1, 0) is handled by the scalar remainder
+                constexpr size_t W = V::Width;
+                auto pointX = V::set1(px);
+                auto pointY = V::set1(py);
+                size_t count = 0;
+                size_t i = 1;
+                for (; i+W <= n; i+=W)
+                {
+                    auto x0 = V::load(x+i-1);
+                    auto y0 = V::load(y+i-1);
+                    auto x1 = V::load(x+i);
+                    auto y1 = V::load(y+i);
+                    auto straddles = V::xor_(V::cmpgt(y0, pointY), V::cmpgt(y1, pointY));
+                    auto xIntersection = V::add(V::div(V::mul(V::sub(x1, x0), V::sub(pointY, y0)), V::sub(y1, y0)), x0);
+                    int bits = V::movemask(V::and_(straddles, V::cmplt(pointX, xIntersection)));
+                    for (; bits != 0; bits >>= 1)
+                        count += bits & 1;
+                }
+
+                for (; i<=n; ++i)
+                {
+                    size_t j = i % n;
+                    count += crosses(px, py, x[i-1], y[i-1], x[j], y[j]) ? 1 : 0;
+                }
+
+                return count;
+            }
+
+            template <typename V>
+            inline double distanceSquared(double px, double py, const double* x, const double* y, size_t n)
+            {
+                constexpr size_t W = V::Width;
+                double minDistance = HUGE_VAL;
+                if (n == 1)
+                {
+                    return (px - x[0])*(px - x[0]) + (py - y[0])*(py - y[0]);
+                }
+
+                // Segments (i, i+1)
+                auto pointX = V::set1(px);
+                auto pointY = V::set1(py);
+                auto zero = V::set1(0.0);
+                auto one = V::set1(1.0);
+                auto minimum = V::set1(minDistance);
+                size_t i = 0;
+                for (; i+W < n; i+=W)
+                {
+                    auto x0 = V::load(x+i);
+                    auto y0 = V::load(y+i);
+                    auto dx = V::sub(V::load(x+i+1), x0);
+                    auto dy = V::sub(V::load(y+i+1), y0);
+                    auto vx = V::sub(pointX, x0);
+                    auto vy = V::sub(pointY, y0);
+                    auto t = V::div(V::add(V::mul(vx, dx), V::mul(vy, dy)), V::add(V::mul(dx, dx), V::mul(dy, dy)));
+                    t = V::min(V::max(t, zero), one); // Degenerate segments give nan, clamped to 0
+                    auto ex = V::sub(vx, V::mul(t, dx));
+                    auto ey = V::sub(vy, V::mul(t, dy));
+                    minimum = V::min(minimum, V::add(V::mul(ex, ex), V::mul(ey, ey)));
+                }
+
+                double lanes[W];
+                V::store(lanes, minimum);
+                for (size_t lane=0; lane<W; ++lane)
+                {
+                    minDistance = lanes[lane] < minDistance ? lanes[lane] : minDistance;
+                }
+                for (; i+1 < n; ++i)
+                {
+                    double d = segmentDistanceSquared(px, py, x[i], y[i], x[i+1], y[i+1]);
+                    minDistance = d < minDistance ? d : minDistance;
+                }
+
+                return minDistance;
+            }
+        }
+    }
+}
+
+#endif /* BLUEMARBLE_GEOMETRYPREDICATES */
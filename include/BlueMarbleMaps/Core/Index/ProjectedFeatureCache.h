@@ -0,0 +1,81 @@
+#ifndef BLUEMARBLE_PROJECTEDFEATURECACHE
+#define BLUEMARBLE_PROJECTEDFEATURECACHE
+
+#include "BlueMarbleMaps/Core/Feature.h"
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace BlueMarble
+{
+    // Cache of feature geometries projected to other coordinate systems. Entries are keyed by
+    // target crs and feature id (and thereby data set), and are valid as long as the geometry
+    // of the source feature is the same object at the same version. The least recently used
+    // geometries are evicted when the total memory usage exceeds the limit.
+    // Thread safe, the cache is typically filled by the thread reading the data sets.
+    class ProjectedFeatureCache
+    {
+        public:
+            static constexpr size_t DefaultMaxBytes = 256*1024*1024;
+
+            ProjectedFeatureCache(size_t maxBytes = DefaultMaxBytes);
+
+            // Returns a feature with the geometry of the source feature projected to crs.
+            // Uses the cached geometry if valid, otherwise the feature is projected and cached.
+            FeaturePtr projectTo(const CrsPtr& crs, const FeaturePtr& feature);
+            // Returns the cached projection of the feature, or nullptr if missing or outdated
+            FeaturePtr get(const CrsPtr& crs, const FeaturePtr& feature);
+
+            void remove(const Id& id);
+            void clear();
+
+            size_t maxBytes() const;
+            void maxBytes(size_t maxBytes);
+            size_t memoryUsage() const;
+            size_t size() const;
+            size_t hits() const;
+            size_t misses() const;
+        private:
+            struct Key
+            {
+                int64_t crsId;
+                Id      id;
+                inline bool operator==(const Key& other) const { return crsId == other.crsId && id == other.id; }
+            };
+            struct KeyHash
+            {
+                inline std::size_t operator()(const Key& key) const noexcept
+                {
+                    return Id::IdHash{}(key.id) ^ (std::hash<int64_t>{}(key.crsId) << 2);
+                }
+            };
+            struct Entry
+            {
+                Key                     key;
+                std::weak_ptr<Geometry> source;
+                uint64_t                sourceVersion;
+                GeometryPtr             projected;
+                uint64_t                projectedVersion; // Detects modifications of the shared projected geometry
+                size_t                  bytes;
+            };
+            typedef std::list<Entry> EntryList;
+
+            // Returns the valid cached geometry, or nullptr. Requires the mutex to be locked.
+            GeometryPtr find(const Key& key, const GeometryPtr& source);
+            void insert(const Key& key, const GeometryPtr& source, uint64_t sourceVersion, const GeometryPtr& projected);
+            void erase(EntryList::iterator it);
+            void evict();
+
+            mutable std::mutex                                      m_mutex;
+            EntryList                                               m_entries; // Most recently used first
+            std::unordered_map<Key, EntryList::iterator, KeyHash>   m_lookup;
+            size_t                                                  m_maxBytes;
+            size_t                                                  m_bytes;
+            size_t                                                  m_hits;
+            size_t                                                  m_misses;
+    };
+    typedef std::shared_ptr<ProjectedFeatureCache> ProjectedFeatureCachePtr;
+}
+
+#endif /* BLUEMARBLE_PROJECTEDFEATURECACHE */
@@ -14,6 +14,20 @@ namespace BlueMarble
     class DataSet; // Forward declaration.
     class Map;     // Forward declaration.
     typedef std::shared_ptr<Map> MapPtr;
+
+    // Image of a layer rendered by the map for a north up view, see Layer::renderCacheEnabled()
+    struct LayerRenderCache
+    {
+        DrawablePtr       drawable;             // Offscreen, same renderer as the map, transparent background
+        RasterGeometryPtr image;                // Straight alpha, its bounds the map area of the view it was rendered for
+        CrsPtr            crs;
+        uint64_t          dataVersion = 0;
+        uint64_t          stateVersion = 0;     // Of the hover and selection state of the map
+        bool              busy = false;         // The layer was loading or animating when the view settled, no image is rendered until it is done
+        Rectangle         settlingArea = Rectangle::undefined(); // View of the previous frame, while the image is out of date
+
+        void clear() { image = nullptr; crs = nullptr; busy = false; settlingArea = Rectangle::undefined(); }
+    };
     
     class Layer 
         : public ResourceObject
@@ -33,6 +47,15 @@ namespace BlueMarble
             void maxScale(double maxScale) { m_maxScale = maxScale; }
             double minScale() {return m_minScale; }
             void minScale(double minScale) { m_minScale = minScale; }
+            // Render target caching. The map renders the layer into an image once the view stops changing, and for
+            // pans it draws the image moved and renders only the newly exposed strips. Meant for layers whose data and
+            // style rarely change, e.g. a background of countries. Disabled by default.
+            void renderCacheEnabled(bool enabled) { m_renderCacheEnabled = enabled; }
+            bool renderCacheEnabled() const { return m_renderCacheEnabled; }
+            // Call when the data or style of the layer changed, it drops the render cache
+            void dataChanged() { ++m_dataVersion; }
+            uint64_t dataVersion() const { return m_dataVersion; }
+            LayerRenderCache& renderCache() { return m_renderCache; }
 
             virtual void hitTest(const MapPtr& map, const Rectangle& bounds, std::vector<PresentationObject>& presObjects) = 0;
             virtual FeatureEnumeratorPtr prepare(const CrsPtr &crs, const FeatureQuery& featureQuery) = 0;
@@ -50,8 +73,10 @@ namespace BlueMarble
             double  m_maxScale;
             double  m_minScale;
             bool    m_renderingEnabled;
+            bool    m_renderCacheEnabled;
+            uint64_t m_dataVersion;
 
-            DrawablePtr m_drawable; // Needed if we need to draw on our own buffer
+            LayerRenderCache m_renderCache;
     };
     typedef std::shared_ptr<Layer> LayerPtr;
 
@@ -3,10 +3,13 @@
 
 #include "BlueMarbleMaps/Core//Layer/Layer.h"
 #include "BlueMarbleMaps/Core/Index/FIFOCache.h"
+#include "BlueMarbleMaps/Core/Index/ProjectedFeatureCache.h"
 #include "BlueMarbleMaps/System/Thread.h"
 
 #include <thread>
 #include <condition_variable>
+#include <unordered_map>
+#include <unordered_set>
 
 
 namespace BlueMarble
@@ -29,6 +32,8 @@ namespace BlueMarble
             std::vector<VisualizerPtr>& selectionVisualizers() { return m_selectionVisualizers; }
 
             std::vector<EffectPtr>& effects() { return m_effects; }
+            // Features of data sets in another crs than the map are projected once and cached here
+            const ProjectedFeatureCachePtr& projectedFeatureCache() { return m_projectedFeatures; }
 
             virtual void hitTest(const MapPtr& map, const Rectangle& bounds, std::vector<PresentationObject>& presObjects) override final;
             virtual FeatureEnumeratorPtr prepare(const CrsPtr &crs, const FeatureQuery& featureQuery) override final;
@@ -39,6 +44,14 @@ namespace BlueMarble
             // TODO: possibly make these part of base "Layer"
             IdCollectionPtr getFeatureIds(const CrsPtr& crs, const FeatureQuery& featureQuery);
             FeatureCollectionPtr getFeatures(const CrsPtr& crs, const IdCollectionPtr& ids);
+            // Returns the areas of the query that needs to be queried from the data sets, given the previous
+            // query. Returns an empty vector if the view did not change enough to expose anything new. The
+            // whole view is returned when the data changed (dataChanged()), when zoomed, and periodically.
+            std::vector<Rectangle> exposedAreas(const CrsPtr& crs, const FeatureQuery& featureQuery);
+            // Features of a partial query that are read already, the rest is read in the background.
+            // The state of the view (previous query, visible features) is left as it is.
+            FeatureEnumeratorPtr preparePartial(const CrsPtr& crs, const FeatureQuery& featureQuery);
+            void readAsync(const CrsPtr& crs, const IdCollectionPtr& ids);
 
             void createDefaultVisualizers();
 
@@ -50,11 +63,21 @@ namespace BlueMarble
             std::vector<DataSetPtr> m_dataSets;
 
             FIFOCachePtr            m_cache;
+            ProjectedFeatureCachePtr m_projectedFeatures;
             bool                    m_readAsync;
             std::mutex              m_mutex;
-            FeatureQuery            m_query;
+            FeatureQuery            m_query;     // Previous query when reading asynchronously
+            CrsPtr                  m_queryCrs;
+            int64_t                 m_fullQueryTimeMs; // When the whole view was last queried
+            double                  m_fullQueryResolution;
+            uint64_t                m_fullQueryDataVersion;
             System::ThreadPool      m_threadPool;
 
+            // Features of the previous query when reading asynchronously, and the ids
+            // of the ones waiting to be read into the cache
+            std::unordered_map<Id, FeaturePtr, Id::IdHash> m_visibleFeatures;
+            std::unordered_set<Id, Id::IdHash>             m_pendingIds;
+
             FeatureEnumeratorPtr    m_queriedFeatures;
 
 
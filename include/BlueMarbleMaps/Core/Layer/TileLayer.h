@@ -5,6 +5,9 @@
 #include "BlueMarbleMaps/System/Thread.h"
 #include "BlueMarbleMaps/Core/Index/FIFOCache.h"
 
+#include <unordered_map>
+#include <unordered_set>
+
 namespace BlueMarble
 {
     using TileId = uint64_t;
@@ -16,11 +19,15 @@ namespace BlueMarble
         int y=-1;
         int zoom=-1;
 
+        // Limited by the 29 bits used for x and y in id()
+        static constexpr int MaxZoom = 29;
+
         FeatureEnumeratorPtr features{nullptr}; // The features contained in this tile, could be empty if not loaded yet
+        FeatureEnumeratorPtr guests{nullptr}; // Features in this tile that has another home tile, same layout as features
 
         inline bool isValid() const
         {
-            return x >= 0 && y >= 0 && zoom >= 0 && zoom <= 20;
+            return x >= 0 && y >= 0 && zoom >= 0 && zoom <= MaxZoom;
         }
 
         TileId id() const 
@@ -87,7 +94,7 @@ namespace BlueMarble
 
         bool parentOf(const Tile& tile, Tile& parent) const
         {
-            if (tile.zoom == 0)
+            if (tile.zoom <= m_minZoom)
                 return false;
 
             int zoom = tile.zoom - 1;
@@ -102,6 +109,46 @@ namespace BlueMarble
             return true;
         }
 
+        // Returns the four tiles covering the tile at the next zoom level
+        std::vector<Tile> childrenOf(const Tile& tile) const
+        {
+            if (tile.zoom >= m_maxZoom)
+                return {};
+
+            int zoom = tile.zoom + 1;
+            int x = tile.x << 1;
+            int y = tile.y << 1;
+
+            return { {x, y, zoom}, {x+1, y, zoom}, {x, y+1, zoom}, {x+1, y+1, zoom} };
+        }
+
+        // Returns the tile containing the point. Points on a border between two tiles
+        // belongs to the tile with the larger index.
+        Tile tileAt(const Point& point, int zoom) const
+        {
+            int n = tilesPerAxis(zoom);
+            int x = static_cast<int>(std::floor((point.x() - m_fullExtent.xMin()) / tileWidth(zoom)));
+            int y = static_cast<int>(std::floor((point.y() - m_fullExtent.yMin()) / tileHeight(zoom)));
+
+            Tile tile;
+            tile.x = std::clamp(x, 0, n - 1);
+            tile.y = std::clamp(y, 0, n - 1);
+            tile.zoom = zoom;
+
+            return tile;
+        }
+
+        // Returns the tile containing the center of the part of the bounds inside the full extent,
+        // i.e. a tile overlapping the bounds. Degenerate bounds (points, axis aligned lines) use their center.
+        Tile tileAt(const Rectangle& bounds, int zoom) const
+        {
+            Rectangle clipped = bounds.intersect(m_fullExtent);
+            return tileAt(clipped.isUndefined() ? bounds.center() : clipped.center(), zoom);
+        }
+
+        int minZoom() const { return m_minZoom; }
+        int maxZoom() const { return m_maxZoom; }
+
         int tilesPerAxis(int zoom) const
         {
             return 1 << zoom;
@@ -173,7 +220,7 @@ namespace BlueMarble
     class TileManager
     {
     public:
-        TileManager(const Rectangle& fullExtent);
+        TileManager(const Rectangle& fullExtent, int minZoom, int maxZoom);
         Rectangle tileBounds(int x, int y, int zoom) const;
 
         std::vector<Tile> getTilesForArea(const Rectangle& area, int zoom) const;
@@ -186,30 +233,103 @@ namespace BlueMarble
         void setTile(Tile&& tile);
         void removeTile(const Tile& tile);
         void markTileDirty(const Tile &tile);
+        // Counts a failed load of the tile (an exception thrown while loading). The tile is loaded again after a delay
+        // that doubles with each failure, and given up on after a few attempts, until the tiles are reset.
+        void tileLoadFailed(const Tile& tile, int64_t timeStampMs);
+        bool isTileLoadDelayed(const Tile& tile, int64_t timeStampMs) const;
+        bool hasFailedTile(const Tile& tile) const;
+        int loadedTileCount() const;
+        int loadingTileCount() const;
         bool parentOf(const Tile& tile, Tile& parent) const
         {
             return m_tilingScheme.parentOf(tile, parent);
         }
+        std::vector<Tile> childrenOf(const Tile& tile) const
+        {
+            return m_tilingScheme.childrenOf(tile);
+        }
+        const TilingScheme& tilingScheme() const { return m_tilingScheme; }
 
     private:
         TilingScheme m_tilingScheme;
         std::map<std::uint64_t, Tile> m_tileCache; // Cache of loaded tiles, keyed by a hash of the tile coordinates
+        struct FailedLoads
+        {
+            int count;
+            int64_t lastTimeStampMs;
+        };
+        std::unordered_map<TileId, FailedLoads> m_failedLoads;
     };
 
     class TileLayer : public LayerSet
     {
     public:
+        struct ZoomRange
+        {
+            int minZoom;
+            int maxZoom;
+            bool contains(int zoom) const { return zoom >= minZoom && zoom <= maxZoom; }
+        };
+
         TileLayer();
         bool asyncRead() const { return m_readAsync; }
         void asyncRead(bool async);
+
+        // Tiling parameters. Changing the tile size or zoom range discards the tile cache,
+        // changing the worker parameters restarts the background workers.
+        int tileSize() const { return m_tileSize; }
+        void tileSize(int tileSize);
+        int minZoom() const { return m_zoomRange.minZoom; }
+        int maxZoom() const { return m_zoomRange.maxZoom; }
+        void zoomRange(int minZoom, int maxZoom);
+        size_t numWorkers() const { return m_numWorkers; }
+        void numWorkers(size_t numWorkers);
+        size_t queueSize() const { return m_queueSize; }
+        void queueSize(size_t queueSize);
+        System::ThreadPool::QueuePolicy queuePolicy() const { return m_queuePolicy; }
+        void queuePolicy(System::ThreadPool::QueuePolicy queuePolicy);
+
+        // Restricts the zoom levels a sub layer is loaded for, such that heavy layers
+        // are skipped when loading tiles outside of their useful zoom band.
+        void subLayerZoomRange(const LayerPtr& layer, int minZoom, int maxZoom);
+        ZoomRange subLayerZoomRange(const LayerPtr& layer) const;
+
+        // Number of tiles in the cache that are loaded/waiting to be loaded
+        int loadedTileCount() const;
+        int loadingTileCount() const;
+
         virtual FeatureEnumeratorPtr prepare(const CrsPtr &crs, const FeatureQuery& featureQuery) override final;
         virtual void update(const MapPtr& map, const FeatureEnumeratorPtr& features, const FeatureQuery& featureQuery) override final;
         virtual void flushCache() override final;
     private:
         void verifyValidSubLayers();
+        void restartThreadPool();
+        void resetTiles();
+        int zoomForScale(const CrsPtr& crs, double scale) const;
         void scheduleTileLoad(const Tile& tile, const CrsPtr& crs, const FeatureQuery& tileQuery);
-        FeatureEnumeratorPtr thinFeatures(const FeatureEnumeratorPtr& features, double unitsPerPixel, const Rectangle& tileArea) const;
+        // Finds loaded tiles to render in place of a tile that is not loaded yet. Loaded descendants
+        // are used first, gaps are covered by the closest loaded ancestor. Returns false if nothing was found.
+        bool substituteTile(const Tile& tile, std::vector<Tile>& substitutes) const;
+        bool collectLoadedDescendants(const Tile& tile, int depth, std::vector<Tile>& descendants) const;
+        // Guest features (see isHomeTile()) are moved to guests, which gets the same layout of sub enumerators as the result
+        FeatureEnumeratorPtr thinFeatures(const FeatureEnumeratorPtr& features, double unitsPerPixel, const Tile& tile, const TilingScheme& tilingScheme, const FeatureEnumeratorPtr& guests) const;
         FeaturePtr thinFeature(const FeaturePtr& feature, double unitsPerPixel, const Rectangle& tileArea) const;
+        // Splits the features returned for a tile into features unique to the tile (clipped), and features that
+        // can be returned for several tiles (shared). The fills of polygons leaving the tile are clipped to it
+        // (FeatureAttributeKeys::FillOnly), the whole polygon is shared for its outline (FeatureAttributeKeys::NoFill),
+        // also when the tile only overlaps its bounds. Lines are not clipped, such that they are drawn in one piece,
+        // with one id, without seams.
+        void clipFeature(const FeaturePtr& feature, const Rectangle& tileArea, std::vector<FeaturePtr>& clipped, std::vector<FeaturePtr>& shared) const;
+        static bool isClippedToTile(GeometryType type);
+        // Shared features are drawn by their home tile if it is rendered, and are guests in the other tiles.
+        // The home tile is the tile at the center of their bounds (see TilingScheme::tileAt()), which
+        // overlaps the bounds, and so gets the feature when it is loaded.
+        static bool isHomeTile(const FeaturePtr& feature, const Tile& tile, const TilingScheme& tilingScheme);
+        // Creates enumerators over the features of a cached tile for one frame. The feature collections are
+        // shared with the cache, the iteration state is not. Guests are added unless one of the rendered tiles
+        // is their home tile, or they have already been added for another tile. Does not access the cache,
+        // such that it is called without holding the lock.
+        static FeatureEnumeratorPtr frameFeatures(const FeatureEnumeratorPtr& features, const FeatureEnumeratorPtr& guests, const TilingScheme& tilingScheme, const std::unordered_set<TileId>& renderedTiles, const std::vector<int>& renderedZooms, std::unordered_set<Id, Id::IdHash>& guestsAdded);
         void thinLine(std::vector<Point>& thinned, const std::vector<Point>& line, bool closed, double unitsPerPixel) const;
         void drawTiles(const MapPtr& map, const FeatureQuery& featureQuery) const;
         void cleanCache();
@@ -219,6 +339,11 @@ namespace BlueMarble
         bool                            m_readAsync;
         mutable std::mutex              m_mutex; // Mutex for synchronizing access to the tile cache
         int                             m_tileSize;
+        ZoomRange                       m_zoomRange;
+        size_t                          m_numWorkers;
+        size_t                          m_queueSize;
+        System::ThreadPool::QueuePolicy m_queuePolicy;
+        std::map<LayerPtr, ZoomRange>   m_subLayerZoomRanges;
     };
 
     using TileLayerPtr = std::shared_ptr<TileLayer>;
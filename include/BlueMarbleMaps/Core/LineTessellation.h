@@ -0,0 +1,36 @@
+#ifndef BLUEMARBLE_LINETESSELLATION
+#define BLUEMARBLE_LINETESSELLATION
+
+#include "BlueMarbleMaps/Core/Pen.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace BlueMarble
+{
+    // Tessellation of polylines into triangles, for drawing lines of a width in pixels with the joins
+    // and caps of a Pen. Each vertex is a point of the line plus an offset to the edge of the line. The
+    // offset has its length in pixels and its direction in the coordinate system of the line, such that
+    // the renderer can turn it to the screen and the width stays the same at any zoom without tessellating again.
+    // Segments are drawn as quads, with the outer side of each corner filled by the join. The inner sides
+    // of bevel and round joins overlap.
+    namespace LineTessellation
+    {
+        struct Vertex
+        {
+            uint32_t point;     // Index of the line point this vertex is extruded from
+            float    offsetX;   // Offset from the point, in pixels
+            float    offsetY;
+        };
+
+        // Tessellates the polyline (x[i], y[i]) for the width, join, cap and miter limit of the pen.
+        // A closed line gets a join between its last and first point instead of caps. Consecutive duplicate
+        // points are skipped. Appends to outVertices and three indices (into outVertices) per triangle to
+        // outIndices, returns false if the line has less than two distinct points or no width.
+        bool tessellate(const double* x, const double* y, size_t n, bool closed, const Pen& pen,
+                        std::vector<Vertex>& outVertices, std::vector<uint32_t>& outIndices);
+    }
+}
+
+#endif /* BLUEMARBLE_LINETESSELLATION */
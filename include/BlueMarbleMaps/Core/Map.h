@@ -6,6 +6,7 @@
 #include "BlueMarbleMaps/Core/Camera/ICameraController.h"
 #include "BlueMarbleMaps/Core/Animation.h"
 #include "BlueMarbleMaps/Core/Drawable.h"
+#include "BlueMarbleMaps/Core/FrameArena.h"
 #include "BlueMarbleMaps/Core/Layer/Layer.h"
 #include "BlueMarbleMaps/Core/PresentationObject.h"
 #include "BlueMarbleMaps/Core/ResourceObject.h"
@@ -15,6 +16,7 @@
 
 #include <map>
 #include <functional>
+#include <vector>
 
 
 namespace BlueMarble
@@ -29,6 +31,24 @@ namespace BlueMarble
         Replace
     };
 
+    // Offscreen rendering of a map area to an image, see Map::renderToImages()
+    struct RenderJob
+    {
+        Rectangle area;     // In the crs of the map, centered in the image with the aspect ratio kept
+        int       width;    // Of the image, in pixels
+        int       height;
+        int64_t   timeoutMs = 10000; // For layers reading asynchronously to finish loading and animations to settle
+    };
+
+    struct RenderedImage
+    {
+        std::vector<unsigned char> png;     // Encoded image
+        int     width;
+        int     height;
+        int64_t renderTimeMs;               // Rendering and encoding
+        bool    complete;                   // False if the job timed out with layers still loading or updating
+    };
+
     class Map;
     typedef std::shared_ptr<Map> MapPtr;
     class Map 
@@ -96,6 +116,10 @@ namespace BlueMarble
             void updateEnabled(bool enabled) { m_updateEnabled = enabled; };
             bool quickUpdateEnabled() const { return m_quickUpdateEnabled; }
             void quickUpdateEnabled(bool enabled) { m_quickUpdateEnabled = enabled; }
+            // Partial redraw: when only invalidated areas changed, the next update renders just the layers and features
+            // intersecting them, clipped to them, over the previous frame. Enabled by default.
+            bool partialUpdateEnabled() const { return m_partialUpdateEnabled; }
+            void partialUpdateEnabled(bool enabled) { m_partialUpdateEnabled = enabled; }
             const Attributes& updateAttributes() const { return m_updateAttributes; };
             Attributes& updateAttributes() { return m_updateAttributes; };
 
@@ -125,13 +149,31 @@ namespace BlueMarble
             bool isHovered(const Id& id);
             bool isHovered(FeaturePtr feature);
 
+            // Damage tracking. Marks an area of the screen (in pixels), or the screen bounds of a feature, as changed
+            // and schedules an update that redraws it. Hover and selection changes invalidate their features. Any other
+            // update request (update(), camera changes, resize) renders the full frame.
+            void invalidate(const Rectangle& screenArea);
+            void invalidate(const FeaturePtr& feature);
+            void invalidate(const Id& id);
+            // Screen area the next update redraws, undefined when nothing is invalidated
+            const Rectangle& dirtyRegion() const { return m_dirtyRegion; }
+
             DrawablePtr drawable();
             void drawable(const DrawablePtr& drawable);
             void resize(int width, int height);
 
             void flushCache();
 
+            // Headless rendering, without a MapControl or window. Renders the jobs in order with the drawable of the map
+            // (a SoftwareBitmapDrawable by default), each from an orthographic camera looking straight down at its area.
+            // Each job is updated until its layers are done, or it times out. The layer caches are kept between the jobs.
+            // The camera, camera controller and size are restored afterwards.
+            std::vector<RenderedImage> renderToImages(const std::vector<RenderJob>& jobs);
+            RenderedImage renderToImage(const RenderJob& job);
+
             bool& showDebugInfo() { return m_showDebugInfo; }
+            // Arena of the current (or last) update, transient objects of the frame are allocated here
+            const FrameArenaPtr& frameArena() const { return m_frameArena; }
             void onAttachedToMapControl(MapControlPtr mapControl) { m_mapControl = mapControl; };
             void onDetachedFromMapControl() { m_mapControl = nullptr; };
 
@@ -160,12 +202,25 @@ namespace BlueMarble
         private:
             void updateUpdateAttributes(int64_t timeStampMs);
             void beforeRender();
-            void renderLayers();
-            FeatureQuery produceUpdateQuery();
-            void renderLayer(const LayerPtr& layer, const FeatureQuery& featureQuery);
+            // Returns false if a layer was not done
+            bool renderLayers(const Rectangle& screenArea);
+            FeatureQuery produceUpdateQuery(const Rectangle& screenArea);
+            // Returns false if the layer was not done, e.g. data still loading
+            bool renderLayer(const LayerPtr& layer, const FeatureQuery& featureQuery);
+            // As renderLayer(), but also false if the layer requested more updates, e.g. when animating
+            bool renderLayerSettled(const LayerPtr& layer, const FeatureQuery& featureQuery);
+            bool renderCachedLayer(const LayerPtr& layer, const FeatureQuery& featureQuery);
+            // Returns false, and keeps no image, if the layer was not done
+            bool renderLayerToCache(const LayerPtr& layer, const FeatureQuery& featureQuery, const Rectangle& viewArea);
+            // Map area seen by a north up view looking straight down, undefined for other views
+            Rectangle northUpViewArea() const;
             void afterRender();
 
+            // Schedules an update of the full frame, for invalidations whose screen area is unknown
+            void invalidateAll();
+
             void drawDebugInfo(int elapsedMs);
+            RenderedImage renderJob(const RenderJob& job);
 
             MapControlPtr m_mapControl;
             DrawablePtr m_drawable;
@@ -176,12 +231,18 @@ namespace BlueMarble
             bool m_updateRequired;
             bool m_updateEnabled;
             bool m_quickUpdateEnabled;
+            bool m_partialUpdateEnabled;
+            bool m_fullUpdateRequired;  // Anything but invalidated areas changed
+            bool m_layersComplete;      // All layers were done in the last update, none still loading
+            Rectangle m_dirtyRegion;    // Invalidated screen area, in pixels
+            uint64_t m_renderStateVersion; // Bumped by invalidations, drops layer render caches
 
             CameraPtr           m_camera;
             ICameraController*  m_cameraController;
             ino64_t             m_lastUpdateTimeStamp;
 
             Attributes m_updateAttributes;
+            FrameArenaPtr m_frameArena;
 
             std::vector<LayerPtr> m_layers;
             std::vector<PresentationObject> m_presentationObjects;
@@ -3,10 +3,15 @@
 #include <glfw3.h>
 #include "Drawable.h"
 #include "BlueMarbleMaps/Core/Brush.h"
+#include "BlueMarbleMaps/Core/LineTessellation.h"
 #include "BlueMarbleMaps/Core/Pen.h"
 #include "Platform/OpenGL/Batch.h"
+#include "Platform/OpenGL/InstancedMesh.h"
+#include "Platform/OpenGL/TextureAtlas.h"
 #include "Platform/OpenGL/Primitive.h"
+#include "Platform/OpenGL/RetainedBuffer.h"
 #include <map>
+#include <unordered_map>
 
 namespace BlueMarble
 {
@@ -15,7 +20,7 @@ namespace BlueMarble
     public:
         OpenGLDrawable(int width, int height, int colorDepth = 4);
         OpenGLDrawable(const Drawable& drawable) = delete;
-        ~OpenGLDrawable() = default;
+        ~OpenGLDrawable();
         // Properties
         int width() const;
         int height() const;
@@ -36,6 +41,7 @@ namespace BlueMarble
         void resize(int width, int height);
         void drawCircle(double x, double y, double radius, const Pen& pen, const Brush& brush);
         void drawArc(double cx, double cy, double rx, double ry, double theta, const Pen& pen, const Brush& brush);
+        void drawSymbols(const std::vector<SymbolInstance>& symbols);
         void drawLine(const LineGeometryPtr& geometry, const Pen& pen);
         void drawPolygon(const PolygonGeometryPtr& geometry, const Pen& pen, const Brush& brush);
         void drawRect(const Point& topLeft, const Point& bottomRight, const Color& color);
@@ -45,31 +51,124 @@ namespace BlueMarble
         Color readPixel(int x, int y);
         void setPixel(int x, int y, const Color& color);
         void clearBuffer() override final;
+        // Scissor rectangle. Drawing goes to an offscreen frame buffer that keeps the previous frame,
+        // copied to the window in swapBuffers().
+        void setClipRect(const Rectangle& pixels) override final;
         void swapBuffers();
         Raster getRaster() override final;
         RendererImplementation renderer();
+        // Shares the OpenGL context, and draws to a frame buffer of its own
+        std::shared_ptr<Drawable> createOffscreen(int width, int height) override final;
         void flushCache() override final;
+        bool isComplete() const override final;
+
+        // Retained mode: lines and polygons drawn unchanged (same geometry object, version and style) in
+        // consecutive frames are uploaded to static buffers shared with nearby geometries and redrawn from
+        // those with the current view matrix, instead of being rebuilt into the batches each frame. They are
+        // drawn in the order they were submitted, interleaved with the batched ones. Enabled by default.
+        void retainedMode(bool enabled);
+        bool retainedMode() const;
+        // Number of geometries with retained buffers
+        size_t retainedCount() const;
+        // Counters of the retained polygons and lines together
+        RetainedBufferStats retainedStats() const;
+        // Batch counters of the current frame, the last rendered one once it is done
+        BatchStats batchStats() const;
+
+        // Rasters are drawn from tiles of RasterTileSize cells in a texture atlas, at the level of detail
+        // of the view. The tiles are kept within the memory budget (128 MB by default), the least recently
+        // drawn ones are replaced first. Changing the budget drops all tiles.
+        // At most rasterUploadsPerFrame tiles (16 by default) are uploaded per frame, the rest of the raster
+        // is drawn from the coarsest resident level in the meantime and the drawable is not complete.
+        static constexpr int RasterTileSize = 256;
+        void rasterMemoryBudget(size_t bytes);
+        size_t rasterMemoryBudget() const;
+        void rasterUploadsPerFrame(int uploads);
+        int rasterUploadsPerFrame() const;
+        TextureAtlasStats rasterStats() const;
     protected:
         GLFWwindow* m_window;
         int m_width;
         int m_height;
     private:
         static glm::mat4x4 transformToMatrix(const Transform& transform);
-	    Vertice createPoint(const Point& point, Color color);
         Color getColorFromList(const std::vector<Color>& colors, int index);
         static void GLAPIENTRY MessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam);
 
-	    std::map<BMID,PrimitivePtr> m_primitives;
+        struct RetainedKey
+        {
+            const Geometry* geometry;
+            size_t          style;      // Hash of the colors, width, joins and caps
+            bool            isPolygon;
+            inline bool operator==(const RetainedKey& other) const { return geometry == other.geometry && style == other.style && isPolygon == other.isPolygon; }
+        };
+        struct RetainedKeyHash
+        {
+            size_t operator()(const RetainedKey& key) const { return std::hash<const void*>()(key.geometry) ^ (key.style*31) ^ key.isPolygon; }
+        };
+        struct RetainedGeometry
+        {
+            std::weak_ptr<Geometry>      geometry;   // Tells a geometry apart from a new one at the same address
+            uint64_t                     version;
+            uint64_t                     firstFrame;
+            uint64_t                     lastFrame;
+            RetainedBuffer::Allocation   allocation; // Added when drawn unchanged in a second frame
+        };
+
+        // Triangles of the line (x[i], y[i], z[i]) extruded to the width of the pen, z may be null
+        bool tessellateLine(const double* x, const double* y, const double* z, size_t n, bool closed, const Pen& pen,
+                            const Point& origin, std::vector<LineVertex>& vertices, std::vector<GLuint>& indices);
+        RetainedGeometry* findRetained(const GeometryPtr& geometry, size_t style, bool isPolygon);
+        void releaseRetained(RetainedGeometry& retained, bool isPolygon);
+        // (Re)allocates the offscreen frame buffer for the size of the drawable and binds it
+        void createFrameBuffer();
+        // Binds the frame buffer, viewport and scissor rectangle of this drawable. Several drawables
+        // can share the context, see createOffscreen().
+        void makeCurrent();
+        // Draw what was submitted so far, the batched geometries before the retained ones queued after them.
+        // Called before a batched geometry is submitted after retained ones, to keep the order of submission.
+        void flushPolygons();
+        void flushLines();
+        void drawRetained(RetainedBuffer& buffer, std::vector<RetainedBuffer::Allocation>& draws, const ShaderPtr& shader);
+
         ShaderPtr m_basicShader;
         ShaderPtr m_polyShader;
         ShaderPtr m_lineShader;
+        ShaderPtr m_symbolShader;
+        ShaderPtr m_rasterShader;
         Transform m_transform;
         glm::dmat4 m_viewMatrix;
         glm::dmat4 m_projectionMatrix;
         Point       m_renderOrigin;
         Color m_color;
+        GLuint m_frameBuffer;
+        GLuint m_frameTexture;
+        Rectangle m_clipRect;
         BatchPtr lineBatch;
         BatchPtr polyBatch;
+        InstancedMeshPtr m_circleSymbol;
+        std::vector<SymbolVertex> m_symbolInstances;   // Drawn instanced in endBatches()
+        TextureAtlasPtr m_rasterAtlas;
+        BatchPtr m_rasterBatch;
+        size_t m_rasterMemoryBudget;
+        int m_rasterUploadsPerFrame;
+        int m_rasterUploads;        // In the current frame
+        bool m_complete;
+        std::vector<RasterVertex> m_rasterVertices;
+        std::vector<GLuint> m_rasterIndices;
+
+        bool     m_retainedMode;
+        uint64_t m_frame;
+        std::unordered_map<RetainedKey, RetainedGeometry, RetainedKeyHash> m_retained;
+        RetainedBufferPtr m_retainedPolygons;
+        RetainedBufferPtr m_retainedLines;
+        std::vector<RetainedBuffer::Allocation> m_retainedPolygonDraws; // Queued after everything pending in the batch
+        std::vector<RetainedBuffer::Allocation> m_retainedLineDraws;
+
+        // Reused between lines
+        std::vector<LineTessellation::Vertex> m_tessellation;
+        std::vector<LineVertex> m_lineVertices;
+        std::vector<GLuint> m_lineIndices;
     };
     typedef std::shared_ptr<OpenGLDrawable> OpenGLDrawablePtr;
 
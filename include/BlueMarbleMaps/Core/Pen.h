@@ -13,6 +13,20 @@ namespace BlueMarble
 			Tracked,
 			Dotted
 		};
+		// Shape of the corners of wide lines
+		enum class Join
+		{
+			Miter,
+			Round,
+			Bevel
+		};
+		// Shape of the ends of wide lines
+		enum class Cap
+		{
+			Butt,
+			Round,
+			Square
+		};
 
 		static Pen transparent() { return Pen(Color::transparent(), 0.0); }
 		Pen();
@@ -37,11 +51,22 @@ namespace BlueMarble
 		void setProperties(Properties properties);
 		Properties getProperties() const;
 
+		void setJoin(Join join);
+		Join getJoin() const;
+		void setCap(Cap cap);
+		Cap getCap() const;
+		// Longest miter, in line widths, before a miter join falls back to a bevel
+		void setMiterLimit(double miterLimit);
+		double getMiterLimit() const;
+
 	private:
 		double m_thickness;
 		double m_offset;
 		bool m_antiAlias;
 		std::vector<Color> m_colors;
 		Properties m_properties;
+		Join m_join;
+		Cap m_cap;
+		double m_miterLimit;
 	};
 }
@@ -4,6 +4,7 @@
 #include "BlueMarbleMaps/Core/Color.h"
 #include <string>
 #include <memory>
+#include <vector>
 
 namespace BlueMarble
 {
@@ -50,8 +51,12 @@ namespace BlueMarble
             void rotate(double angle, int cx, int cy, ResizeInterpolation interpolation = ResizeInterpolation::NearestNeighbor);
             void fill(int val);
             void blur(double sigmaX, double sigmaY, double sigmaZ, bool isGaussian=false);
+            // Divides the colors by alpha, for 4 channel rasters drawn onto a transparent black background
+            void unpremultiplyAlpha();
             Raster getCrop(int x0, int y0, int x1, int y1) const;
             void save(const std::string& filePath) const;
+            // Contents of the PNG file save() writes
+            std::vector<unsigned char> encodePng() const;
             void* data() const;
 
             Raster& operator=(const Raster& raster);
@@ -0,0 +1,35 @@
+#ifndef BLUEMARBLE_RASTERWARP
+#define BLUEMARBLE_RASTERWARP
+
+#include "BlueMarbleMaps/Core/Geometry.h"
+#include "BlueMarbleMaps/CoordinateSystem/Crs.h"
+
+namespace BlueMarble
+{
+    // Reprojection (warping) of rasters between coordinate systems, nearest neighbor sampled.
+    // Each target cell is inverse mapped to a source cell. Source coordinates are computed
+    // exactly at a sparse grid of target cells and interpolated linearly in between. When both
+    // projections are separable (see Projection::isSeparable()), the source column only depends
+    // on the target column and the source row on the target row, and the mapping is computed
+    // exactly for each column and row instead. Rows are processed in parallel.
+    namespace RasterWarp
+    {
+        constexpr int DefaultGridStep = 16;
+
+        enum class Method
+        {
+            Automatic, // Separable if possible, otherwise grid
+            Grid
+        };
+
+        // Returns a raster geometry of the same size as the source, covering the source bounds projected to targetCrs.
+        // Cells mapping outside of the source are left transparent.
+        RasterGeometryPtr reProject(RasterGeometry& source,
+                                    const CrsPtr& sourceCrs,
+                                    const CrsPtr& targetCrs,
+                                    Method method = Method::Automatic,
+                                    int gridStep = DefaultGridStep);
+    }
+}
+
+#endif /* BLUEMARBLE_RASTERWARP */
@@ -19,14 +19,15 @@ namespace BlueMarble
             virtual void backgroundColor(const Color& color);
             
             // Methods
-            void setProjectionMatrix(const glm::dmat4& proj) override final {};
-            void setViewMatrix(const glm::dmat4& viewMatrix) override final {};
-            void setRenderOrigin(const Point& origin) override final {};
+            void setProjectionMatrix(const glm::dmat4& proj) override final;
+            void setViewMatrix(const glm::dmat4& viewMatrix) override final;
+            void setRenderOrigin(const Point& origin) override final;
             void beginBatches() override final;
             void endBatches() override final;
             void resize(int width, int height)  override final;
             void drawArc(double cx, double cy, double rx, double ry, double theta, const Pen& pen, const Brush& brush) override final;
             void drawCircle(double x, double y, double radius, const Pen& pen, const Brush& brush);
+            void drawSymbols(const std::vector<SymbolInstance>& symbols) override final;
             void drawLine(const LineGeometryPtr& geometry, const Pen& pen) override final;
             void drawPolygon(const PolygonGeometryPtr& geometry, const Pen& pen, const Brush& brush) override final;
             void drawRect(const Point& topLeft, const Point& bottomRight, const Color& color) override final;
@@ -36,9 +37,11 @@ namespace BlueMarble
             Color readPixel(int x, int y) override final;
             void setPixel(int x, int y, const Color& color) override final;
             void clearBuffer() override final;
+            void setClipRect(const Rectangle& pixels) override final;
             void swapBuffers() override final;
-            virtual Raster getRaster() override final { throw std::runtime_error("SoftwareDrawable::getRaster() Not implemented"); };
+            virtual Raster getRaster() override final;
             RendererImplementation renderer() override final;
+            std::shared_ptr<Drawable> createOffscreen(int width, int height) override final;
             void flushCache() override {}
         protected:
             class Impl;
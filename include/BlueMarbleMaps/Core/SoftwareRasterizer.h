@@ -0,0 +1,139 @@
+#ifndef BLUEMARBLE_SOFTWARERASTERIZER
+#define BLUEMARBLE_SOFTWARERASTERIZER
+
+#include "BlueMarbleMaps/Core/Color.h"
+#include "BlueMarbleMaps/Core/Core.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace BlueMarble
+{
+    // Binned, multithreaded scanline rasterizer for 8 bit images with one plane per channel (the layout
+    // of CImg) and 3 (RGB) or 4 (RGBA) channels. Draw calls are recorded in pixel coordinates and binned
+    // to the TileSize x TileSize screen tiles their bounds overlap. flush() rasterizes the tiles in parallel,
+    // each tile drawing its primitives in the order they were recorded, so the image is the same as when
+    // drawing them one by one. A pixel is covered when its center is inside (no anti-aliasing), and the
+    // color is blended over the image with its alpha.
+    class SoftwareRasterizer
+    {
+        public:
+            static constexpr int TileSize = 64;
+
+            enum class FillRule
+            {
+                EvenOdd,
+                NonZero
+            };
+
+            // With 0 threads, one per hardware thread is used. The calling thread is one of them.
+            SoftwareRasterizer(unsigned int threads = 0);
+            ~SoftwareRasterizer();
+            SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+            SoftwareRasterizer& operator=(const SoftwareRasterizer&) = delete;
+
+            // The image drawn to, it has to stay alive until the next flush(). Drops anything recorded.
+            void setTarget(uint8_t* data, int width, int height, int channels);
+            unsigned int threadCount() const;
+            // Pixels [x0, x1) x [y0, y1) that are drawn to, the whole image by default. Applies to what is recorded after.
+            void setClip(int x0, int y0, int x1, int y1);
+
+            // Polygon of the rings [ringOffsets[r], ringOffsets[r+1]) of the coordinate arrays, implicitly closed
+            void fillPolygon(const double* x, const double* y, const size_t* ringOffsets, size_t ringCount,
+                             const Color& color, FillRule rule = FillRule::EvenOdd);
+            // Union of the triangles, three indices (into x and y) per triangle
+            void fillTriangles(const double* x, const double* y, const uint32_t* indices, size_t indexCount, const Color& color);
+            // Draws an 8 bit image of 1 to 4 channels, sampled nearest neighbour, as the parallelogram with its top left,
+            // top right and bottom left corners at the points. Channel c of column i, row j is at
+            // data[j*rowStride + i*pixelStride + c*channelStride]. The data has to stay alive until the next flush().
+            void drawImage(const uint8_t* data, int width, int height, int channels, size_t pixelStride, size_t rowStride,
+                           size_t channelStride, const Point& topLeft, const Point& topRight, const Point& bottomLeft, double alpha);
+
+            // Rasterizes and drops everything recorded
+            void flush();
+            // Drops everything recorded without drawing it
+            void discard();
+            size_t pendingCount() const;
+
+        private:
+            // Edge of a polygon, top to bottom
+            struct Edge
+            {
+                float x0;
+                float y0;
+                float y1;
+                float dxdy;
+                int   winding;
+            };
+
+            struct Image
+            {
+                const uint8_t* data;
+                int     width;
+                int     height;
+                int     channels;
+                size_t  pixelStride;
+                size_t  rowStride;
+                size_t  channelStride;
+                double  ux, uy, u0;     // Pixel center to image column
+                double  vx, vy, v0;     // Pixel center to image row
+                int     alpha;
+            };
+
+            struct Primitive
+            {
+                size_t   firstEdge;
+                size_t   edgeCount;
+                int      x0, y0, x1, y1; // Covered pixels, [x0, x1) x [y0, y1)
+                uint8_t  color[4];
+                FillRule rule;
+                int      image;          // Index in m_images, -1 for a solid fill
+            };
+
+            struct Scratch
+            {
+                std::vector<const Edge*>            edges;
+                std::vector<const Edge*>            active;
+                std::vector<std::pair<float, int>>  crossings;
+            };
+
+            void addEdge(double x0, double y0, double x1, double y1);
+            void addPrimitive(size_t firstEdge, double xMin, double yMin, double xMax, double yMax, const Color& color, FillRule rule, int image);
+            void rasterizeTiles(Scratch& scratch);
+            void rasterizeTile(int tile, Scratch& scratch);
+            void rasterizePrimitive(const Primitive& primitive, int tx0, int ty0, int tx1, int ty1, Scratch& scratch);
+            void fillSpan(const Primitive& primitive, int row, int x0, int x1);
+            void workerLoop();
+
+            uint8_t* m_data;
+            int      m_width;
+            int      m_height;
+            int      m_channels;
+            int      m_tilesX;
+            int      m_tilesY;
+            int      m_clipX0, m_clipY0, m_clipX1, m_clipY1;
+
+            std::vector<Edge>                  m_edges;
+            std::vector<Primitive>             m_primitives;
+            std::vector<Image>                 m_images;
+            std::vector<std::vector<uint32_t>> m_bins;  // Primitives per tile, in the order recorded
+
+            // Workers, woken by flush() to take tiles until none are left
+            std::vector<std::thread> m_workers;
+            std::mutex               m_mutex;
+            std::condition_variable  m_wake;
+            std::condition_variable  m_done;
+            uint64_t                 m_generation;
+            unsigned int             m_busy;
+            bool                     m_stop;
+            std::atomic<int>         m_nextTile;
+            Scratch                  m_scratch;         // Of the calling thread
+    };
+}
+
+#endif /* BLUEMARBLE_SOFTWARERASTERIZER */
@@ -0,0 +1,198 @@
+#ifndef BLUEMARBLE_STYLEEXPRESSION
+#define BLUEMARBLE_STYLEEXPRESSION
+
+#include "BlueMarbleMaps/Core/Attributes.h"
+#include "BlueMarbleMaps/Core/Color.h"
+#include "BlueMarbleMaps/Core/Feature.h"
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace BlueMarble
+{
+    // Numeric style expression, built from attribute references, constants, arithmetic and
+    // interpolate/step/match. The expression is compiled once into a CompiledStyleExpression
+    // and evaluated per feature.
+    //
+    // Example, width by population and view scale:
+    //     auto width = StyleExpression::interpolate(StyleExpression::attribute("POP_EST"), {{ 1e5, 1.0 }, { 1e7, 4.0 }})
+    //                * StyleExpression::viewScale();
+    //     lineVis->width(CompiledStyleExpression(width));
+    class StyleExpression
+    {
+        public:
+            typedef std::vector<std::pair<double, double>>          Stops;
+            typedef std::vector<std::pair<AttributeValue, double>>  Cases;
+
+            enum class Operator
+            {
+                Constant,
+                Attribute,
+                ViewScale,
+                Add,
+                Subtract,
+                Multiply,
+                Divide,
+                Min,
+                Max,
+                Interpolate,
+                Step,
+                Match
+            };
+
+            StyleExpression(double value); // Constant
+
+            static StyleExpression constant(double value);
+            // Numeric value of the attribute (int, double or bool). The feature attributes are searched
+            // first, then the update attributes. The default value is used if missing or not numeric.
+            static StyleExpression attribute(const AttributeKey& key, double defaultValue = 0.0);
+            // The view scale of the map (UpdateAttributeKeys::UpdateViewScale), used as zoom input
+            static StyleExpression viewScale();
+            // Linear interpolation between stops (input, output), sorted by input. Clamped outside the stops.
+            static StyleExpression interpolate(const StyleExpression& input, const Stops& stops);
+            // Output of the last stop with input <= the input value, base if below the first stop
+            static StyleExpression step(const StyleExpression& input, double base, const Stops& stops);
+            // Output of the case equal to the attribute value, defaultValue if none. The attribute is looked
+            // up as for attribute().
+            static StyleExpression match(const AttributeKey& key, const Cases& cases, double defaultValue);
+            static StyleExpression min(const StyleExpression& a, const StyleExpression& b);
+            static StyleExpression max(const StyleExpression& a, const StyleExpression& b);
+
+            friend StyleExpression operator+(const StyleExpression& a, const StyleExpression& b);
+            friend StyleExpression operator-(const StyleExpression& a, const StyleExpression& b);
+            friend StyleExpression operator*(const StyleExpression& a, const StyleExpression& b);
+            friend StyleExpression operator/(const StyleExpression& a, const StyleExpression& b);
+
+        private:
+            friend class CompiledStyleExpression;
+
+            struct Node
+            {
+                Operator                                op;
+                double                                  value; // Constant, default or step base
+                AttributeKey                            key;
+                Stops                                   stops;
+                Cases                                   cases;
+                std::vector<std::shared_ptr<const Node>> arguments;
+            };
+            typedef std::shared_ptr<const Node> NodePtr;
+
+            StyleExpression(const NodePtr& node);
+            static StyleExpression binary(Operator op, const StyleExpression& a, const StyleExpression& b);
+
+            NodePtr m_node;
+    };
+
+    StyleExpression operator+(const StyleExpression& a, const StyleExpression& b);
+    StyleExpression operator-(const StyleExpression& a, const StyleExpression& b);
+    StyleExpression operator*(const StyleExpression& a, const StyleExpression& b);
+    StyleExpression operator/(const StyleExpression& a, const StyleExpression& b);
+
+    // Style expression compiled into flat bytecode for a stack machine. Sub expressions that
+    // depend on neither the feature nor the view scale are folded into constants. Expressions
+    // that do not depend on the feature are evaluated once per view scale and cached, such
+    // that they cost a comparison per feature.
+    // Can be used wherever a DoubleEvaluation is expected, also from several threads at once.
+    // Copies share the compiled program.
+    class CompiledStyleExpression
+    {
+        public:
+            static constexpr size_t MaxStackDepth = 32;
+
+            CompiledStyleExpression(const StyleExpression& expression);
+
+            bool dependsOnFeature() const { return m_dependsOnFeature; }
+            bool dependsOnViewScale() const { return m_dependsOnViewScale; }
+            size_t instructionCount() const;
+
+            double evaluate(const Attributes& featureAttributes, const Attributes& updateAttributes) const;
+
+            double operator()(const FeaturePtr& feature, Attributes& updateAttributes) const;
+
+        private:
+            struct Instruction
+            {
+                StyleExpression::Operator   op;
+                uint32_t                    index; // Into the constant, key, stops or match table
+            };
+
+            struct AttributeRef
+            {
+                AttributeKey    key;
+                double          defaultValue;
+            };
+
+            struct StopsRef
+            {
+                StyleExpression::Stops  stops;
+                double                  base;
+            };
+
+            struct MatchRef
+            {
+                AttributeKey            key;
+                StyleExpression::Cases  cases;
+                double                  defaultValue;
+            };
+
+            struct Program
+            {
+                std::vector<Instruction>    instructions;
+                std::vector<double>         constants;
+                std::vector<AttributeRef>   attributes;
+                std::vector<StopsRef>       stops;
+                std::vector<MatchRef>       matches;
+                size_t                      stackDepth = 0;
+            };
+
+            // Value of a feature independent expression at the last view scale. Written under a sequence
+            // counter, such that a thread reads both the view scale and the value of the same write.
+            // Copies start empty.
+            class Cache
+            {
+                public:
+                    Cache();
+                    Cache(const Cache&) : Cache() {}
+                    Cache& operator=(const Cache&);
+
+                    bool get(double viewScale, double& value) const;
+                    // Skipped when another thread is writing
+                    void set(double viewScale, double value) const;
+                private:
+                    mutable std::atomic<uint64_t>   m_sequence;
+                    mutable std::atomic<double>     m_viewScale; // nan for none
+                    mutable std::atomic<double>     m_value;
+            };
+
+            static void emit(Program& program, const StyleExpression::NodePtr& node, size_t depth, bool fold);
+            static double execute(const Program& program, const Attributes& featureAttributes, const Attributes& updateAttributes);
+            static const AttributeValue* findAttribute(const AttributeKey& key, const Attributes& featureAttributes, const Attributes& updateAttributes);
+            static double attributeValue(const AttributeRef& ref, const Attributes& featureAttributes, const Attributes& updateAttributes);
+            static double viewScale(const Attributes& updateAttributes);
+
+            std::shared_ptr<const Program>  m_program;
+            bool                            m_dependsOnFeature;
+            bool                            m_dependsOnViewScale;
+            Cache                           m_cache;
+    };
+
+    // Color from four compiled expressions, usable wherever a ColorEvaluation is expected
+    class ColorStyleExpression
+    {
+        public:
+            ColorStyleExpression(const StyleExpression& r, const StyleExpression& g, const StyleExpression& b, const StyleExpression& a = 1.0);
+
+            Color evaluate(const Attributes& featureAttributes, const Attributes& updateAttributes) const;
+
+            Color operator()(const FeaturePtr& feature, Attributes& updateAttributes) const;
+        private:
+            CompiledStyleExpression m_r;
+            CompiledStyleExpression m_g;
+            CompiledStyleExpression m_b;
+            CompiledStyleExpression m_a;
+    };
+}
+
+#endif /* BLUEMARBLE_STYLEEXPRESSION */
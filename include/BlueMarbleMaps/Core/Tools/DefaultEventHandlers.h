@@ -82,8 +82,7 @@ namespace BlueMarble
                 }
                 else
                 {
-                    m_map->deSelectAll();
-                    m_map->update();
+                    m_map->deSelectAll(); // Redraws the deselected features
 
                     return true;
                 }
@@ -109,8 +108,7 @@ namespace BlueMarble
                 {
                     m_map->deSelect(selFeat);
                 }
-                
-                m_map->update();
+                // Selection changes redraw the features involved
 
                 return true;
             }
@@ -143,11 +141,12 @@ namespace BlueMarble
                                                       (double)event.pos.y});
                 auto delta = toPos-fromPos;
 
+                // Redraw where the feature was and where it ends up
+                m_map->invalidate(m_editFeature);
                 if (m_nodeIndex != -1)
                 {
                     BMM_DEBUG() << "Edit Node: " << m_nodeIndex << "\n";
-                    auto& point = getNodePoint(m_editFeature, m_nodeIndex);
-                    point = toPos;
+                    setNodePoint(m_editFeature, m_nodeIndex, toPos);
                 }
                 else
                 {
@@ -155,8 +154,7 @@ namespace BlueMarble
                     toPos = m_map->crs()->projectTo(m_editFeature->crs(), toPos);
                     m_editFeature->move(toPos-fromPos);
                 }
-
-                m_map->update();
+                m_map->invalidate(m_editFeature);
 
                 return true;
             }
@@ -168,20 +166,20 @@ namespace BlueMarble
             }
 
         private:
-            Point& getNodePoint(const FeaturePtr& feature, int nodeIndex)
+            void setNodePoint(const FeaturePtr& feature, int nodeIndex, const Point& point)
             {
                 if (feature->geometryType() == GeometryType::Point)
                 {
-                    return feature->geometryAsPoint()->point();
+                    feature->geometryAsPoint()->point() = point;
                 }
                 else if (feature->geometryType() == GeometryType::Polygon)
                 {
                     // TODO: could be inner ring
-                    return feature->geometryAsPolygon()->outerRing()[nodeIndex];
+                    feature->geometryAsPolygon()->outerRing()[nodeIndex] = point;
                 }
                 else if (feature->geometryType() == GeometryType::Line)
                 {
-                    return feature->geometryAsLine()->points()[nodeIndex];
+                    feature->geometryAsLine()->points()[nodeIndex] = point;
                 }
                 else
                 {
@@ -486,14 +484,12 @@ namespace BlueMarble
                     
                     hoverFeature = pObjs[0].sourceFeature();
                     
-                    m_map->update();
                     m_hoverFeature = hoverFeature;
                 }
 
                 if (!m_map->isHovered(hoverFeature))
                 {
-                    m_map->hover(hoverFeature);
-                    m_map->update();
+                    m_map->hover(hoverFeature); // Redraws the features whose hover state changed
                 }
 
                 return true;
@@ -0,0 +1,29 @@
+#ifndef BLUEMARBLE_TRIANGULATION
+#define BLUEMARBLE_TRIANGULATION
+
+#include "BlueMarbleMaps/Core/CoordinateBuffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace BlueMarble
+{
+    // Polygon triangulation by ear clipping on a linked list of the vertices, with holes bridged into
+    // the outer ring and a z-order curve index of the vertices for the ear tests of larger polygons
+    // (the earcut algorithm). Runs in about O(n log n) for typical map polygons, bridging a hole costs
+    // O(n) in addition. Self intersecting and degenerate input is handled on a best effort basis, without failing.
+    namespace Triangulation
+    {
+        // Triangulates the polygon with rings [ringOffsets[r], ringOffsets[r+1]) in the coordinate arrays,
+        // the first ring is the outer ring and the others are holes. Rings are implicitly closed, and may
+        // have any orientation. Appends three vertex indices per triangle to outIndices (indices into x and y),
+        // returns false if no triangles could be made.
+        bool triangulate(const double* x, const double* y, const size_t* ringOffsets, size_t ringCount, std::vector<uint32_t>& outIndices);
+
+        // Triangulates a polygon stored with one part per ring, the first part is the outer ring
+        bool triangulate(const CoordinateBuffer& coordinates, std::vector<uint32_t>& outIndices);
+    }
+}
+
+#endif /* BLUEMARBLE_TRIANGULATION */
@@ -36,6 +36,9 @@ namespace BlueMarble
             void quickUpdate(bool quickpdate) { m_quickUpdate = quickpdate; }
             void ids(const IdCollectionPtr& ids) { m_ids = ids; }
             IdCollectionPtr ids() const { return m_ids; }
+            // A part of the view (e.g. an invalidated area) redrawn over the previous frame, not a new view
+            bool partial() const { return m_partial; }
+            void partial(bool partial) { m_partial = partial; }
 
         private:
             Rectangle   m_area = Rectangle::infinite();
@@ -43,6 +46,7 @@ namespace BlueMarble
             double      m_scale = 1.0;
             Attributes* m_updateAttributes = nullptr;
             bool        m_quickUpdate = false;
+            bool        m_partial = false;
             RasterGeometryMode m_rasterMode = RasterGeometryMode::Original;
             double              m_resolution=-1.0;
     };
@@ -6,11 +6,13 @@
 #include "PresentationObject.h"
 #include "LabelOrganizer.h"
 #include "AttributeVariable.h"
+#include "StyleExpression.h"
 #include "Brush.h"
 #include "Pen.h"
 
 #include <functional>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 namespace BlueMarble
@@ -175,6 +177,8 @@ namespace BlueMarble
                         m_hotSpot = hotSpotFromAlignments(alignments);
                     }
 
+                    inline BuiltInSymbol builtInSymbol() const { return m_symbol; }
+
                     inline void render(Drawable& drawable, const Point& point, double size, const Color& color, double rotation)
                     {
                         switch (m_symbol)
@@ -263,6 +267,7 @@ namespace BlueMarble
             void renderPoints(Drawable& drawable, const std::vector<Point>& points, const FeaturePtr& feature, const FeaturePtr& source, Attributes& updateAttributes) override final;
         private:
             Symbol m_symbol;
+            std::vector<SymbolInstance> m_instances; // Reused between features
     };
     typedef std::shared_ptr<SymbolVisualizer> SymbolVisualizerPtr;
 
@@ -293,9 +298,22 @@ namespace BlueMarble
         protected:
             bool isValidGeometry(GeometryType type) override final;
         private:
+            // Line geometries drawn for a feature geometry (e.g. the rings of a polygon), kept while the feature
+            // geometry is unchanged such that the drawable gets the same geometries each frame and can retain them
+            struct LineCacheEntry
+            {
+                std::weak_ptr<Geometry>      source;
+                uint64_t                     version;
+                double                       offsetZ;
+                std::vector<LineGeometryPtr> lines;
+            };
+
             Pen createPen(const FeaturePtr& feature, Attributes& attributes);
+            const std::vector<LineGeometryPtr>& linesToDraw(const FeaturePtr& feature, double offsetZ);
 
             DoubleEvaluation m_widthEval;
+            std::unordered_map<const Geometry*, LineCacheEntry> m_lineCache;
+            size_t m_lineCachePruneSize;
     };
     typedef std::shared_ptr<LineVisualizer> LineVisualizerPtr;
 
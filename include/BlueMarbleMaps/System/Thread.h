@@ -38,11 +38,14 @@ public:
     void start(size_t numThreads, size_t maxQueueSize, QueuePolicy queuePolicy);
     void stop(bool dropQueuedTasks = false);
     bool isRunning() const { return !m_stop; }
+    // True when called from a worker of any thread pool, for work that would otherwise start threads of its own
+    static bool isWorkerThread();
     // template<class F, class... Args>
     // auto enqueue(F&& f, Args&&... args) -> std::future<typename std::result_of<F(Args...)>::type>;
     // Enqueues a task with an optional "onDropped" callback. onDropped is called
     // synchronuously when calling enqueue, or stop(true) (or when the thread pool is destroyed).
     // onDropped is always called on the same thread as of which the thread pool was created.
+    // When stopping, onDropped is called after the workers have finished their tasks.
     void enqueue(Task&& task);
     void enqueue(std::function<void()>&& task) { enqueue(Task{std::move(task), []{}}); };
 private:
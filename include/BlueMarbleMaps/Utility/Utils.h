@@ -319,6 +319,88 @@ namespace BlueMarble
         }
 
 
+        // Clips a ring against an axis aligned rectangle using the
+        // Sutherland-Hodgman algorithm: https://en.wikipedia.org/wiki/Sutherland%E2%80%93Hodgman_algorithm
+        // The ring is treated as implicitly closed (first point is not repeated). Since the
+        // clip window is convex, holes can be clipped one by one with the same function.
+        // Concave rings that are cut in several pieces are kept as one ring connected by
+        // degenerate edges along the clip border, which is fine for filling.
+        inline std::vector<Point> clipRingToRectangle(const std::vector<Point>& ring, const Rectangle& clip)
+        {
+            if (ring.size() < 3)
+            {
+                return std::vector<Point>();
+            }
+
+            enum Edge { Left, Right, Bottom, Top };
+
+            auto isInside = [&clip](const Point& p, Edge edge)
+            {
+                switch (edge)
+                {
+                case Left:   return p.x() >= clip.xMin();
+                case Right:  return p.x() <= clip.xMax();
+                case Bottom: return p.y() >= clip.yMin();
+                default:     return p.y() <= clip.yMax();
+                }
+            };
+
+            auto intersection = [&clip](const Point& p1, const Point& p2, Edge edge)
+            {
+                double t;
+                switch (edge)
+                {
+                case Left:   t = (clip.xMin() - p1.x()) / (p2.x() - p1.x()); break;
+                case Right:  t = (clip.xMax() - p1.x()) / (p2.x() - p1.x()); break;
+                case Bottom: t = (clip.yMin() - p1.y()) / (p2.y() - p1.y()); break;
+                default:     t = (clip.yMax() - p1.y()) / (p2.y() - p1.y()); break;
+                }
+                return p1 + (p2 - p1)*t;
+            };
+
+            std::vector<Point> input;
+            std::vector<Point> output = ring;
+            for (Edge edge : { Left, Right, Bottom, Top })
+            {
+                if (output.empty())
+                {
+                    break;
+                }
+
+                std::swap(input, output);
+                output.clear();
+                output.reserve(input.size() + 4);
+
+                Point prev = input.back();
+                bool prevInside = isInside(prev, edge);
+                for (const auto& curr : input)
+                {
+                    bool currInside = isInside(curr, edge);
+                    if (currInside)
+                    {
+                        if (!prevInside)
+                        {
+                            output.push_back(intersection(prev, curr, edge));
+                        }
+                        output.push_back(curr);
+                    }
+                    else if (prevInside)
+                    {
+                        output.push_back(intersection(prev, curr, edge));
+                    }
+                    prev = curr;
+                    prevInside = currInside;
+                }
+            }
+
+            if (output.size() < 3)
+            {
+                output.clear();
+            }
+
+            return output;
+        }
+
         inline std::vector<Point> scalePoints(const std::vector<Point>& input, double scale, Point fixPoint=Point::undefined())
         {
             assert(!input.empty());
@@ -1,30 +1,109 @@
 #pragma once
+#include <cassert>
+#include <cstdint>
 #include <memory>
+#include <vector>
 #include <glad/glad.h>
 #include <VAO.h>
 #include <VBO.h>
 #include <IBO.h>
 
+// Counters of a batch during one frame, for profiling
+struct BatchStats
+{
+	size_t vertices = 0;	// Vertices submitted
+	size_t indices = 0;		// Indices submitted, including primitive restarts
+	size_t bytes = 0;		// Vertex and index data drawn, the upload volume
+	size_t drawCalls = 0;
+	size_t flushes = 0;		// Draws forced by a full buffer in the middle of a pass
+	size_t grows = 0;		// Reallocations of the buffers
+	size_t waits = 0;		// Fences that were not yet signaled when a buffer region was reused
+
+	BatchStats& operator+=(const BatchStats& other);
+};
+
+// Streams vertices (of any interleaved layout) and indices of many small draw calls into shared
+// buffers and draws them with one glDrawElements per pass (begin() ... end()).
+// The buffers are split into RegionCount regions used round robin, one per frame, and persistently
+// mapped when the context supports it (GL 4.4), otherwise written through glBufferSubData. A fence
+// is placed after the last draw from a region, and waited for before the region is written again,
+// so the CPU never writes to memory the GPU is still reading and the driver never needs to sync
+// implicitly. When a frame needs more than a region holds, the pending draws are flushed and the
+// batch continues in the next region, and the buffers are grown to fit the whole frame at the start
+// of the next frame. The buffers never shrink.
 class Batch
 {
 #define MAGIX_NUMBER 0xFFFFFFFF
 public:
-	Batch(bool isPolygon);
+	static constexpr int RegionCount = 3;
+
+	Batch(GLenum drawType, const VertexLayout& layout, size_t vertexCapacity = 1 << 16, size_t indexCapacity = 1 << 17);
 	~Batch();
+	Batch(const Batch&) = delete;
+	Batch& operator=(const Batch&) = delete;
+
+	// Starts a new frame, moves on to the next buffer region
+	void nextFrame();
 	void begin();
-	void submit(std::vector<Vertice>& vertices);
-	void submit(std::vector<Vertice>& vertices, std::vector<GLuint>& indices);
+	// The vertices have to match the layout of the batch
+	template <typename V>
+	void submit(const std::vector<V>& vertices)
+	{
+		assert(sizeof(V) == m_layout.stride);
+		submitVertices(vertices.data(), vertices.size(), nullptr, vertices.size());
+	}
+	template <typename V>
+	void submit(const std::vector<V>& vertices, const std::vector<GLuint>& indices)
+	{
+		assert(sizeof(V) == m_layout.stride);
+		submitVertices(vertices.data(), vertices.size(), indices.data(), indices.size());
+	}
+	// Draws everything submitted since begin() and ends the pass
 	void end();
+	// Draws everything submitted so far, may be called anywhere within a pass
 	void flush();
 
+	// Counters of the current frame
+	const BatchStats& stats() const;
+	// Counters of the previous frame
+	const BatchStats& lastFrameStats() const;
+	// Capacity of one region, in vertices and indices
+	size_t vertexCapacity() const;
+	size_t indexCapacity() const;
+	bool persistentlyMapped() const;
+
 private:
-	VAO m_vao;
-	IBO m_ibo;
-	VBO m_vbo;
-	Vertice* m_vertBuffer;
-	GLuint* m_indexBuffer;
-	GLuint m_indexCount;
-	GLuint m_verticeCounter;
-	bool m_isPolygon;
+	// Without indices the vertices are drawn in order
+	void submitVertices(const void* vertices, size_t vertexCount, const GLuint* indices, size_t indexCount);
+	void allocate(size_t vertexCapacity, size_t indexCapacity);
+	void releaseFences();
+	void reserve(size_t vertexCount, size_t indexCount);
+	void nextRegion();
+	void waitForRegion();
+	uint8_t* vertexData();
+	GLuint* indexData();
+
+	std::unique_ptr<VAO> m_vao;
+	std::unique_ptr<VBO> m_vbo;
+	std::unique_ptr<IBO> m_ibo;
+	GLenum m_drawType;
+	VertexLayout m_layout;
+	bool m_persistent;
+	uint8_t* m_mappedVertices;			// Persistently mapped buffers
+	GLuint* m_mappedIndices;
+	std::vector<uint8_t> m_stagingVertices;	// Written instead when the buffers can't be mapped
+	std::vector<GLuint> m_stagingIndices;
+	size_t m_vertexCapacity;
+	size_t m_indexCapacity;
+	GLsync m_fences[RegionCount];
+	int m_region;
+	size_t m_vertexCount;				// Used in the current region
+	size_t m_indexCount;
+	size_t m_vertexDrawStart;			// Submitted but not yet drawn from here
+	size_t m_indexDrawStart;
+	size_t m_frameVertexCount;			// Used in the current frame, over all regions
+	size_t m_frameIndexCount;
+	BatchStats m_stats;
+	BatchStats m_lastFrameStats;
 };
-typedef std::shared_ptr<Batch> BatchPtr;
\ No newline at end of file
+typedef std::shared_ptr<Batch> BatchPtr;
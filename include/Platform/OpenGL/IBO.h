@@ -7,7 +7,7 @@ struct IBO
 	IBO();
 	~IBO();
 	void init();
-	void bufferData(std::vector<GLuint> indicies);
+	void bufferData(const std::vector<GLuint>& indicies);
 	void allocateDynamicBuffer(GLuint size);
 	void bind();
 	void unbind();
@@ -0,0 +1,46 @@
+#pragma once
+#include <cassert>
+#include <memory>
+#include <vector>
+#include <glad/glad.h>
+#include "glm.hpp"
+#include <VAO.h>
+#include <VBO.h>
+#include <IBO.h>
+
+// A small 2D mesh (e.g. a symbol) drawn once per instance with a single glDrawElementsInstanced.
+// The attributes of the instances, in the instance layout, are streamed to a buffer of their own on
+// each draw, so the CPU cost per instance is writing its attributes and nothing else.
+// The instance buffer is orphaned on each draw and grows when needed, it never shrinks.
+class InstancedMesh
+{
+public:
+	InstancedMesh(const std::vector<glm::vec2>& vertices, const std::vector<GLuint>& indices, const VertexLayout& instanceLayout);
+	InstancedMesh(const InstancedMesh&) = delete;
+	InstancedMesh& operator=(const InstancedMesh&) = delete;
+
+	// The instances have to match the instance layout
+	template <typename I>
+	void draw(const std::vector<I>& instances)
+	{
+		assert(sizeof(I) == m_instanceLayout.stride);
+		draw(instances.data(), instances.size());
+	}
+	void draw(const void* instances, size_t instanceCount);
+
+	// Capacity of the instance buffer, in instances
+	size_t instanceCapacity() const;
+
+	// A filled circle of radius 1 around the origin, as a triangle fan of nSegments triangles
+	static void circle(int nSegments, std::vector<glm::vec2>& outVertices, std::vector<GLuint>& outIndices);
+
+private:
+	VAO m_vao;
+	VBO m_meshVbo;
+	IBO m_ibo;
+	VBO m_instanceVbo;
+	VertexLayout m_instanceLayout;
+	GLsizei m_indexCount;
+	size_t m_instanceCapacity;
+};
+typedef std::shared_ptr<InstancedMesh> InstancedMeshPtr;
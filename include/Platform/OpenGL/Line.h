@@ -27,7 +27,8 @@ class Line : public Primitive
 {
 public:
 	Line();
-	Line(LineGeometryInfoPtr info, std::vector<Vertice> &vertices);
+	Line(LineGeometryInfoPtr info, const std::vector<Vertice> &vertices);
+	Line(LineGeometryInfoPtr info, const std::vector<ColorVertex> &vertices);
 
 	void setVao(VAO& vao) override;
 	void setVbo(VBO& vbo) override;
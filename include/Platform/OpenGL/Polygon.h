@@ -45,7 +45,10 @@ class Polygon : public Primitive
 {
 public:
 	Polygon();
-	Polygon(PolygonGeometryInfoPtr info, std::vector<Vertice>& vertices, std::vector<GLuint>& indices);
+	Polygon(PolygonGeometryInfoPtr info, const std::vector<Vertice>& vertices, const std::vector<GLuint>& indices);
+	Polygon(PolygonGeometryInfoPtr info, const std::vector<ColorVertex>& vertices, const std::vector<GLuint>& indices);
+	// Triangles of a wide line
+	Polygon(PolygonGeometryInfoPtr info, const std::vector<LineVertex>& vertices, const std::vector<GLuint>& indices);
 
 	void setVao(VAO& vao) override;
 	void setVbo(VBO& vbo) override;
@@ -0,0 +1,100 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+#include "glm.hpp"
+#include <VAO.h>
+#include <VBO.h>
+#include <IBO.h>
+
+// Counters of a retained buffer, for profiling
+struct RetainedBufferStats
+{
+	size_t pages = 0;		// Pages currently allocated
+	size_t drawCalls = 0;	// Since the buffer was created
+	size_t draws = 0;		// Geometries drawn, merged into the draw calls
+};
+
+// Vertices and indices (of any interleaved layout) of geometries drawn unchanged over many frames,
+// kept in static buffers shared by many geometries (pages) instead of buffers of their own.
+// Geometries are appended to the pages in the order they are added, a geometry is added to a page
+// whose origin is near enough, relative to the size of the geometry, for its vertices to fit a float
+// about as well as relative to the geometry itself. Geometries drawn in the same order as they were
+// added are then next to each other in a page, and are drawn with one glMultiDrawElements per page.
+// Pages are only appended to. The space of released geometries is reclaimed when all geometries of
+// the page are released, a full page with little left in use is stale (see isStale()).
+class RetainedBuffer
+{
+public:
+	// Where the vertices and indices of a geometry are, in a page
+	struct Allocation
+	{
+		uint32_t page = 0;	// 0 for none
+		GLuint firstIndex = 0;
+		GLuint indexCount = 0;
+	};
+	// The page a geometry is to be added to, and the origin its vertices have to be relative to
+	struct Placement
+	{
+		uint32_t page;
+		glm::dvec3 origin;
+	};
+
+	RetainedBuffer(const VertexLayout& layout, size_t pageVertexCapacity = 1 << 14, size_t pageIndexCapacity = 1 << 16);
+	RetainedBuffer(const RetainedBuffer&) = delete;
+	RetainedBuffer& operator=(const RetainedBuffer&) = delete;
+
+	// Finds a page for a geometry within the bounds, or creates one
+	Placement place(double xMin, double yMin, double xMax, double yMax);
+	// The vertices have to match the layout of the buffer and be relative to the origin of the placement,
+	// the indices are relative to the vertices
+	template <typename V>
+	Allocation add(const Placement& placement, const std::vector<V>& vertices, const std::vector<GLuint>& indices)
+	{
+		return add(placement, vertices.data(), vertices.size(), indices.data(), indices.size());
+	}
+	void release(const Allocation& allocation);
+	// The page of the allocation is full and mostly released. Adding the geometry again lets the page be freed.
+	bool isStale(const Allocation& allocation) const;
+	// Releases all pages
+	void clear();
+
+	// Draws the allocations in order. setOrigin(origin) is called before the draws of each page, to
+	// add the offset from the origin of the page to the view matrix.
+	void draw(const std::vector<Allocation>& allocations, const std::function<void(const glm::dvec3&)>& setOrigin);
+
+	RetainedBufferStats stats() const;
+
+private:
+	struct Page
+	{
+		uint32_t id;
+		glm::dvec3 origin;
+		VAO vao;
+		VBO vbo;
+		IBO ibo;
+		size_t vertexCapacity = 0;
+		size_t indexCapacity = 0;
+		size_t vertexCount = 0;		// Used, including released geometries
+		size_t indexCount = 0;
+		size_t liveIndexCount = 0;	// Of the geometries not yet released
+		bool full = false;			// No longer added to
+	};
+
+	Allocation add(const Placement& placement, const void* vertices, size_t vertexCount, const GLuint* indices, size_t indexCount);
+	Page& createPage(const glm::dvec3& origin, size_t vertexCapacity, size_t indexCapacity);
+
+	VertexLayout m_layout;
+	size_t m_pageVertexCapacity;
+	size_t m_pageIndexCapacity;
+	std::unordered_map<uint32_t, std::unique_ptr<Page>> m_pages;
+	std::vector<uint32_t> m_openPages;		// Geometries are added to, the most recently used first
+	uint32_t m_nextPage;
+	std::vector<GLsizei> m_counts;			// Reused between draws
+	std::vector<const void*> m_offsets;
+	RetainedBufferStats m_stats;
+};
+typedef std::shared_ptr<RetainedBuffer> RetainedBufferPtr;
@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+
+// Identifies a tile in a TextureAtlas, e.g. a raster, its version, level of detail and tile index
+struct AtlasKey
+{
+	uint64_t id;
+	uint64_t version;
+	int level;
+	int x;
+	int y;
+
+	inline bool operator==(const AtlasKey& other) const
+	{
+		return id == other.id && version == other.version && level == other.level && x == other.x && y == other.y;
+	}
+};
+
+struct AtlasKeyHash
+{
+	size_t operator()(const AtlasKey& key) const
+	{
+		size_t hash = std::hash<uint64_t>()(key.id);
+		hash = hash*31 + std::hash<uint64_t>()(key.version);
+		hash = hash*31 + (size_t)key.level;
+		hash = hash*31 + std::hash<int64_t>()((int64_t)key.x << 32 | (uint32_t)key.y);
+		return hash;
+	}
+};
+
+// Counters of an atlas since it was created
+struct TextureAtlasStats
+{
+	size_t uploads = 0;		// Tiles written to the atlas
+	size_t evictions = 0;	// Resident tiles replaced by another
+	size_t flushes = 0;		// Evictions of a tile used by the current draw, that had to be drawn first
+};
+
+// Fixed-size RGBA8 tiles in the layers of one GL_TEXTURE_2D_ARRAY, sized after a memory budget.
+// Tiles are kept until their layer is needed for another tile, the least recently used one is
+// replaced first. Pixels are written to a pixel unpack buffer and copied to the texture from there,
+// so the driver can transfer them without blocking the draw calls of the frame.
+class TextureAtlas
+{
+public:
+	TextureAtlas(int tileSize, size_t memoryBudget);
+	~TextureAtlas();
+	TextureAtlas(const TextureAtlas&) = delete;
+	TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+	// Starts a new use of the atlas, e.g. a draw call. The tiles acquired since are protected, see acquire().
+	void beginUse();
+	// Layer holding the tile. A tile that is not resident replaces the least recently used one, and
+	// fill(rgba) writes its pixels, tileSize rows of tileSize pixels. If the replaced tile was acquired
+	// in the current use, flush() is called first so it can be drawn before it is overwritten.
+	// Leaves the atlas bound to the active texture unit.
+	GLint acquire(const AtlasKey& key, const std::function<void(uint8_t* rgba)>& fill, const std::function<void()>& flush);
+	// Layer holding the tile if it is resident, -1 otherwise. A resident tile counts as acquired.
+	GLint acquireResident(const AtlasKey& key);
+	// Forgets all tiles
+	void clear();
+
+	void bind(GLuint unit);
+	int tileSize() const;
+	int layerCount() const;
+	size_t residentCount() const;
+	size_t memoryUsage() const;
+	const TextureAtlasStats& stats() const;
+
+private:
+	void upload(GLint layer, const std::function<void(uint8_t* rgba)>& fill);
+	void use(GLint layer);
+
+	struct Layer
+	{
+		AtlasKey key;
+		bool resident;
+		uint64_t lastUse;
+		std::list<GLint>::iterator lruPosition;
+	};
+
+	GLuint m_texture;
+	GLuint m_pixelBuffer;
+	int m_tileSize;
+	int m_layerCount;
+	uint64_t m_use;
+	std::vector<Layer> m_layers;
+	std::list<GLint> m_lru;			// Most recently used first
+	std::unordered_map<AtlasKey, GLint, AtlasKeyHash> m_tiles;
+	TextureAtlasStats m_stats;
+};
+typedef std::shared_ptr<TextureAtlas> TextureAtlasPtr;
@@ -1,6 +1,32 @@
 #pragma once
 #include <glad/glad.h>
 #include "Platform/OpenGL/VBO.h"
+#include <vector>
+
+// Attribute of an interleaved vertex format
+struct VertexAttribute
+{
+	GLuint location;
+	GLuint components;
+	GLenum type;
+	GLboolean normalized;
+	size_t offset;
+	GLuint divisor = 0;	// Advanced once per this many instances, 0 per vertex
+};
+
+struct VertexLayout
+{
+	GLsizeiptr stride;
+	std::vector<VertexAttribute> attributes;
+
+	static VertexLayout colorVertex();
+	static VertexLayout lineVertex();
+	static VertexLayout rasterVertex();
+	// Unit symbol mesh (a vec2) and the SymbolVertex of each instance
+	static VertexLayout symbolMesh();
+	static VertexLayout symbolInstance();
+};
+
 struct VAO
 {
 	GLuint m_id;
@@ -9,7 +35,8 @@ struct VAO
 	~VAO();
 	void init();
 	void bind();
-	void link(VBO& vbo, GLuint layout, GLuint nrOfComponents, GLenum type, GLsizeiptr stride, GLvoid* offset);
+	void link(VBO& vbo, GLuint layout, GLuint nrOfComponents, GLenum type, GLsizeiptr stride, GLvoid* offset, GLboolean normalized = GL_FALSE);
+	void link(VBO& vbo, const VertexLayout& layout);
 	void linkInt(VBO& vbo, GLuint layout, GLuint nrOfComponents, GLenum type, GLsizeiptr stride, GLvoid* offset);
 	void unbind();
 };
\ No newline at end of file
@@ -10,7 +10,9 @@ struct VBO
 	~VBO();
 	
 	void init();
-	void bufferData(std::vector<Vertice>& vertices);
+	void bufferData(const std::vector<Vertice>& vertices);
+	void bufferData(const std::vector<ColorVertex>& vertices);
+	void bufferData(const std::vector<LineVertex>& vertices);
 	void allocateDynamicBuffer(GLuint size);
 	void bind();
 	void unbind();
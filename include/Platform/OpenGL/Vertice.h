@@ -1,5 +1,6 @@
 #pragma once
 #include "glm.hpp"
+#include <cstdint>
 
 struct Vertice
 {
@@ -7,4 +8,41 @@ struct Vertice
 	glm::vec4 color;
 	glm::vec2 texCoord;
 	//glm::vec3 normal;
-};
\ No newline at end of file
+};
+
+// Vertex of untextured lines and polygons, 16 bytes instead of the 36 of Vertice.
+// The position is relative to an origin close to the geometry, so that it keeps its precision
+// as a float, and the color is normalized RGBA8 (red in the lowest byte), read as a vec4 by the shaders.
+struct ColorVertex
+{
+	glm::vec3 position;
+	uint32_t color;
+};
+
+// Vertex of wide lines, a ColorVertex on the line and the offset from it to the edge of the line.
+// The offset has its length in pixels and its direction in map coordinates, the vertex shader turns
+// it to the screen, so the width does not change with the zoom.
+struct LineVertex
+{
+	glm::vec3 position;
+	uint32_t color;
+	glm::vec2 offset;
+};
+
+// Per instance attributes of instanced symbols. The symbol mesh, of unit size, is rotated, scaled,
+// and moved to the position of each instance.
+struct SymbolVertex
+{
+	glm::vec3 position;	// Relative to an origin, as for ColorVertex
+	float size;
+	float rotation;		// Radians, counter clockwise
+	uint32_t color;
+};
+
+// Vertex of raster tiles in a texture array, texCoord is (u, v, layer)
+struct RasterVertex
+{
+	glm::vec3 position;
+	uint32_t color;
+	glm::vec3 texCoord;
+};
@@ -115,6 +115,18 @@ Rectangle Crs::projectTo(const CrsPtr& crs, const Rectangle& rect) const
     return Rectangle::fromPoints(newCorners);
 }
 
+void Crs::projectTo(const CrsPtr& crs, double* x, double* y, size_t n) const
+{
+    if (m_id != -1 && m_id == crs->id())
+    {
+        return;
+    }
+
+    const auto& ellipsoid = m_datum->ellipsoid();
+    m_projection->unProjectMany(x, y, n, ellipsoid);
+    crs->projection()->projectMany(x, y, n, ellipsoid);
+}
+
 double Crs::globalMetersPerUnit() const
 {
     return m_projection->globalMetersPerUnit(m_datum->ellipsoid());
@@ -0,0 +1,99 @@
+#include "BlueMarbleMaps/CoordinateSystem/MercatorKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace BlueMarble;
+using namespace BlueMarble::MercatorKernels;
+
+InstructionSet MercatorKernels::bestInstructionSet()
+{
+    static const InstructionSet best = []()
+    {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+        __builtin_cpu_init();
+        if (Detail::avx2Compiled() && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            return InstructionSet::AVX2;
+        if (Detail::sse2Compiled() && __builtin_cpu_supports("sse2"))
+            return InstructionSet::SSE2;
+#endif
+        return InstructionSet::Scalar;
+    }();
+
+    return best;
+}
+
+const char* MercatorKernels::toString(InstructionSet instructionSet)
+{
+    switch (instructionSet)
+    {
+        case InstructionSet::Scalar: return "Scalar";
+        case InstructionSet::SSE2:   return "SSE2";
+        case InstructionSet::AVX2:   return "AVX2";
+    }
+
+    return "Unknown";
+}
+
+void MercatorKernels::project(double* x, double* y, size_t n, double radius)
+{
+    project(bestInstructionSet(), x, y, n, radius);
+}
+
+void MercatorKernels::unProject(double* x, double* y, size_t n, double radius)
+{
+    unProject(bestInstructionSet(), x, y, n, radius);
+}
+
+void MercatorKernels::project(InstructionSet instructionSet, double* x, double* y, size_t n, double radius)
+{
+    switch (instructionSet)
+    {
+        case InstructionSet::AVX2:
+            Detail::projectAvx2(x, y, n, radius);
+            break;
+        case InstructionSet::SSE2:
+            Detail::projectSse2(x, y, n, radius);
+            break;
+        default:
+            Detail::projectScalar(x, y, n, radius);
+            break;
+    }
+}
+
+void MercatorKernels::unProject(InstructionSet instructionSet, double* x, double* y, size_t n, double radius)
+{
+    switch (instructionSet)
+    {
+        case InstructionSet::AVX2:
+            Detail::unProjectAvx2(x, y, n, radius);
+            break;
+        case InstructionSet::SSE2:
+            Detail::unProjectSse2(x, y, n, radius);
+            break;
+        default:
+            Detail::unProjectScalar(x, y, n, radius);
+            break;
+    }
+}
+
+void Detail::projectScalar(double* x, double* y, size_t n, double radius)
+{
+    // Same as MercatorWebProjection::project()
+    for (size_t i(0); i<n; ++i)
+    {
+        double lat = std::clamp(y[i], -MaxLatitude, MaxLatitude);
+        x[i] = radius * x[i] * Pi / 180.0;
+        y[i] = radius * std::log(std::tan(Pi / 4.0 + (lat * Pi / 180.0) / 2.0));
+    }
+}
+
+void Detail::unProjectScalar(double* x, double* y, size_t n, double radius)
+{
+    // Same as MercatorWebProjection::unProject()
+    for (size_t i(0); i<n; ++i)
+    {
+        x[i] = x[i] / radius * 180.0 / Pi;
+        y[i] = (2.0 * std::atan(std::exp(y[i] / radius)) - Pi / 2.0) * 180.0 / Pi;
+    }
+}
@@ -0,0 +1,86 @@
+#include "BlueMarbleMaps/CoordinateSystem/MercatorKernels.h"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+using namespace BlueMarble::MercatorKernels;
+
+#if defined(__AVX2__) && defined(__FMA__)
+
+namespace
+{
+    // Vector type for the generic kernels in MercatorKernels.h
+    struct Avx2
+    {
+        using T = __m256d;
+        static constexpr size_t Width = 4;
+
+        static inline T set1(double v) { return _mm256_set1_pd(v); }
+        static inline T load(const double* p) { return _mm256_loadu_pd(p); }
+        static inline void store(double* p, T v) { _mm256_storeu_pd(p, v); }
+        static inline T add(T a, T b) { return _mm256_add_pd(a, b); }
+        static inline T sub(T a, T b) { return _mm256_sub_pd(a, b); }
+        static inline T mul(T a, T b) { return _mm256_mul_pd(a, b); }
+        static inline T div(T a, T b) { return _mm256_div_pd(a, b); }
+        static inline T fma(T a, T b, T c) { return _mm256_fmadd_pd(a, b, c); } // a*b + c
+        static inline T sqrt(T a) { return _mm256_sqrt_pd(a); }
+        static inline T min(T a, T b) { return _mm256_min_pd(a, b); }
+        static inline T max(T a, T b) { return _mm256_max_pd(a, b); }
+        static inline T cmpgt(T a, T b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+        static inline T select(T mask, T a, T b) { return _mm256_blendv_pd(b, a, mask); }
+
+        // 2^n for integral n
+        static inline T pow2(T n)
+        {
+            auto magic = _mm256_set1_pd(Detail::RoundMagic);
+            auto bits = _mm256_sub_epi64(_mm256_castpd_si256(_mm256_add_pd(n, magic)), _mm256_castpd_si256(magic));
+            return _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_add_epi64(bits, _mm256_set1_epi64x(1023)), 52));
+        }
+
+        // x = m*2^e, m in [1, 2). x has to be positive and normal.
+        static inline void frexp(T x, T& m, T& e)
+        {
+            auto bits = _mm256_castpd_si256(x);
+            auto twoPow52 = _mm256_set1_pd(4503599627370496.0);
+            auto biased = _mm256_or_si256(_mm256_srli_epi64(bits, 52), _mm256_castpd_si256(twoPow52));
+            e = _mm256_sub_pd(_mm256_sub_pd(_mm256_castsi256_pd(biased), twoPow52), _mm256_set1_pd(1023.0));
+            auto mantissa = _mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL));
+            m = _mm256_castsi256_pd(_mm256_or_si256(mantissa, _mm256_castpd_si256(_mm256_set1_pd(1.0))));
+        }
+    };
+}
+
+bool Detail::avx2Compiled()
+{
+    return true;
+}
+
+void Detail::projectAvx2(double* x, double* y, size_t n, double radius)
+{
+    forEachBlock<Avx2>(x, y, n, radius, projectBlock<Avx2>);
+}
+
+void Detail::unProjectAvx2(double* x, double* y, size_t n, double radius)
+{
+    forEachBlock<Avx2>(x, y, n, radius, unProjectBlock<Avx2>);
+}
+
+#else
+
+bool Detail::avx2Compiled()
+{
+    return false;
+}
+
+void Detail::projectAvx2(double* x, double* y, size_t n, double radius)
+{
+    projectScalar(x, y, n, radius);
+}
+
+void Detail::unProjectAvx2(double* x, double* y, size_t n, double radius)
+{
+    unProjectScalar(x, y, n, radius);
+}
+
+#endif
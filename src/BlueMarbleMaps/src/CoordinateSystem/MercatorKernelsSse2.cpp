@@ -0,0 +1,86 @@
+#include "BlueMarbleMaps/CoordinateSystem/MercatorKernels.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace BlueMarble::MercatorKernels;
+
+#if defined(__SSE2__)
+
+namespace
+{
+    // Vector type for the generic kernels in MercatorKernels.h
+    struct Sse2
+    {
+        using T = __m128d;
+        static constexpr size_t Width = 2;
+
+        static inline T set1(double v) { return _mm_set1_pd(v); }
+        static inline T load(const double* p) { return _mm_loadu_pd(p); }
+        static inline void store(double* p, T v) { _mm_storeu_pd(p, v); }
+        static inline T add(T a, T b) { return _mm_add_pd(a, b); }
+        static inline T sub(T a, T b) { return _mm_sub_pd(a, b); }
+        static inline T mul(T a, T b) { return _mm_mul_pd(a, b); }
+        static inline T div(T a, T b) { return _mm_div_pd(a, b); }
+        static inline T fma(T a, T b, T c) { return _mm_add_pd(_mm_mul_pd(a, b), c); } // a*b + c
+        static inline T sqrt(T a) { return _mm_sqrt_pd(a); }
+        static inline T min(T a, T b) { return _mm_min_pd(a, b); }
+        static inline T max(T a, T b) { return _mm_max_pd(a, b); }
+        static inline T cmpgt(T a, T b) { return _mm_cmpgt_pd(a, b); }
+        static inline T select(T mask, T a, T b) { return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b)); }
+
+        // 2^n for integral n
+        static inline T pow2(T n)
+        {
+            auto magic = _mm_set1_pd(Detail::RoundMagic);
+            auto bits = _mm_sub_epi64(_mm_castpd_si128(_mm_add_pd(n, magic)), _mm_castpd_si128(magic));
+            return _mm_castsi128_pd(_mm_slli_epi64(_mm_add_epi64(bits, _mm_set1_epi64x(1023)), 52));
+        }
+
+        // x = m*2^e, m in [1, 2). x has to be positive and normal.
+        static inline void frexp(T x, T& m, T& e)
+        {
+            auto bits = _mm_castpd_si128(x);
+            auto twoPow52 = _mm_set1_pd(4503599627370496.0);
+            auto biased = _mm_or_si128(_mm_srli_epi64(bits, 52), _mm_castpd_si128(twoPow52));
+            e = _mm_sub_pd(_mm_sub_pd(_mm_castsi128_pd(biased), twoPow52), _mm_set1_pd(1023.0));
+            auto mantissa = _mm_and_si128(bits, _mm_set1_epi64x(0x000FFFFFFFFFFFFFLL));
+            m = _mm_castsi128_pd(_mm_or_si128(mantissa, _mm_castpd_si128(_mm_set1_pd(1.0))));
+        }
+    };
+}
+
+bool Detail::sse2Compiled()
+{
+    return true;
+}
+
+void Detail::projectSse2(double* x, double* y, size_t n, double radius)
+{
+    forEachBlock<Sse2>(x, y, n, radius, projectBlock<Sse2>);
+}
+
+void Detail::unProjectSse2(double* x, double* y, size_t n, double radius)
+{
+    forEachBlock<Sse2>(x, y, n, radius, unProjectBlock<Sse2>);
+}
+
+#else
+
+bool Detail::sse2Compiled()
+{
+    return false;
+}
+
+void Detail::projectSse2(double* x, double* y, size_t n, double radius)
+{
+    projectScalar(x, y, n, radius);
+}
+
+void Detail::unProjectSse2(double* x, double* y, size_t n, double radius)
+{
+    unProjectScalar(x, y, n, radius);
+}
+
+#endif
@@ -1,4 +1,5 @@
 #include "BlueMarbleMaps/CoordinateSystem/Projection.h"
+#include "BlueMarbleMaps/CoordinateSystem/MercatorKernels.h"
 
 using namespace BlueMarble;
 
@@ -9,4 +10,34 @@ Projection::Projection()
 ProjectionPtr Projection::longLat()
 {
     return std::make_shared<LongLatProjection>();
-}
\ No newline at end of file
+}
+
+void Projection::projectMany(double* x, double* y, size_t n, const EllipsoidPtr& ellipsoid)
+{
+    for (size_t i(0); i<n; ++i)
+    {
+        auto p = project(Point(x[i], y[i]), ellipsoid);
+        x[i] = p.x();
+        y[i] = p.y();
+    }
+}
+
+void Projection::unProjectMany(double* x, double* y, size_t n, const EllipsoidPtr& ellipsoid)
+{
+    for (size_t i(0); i<n; ++i)
+    {
+        auto p = unProject(Point(x[i], y[i]), ellipsoid);
+        x[i] = p.x();
+        y[i] = p.y();
+    }
+}
+
+void MercatorWebProjection::projectMany(double* x, double* y, size_t n, const EllipsoidPtr& ellipsoid)
+{
+    MercatorKernels::project(x, y, n, ellipsoid->a());
+}
+
+void MercatorWebProjection::unProjectMany(double* x, double* y, size_t n, const EllipsoidPtr& ellipsoid)
+{
+    MercatorKernels::unProject(x, y, n, ellipsoid->a());
+}
@@ -0,0 +1,70 @@
+#include "BlueMarbleMaps/Core/Attributes.h"
+
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+using namespace BlueMarble;
+
+namespace
+{
+    struct KeyTable
+    {
+        KeyTable()
+            : mutex()
+            , ids()
+            , names()
+        {
+            // Id 0 is the empty key
+            ids.emplace("", 0);
+            names.emplace_back("");
+        }
+
+        std::shared_mutex                           mutex;
+        std::unordered_map<std::string, uint32_t>   ids;
+        std::deque<std::string>                     names; // Deque, such that references stay valid when growing
+    };
+
+    KeyTable& keyTable()
+    {
+        // Function local, such that keys can be interned during static initialization
+        static KeyTable table;
+        return table;
+    }
+}
+
+const std::string& AttributeKey::name() const
+{
+    auto& table = keyTable();
+    std::shared_lock lock(table.mutex);
+    return table.names[m_id];
+}
+
+size_t AttributeKey::count()
+{
+    auto& table = keyTable();
+    std::shared_lock lock(table.mutex);
+    return table.names.size();
+}
+
+uint32_t AttributeKey::intern(const std::string& name)
+{
+    auto& table = keyTable();
+    {
+        std::shared_lock lock(table.mutex);
+        auto it = table.ids.find(name);
+        if (it != table.ids.end())
+        {
+            return it->second;
+        }
+    }
+
+    std::unique_lock lock(table.mutex);
+    auto [it, inserted] = table.ids.try_emplace(name, (uint32_t)table.names.size());
+    if (inserted)
+    {
+        table.names.push_back(name);
+    }
+    return it->second;
+}
@@ -0,0 +1,273 @@
+#include "BlueMarbleMaps/Core/CoordinateBuffer.h"
+
+#include <algorithm>
+#include <limits>
+
+
+using namespace BlueMarble;
+
+CoordinateBuffer::CoordinateBuffer()
+    : m_x()
+    , m_y()
+    , m_z()
+    , m_partOffsets{0}
+    , m_hasZ(false)
+    , m_version(0)
+{
+}
+
+CoordinateBuffer::CoordinateBuffer(const std::vector<Point>& points)
+    : CoordinateBuffer()
+{
+    addPart(points);
+}
+
+CoordinateBuffer::CoordinateBuffer(CoordinateBuffer&& other)
+    : m_x(std::move(other.m_x))
+    , m_y(std::move(other.m_y))
+    , m_z(std::move(other.m_z))
+    , m_partOffsets(std::move(other.m_partOffsets))
+    , m_hasZ(other.m_hasZ)
+    , m_version(other.m_version)
+{
+    other.clear(); // Leave a valid, empty buffer
+}
+
+CoordinateBuffer& CoordinateBuffer::operator=(const CoordinateBuffer& other)
+{
+    if (this == &other)
+        return *this;
+
+    uint64_t version = std::max(m_version, other.m_version) + 1;
+    m_x = other.m_x;
+    m_y = other.m_y;
+    m_z = other.m_z;
+    m_partOffsets = other.m_partOffsets;
+    m_hasZ = other.m_hasZ;
+    m_version = version;
+
+    return *this;
+}
+
+CoordinateBuffer& CoordinateBuffer::operator=(CoordinateBuffer&& other)
+{
+    if (this == &other)
+        return *this;
+
+    uint64_t version = std::max(m_version, other.m_version) + 1;
+    m_x = std::move(other.m_x);
+    m_y = std::move(other.m_y);
+    m_z = std::move(other.m_z);
+    m_partOffsets = std::move(other.m_partOffsets);
+    m_hasZ = other.m_hasZ;
+    m_version = version;
+    other.clear();
+
+    return *this;
+}
+
+void CoordinateBuffer::setPoint(size_t index, const Point& point)
+{
+    assert(index < size());
+    ensureZ(point);
+
+    m_x[index] = point.x();
+    m_y[index] = point.y();
+    if (hasZ())
+    {
+        m_z[index] = point.z();
+    }
+    touch();
+}
+
+std::vector<Point> CoordinateBuffer::partPoints(size_t part) const
+{
+    std::vector<Point> points;
+    points.reserve(partSize(part));
+    for (size_t i=partBegin(part); i<partEnd(part); ++i)
+    {
+        points.push_back(point(i));
+    }
+
+    return points;
+}
+
+void CoordinateBuffer::addPart(const std::vector<Point>& points)
+{
+    m_partOffsets.push_back(size());
+    assignPart(partCount()-1, points);
+}
+
+void CoordinateBuffer::assignPart(size_t part, const std::vector<Point>& points)
+{
+    erasePoints(part, 0, partSize(part));
+
+    size_t begin = partBegin(part);
+    size_t n = points.size();
+    for (const auto& p : points)
+    {
+        ensureZ(p);
+    }
+
+    m_x.insert(m_x.begin() + begin, n, 0.0);
+    m_y.insert(m_y.begin() + begin, n, 0.0);
+    if (hasZ())
+    {
+        m_z.insert(m_z.begin() + begin, n, 0.0);
+    }
+
+    for (size_t i(0); i<n; ++i)
+    {
+        m_x[begin+i] = points[i].x();
+        m_y[begin+i] = points[i].y();
+        if (hasZ())
+        {
+            m_z[begin+i] = points[i].z();
+        }
+    }
+
+    for (size_t i=part+1; i<m_partOffsets.size(); ++i)
+    {
+        m_partOffsets[i] += n;
+    }
+    touch();
+}
+
+void CoordinateBuffer::removePart(size_t part)
+{
+    erasePoints(part, 0, partSize(part));
+    m_partOffsets.erase(m_partOffsets.begin() + part + 1);
+    touch();
+}
+
+void CoordinateBuffer::insertPoint(size_t part, size_t index, const Point& point)
+{
+    assert(index <= partSize(part));
+    ensureZ(point);
+
+    size_t i = partBegin(part) + index;
+    m_x.insert(m_x.begin() + i, point.x());
+    m_y.insert(m_y.begin() + i, point.y());
+    if (hasZ())
+    {
+        m_z.insert(m_z.begin() + i, point.z());
+    }
+
+    for (size_t p=part+1; p<m_partOffsets.size(); ++p)
+    {
+        ++m_partOffsets[p];
+    }
+    touch();
+}
+
+void CoordinateBuffer::erasePoints(size_t part, size_t first, size_t last)
+{
+    assert(first <= last && last <= partSize(part));
+    if (first == last)
+        return;
+
+    size_t begin = partBegin(part);
+    m_x.erase(m_x.begin() + begin + first, m_x.begin() + begin + last);
+    m_y.erase(m_y.begin() + begin + first, m_y.begin() + begin + last);
+    if (hasZ())
+    {
+        m_z.erase(m_z.begin() + begin + first, m_z.begin() + begin + last);
+    }
+
+    size_t n = last - first;
+    for (size_t p=part+1; p<m_partOffsets.size(); ++p)
+    {
+        m_partOffsets[p] -= n;
+    }
+    touch();
+}
+
+void CoordinateBuffer::clear()
+{
+    m_x.clear();
+    m_y.clear();
+    m_z.clear();
+    m_partOffsets.assign(1, 0);
+    m_hasZ = false;
+    touch();
+}
+
+void CoordinateBuffer::reserve(size_t nPoints)
+{
+    m_x.reserve(nPoints);
+    m_y.reserve(nPoints);
+    if (hasZ())
+    {
+        m_z.reserve(nPoints);
+    }
+}
+
+void CoordinateBuffer::move(const Point& delta)
+{
+    double dx = delta.x();
+    double dy = delta.y();
+    transform([dx, dy](double& x, double& y)
+    {
+        x += dx;
+        y += dy;
+    });
+
+    if (hasZ())
+    {
+        for (auto& z : m_z)
+        {
+            z += delta.z();
+        }
+    }
+}
+
+Rectangle CoordinateBuffer::bounds() const
+{
+    return rangeBounds(0, size());
+}
+
+Rectangle CoordinateBuffer::partBounds(size_t part) const
+{
+    return rangeBounds(partBegin(part), partEnd(part));
+}
+
+size_t CoordinateBuffer::memoryUsage() const
+{
+    return (m_x.capacity() + m_y.capacity() + m_z.capacity())*sizeof(double)
+         + m_partOffsets.capacity()*sizeof(size_t);
+}
+
+void CoordinateBuffer::ensureZ(const Point& point)
+{
+    if (point.z() != 0.0 && !m_hasZ)
+    {
+        // Zeros for the points so far, the point itself is inserted or set after
+        m_z.assign(size(), 0.0);
+        m_hasZ = true;
+    }
+}
+
+Rectangle CoordinateBuffer::rangeBounds(size_t begin, size_t end) const
+{
+    if (begin == end)
+    {
+        return Rectangle::undefined();
+    }
+
+    auto inf = std::numeric_limits<double>::infinity();
+    double xMin = inf;
+    double yMin = inf;
+    double xMax = -inf;
+    double yMax = -inf;
+    const double* x = m_x.data();
+    const double* y = m_y.data();
+    for (size_t i=begin; i<end; ++i)
+    {
+        xMin = std::min(xMin, x[i]);
+        xMax = std::max(xMax, x[i]);
+        yMin = std::min(yMin, y[i]);
+        yMax = std::max(yMax, y[i]);
+    }
+
+    return Rectangle(xMin, yMin, xMax, yMax);
+}
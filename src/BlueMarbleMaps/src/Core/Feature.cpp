@@ -1,4 +1,5 @@
 #include "BlueMarbleMaps/Core/Feature.h"
+#include "BlueMarbleMaps/Core/RasterWarp.h"
 
 
 using namespace BlueMarble;
@@ -59,32 +60,14 @@ void Feature::reProjectTo(const CrsPtr &crs)
 {
     if (geometryType() == GeometryType::Raster)
     {
-        auto rasterGeom = geometryAsRaster();
-        auto& currRaster = geometryAsRaster()->raster();
-
-        auto newBounds = this->crs()->projectTo(crs, bounds());
-
-        auto newRast = Raster(currRaster.width(), currRaster.height(), currRaster.channels());
-        RasterGeometryPtr newRaster = std::make_shared<RasterGeometry>(std::move(newRast), newBounds);
-
-        for (int i(0); i < currRaster.width(); ++i)
-        {
-            for (int j(0); j < currRaster.height(); ++j)
-            {
-                auto p = newRaster->rasterIndexToPoint(i,j);
-                auto pOld = crs->projectTo(m_crs, p);
-                auto ind = rasterGeom->pointToRasterIndex(pOld);
-                auto color = rasterGeom->raster().getColorAt(ind.x(), ind.y());
-                newRaster->raster().setColorAt(i,j, color);
-            }
-        }
-        m_geometry = newRaster;
+        m_geometry = RasterWarp::reProject(*geometryAsRaster(), m_crs, crs);
     }
     else
     {
-        m_geometry->forEachPoint([&](Point& p)
+        // Batch projection of the coordinate arrays
+        m_geometry->forEachCoordinateArray([&](double* x, double* y, size_t n)
         {
-            p = m_crs->projectTo(crs, p);
+            m_crs->projectTo(crs, x, y, n);
         });
     }
 
@@ -189,7 +172,7 @@ std::string BlueMarble::Feature::prettyString() const
     
     for (auto attr : m_attributes)
     {
-        s += "\t\t" + attr.first;
+        s += "\t\t" + attr.first.name();
         s += " : " + attributeToString(attr.second);
         s += "\n";
     }
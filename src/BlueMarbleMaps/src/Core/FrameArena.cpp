@@ -0,0 +1,40 @@
+#include "BlueMarbleMaps/Core/FrameArena.h"
+
+#include <algorithm>
+
+using namespace BlueMarble;
+
+namespace
+{
+    thread_local FrameArenaPtr s_currentArena;
+}
+
+FrameArena::FrameArena(size_t initialBlockSize)
+    : m_resource(std::max<size_t>(initialBlockSize, 1))
+    , m_allocationCount(0)
+    , m_bytesAllocated(0)
+{
+}
+
+void* FrameArena::allocate(size_t bytes, size_t alignment)
+{
+    ++m_allocationCount;
+    m_bytesAllocated += bytes;
+    return m_resource.allocate(bytes, alignment);
+}
+
+const FrameArenaPtr& FrameArena::current()
+{
+    return s_currentArena;
+}
+
+FrameArena::Scope::Scope(const FrameArenaPtr& arena)
+    : m_previous(s_currentArena)
+{
+    s_currentArena = arena;
+}
+
+FrameArena::Scope::~Scope()
+{
+    s_currentArena = m_previous;
+}
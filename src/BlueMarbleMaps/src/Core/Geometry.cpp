@@ -1,10 +1,23 @@
 #include "BlueMarbleMaps/Core/Geometry.h"
+#include "BlueMarbleMaps/Core/GeometryPredicates.h"
+#include "BlueMarbleMaps/Core/Triangulation.h"
 
+#include <cstring>
 
 using namespace BlueMarble;
 
+namespace
+{
+    inline uint64_t combineVersion(uint64_t version, uint64_t value)
+    {
+        return version ^ (value + 0x9e3779b97f4a7c15ULL + (version << 6) + (version >> 2));
+    }
+}
+
 Geometry::Geometry()
     : EngineObject()
+    , m_boundsCache()
+    , m_version(0)
 {
     
 }
@@ -20,35 +33,65 @@ PointGeometry::PointGeometry(const Point& point)
 {
 }
 
+void PointGeometry::forEachCoordinateArray(const std::function<void(double* x, double* y, size_t n)>& func)
+{
+    double x = m_point.x();
+    double y = m_point.y();
+    func(&x, &y, 1);
+    m_point = Point(x, y, m_point.z());
+    touch();
+}
+
+uint64_t PointGeometry::version() const
+{
+    // The point can be modified through point() unnoticed, the coordinates are part of the version
+    uint64_t version = Geometry::version();
+    for (double c : { m_point.x(), m_point.y(), m_point.z() })
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &c, sizeof(bits));
+        version = combineVersion(version, bits);
+    }
+
+    return version;
+}
+
 LineGeometry::LineGeometry()
     : Geometry()
-    , m_points()
+    , m_coordinates(std::vector<Point>())
     , m_isClosed(false)
 {
 }
 
 LineGeometry::LineGeometry(const std::vector<Point>& points)
     : Geometry()
-    , m_points(points)
+    , m_coordinates(points)
     , m_isClosed(false)
 {
 }
 
 BlueMarble::LineGeometry::LineGeometry(const Rectangle &rect)
     : Geometry()
-    , m_points(rect.corners())
+    , m_coordinates(rect.corners())
     , m_isClosed(true)
 {
 }
 
+Rectangle LineGeometry::calculateBounds()
+{
+    return m_boundsCache.get(version(), [this]() { return m_coordinates.bounds(); });
+}
+
 double LineGeometry::length() const
 {
+    const auto& x = m_coordinates.x();
+    const auto& y = m_coordinates.y();
     double length = 0.0;
-    for (int i(0); i < (int)(m_points.size()-1); ++i)
+    for (int i(0); i < (int)(m_coordinates.size()-1); ++i)
     {
-        const auto& p1 = m_points[i];
-        const auto& p2 = m_points[i+1];
-        length += (p2-p1).length();
+        double dx = x[i+1] - x[i];
+        double dy = y[i+1] - y[i];
+        length += std::sqrt(dx*dx + dy*dy);
     }
 
     return length;
@@ -56,40 +99,63 @@ double LineGeometry::length() const
 
 void LineGeometry::move(const Point& delta)
 {
-    Utils::movePoints(m_points, delta);
+    m_coordinates.move(delta);
 }
 
 void LineGeometry::moveTo(const Point& point)
 {
-    Utils::movePointsTo(m_points, point);
+    if (m_coordinates.empty())
+        return;
+
+    auto avgCenter = Utils::averageCenter(m_coordinates.partPoints(0));
+    m_coordinates.move(point - avgCenter);
 }
 
-PolygonGeometry::PolygonGeometry()
-    : Geometry()
-    , m_rings()
-    , m_cachedBounds([&] () { return Rectangle::fromPoints(outerRing());})
+bool LineGeometry::isInside(const Rectangle& bounds) const
 {
+    return GeometryPredicates::anyInside(bounds.xMin(), bounds.yMin(), bounds.xMax(), bounds.yMax(),
+                                         m_coordinates.x().data(), m_coordinates.y().data(), m_coordinates.size());
+}
+
+bool LineGeometry::isStrictlyInside(const Rectangle& bounds) const
+{
+    return GeometryPredicates::allInside(bounds.xMin(), bounds.yMin(), bounds.xMax(), bounds.yMax(),
+                                         m_coordinates.x().data(), m_coordinates.y().data(), m_coordinates.size());
+}
+
+void LineGeometry::forEachPoint(const std::function<void(Point&)>& func)
+{
+    for (size_t i(0); i<m_coordinates.size(); ++i)
+    {
+        Point p = m_coordinates.point(i);
+        func(p);
+        m_coordinates.setPoint(i, p);
+    }
 }
 
-PolygonGeometry::PolygonGeometry(const PolygonGeometry &other)
+PolygonGeometry::PolygonGeometry()
     : Geometry()
-    , m_rings(other.m_rings)
-    , m_cachedBounds([&] () { return Rectangle::fromPoints(outerRing());})
+    , m_coordinates()
+    , m_triangulationCache()
 {
 }
 
 PolygonGeometry::PolygonGeometry(const std::vector<Point>& ring)
     : Geometry()
-    , m_cachedBounds([&] () { return Rectangle::fromPoints(outerRing());})
+    , m_coordinates(ring)
+    , m_triangulationCache()
 {
-    m_rings.push_back(ring);
 }
 
 PolygonGeometry::PolygonGeometry(const std::vector<std::vector<Point>>& rings)
     : Geometry()
-    , m_rings(rings)
-    , m_cachedBounds([&] () { return Rectangle::fromPoints(outerRing());})
+    , m_coordinates()
+    , m_triangulationCache()
 {
+    for (const auto& ring : rings)
+    {
+        m_coordinates.addPart(ring);
+    }
 }
 
 PolygonGeometry::PolygonGeometry(const Rectangle& outerRect)
@@ -97,36 +163,94 @@ PolygonGeometry::PolygonGeometry(const Rectangle& outerRect)
 {
 }
 
-PolygonGeometry& PolygonGeometry::operator=(const PolygonGeometry& other)
+Rectangle BlueMarble::PolygonGeometry::calculateBounds()
 {
-    m_rings = other.m_rings;
-    m_cachedBounds = Utils::CachableVariable<Rectangle>([&] () { return Rectangle::fromPoints(outerRing());});
+    assert(m_coordinates.partCount() > 0);
+    return m_boundsCache.get(version(), [this]() { return m_coordinates.partBounds(0); });
+}
 
-    return *this;
+void PolygonGeometry::move(const Point &delta)
+{
+    m_coordinates.move(delta);
 }
 
-Rectangle BlueMarble::PolygonGeometry::calculateBounds()
+void PolygonGeometry::moveTo(const Point& point)
 {
-    //return m_cachedBounds.get(); // FIXME: this is quicker, but we need to ensure that we update it when the geometry changes
-    return Rectangle::fromPoints(outerRing()); //{  };
+    // Each ring is centered on the point
+    for (size_t i(0); i<m_coordinates.partCount(); ++i)
+    {
+        auto ring = m_coordinates.partPoints(i);
+        if (ring.empty())
+            continue;
+        Utils::movePointsTo(ring, point);
+        m_coordinates.assignPart(i, ring);
+    }
 }
 
-void PolygonGeometry::move(const Point &delta)
+bool PolygonGeometry::isInside(const Rectangle& bounds) const
 {
-    for (auto& ring : m_rings)
+    // TODO: if the bounds overlap with a polygon but in between nodes, this doesnt work
+    
+    const double* x = m_coordinates.x().data();
+    const double* y = m_coordinates.y().data();
+    auto partInside = [&](size_t part)
+    {
+        size_t begin = m_coordinates.partBegin(part);
+        return GeometryPredicates::anyInside(bounds.xMin(), bounds.yMin(), bounds.xMax(), bounds.yMax(), x + begin, y + begin, m_coordinates.partSize(part));
+    };
+    auto centerInsidePart = [&](size_t part)
+    {
+        size_t begin = m_coordinates.partBegin(part);
+        auto center = bounds.center();
+        return GeometryPredicates::pointInPolygon(center.x(), center.y(), x + begin, y + begin, m_coordinates.partSize(part));
+    };
+
+    // If any point on the outer ring is inside of the bounds
+    // this Polygon is inside the bounds
+    if (partInside(0))
+        return true;
+
+    // If the center of the bounds is not within the outer ring,
+    // this Polygon is can be inside the bounds since the above 
+    // was false.
+    if (!centerInsidePart(0))
+        return false;
+    
+    // Check whether the bounds are completely inside any of the inner rings.
+    // If it is, this Polygon is not inside the bounds
+    for (size_t i=1; i<m_coordinates.partCount(); i++)
     {
-        Utils::movePoints(ring, delta);
+        if (centerInsidePart(i) && !partInside(i))
+            return false;
     }
+
+    return true;
 }
 
-void PolygonGeometry::moveTo(const Point& point)
+bool PolygonGeometry::isStrictlyInside(const Rectangle& bounds) const
 {
-    for (auto& ring : m_rings)
+    return GeometryPredicates::allInside(bounds.xMin(), bounds.yMin(), bounds.xMax(), bounds.yMax(),
+                                         m_coordinates.x().data(), m_coordinates.y().data(), m_coordinates.partEnd(0));
+}
+
+void PolygonGeometry::forEachPoint(const std::function<void(Point&)>& func)
+{
+    for (size_t i(0); i<m_coordinates.size(); ++i)
     {
-        Utils::movePointsTo(ring, point);
+        Point p = m_coordinates.point(i);
+        func(p);
+        m_coordinates.setPoint(i, p);
     }
 }
 
+TriangulationCache::IndicesPtr PolygonGeometry::triangulation() const
+{
+    return m_triangulationCache.get(m_coordinates.version(), [this](TriangulationCache::Indices& indices)
+    {
+        Triangulation::triangulate(m_coordinates, indices);
+    });
+}
+
 RasterGeometry::RasterGeometry()
     : Geometry()
     , m_raster()
@@ -263,12 +387,29 @@ MultiPolygonGeometry::MultiPolygonGeometry(const std::vector<PolygonGeometry>& p
 {
 }
 
+Rectangle MultiPolygonGeometry::calculateBounds()
+{
+    return m_boundsCache.get(version(), [this]()
+    {
+        std::vector<Rectangle> boundsList;
+        boundsList.reserve(m_polygons.size());
+        for (auto& pol : m_polygons)
+        {
+            auto bounds = pol.calculateBounds();
+            if (!bounds.isUndefined())
+                boundsList.push_back(bounds);
+        }
+        return Rectangle::mergeBounds(boundsList);
+    });
+}
+
 void MultiPolygonGeometry::move(const Point& delta)
 {
     for (auto& pol : m_polygons)
     {
         pol.move(delta);
     }
+    touch();
 }
 
 void MultiPolygonGeometry::moveTo(const Point& point)
@@ -277,6 +418,38 @@ void MultiPolygonGeometry::moveTo(const Point& point)
     {
         pol.moveTo(point);
     }
+    touch();
+}
+
+void MultiPolygonGeometry::forEachPoint(const std::function<void(Point&)>& func)
+{
+    for (auto& pol : m_polygons)
+    {
+        pol.forEachPoint(func);
+    }
+    touch();
+}
+
+void MultiPolygonGeometry::forEachCoordinateArray(const std::function<void(double* x, double* y, size_t n)>& func)
+{
+    for (auto& pol : m_polygons)
+    {
+        pol.forEachCoordinateArray(func);
+    }
+    touch();
+}
+
+uint64_t MultiPolygonGeometry::version() const
+{
+    // Modifying a polygon increases its version (assigning one gives a newer version than both),
+    // adding or removing polygons changes the count
+    uint64_t version = combineVersion(Geometry::version(), m_polygons.size());
+    for (const auto& pol : m_polygons)
+    {
+        version = combineVersion(version, pol.version());
+    }
+
+    return version;
 }
 
 PointGeometryPtr polygonToPoint(PolygonGeometryPtr polygon)
@@ -300,3 +473,68 @@ MultiLineGeometry::MultiLineGeometry(const std::vector<LineGeometry>& lines)
 {
     
 }
+
+Rectangle MultiLineGeometry::calculateBounds()
+{
+    return m_boundsCache.get(version(), [this]()
+    {
+        std::vector<Rectangle> boundsList;
+        boundsList.reserve(m_lines.size());
+        for (auto& line : m_lines)
+        {
+            auto bounds = line.calculateBounds();
+            if (!bounds.isUndefined())
+                boundsList.push_back(bounds);
+        }
+        return Rectangle::mergeBounds(boundsList);
+    });
+}
+
+void MultiLineGeometry::move(const Point& delta)
+{
+    for (auto& line : m_lines)
+    {
+        line.move(delta);
+    }
+    touch();
+}
+
+void MultiLineGeometry::moveTo(const Point& point)
+{
+    for (auto& line : m_lines)
+    {
+        line.moveTo(point);
+    }
+    touch();
+}
+
+void MultiLineGeometry::forEachPoint(const std::function<void(Point&)>& func)
+{
+    for (auto& line : m_lines)
+    {
+        line.forEachPoint(func);
+    }
+    touch();
+}
+
+void MultiLineGeometry::forEachCoordinateArray(const std::function<void(double* x, double* y, size_t n)>& func)
+{
+    for (auto& line : m_lines)
+    {
+        line.forEachCoordinateArray(func);
+    }
+    touch();
+}
+
+uint64_t MultiLineGeometry::version() const
+{
+    // Modifying a line increases its version (assigning one gives a newer version than both),
+    // adding or removing lines changes the count
+    uint64_t version = combineVersion(Geometry::version(), m_lines.size());
+    for (const auto& line : m_lines)
+    {
+        version = combineVersion(version, line.version());
+    }
+
+    return version;
+}
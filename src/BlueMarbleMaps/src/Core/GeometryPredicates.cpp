@@ -0,0 +1,183 @@
+#include "BlueMarbleMaps/Core/GeometryPredicates.h"
+
+using namespace BlueMarble;
+using namespace BlueMarble::GeometryPredicates;
+
+namespace
+{
+    enum class InstructionSet
+    {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    InstructionSet bestInstructionSet()
+    {
+        static const InstructionSet best = []()
+        {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+            __builtin_cpu_init();
+            if (Detail::avx2Compiled() && __builtin_cpu_supports("avx2"))
+                return InstructionSet::AVX2;
+            if (Detail::sse2Compiled() && __builtin_cpu_supports("sse2"))
+                return InstructionSet::SSE2;
+#endif
+            return InstructionSet::Scalar;
+        }();
+
+        return best;
+    }
+}
+
+size_t GeometryPredicates::overlapping(double xMin, double yMin, double xMax, double yMax, const RectangleArrays& rectangles, std::vector<uint32_t>& outIndices)
+{
+    const double area[] = { xMin, yMin, xMax, yMax };
+    size_t n = rectangles.size();
+    size_t offset = outIndices.size();
+    outIndices.resize(offset + n);
+
+    size_t count;
+    switch (bestInstructionSet())
+    {
+        case InstructionSet::AVX2:
+            count = Detail::overlappingAvx2(area, rectangles.xMin.data(), rectangles.yMin.data(), rectangles.xMax.data(), rectangles.yMax.data(), n, outIndices.data() + offset);
+            break;
+        case InstructionSet::SSE2:
+            count = Detail::overlappingSse2(area, rectangles.xMin.data(), rectangles.yMin.data(), rectangles.xMax.data(), rectangles.yMax.data(), n, outIndices.data() + offset);
+            break;
+        default:
+            count = Detail::overlappingScalar(area, rectangles.xMin.data(), rectangles.yMin.data(), rectangles.xMax.data(), rectangles.yMax.data(), n, outIndices.data() + offset);
+            break;
+    }
+
+    outIndices.resize(offset + count);
+    return count;
+}
+
+bool GeometryPredicates::anyInside(double xMin, double yMin, double xMax, double yMax, const double* x, const double* y, size_t n)
+{
+    const double area[] = { xMin, yMin, xMax, yMax };
+    switch (bestInstructionSet())
+    {
+        case InstructionSet::AVX2: return Detail::firstInsideAvx2(area, x, y, n, true) < n;
+        case InstructionSet::SSE2: return Detail::firstInsideSse2(area, x, y, n, true) < n;
+        default:                   return Detail::firstInsideScalar(area, x, y, n, true) < n;
+    }
+}
+
+bool GeometryPredicates::allInside(double xMin, double yMin, double xMax, double yMax, const double* x, const double* y, size_t n)
+{
+    const double area[] = { xMin, yMin, xMax, yMax };
+    switch (bestInstructionSet())
+    {
+        case InstructionSet::AVX2: return Detail::firstInsideAvx2(area, x, y, n, false) == n;
+        case InstructionSet::SSE2: return Detail::firstInsideSse2(area, x, y, n, false) == n;
+        default:                   return Detail::firstInsideScalar(area, x, y, n, false) == n;
+    }
+}
+
+bool GeometryPredicates::pointInPolygon(double px, double py, const double* x, const double* y, size_t n)
+{
+    size_t crossings;
+    switch (bestInstructionSet())
+    {
+        case InstructionSet::AVX2: crossings = Detail::crossingsAvx2(px, py, x, y, n); break;
+        case InstructionSet::SSE2: crossings = Detail::crossingsSse2(px, py, x, y, n); break;
+        default:                   crossings = Detail::crossingsScalar(px, py, x, y, n); break;
+    }
+
+    return crossings % 2 == 1;
+}
+
+void GeometryPredicates::pointsInPolygon(const double* px, const double* py, size_t count, const double* x, const double* y, size_t n, uint8_t* outInside)
+{
+    for (size_t i(0); i<count; ++i)
+    {
+        outInside[i] = pointInPolygon(px[i], py[i], x, y, n) ? 1 : 0;
+    }
+}
+
+double GeometryPredicates::distanceToPolyline(double px, double py, const double* x, const double* y, size_t n)
+{
+    double distanceSquared;
+    switch (bestInstructionSet())
+    {
+        case InstructionSet::AVX2: distanceSquared = Detail::distanceSquaredAvx2(px, py, x, y, n); break;
+        case InstructionSet::SSE2: distanceSquared = Detail::distanceSquaredSse2(px, py, x, y, n); break;
+        default:                   distanceSquared = Detail::distanceSquaredScalar(px, py, x, y, n); break;
+    }
+
+    return std::sqrt(distanceSquared);
+}
+
+const char* GeometryPredicates::instructionSet()
+{
+    switch (bestInstructionSet())
+    {
+        case InstructionSet::AVX2: return "AVX2";
+        case InstructionSet::SSE2: return "SSE2";
+        default:                   return "Scalar";
+    }
+}
+
+size_t Detail::overlappingScalar(const double* area, const double* xMin, const double* yMin, const double* xMax, const double* yMax, size_t n, uint32_t* outIndices, uint32_t firstIndex)
+{
+    size_t count = 0;
+    for (size_t i(0); i<n; ++i)
+    {
+        if (xMin[i] <= area[2] && area[0] <= xMax[i] && yMin[i] <= area[3] && area[1] <= yMax[i])
+        {
+            outIndices[count++] = firstIndex + uint32_t(i);
+        }
+    }
+
+    return count;
+}
+
+size_t Detail::firstInsideScalar(const double* area, const double* x, const double* y, size_t n, bool inside)
+{
+    for (size_t i(0); i<n; ++i)
+    {
+        bool isInside = area[0] <= x[i] && x[i] <= area[2] && area[1] <= y[i] && y[i] <= area[3];
+        if (isInside == inside)
+        {
+            return i;
+        }
+    }
+
+    return n;
+}
+
+size_t Detail::crossingsScalar(double px, double py, const double* x, const double* y, size_t n)
+{
+    if (n < 3)
+    {
+        return 0;
+    }
+
+    size_t count = 0;
+    for (size_t i(0), j(n-1); i<n; j=i++)
+    {
+        count += crosses(px, py, x[j], y[j], x[i], y[i]) ? 1 : 0;
+    }
+
+    return count;
+}
+
+double Detail::distanceSquaredScalar(double px, double py, const double* x, const double* y, size_t n)
+{
+    if (n == 1)
+    {
+        return (px - x[0])*(px - x[0]) + (py - y[0])*(py - y[0]);
+    }
+
+    double minDistance = HUGE_VAL;
+    for (size_t i(0); i+1<n; ++i)
+    {
+        double d = segmentDistanceSquared(px, py, x[i], y[i], x[i+1], y[i+1]);
+        minDistance = d < minDistance ? d : minDistance;
+    }
+
+    return minDistance;
+}
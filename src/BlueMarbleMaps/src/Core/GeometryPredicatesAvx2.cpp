@@ -0,0 +1,89 @@
+#include "BlueMarbleMaps/Core/GeometryPredicates.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+using namespace BlueMarble::GeometryPredicates;
+
+#if defined(__AVX2__)
+
+namespace
+{
+    // Vector type for the generic kernels in GeometryPredicates.h
+    struct Avx2
+    {
+        using T = __m256d;
+        static constexpr size_t Width = 4;
+
+        static inline T set1(double v) { return _mm256_set1_pd(v); }
+        static inline T load(const double* p) { return _mm256_loadu_pd(p); }
+        static inline void store(double* p, T v) { _mm256_storeu_pd(p, v); }
+        static inline T add(T a, T b) { return _mm256_add_pd(a, b); }
+        static inline T sub(T a, T b) { return _mm256_sub_pd(a, b); }
+        static inline T mul(T a, T b) { return _mm256_mul_pd(a, b); }
+        static inline T div(T a, T b) { return _mm256_div_pd(a, b); }
+        static inline T min(T a, T b) { return _mm256_min_pd(a, b); }
+        static inline T max(T a, T b) { return _mm256_max_pd(a, b); } // b if a is nan
+        static inline T cmplt(T a, T b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+        static inline T cmple(T a, T b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+        static inline T cmpgt(T a, T b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+        static inline T and_(T a, T b) { return _mm256_and_pd(a, b); }
+        static inline T xor_(T a, T b) { return _mm256_xor_pd(a, b); }
+        static inline int movemask(T a) { return _mm256_movemask_pd(a); }
+    };
+}
+
+bool Detail::avx2Compiled()
+{
+    return true;
+}
+
+size_t Detail::overlappingAvx2(const double* area, const double* xMin, const double* yMin, const double* xMax, const double* yMax, size_t n, uint32_t* outIndices)
+{
+    return overlapping<Avx2>(area, xMin, yMin, xMax, yMax, n, outIndices);
+}
+
+size_t Detail::firstInsideAvx2(const double* area, const double* x, const double* y, size_t n, bool inside)
+{
+    return firstInside<Avx2>(area, x, y, n, inside);
+}
+
+size_t Detail::crossingsAvx2(double px, double py, const double* x, const double* y, size_t n)
+{
+    return crossings<Avx2>(px, py, x, y, n);
+}
+
+double Detail::distanceSquaredAvx2(double px, double py, const double* x, const double* y, size_t n)
+{
+    return distanceSquared<Avx2>(px, py, x, y, n);
+}
+
+#else
+
+bool Detail::avx2Compiled()
+{
+    return false;
+}
+
+size_t Detail::overlappingAvx2(const double* area, const double* xMin, const double* yMin, const double* xMax, const double* yMax, size_t n, uint32_t* outIndices)
+{
+    return overlappingScalar(area, xMin, yMin, xMax, yMax, n, outIndices);
+}
+
+size_t Detail::firstInsideAvx2(const double* area, const double* x, const double* y, size_t n, bool inside)
+{
+    return firstInsideScalar(area, x, y, n, inside);
+}
+
+size_t Detail::crossingsAvx2(double px, double py, const double* x, const double* y, size_t n)
+{
+    return crossingsScalar(px, py, x, y, n);
+}
+
+double Detail::distanceSquaredAvx2(double px, double py, const double* x, const double* y, size_t n)
+{
+    return distanceSquaredScalar(px, py, x, y, n);
+}
+
+#endif
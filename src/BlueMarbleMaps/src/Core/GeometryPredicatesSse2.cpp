@@ -0,0 +1,89 @@
+#include "BlueMarbleMaps/Core/GeometryPredicates.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace BlueMarble::GeometryPredicates;
+
+#if defined(__SSE2__)
+
+namespace
+{
+    // Vector type for the generic kernels in GeometryPredicates.h
+    struct Sse2
+    {
+        using T = __m128d;
+        static constexpr size_t Width = 2;
+
+        static inline T set1(double v) { return _mm_set1_pd(v); }
+        static inline T load(const double* p) { return _mm_loadu_pd(p); }
+        static inline void store(double* p, T v) { _mm_storeu_pd(p, v); }
+        static inline T add(T a, T b) { return _mm_add_pd(a, b); }
+        static inline T sub(T a, T b) { return _mm_sub_pd(a, b); }
+        static inline T mul(T a, T b) { return _mm_mul_pd(a, b); }
+        static inline T div(T a, T b) { return _mm_div_pd(a, b); }
+        static inline T min(T a, T b) { return _mm_min_pd(a, b); }
+        static inline T max(T a, T b) { return _mm_max_pd(a, b); } // b if a is nan
+        static inline T cmplt(T a, T b) { return _mm_cmplt_pd(a, b); }
+        static inline T cmple(T a, T b) { return _mm_cmple_pd(a, b); }
+        static inline T cmpgt(T a, T b) { return _mm_cmpgt_pd(a, b); }
+        static inline T and_(T a, T b) { return _mm_and_pd(a, b); }
+        static inline T xor_(T a, T b) { return _mm_xor_pd(a, b); }
+        static inline int movemask(T a) { return _mm_movemask_pd(a); }
+    };
+}
+
+bool Detail::sse2Compiled()
+{
+    return true;
+}
+
+size_t Detail::overlappingSse2(const double* area, const double* xMin, const double* yMin, const double* xMax, const double* yMax, size_t n, uint32_t* outIndices)
+{
+    return overlapping<Sse2>(area, xMin, yMin, xMax, yMax, n, outIndices);
+}
+
+size_t Detail::firstInsideSse2(const double* area, const double* x, const double* y, size_t n, bool inside)
+{
+    return firstInside<Sse2>(area, x, y, n, inside);
+}
+
+size_t Detail::crossingsSse2(double px, double py, const double* x, const double* y, size_t n)
+{
+    return crossings<Sse2>(px, py, x, y, n);
+}
+
+double Detail::distanceSquaredSse2(double px, double py, const double* x, const double* y, size_t n)
+{
+    return distanceSquared<Sse2>(px, py, x, y, n);
+}
+
+#else
+
+bool Detail::sse2Compiled()
+{
+    return false;
+}
+
+size_t Detail::overlappingSse2(const double* area, const double* xMin, const double* yMin, const double* xMax, const double* yMax, size_t n, uint32_t* outIndices)
+{
+    return overlappingScalar(area, xMin, yMin, xMax, yMax, n, outIndices);
+}
+
+size_t Detail::firstInsideSse2(const double* area, const double* x, const double* y, size_t n, bool inside)
+{
+    return firstInsideScalar(area, x, y, n, inside);
+}
+
+size_t Detail::crossingsSse2(double px, double py, const double* x, const double* y, size_t n)
+{
+    return crossingsScalar(px, py, x, y, n);
+}
+
+double Detail::distanceSquaredSse2(double px, double py, const double* x, const double* y, size_t n)
+{
+    return distanceSquaredScalar(px, py, x, y, n);
+}
+
+#endif
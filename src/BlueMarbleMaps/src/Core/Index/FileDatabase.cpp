@@ -111,16 +111,16 @@ JsonValue serializeAttributes(Attributes& attrs)
         switch (val.type())
         {
         case AttributeValueType::Boolean:
-            root[it.first] = JsonValue(val.getBoolean());
+            root[it.first.name()] = JsonValue(val.getBoolean());
             break;
         case AttributeValueType::Integer:
-            root[it.first] = JsonValue(val.getInteger());
+            root[it.first.name()] = JsonValue(val.getInteger());
             break;
         case AttributeValueType::Double:
-            root[it.first] = JsonValue(val.getDouble());
+            root[it.first.name()] = JsonValue(val.getDouble());
             break;
         case AttributeValueType::String:
-            root[it.first] = JsonValue(val.getString());
+            root[it.first.name()] = JsonValue(val.getString());
             break;
         default:
             std::cout << "serializeAttributes(Attributes& attrs) Inhandled attribute type: " << (int)val.type() << "\n";
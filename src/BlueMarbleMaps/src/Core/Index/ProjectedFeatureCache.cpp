@@ -0,0 +1,216 @@
+#include "BlueMarbleMaps/Core/Index/ProjectedFeatureCache.h"
+#include "BlueMarbleMaps/Core/FrameArena.h"
+
+using namespace BlueMarble;
+
+namespace
+{
+    size_t estimateMemoryUsage(const GeometryPtr& geometry)
+    {
+        switch (geometry->type())
+        {
+            case GeometryType::Point:
+                return sizeof(PointGeometry);
+            case GeometryType::Line:
+                return sizeof(LineGeometry) + std::static_pointer_cast<LineGeometry>(geometry)->coordinates().memoryUsage();
+            case GeometryType::Polygon:
+                return sizeof(PolygonGeometry) + std::static_pointer_cast<PolygonGeometry>(geometry)->coordinates().memoryUsage();
+            case GeometryType::MultiLine:
+            {
+                size_t bytes = sizeof(MultiLineGeometry);
+                const auto& multiLine = *std::static_pointer_cast<const MultiLineGeometry>(geometry);
+                for (const auto& line : multiLine.lines())
+                    bytes += sizeof(LineGeometry) + line.coordinates().memoryUsage();
+                return bytes;
+            }
+            case GeometryType::MultiPolygon:
+            {
+                size_t bytes = sizeof(MultiPolygonGeometry);
+                const auto& multiPolygon = *std::static_pointer_cast<const MultiPolygonGeometry>(geometry);
+                for (const auto& polygon : multiPolygon.polygons())
+                    bytes += sizeof(PolygonGeometry) + polygon.coordinates().memoryUsage();
+                return bytes;
+            }
+            case GeometryType::Raster:
+            {
+                auto& raster = std::static_pointer_cast<RasterGeometry>(geometry)->raster();
+                return sizeof(RasterGeometry) + (size_t)raster.width()*raster.height()*raster.channels();
+            }
+            default:
+                return sizeof(Geometry);
+        }
+    }
+}
+
+ProjectedFeatureCache::ProjectedFeatureCache(size_t maxBytes)
+    : m_mutex()
+    , m_entries()
+    , m_lookup()
+    , m_maxBytes(maxBytes)
+    , m_bytes(0)
+    , m_hits(0)
+    , m_misses(0)
+{
+}
+
+FeaturePtr ProjectedFeatureCache::projectTo(const CrsPtr& crs, const FeaturePtr& feature)
+{
+    if (auto projected = get(crs, feature))
+    {
+        return projected;
+    }
+
+    // The version is read before projecting, such that modifications made meanwhile invalidates the entry
+    const auto& source = feature->geometry();
+    uint64_t sourceVersion = source->version();
+    auto projected = feature->projectTo(crs)->get(0);
+
+    if (crs->id() != -1)
+    {
+        std::lock_guard lock(m_mutex);
+        insert(Key{ crs->id(), feature->id() }, source, sourceVersion, projected->geometry());
+    }
+
+    return projected;
+}
+
+FeaturePtr ProjectedFeatureCache::get(const CrsPtr& crs, const FeaturePtr& feature)
+{
+    if (crs->id() == -1)
+    {
+        return nullptr;
+    }
+
+    GeometryPtr geometry;
+    {
+        std::lock_guard lock(m_mutex);
+        geometry = find(Key{ crs->id(), feature->id() }, feature->geometry());
+        if (geometry)
+            ++m_hits;
+        else
+            ++m_misses;
+    }
+
+    if (!geometry)
+    {
+        return nullptr;
+    }
+
+    // Only the geometry is cached, the attributes are copied as when projecting
+    return makeTransient<Feature>(feature->id(), crs, geometry, feature->attributes());
+}
+
+void ProjectedFeatureCache::remove(const Id& id)
+{
+    std::lock_guard lock(m_mutex);
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+    {
+        auto next = std::next(it);
+        if (it->key.id == id)
+        {
+            erase(it);
+        }
+        it = next;
+    }
+}
+
+void ProjectedFeatureCache::clear()
+{
+    std::lock_guard lock(m_mutex);
+    m_entries.clear();
+    m_lookup.clear();
+    m_bytes = 0;
+}
+
+size_t ProjectedFeatureCache::maxBytes() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_maxBytes;
+}
+
+void ProjectedFeatureCache::maxBytes(size_t maxBytes)
+{
+    std::lock_guard lock(m_mutex);
+    m_maxBytes = maxBytes;
+    evict();
+}
+
+size_t ProjectedFeatureCache::memoryUsage() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_bytes;
+}
+
+size_t ProjectedFeatureCache::size() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_entries.size();
+}
+
+size_t ProjectedFeatureCache::hits() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_hits;
+}
+
+size_t ProjectedFeatureCache::misses() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_misses;
+}
+
+GeometryPtr ProjectedFeatureCache::find(const Key& key, const GeometryPtr& source)
+{
+    auto lookupIt = m_lookup.find(key);
+    if (lookupIt == m_lookup.end())
+    {
+        return nullptr;
+    }
+
+    auto it = lookupIt->second;
+    bool valid = it->source.lock() == source
+              && it->sourceVersion == source->version()
+              && it->projectedVersion == it->projected->version();
+    if (!valid)
+    {
+        erase(it);
+        return nullptr;
+    }
+
+    // Move to front, most recently used
+    m_entries.splice(m_entries.begin(), m_entries, it);
+
+    return it->projected;
+}
+
+void ProjectedFeatureCache::insert(const Key& key, const GeometryPtr& source, uint64_t sourceVersion, const GeometryPtr& projected)
+{
+    auto lookupIt = m_lookup.find(key);
+    if (lookupIt != m_lookup.end())
+    {
+        erase(lookupIt->second);
+    }
+
+    size_t bytes = estimateMemoryUsage(projected);
+    m_entries.push_front(Entry{ key, source, sourceVersion, projected, projected->version(), bytes });
+    m_lookup[key] = m_entries.begin();
+    m_bytes += bytes;
+
+    evict();
+}
+
+void ProjectedFeatureCache::erase(EntryList::iterator it)
+{
+    m_bytes -= it->bytes;
+    m_lookup.erase(it->key);
+    m_entries.erase(it);
+}
+
+void ProjectedFeatureCache::evict()
+{
+    // Keep the most recently used entry, even if larger than the limit
+    while (m_bytes > m_maxBytes && m_entries.size() > 1)
+    {
+        erase(std::prev(m_entries.end()));
+    }
+}
@@ -1,4 +1,5 @@
 #include "BlueMarbleMaps/Core/Index/QuadTreeIndex.h"
+#include "BlueMarbleMaps/Core/GeometryPredicates.h"
 #include "BlueMarbleMaps/System/File.h"
 #include "BlueMarbleMaps/Core/Serialization/Json/JsonValue.h"
 
@@ -16,6 +17,7 @@ class BlueMarble::QuadTreeNode
         inline QuadTreeNode(const Rectangle& bounds, int depth)
             : m_bounds(bounds)
             , m_entries()
+            , m_entryBounds()
             , m_children()
             , m_depth(depth)
         {
@@ -43,6 +45,7 @@ class BlueMarble::QuadTreeNode
         inline void add(const FeatureId& id, const Rectangle& bounds)
         {
             m_entries.emplace_back(Entry{id, bounds});
+            m_entryBounds.push_back(bounds.xMin(), bounds.yMin(), bounds.xMax(), bounds.yMax());
         }
 
         inline bool insert(const FeatureId& id, const Rectangle& bounds, int maxDepth)
@@ -64,7 +67,7 @@ class BlueMarble::QuadTreeNode
             }
 
             // No child bounds the entire feature, we add it!
-            m_entries.emplace_back(Entry{id, bounds});
+            add(id, bounds);
 
             if (m_entries.size() > MaxEntries && 
                 m_depth < maxDepth && 
@@ -89,6 +92,12 @@ class BlueMarble::QuadTreeNode
                     if (inserted) it = m_entries.erase(it);
                     else          it++;
                 }
+
+                m_entryBounds.clear();
+                for (const auto& e : m_entries)
+                {
+                    m_entryBounds.push_back(e.second.xMin(), e.second.yMin(), e.second.xMax(), e.second.yMax());
+                }
             }
             
             return true;
@@ -130,14 +139,13 @@ class BlueMarble::QuadTreeNode
                 return;
             }
 
-            for (const auto& e : m_entries)
+            // Batch overlap test of the entries, thread local to avoid allocating each query
+            thread_local std::vector<uint32_t> overlapping;
+            overlapping.clear();
+            GeometryPredicates::overlapping(bounds.xMin(), bounds.yMin(), bounds.xMax(), bounds.yMax(), m_entryBounds, overlapping);
+            for (uint32_t i : overlapping)
             {
-                // NOTE: if bounds are cached, this is faster.
-                // Otherwise probably slower
-                if (e.second.overlap(bounds))
-                {
-                    featureIds->add(e.first);
-                }
+                featureIds->add(m_entries[i].first);
             }
                 
             for (const auto& child : m_children)
@@ -149,6 +157,7 @@ class BlueMarble::QuadTreeNode
     private:
         Rectangle                  m_bounds;
         std::vector<Entry>         m_entries;
+        RectangleArrays            m_entryBounds; // Bounds of m_entries, for batch queries
         std::vector<QuadTreeNode>  m_children;
         int                        m_depth;
 };
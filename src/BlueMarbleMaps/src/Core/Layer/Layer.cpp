@@ -13,7 +13,9 @@ Layer::Layer()
     , m_maxScale(std::numeric_limits<double>::infinity())
     , m_minScale(0)
     , m_renderingEnabled(true)
-    , m_drawable(nullptr)
+    , m_renderCacheEnabled(false)
+    , m_dataVersion(0)
+    , m_renderCache()
 {
     
 }
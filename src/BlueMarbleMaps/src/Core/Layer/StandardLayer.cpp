@@ -1,4 +1,5 @@
 #include "BlueMarbleMaps/Core/Layer/StandardLayer.h"
+#include "BlueMarbleMaps/Core/FrameArena.h"
 #include "BlueMarbleMaps/Core/Map.h"
 
 #include <chrono>
@@ -7,6 +8,15 @@
 
 using namespace BlueMarble;
 
+namespace
+{
+    // When reading asynchronously, the whole view is queried again at least this often, picking up features
+    // in the interior of the view that the data sets changed without the layer being told
+    constexpr int64_t FullQueryIntervalMs = 2000;
+    // ...and when zoomed by more than this factor since, the data sets may return other features for the resolution
+    constexpr double FullQueryResolutionRatio = 1.5;
+}
+
 StandardLayer::StandardLayer(bool createDefaultVisualizerz)
     : Layer()
     , m_visualizers()
@@ -15,9 +25,17 @@ StandardLayer::StandardLayer(bool createDefaultVisualizerz)
     , m_effects()
     , m_dataSets()
     , m_cache(std::make_shared<FIFOCache>())
+    , m_projectedFeatures(std::make_shared<ProjectedFeatureCache>())
     , m_readAsync(false)
-    , m_queriedFeatures(std::make_shared<FeatureEnumerator>())
+    , m_query()
+    , m_queryCrs(nullptr)
+    , m_fullQueryTimeMs(0)
+    , m_fullQueryResolution(-1.0)
+    , m_fullQueryDataVersion(0)
     , m_threadPool() // TODO: make these parameters configurable
+    , m_visibleFeatures()
+    , m_pendingIds()
+    , m_queriedFeatures(std::make_shared<FeatureEnumerator>())
 {
     // TODO: remove, this is a temporary solution
     if (createDefaultVisualizerz)
@@ -38,6 +56,7 @@ void StandardLayer::asyncRead(bool async)
     else if (!m_readAsync && async)
     {
         m_threadPool.start(1, 1, System::ThreadPool::QueuePolicy::ReplaceOldestWhenFull);
+        m_queryCrs = nullptr; // The previous query is outdated
     }
 
     m_readAsync = async;
@@ -50,7 +69,8 @@ bool StandardLayer::asyncRead()
 
 void StandardLayer::addDataSet(const DataSetPtr &dataSet)
 {
-    return m_dataSets.push_back(dataSet);
+    m_dataSets.push_back(dataSet);
+    dataChanged();
 }
 
 void StandardLayer::hitTest(const MapPtr& map, const Rectangle& bounds, std::vector<PresentationObject>& presObjects)
@@ -132,44 +152,78 @@ void StandardLayer::hitTest(const MapPtr& map, const Rectangle& bounds, std::vec
 
 FeatureEnumeratorPtr StandardLayer::prepare(const CrsPtr &crs, const FeatureQuery& featureQuery)
 {
-    auto queriedFeatures = std::make_shared<FeatureEnumerator>();
+    auto queriedFeatures = makeTransient<FeatureEnumerator>();
     if (!isActiveForQuery(featureQuery))
     {
         return queriedFeatures;
     }
 
-    if (m_readAsync)
+    if (m_readAsync && featureQuery.partial())
     {
+        queriedFeatures = preparePartial(crs, featureQuery);
+    }
+    else if (m_readAsync)
+    {
+        // Only the parts of the view that were not covered by the previous query are queried from
+        // the data sets, such that the work of a small pan scales with the exposed area
+        const auto& area = featureQuery.area();
+        for (const auto& exposed : exposedAreas(crs, featureQuery))
         {
-            auto ids = getFeatureIds(crs, featureQuery);
-            auto cacheMissingIds = std::make_shared<IdCollection>();
+            auto exposedQuery = featureQuery;
+            exposedQuery.area(exposed);
+            auto ids = getFeatureIds(crs, exposedQuery);
+            for (const auto& id : *ids)
             {
-                std::lock_guard lock(m_mutex);
-                for (auto const& id : *ids)
+                if (m_visibleFeatures.find(id) == m_visibleFeatures.end())
                 {
-                    if (m_cache->contains(id))
-                    {
-                        queriedFeatures->add(m_cache->getFeature(id));
-                    }
-                    else
-                    {
-                        cacheMissingIds->add(id);
-                    }
+                    m_pendingIds.insert(id);
                 }
             }
+        }
+
+        // Drop features that are no longer in view
+        for (auto it = m_visibleFeatures.begin(); it != m_visibleFeatures.end();)
+        {
+            if (!it->second->bounds().overlap(area))
+                it = m_visibleFeatures.erase(it);
+            else
+                ++it;
+        }
 
-            m_threadPool.enqueue([this, crs, featureQuery, cacheMissingIds]()
+        auto cacheMissingIds = std::make_shared<IdCollection>();
+        {
+            std::lock_guard lock(m_mutex);
+            for (auto it = m_pendingIds.begin(); it != m_pendingIds.end();)
             {
-                auto features = getFeatures(crs, cacheMissingIds);
-                // std::this_thread::sleep_for(std::chrono::milliseconds(1000)); // Faking load
+                if (m_cache->contains(*it))
                 {
-                    std::lock_guard lock(m_mutex);
-                    for (const auto& f : *features)
+                    const auto& f = m_cache->getFeature(*it);
+                    if (f->bounds().overlap(area))
                     {
-                        m_cache->insert(f->id(), f);
+                        m_visibleFeatures[*it] = f;
                     }
+                    it = m_pendingIds.erase(it);
                 }
-            });
+                else
+                {
+                    cacheMissingIds->add(*it);
+                    ++it;
+                }
+            }
+        }
+
+        if (!cacheMissingIds->empty())
+        {
+            queriedFeatures = makeTransient<FeatureEnumerator>(false); // Still loading
+        }
+        for (const auto& [id, f] : m_visibleFeatures)
+        {
+            queriedFeatures->add(f);
+        }
+
+        if (!cacheMissingIds->empty())
+        {
+            readAsync(crs, cacheMissingIds);
         }
     }
     else
@@ -250,8 +304,8 @@ void StandardLayer::update(const MapPtr& map, const FeatureEnumeratorPtr& featur
 
 FeatureEnumeratorPtr StandardLayer::getFeatures(const CrsPtr& crs, const FeatureQuery& featureQuery, bool activeLayersOnly)
 {
-    auto features = std::make_shared<FeatureCollection>();
-    auto enumerator = std::make_shared<FeatureEnumerator>();
+    auto features = makeTransient<FeatureCollection>();
+    auto enumerator = makeTransient<FeatureEnumerator>();
     enumerator->setFeatures(features);
     if (activeLayersOnly && !isActiveForQuery(featureQuery))
     {
@@ -278,9 +332,8 @@ FeatureEnumeratorPtr StandardLayer::getFeatures(const CrsPtr& crs, const Feature
             // BMM_DEBUG() << "Reprojecting features!\n";
             while (dataSetFeatures->moveNext())
             {
-                auto f = dataSetFeatures->current();
-                auto newFeatures = f->projectTo(crs);
-                features->addRange(*newFeatures);
+                const auto& f = dataSetFeatures->current();
+                features->add(m_projectedFeatures->projectTo(crs, f));
             }
             dataSetFeatures->reset();
         }
@@ -299,6 +352,10 @@ void StandardLayer::flushCache()
         std::unique_lock lock(m_mutex);
         m_cache->clear();
     }
+    m_projectedFeatures->clear();
+
+    // Forces the next query to read the whole view
+    m_queryCrs = nullptr;
     
     for (const auto& d : m_dataSets)
     {
@@ -306,6 +363,100 @@ void StandardLayer::flushCache()
     }
 }
 
+FeatureEnumeratorPtr StandardLayer::preparePartial(const CrsPtr& crs, const FeatureQuery& featureQuery)
+{
+    const auto& area = featureQuery.area();
+    auto ids = getFeatureIds(crs, featureQuery);
+    auto cacheMissingIds = std::make_shared<IdCollection>();
+    std::vector<FeaturePtr> features;
+    {
+        std::lock_guard lock(m_mutex);
+        for (const auto& id : *ids)
+        {
+            if (!m_cache->contains(id))
+            {
+                cacheMissingIds->add(id);
+                continue;
+            }
+            const auto& f = m_cache->getFeature(id);
+            if (f->bounds().overlap(area))
+            {
+                features.push_back(f);
+            }
+        }
+    }
+
+    auto queriedFeatures = makeTransient<FeatureEnumerator>(cacheMissingIds->empty());
+    for (const auto& f : features)
+    {
+        queriedFeatures->add(f);
+    }
+    if (!cacheMissingIds->empty())
+    {
+        readAsync(crs, cacheMissingIds);
+    }
+
+    return queriedFeatures;
+}
+
+void StandardLayer::readAsync(const CrsPtr& crs, const IdCollectionPtr& ids)
+{
+    m_threadPool.enqueue([this, crs, ids]()
+    {
+        auto features = getFeatures(crs, ids);
+        // std::this_thread::sleep_for(std::chrono::milliseconds(1000)); // Faking load
+        {
+            std::lock_guard lock(m_mutex);
+            for (const auto& f : *features)
+            {
+                m_cache->insert(f->id(), f);
+            }
+        }
+    });
+}
+
+std::vector<Rectangle> StandardLayer::exposedAreas(const CrsPtr& crs, const FeatureQuery& featureQuery)
+{
+    const auto& area = featureQuery.area();
+    auto timeStampMs = getTimeStampMs();
+    double resolutionRatio = (featureQuery.resolution() > 0.0 && m_fullQueryResolution > 0.0)
+                           ? featureQuery.resolution()/m_fullQueryResolution : 1.0;
+    bool fullQuery = !m_queryCrs || !crs->isFunctionallyEquivalent(m_queryCrs)
+                  || m_fullQueryDataVersion != dataVersion()
+                  || timeStampMs - m_fullQueryTimeMs >= FullQueryIntervalMs
+                  || resolutionRatio > FullQueryResolutionRatio || resolutionRatio < 1.0/FullQueryResolutionRatio;
+    
+    std::vector<Rectangle> exposed;
+    if (!fullQuery)
+    {
+        exposed = area.subtract(m_query.area());
+        
+        // When most of the view is new (e.g. a jump or zooming out), a single query over the whole
+        // view is cheaper than several strips. It also picks up changes in the data sets.
+        double exposedArea = 0.0;
+        for (const auto& r : exposed)
+        {
+            exposedArea += r.width()*r.height();
+        }
+        fullQuery = exposedArea > 0.5*area.width()*area.height();
+    }
+
+    m_query = featureQuery;
+    m_queryCrs = crs;
+
+    if (fullQuery)
+    {
+        m_fullQueryTimeMs = timeStampMs;
+        m_fullQueryResolution = featureQuery.resolution();
+        m_fullQueryDataVersion = dataVersion();
+        m_visibleFeatures.clear();
+        m_pendingIds.clear();
+        return { area };
+    }
+
+    return exposed;
+}
+
 IdCollectionPtr StandardLayer::getFeatureIds(const CrsPtr& crs, const FeatureQuery& featureQuery)
 {
     auto ids = std::make_shared<IdCollection>();
@@ -332,8 +483,7 @@ FeatureCollectionPtr StandardLayer::getFeatures(const CrsPtr &crs, const IdColle
             // BMM_DEBUG() << "Reprojecting features!\n";
             for (const auto& f : *dataSetFeatures)
             {
-                auto newFeatures = f->projectTo(crs);
-                features->addRange(*newFeatures);
+                features->add(m_projectedFeatures->projectTo(crs, f));
             }
         }
         else
@@ -373,30 +523,13 @@ void StandardLayer::createDefaultVisualizers()
     };
 
     // Standard visualizers
-    auto colorEval = [](FeaturePtr f, Attributes&)
-    {
-        int r=0, g=0, b=255;
-        double a=0.1;
-
-        if (f->attributes().contains("COLOR_R"))
-        {
-            r = f->attributes().get<int>("COLOR_R");
-        }
-        if (f->attributes().contains("COLOR_G"))
-        {
-            g = f->attributes().get<int>("COLOR_G");
-        }
-        if (f->attributes().contains("COLOR_B"))
-        {
-            b = f->attributes().get<int>("COLOR_B");
-        }
-        if (f->attributes().contains("COLOR_A"))
-        {
-            a = f->attributes().get<double>("COLOR_A");
-        }
-
-        return Color(r,g,b,a);
-    };
+    // Compiled once, the attribute keys are resolved at compile time
+    ColorStyleExpression colorEval(
+        StyleExpression::attribute("COLOR_R", 0),
+        StyleExpression::attribute("COLOR_G", 0),
+        StyleExpression::attribute("COLOR_B", 255),
+        StyleExpression::attribute("COLOR_A", 0.1)
+    );
 
     ColorEvaluation colorEvalHover = [colorEval, animatedDouble](FeaturePtr f, Attributes& updateAttributes) -> Color
     {
@@ -453,12 +586,12 @@ void StandardLayer::createDefaultVisualizers()
     textVis->text(
         [](FeaturePtr f, auto) 
         { 
-            if(f->attributes().contains("NAME"))
-                return f->attributes().get<std::string>("NAME");
-            else if(f->attributes().contains("name"))
-                return f->attributes().get<std::string>("name");
-            else if(f->attributes().contains("CONTINENT"))
-                return f->attributes().get<std::string>("CONTINENT");
+            static const AttributeKey TextKeys[] = { "NAME", "name", "CONTINENT" };
+            for (const auto& key : TextKeys)
+            {
+                if (auto value = f->attributes().find(key))
+                    return std::get<std::string>(*value);
+            }
             return std::string();
         }
     );
@@ -5,14 +5,21 @@
 
 using namespace BlueMarble;
 
+// Defaults, configurable through the TileLayer setters
 #define TILELAYER_TILE_SIZE 512
 #define TILELAYER_NUM_WORKERS std::thread::hardware_concurrency()
 #define TILELAYER_QUEUE_SIZE 4
 #define TILELAYER_QUEUE_POLICY System::ThreadPool::QueuePolicy::ReplaceOldestWhenFull
-
-TileManager::TileManager(const Rectangle& fullExtent)
-    : m_tilingScheme(fullExtent)
+#define TILELAYER_MIN_ZOOM 0
+#define TILELAYER_MAX_ZOOM 20
+#define TILELAYER_SUBSTITUTE_DESCENDANT_DEPTH 2
+#define TILELAYER_MAX_LOAD_ATTEMPTS 5
+#define TILELAYER_RETRY_DELAY_MS 250
+
+TileManager::TileManager(const Rectangle& fullExtent, int minZoom, int maxZoom)
+    : m_tilingScheme(fullExtent, minZoom, maxZoom)
     , m_tileCache()
+    , m_failedLoads()
 {
 }
 
@@ -113,6 +120,48 @@ void TileManager::markTileDirty(const Tile &tile)
     //     BMM_DEBUG() << "TileManager::markTileDirty Invalid tile!!!" << tile.toString() << "\n";
     // }
     m_tileCache.at(tile.id()).features = nullptr;
+    m_tileCache.at(tile.id()).guests = nullptr;
+}
+
+void TileManager::tileLoadFailed(const Tile& tile, int64_t timeStampMs)
+{
+    auto& failed = m_failedLoads.try_emplace(tile.id(), FailedLoads{0, 0}).first->second;
+    ++failed.count;
+    failed.lastTimeStampMs = timeStampMs;
+}
+
+bool TileManager::isTileLoadDelayed(const Tile& tile, int64_t timeStampMs) const
+{
+    auto it = m_failedLoads.find(tile.id());
+    if (it == m_failedLoads.end())
+    {
+        return false;
+    }
+    int64_t delayMs = (int64_t)TILELAYER_RETRY_DELAY_MS << std::min(it->second.count - 1, 16);
+    return timeStampMs - it->second.lastTimeStampMs < delayMs;
+}
+
+bool TileManager::hasFailedTile(const Tile& tile) const
+{
+    auto it = m_failedLoads.find(tile.id());
+    return it != m_failedLoads.end() && it->second.count >= TILELAYER_MAX_LOAD_ATTEMPTS;
+}
+
+int TileManager::loadedTileCount() const
+{
+    int count = 0;
+    for (const auto& [id, tile] : m_tileCache)
+    {
+        if (tile.isLoaded())
+            ++count;
+    }
+
+    return count;
+}
+
+int TileManager::loadingTileCount() const
+{
+    return (int)m_tileCache.size() - loadedTileCount();
 }
 
 void TileManager::removeTile(const Tile &tile)
@@ -130,11 +179,15 @@ TileLayer::TileLayer()
     , m_tileManager(nullptr)
     , m_readAsync(true)
     , m_tileSize(TILELAYER_TILE_SIZE)
+    , m_zoomRange{TILELAYER_MIN_ZOOM, TILELAYER_MAX_ZOOM}
+    , m_numWorkers(TILELAYER_NUM_WORKERS)
+    , m_queueSize(TILELAYER_QUEUE_SIZE)
+    , m_queuePolicy(TILELAYER_QUEUE_POLICY)
+    , m_subLayerZoomRanges()
 {
     if (m_readAsync)
     {
-        // TODO: make these parameters configurable
-        m_threadPool.start(TILELAYER_NUM_WORKERS, TILELAYER_QUEUE_SIZE, TILELAYER_QUEUE_POLICY);
+        m_threadPool.start(m_numWorkers, m_queueSize, m_queuePolicy);
         
         // TODO: add pruning of cache to prevent memory explosion
         // m_threadPool.enqueue([this]{
@@ -145,19 +198,116 @@ TileLayer::TileLayer()
 
 void TileLayer::asyncRead(bool async)
 {
-    // TODO: must add parameters for thread pool
     if (m_readAsync && !async)
     {
         m_threadPool.stop();
     }
     else if (!m_readAsync && async)
     {
-        m_threadPool.start(TILELAYER_NUM_WORKERS, TILELAYER_QUEUE_SIZE, TILELAYER_QUEUE_POLICY);
+        m_threadPool.start(m_numWorkers, m_queueSize, m_queuePolicy);
     }
 
     m_readAsync = async;
 }
 
+void TileLayer::tileSize(int tileSize)
+{
+    if (tileSize <= 0)
+    {
+        throw std::runtime_error("TileLayer::tileSize() Tile size must be greater than 0");
+    }
+
+    if (tileSize == m_tileSize)
+        return;
+
+    m_tileSize = tileSize;
+    resetTiles();
+}
+
+void TileLayer::zoomRange(int minZoom, int maxZoom)
+{
+    if (minZoom < 0 || minZoom > maxZoom || maxZoom > Tile::MaxZoom)
+    {
+        throw std::runtime_error("TileLayer::zoomRange() Invalid zoom range");
+    }
+
+    if (minZoom == m_zoomRange.minZoom && maxZoom == m_zoomRange.maxZoom)
+        return;
+
+    m_zoomRange = ZoomRange{minZoom, maxZoom};
+    resetTiles();
+}
+
+void TileLayer::numWorkers(size_t numWorkers)
+{
+    if (numWorkers == 0)
+    {
+        throw std::runtime_error("TileLayer::numWorkers() Number of workers must be greater than 0");
+    }
+
+    m_numWorkers = numWorkers;
+    restartThreadPool();
+}
+
+void TileLayer::queueSize(size_t queueSize)
+{
+    if (queueSize == 0)
+    {
+        throw std::runtime_error("TileLayer::queueSize() Queue size must be greater than 0");
+    }
+
+    m_queueSize = queueSize;
+    restartThreadPool();
+}
+
+void TileLayer::queuePolicy(System::ThreadPool::QueuePolicy queuePolicy)
+{
+    if (queuePolicy == System::ThreadPool::QueuePolicy::BlockWhenFull)
+    {
+        // Tile loads are enqueued while holding m_mutex, which the workers need to store their tiles
+        throw std::runtime_error("TileLayer::queuePolicy() BlockWhenFull is not supported");
+    }
+
+    m_queuePolicy = queuePolicy;
+    restartThreadPool();
+}
+
+void TileLayer::subLayerZoomRange(const LayerPtr& layer, int minZoom, int maxZoom)
+{
+    if (minZoom < 0 || minZoom > maxZoom)
+    {
+        throw std::runtime_error("TileLayer::subLayerZoomRange() Invalid zoom range");
+    }
+
+    m_subLayerZoomRanges[layer] = ZoomRange{minZoom, maxZoom};
+    
+    // Tiles already loaded may contain features of the layer at the wrong zoom levels
+    resetTiles();
+}
+
+TileLayer::ZoomRange TileLayer::subLayerZoomRange(const LayerPtr& layer) const
+{
+    auto it = m_subLayerZoomRanges.find(layer);
+    if (it == m_subLayerZoomRanges.end())
+    {
+        return ZoomRange{0, Tile::MaxZoom};
+    }
+
+    return it->second;
+}
+
+int TileLayer::loadedTileCount() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_tileManager ? m_tileManager->loadedTileCount() : 0;
+}
+
+int TileLayer::loadingTileCount() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_tileManager ? m_tileManager->loadingTileCount() : 0;
+}
+
 FeatureEnumeratorPtr TileLayer::prepare(const CrsPtr &crs, const FeatureQuery &featureQuery)
 {
     if (!isActiveForQuery(featureQuery))
@@ -167,7 +317,7 @@ FeatureEnumeratorPtr TileLayer::prepare(const CrsPtr &crs, const FeatureQuery &f
 
     if (!m_tileManager)
     {
-        m_tileManager = std::make_unique<TileManager>(crs->bounds());
+        m_tileManager = std::make_unique<TileManager>(crs->bounds(), m_zoomRange.minZoom, m_zoomRange.maxZoom);
         verifyValidSubLayers();
     }
 
@@ -176,14 +326,11 @@ FeatureEnumeratorPtr TileLayer::prepare(const CrsPtr &crs, const FeatureQuery &f
         return LayerSet::prepare(crs, featureQuery);
     }
     
-    int tileSize = m_tileSize;
-    double zoom0Resolution = crs->bounds().width() / (double)tileSize;
-    double unitsPerPixel = Drawable::pixelSize() / crs->globalMetersPerUnit() / featureQuery.scale();
-    int zoom = static_cast<int>(std::floor(std::log2(zoom0Resolution/unitsPerPixel)));
-    zoom = std::clamp(zoom, 0, 20); // TODO: make these parameters configurable
-    unitsPerPixel = zoom0Resolution / std::pow(2.0, zoom); // clamp unitsperpix
+    int zoom = zoomForScale(crs, featureQuery.scale());
+    double zoom0Resolution = crs->bounds().width() / (double)m_tileSize;
+    double unitsPerPixel = zoom0Resolution / std::pow(2.0, zoom); // clamp unitsperpix
     
-    double clampedScale = Drawable::pixelSize() / crs->globalMetersPerUnit() / (zoom0Resolution / std::pow(2.0, zoom));
+    double clampedScale = Drawable::pixelSize() / crs->globalMetersPerUnit() / unitsPerPixel;
 
     // BMM_DEBUG() << "TileLayer::prepare() Units per pixel: " << unitsPerPixel << ", Zoom level: " << zoom << "\n";
 
@@ -199,77 +346,151 @@ FeatureEnumeratorPtr TileLayer::prepare(const CrsPtr &crs, const FeatureQuery &f
         enumerator->addEnumerator(std::make_shared<FeatureEnumerator>());   
     }
 
-    std::unordered_map<Id, bool, Id::IdHash> featuresAdded; // Used to avoid adding the same feature multiple times if it appears in multiple tiles
+    // The lock is only held to schedule the loads and to pick the tiles to render, whose enumerators are
+    // taken from the cache. The feature collections are shared as is, only the guest features of a tile
+    // needs to be deduplicated (see isHomeTile()), which is done after releasing the lock.
+    std::unordered_set<TileId> tilesAdded;
+    std::vector<Tile> renderTiles;
+
+    struct TileLoad
+    {
+        Tile tile;
+        bool hasSubstitute;
+        double coverage;
+        double distance;
+    };
+    std::vector<TileLoad> tileLoads;
+    bool allTilesLoaded = true;
+    auto timeStampMs = getTimeStampMs();
     
-    std::lock_guard lock(m_mutex);
-    for (Tile& tile : tiles)
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (const Tile& tile : tiles)
     {
-        if (!m_tileManager->hasTile(tile))
+        if (m_tileManager->hasLoadedTile(tile))
         {
-            // If the tile is not in the cache, we need to load it asynchronously
-            auto tileQuery = featureQuery;
-            tileQuery.area(m_tileManager->tileBounds(tile.x, tile.y, tile.zoom));
-            tileQuery.scale(clampedScale);
-
-            // TODO: Needs debugging together with ImageDataSet::onGetFeatures()
-            // Its needed when crs differ, but seems slower if theyre not.
-            // For datasets that dont have the same crs as requested, its unnecessary to do "clone"
-            // when reqprojecting since we get a copy anyway.
-            tileQuery.rasterGeometryMode(FeatureQuery::RasterGeometryMode::Clipped);
-            tileQuery.resolution(unitsPerPixel);
-
-            scheduleTileLoad(tile, crs, tileQuery);
+            renderTiles.push_back(tile);
+            continue;
         }
 
-        if (!m_tileManager->hasLoadedTile(tile))
+        bool hasSubstitute = substituteTile(tile, renderTiles);
+        if (m_tileManager->hasFailedTile(tile))
         {
-            // Almost working
-            Tile parent = tile;
-            while (m_tileManager->parentOf(parent, parent))
-            {
-                if (m_tileManager->hasLoadedTile(parent))
-                {
-                    // BMM_DEBUG() << "Found PARENT of " << tile.toString() << ": " << parent.toString() << "\n";
-                    tile = parent;
-                    break;
-                }
-            }
+            continue; // Given up on, the substitute is shown without waiting for the tile
         }
+        allTilesLoaded = false;
 
-        if (m_tileManager->hasLoadedTile(tile))
+        if (!m_tileManager->hasTile(tile) && !m_tileManager->isTileLoadDelayed(tile, timeStampMs))
         {
-            // If the tile is in the cache, we can add its features to the enumerator
-            
-            auto cachedTile = m_tileManager->getCachedTile(tile);
-            if (cachedTile.features)
-            {   
-                // BMM_DEBUG() << "Preparing tile: " << tile.toString() << "\n";
-                cachedTile.features->reset();
-
-                // TODO optimize
-                int n = cachedTile.features->subEnumerators().size();
-                for (int i(0); i<n; ++i)
-                {
-                    while (cachedTile.features->subEnumerators()[i]->moveNext())
-                    {
-                        const auto& f = cachedTile.features->subEnumerators()[i]->current();
-                        if (featuresAdded.find(f->id()) == featuresAdded.end())
-                        {
-                            enumerator->subEnumerators()[i]->add(f);
-                            
-                            // featuresAdded[f->id()] = true;
-                            if (f->geometryType() != GeometryType::Raster)
-                            {
-                                featuresAdded[f->id()] = true;
-                            }
-                        }
-                    }
-                    cachedTile.features->subEnumerators()[i]->reset();
-                }
+            // The tile is not in the cache, we need to load it asynchronously
+            auto tileBounds = m_tileManager->tileBounds(tile.x, tile.y, tile.zoom);
+            auto visible = tileBounds.intersect(featureQuery.area());
+            double coverage = visible.isUndefined() ? 0.0 : visible.width()*visible.height();
+            double distance = (tileBounds.center() - featureQuery.area().center()).length();
+            tileLoads.push_back(TileLoad{tile, hasSubstitute, coverage, distance});
+        }
+    }
 
-                cachedTile.features->reset();
-            }
+    // Load tiles without anything to show first, then by screen coverage and distance to the center of the view
+    std::sort(tileLoads.begin(), tileLoads.end(), [](const TileLoad& a, const TileLoad& b)
+    {
+        if (a.hasSubstitute != b.hasSubstitute)
+            return !a.hasSubstitute;
+        if (a.coverage != b.coverage)
+            return a.coverage > b.coverage;
+        return a.distance < b.distance;
+    });
+
+    // Unless the queue grows, scheduling more loads than fits in the queue would only drop the
+    // most important ones. The rest are scheduled in the following frames.
+    size_t nLoads = tileLoads.size();
+    if (m_queuePolicy != System::ThreadPool::QueuePolicy::GrowWhenFull)
+    {
+        nLoads = std::min(nLoads, m_queueSize);
+    }
+
+    for (size_t i(0); i<nLoads; ++i)
+    {
+        const auto& tile = tileLoads[i].tile;
+        auto tileQuery = featureQuery;
+        tileQuery.area(m_tileManager->tileBounds(tile.x, tile.y, tile.zoom));
+        tileQuery.scale(clampedScale);
+
+        // TODO: Needs debugging together with ImageDataSet::onGetFeatures()
+        // Its needed when crs differ, but seems slower if theyre not.
+        // For datasets that dont have the same crs as requested, its unnecessary to do "clone"
+        // when reqprojecting since we get a copy anyway.
+        tileQuery.rasterGeometryMode(FeatureQuery::RasterGeometryMode::Clipped);
+        tileQuery.resolution(unitsPerPixel);
+
+        scheduleTileLoad(tile, crs, tileQuery);
+    }
+
+    // A substituted ancestor covers its loaded descendants, which would draw the same features again
+    std::unordered_set<TileId> renderedTiles;
+    for (const Tile& tile : renderTiles)
+    {
+        renderedTiles.insert(tile.id());
+    }
+    renderTiles.erase(std::remove_if(renderTiles.begin(), renderTiles.end(), [this, &renderedTiles](const Tile& tile)
+    {
+        Tile parent = tile;
+        while (m_tileManager->parentOf(parent, parent))
+        {
+            if (renderedTiles.count(parent.id()) > 0)
+                return true;
         }
+        return false;
+    }), renderTiles.end());
+
+    // Render coarse to fine
+    std::stable_sort(renderTiles.begin(), renderTiles.end(), [](const Tile& a, const Tile& b)
+    {
+        return a.zoom < b.zoom;
+    });
+
+    renderedTiles.clear();
+    std::vector<int> renderedZooms;
+    for (const Tile& tile : renderTiles)
+    {
+        renderedTiles.insert(tile.id());
+        if (std::find(renderedZooms.begin(), renderedZooms.end(), tile.zoom) == renderedZooms.end())
+            renderedZooms.push_back(tile.zoom);
+    }
+
+    std::vector<Tile> frameTiles;
+    frameTiles.reserve(renderTiles.size());
+    for (const Tile& tile : renderTiles)
+    {
+        if (!tilesAdded.insert(tile.id()).second)
+            continue;
+
+        const auto& cachedTile = m_tileManager->getCachedTile(tile);
+        if (!cachedTile.features)
+            continue;
+
+        // The cached enumerators are never modified, a reload replaces them
+        frameTiles.push_back(cachedTile);
+    }
+    TilingScheme tilingScheme = m_tileManager->tilingScheme();
+    lock.unlock();
+
+    std::unordered_set<Id, Id::IdHash> guestsAdded;
+    for (const Tile& tile : frameTiles)
+    {
+        // The cached enumerators are shared by all frames, and maps, rendering the tile.
+        // Each frame iterates its own enumerators over the same features.
+        auto tileEnumerator = frameFeatures(tile.features, tile.guests, tilingScheme, renderedTiles, renderedZooms, guestsAdded);
+        const auto& tileEnumerators = tileEnumerator->subEnumerators();
+        for (size_t i(0); i<tileEnumerators.size(); ++i)
+        {
+            enumerator->subEnumerators()[i]->addEnumerator(tileEnumerators[i]);
+        }
+    }
+
+    if (!allTilesLoaded && featureQuery.updateAttributes())
+    {
+        // Keep updating until the substitutes have been replaced by the actual tiles
+        featureQuery.updateAttributes()->set(UpdateAttributeKeys::UpdateRequired, true);
     }
 
     return enumerator;
@@ -289,15 +510,8 @@ void TileLayer::update(const MapPtr& map, const FeatureEnumeratorPtr& features,
 
 void TileLayer::flushCache()
 {
-    {
-        std::lock_guard lock(m_mutex);
-        m_tileManager = nullptr;
-    }
-    m_threadPool.stop(true);
-    
+    resetTiles();
     LayerSet::flushCache();
-
-    m_threadPool.start(TILELAYER_NUM_WORKERS, TILELAYER_QUEUE_SIZE, TILELAYER_QUEUE_POLICY);
 }
 
 void TileLayer::verifyValidSubLayers()
@@ -338,61 +552,260 @@ void TileLayer::verifyValidSubLayers()
     }
 }
 
+void TileLayer::restartThreadPool()
+{
+    if (!m_readAsync)
+        return;
+
+    m_threadPool.stop(true);
+    m_threadPool.start(m_numWorkers, m_queueSize, m_queuePolicy);
+}
+
+void TileLayer::resetTiles()
+{
+    // Stop the workers before the tile manager is discarded, since loads in progress
+    // store their result in it. Queued loads are dropped.
+    if (m_readAsync)
+    {
+        m_threadPool.stop(true);
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_tileManager = nullptr;
+    }
+
+    if (m_readAsync)
+    {
+        m_threadPool.start(m_numWorkers, m_queueSize, m_queuePolicy);
+    }
+}
+
+int TileLayer::zoomForScale(const CrsPtr& crs, double scale) const
+{
+    double zoom0Resolution = crs->bounds().width() / (double)m_tileSize;
+    double unitsPerPixel = Drawable::pixelSize() / crs->globalMetersPerUnit() / scale;
+    int zoom = static_cast<int>(std::floor(std::log2(zoom0Resolution/unitsPerPixel)));
+    
+    return std::clamp(zoom, m_zoomRange.minZoom, m_zoomRange.maxZoom);
+}
+
+bool TileLayer::substituteTile(const Tile& tile, std::vector<Tile>& substitutes) const
+{
+    // NOTE: this method assumes that the guard has been taken
+    
+    // Typically available when zooming out
+    if (collectLoadedDescendants(tile, TILELAYER_SUBSTITUTE_DESCENDANT_DEPTH, substitutes))
+    {
+        return true;
+    }
+
+    // Typically available when zooming in. Covers the gaps between the loaded descendants, if any.
+    Tile parent = tile;
+    while (m_tileManager->parentOf(parent, parent))
+    {
+        if (m_tileManager->hasLoadedTile(parent))
+        {
+            substitutes.push_back(parent);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool TileLayer::collectLoadedDescendants(const Tile& tile, int depth, std::vector<Tile>& descendants) const
+{
+    if (depth == 0)
+        return false;
+
+    auto children = m_tileManager->childrenOf(tile);
+    if (children.empty())
+        return false;
+
+    bool covered = true;
+    for (const auto& child : children)
+    {
+        if (m_tileManager->hasLoadedTile(child))
+        {
+            descendants.push_back(child);
+        }
+        else
+        {
+            covered = collectLoadedDescendants(child, depth-1, descendants) && covered;
+        }
+    }
+
+    return covered;
+}
+
 void TileLayer::scheduleTileLoad(const Tile& tile, const CrsPtr& crs, const FeatureQuery& tileQuery)
 {
     // NOTE: this method assumes that the guard has been taken
     
     // Mark tile as loading to prevent duplicate loading of the same tile
     m_tileManager->setTile(Tile{tile.x, tile.y, tile.zoom, nullptr});
+
+    // Copy, since the tile manager may be reset while the tile is loading
+    TilingScheme tilingScheme = m_tileManager->tilingScheme();
+
+    // Sub layers outside of their zoom range are not queried, but still get an (empty)
+    // enumerator such that the tile enumerators line up with layers()
+    std::vector<LayerPtr> subLayers;
+    subLayers.reserve(layers().size());
+    for (const auto& l : layers())
+    {
+        subLayers.push_back(subLayerZoomRange(l).contains(tile.zoom) ? l : nullptr);
+    }
+
     m_threadPool.enqueue(
         System::ThreadPool::Task{
-            .task = [this, tile, crs, tileQuery]()
+            .task = [this, tile, crs, tileQuery, tilingScheme, subLayers]()
             {
                 //std::this_thread::sleep_for(std::chrono::milliseconds(200)); // Simulate loading time
                 // FIXME: if datasets have not been initialized, the enumerator will not include all features
-                auto enumerator = LayerSet::getFeatures(crs, tileQuery, true);
-                
-                if (enumerator->isComplete())
+                FeatureEnumeratorPtr enumerator;
+                FeatureEnumeratorPtr guests;
+                bool failed = false;
+                try
+                {
+                    enumerator = std::make_shared<FeatureEnumerator>();
+                    for (const auto& l : subLayers)
+                    {
+                        enumerator->addEnumerator(l ? l->getFeatures(crs, tileQuery, true) : std::make_shared<FeatureEnumerator>());
+                    }
+
+                    if (enumerator->isComplete())
+                    {
+                        double unitPerPix = tileQuery.resolution();
+                        guests = std::make_shared<FeatureEnumerator>();
+                        enumerator = thinFeatures(enumerator, unitPerPix, tile, tilingScheme, guests);
+                    }
+                }
+                catch (const std::exception& e)
                 {
-                    double unitPerPix = tileQuery.resolution();
-                    enumerator = thinFeatures(enumerator, unitPerPix, tileQuery.area());
-                    enumerator->reset();
+                    BMM_DEBUG() << "TileLayer::scheduleTileLoad() Failed to load " << tile.toString() << ": " << e.what() << "\n";
+                    failed = true;
+                }
 
-                    std::lock_guard lock(m_mutex);
-                    m_tileManager->setTile(Tile{tile.x, tile.y, tile.zoom, enumerator});
+                std::lock_guard lock(m_mutex);
+                if (!failed && enumerator->isComplete())
+                {
+                    m_tileManager->setTile(Tile{tile.x, tile.y, tile.zoom, enumerator, guests});
                 }
                 else
                 {
-                    std::lock_guard lock(m_mutex);
+                    // Scheduled again by the next frames. Incomplete loads (data sets still initializing) are
+                    // retried until they complete, loads that threw are delayed and given up on if they keep failing.
                     m_tileManager->removeTile(tile);
+                    if (failed)
+                    {
+                        m_tileManager->tileLoadFailed(tile, getTimeStampMs());
+                    }
                 }
             },
-            .onDropped = [this, tile]() { m_tileManager->removeTile(tile); }// NOTE: we dont acquire the lock here! This should always be called on the main thread
+            // NOTE: we dont acquire the lock here! Called on the main thread, either by enqueue() while prepare()
+            // holds the lock, or by ThreadPool::stop() after the workers have been joined
+            .onDropped = [this, tile]() { if (m_tileManager) m_tileManager->removeTile(tile); }
         }
     );
 }
 
-FeatureEnumeratorPtr TileLayer::thinFeatures(const FeatureEnumeratorPtr &features, double unitsPerPixel, const Rectangle &tileArea) const
+FeatureEnumeratorPtr TileLayer::thinFeatures(const FeatureEnumeratorPtr &features, double unitsPerPixel, const Tile& tile, const TilingScheme& tilingScheme, const FeatureEnumeratorPtr& guests) const
 {
+    auto tileArea = tilingScheme.tileBounds(tile.x, tile.y, tile.zoom);
+
     // This method can be used to thin the features in a tile to reduce the number of features that need to be processed and drawn
     // For example, we could implement a simple grid-based thinning algorithm that only keeps one feature per grid cell
 
     auto thinnedEnumerator = std::make_shared<FeatureEnumerator>(features->isComplete());
 
+    // Clip polygon fills before thinning, such that the vertex count of their fills is bounded by
+    // the tile area rather than the size of the source features (e.g. a continent polygon)
+    std::vector<FeaturePtr> clippedFeatures;
+    std::vector<FeaturePtr> sharedFeatures;
     for (auto& f : *features->features())
     {
-        thinnedEnumerator->add(thinFeature(f, unitsPerPixel, tileArea));
+        clippedFeatures.clear();
+        sharedFeatures.clear();
+        clipFeature(f, tileArea, clippedFeatures, sharedFeatures);
+        for (const auto& clipped : clippedFeatures)
+        {
+            thinnedEnumerator->add(thinFeature(clipped, unitsPerPixel, tileArea));
+        }
+        for (const auto& shared : sharedFeatures)
+        {
+            if (isHomeTile(shared, tile, tilingScheme))
+            {
+                thinnedEnumerator->add(thinFeature(shared, unitsPerPixel, tileArea));
+            }
+            else
+            {
+                // The feature is shared with a neighbouring tile, which draws it if rendered.
+                // Kept as is, such that large features are not copied into every tile they cross.
+                guests->add(shared);
+            }
+        }
     }
 
     // Placeholder implementation that just returns the original features without thinning
     for (auto& subEnum : features->subEnumerators())
     {
-        thinnedEnumerator->addEnumerator(thinFeatures(subEnum, unitsPerPixel, tileArea));
+        auto subGuests = std::make_shared<FeatureEnumerator>();
+        guests->addEnumerator(subGuests);
+        thinnedEnumerator->addEnumerator(thinFeatures(subEnum, unitsPerPixel, tile, tilingScheme, subGuests));
     }
 
     return thinnedEnumerator;
 }
 
+FeatureEnumeratorPtr TileLayer::frameFeatures(const FeatureEnumeratorPtr& features, const FeatureEnumeratorPtr& guests, const TilingScheme& tilingScheme, const std::unordered_set<TileId>& renderedTiles, const std::vector<int>& renderedZooms, std::unordered_set<Id, Id::IdHash>& guestsAdded)
+{
+    auto frameEnumerator = std::make_shared<FeatureEnumerator>(features->isComplete());
+    frameEnumerator->setFeatures(features->features());
+
+    if (guests)
+    {
+        FeatureCollectionPtr withGuests;
+        for (const auto& f : *guests->features())
+        {
+            bool homeRendered = false;
+            for (int zoom : renderedZooms)
+            {
+                if (renderedTiles.count(tilingScheme.tileAt(f->bounds(), zoom).id()) > 0)
+                {
+                    homeRendered = true;
+                    break;
+                }
+            }
+            if (homeRendered || !guestsAdded.insert(f->id()).second)
+            {
+                continue;
+            }
+
+            // The home tile is not loaded or outside of the view, the first tile having the feature draws it
+            if (!withGuests)
+            {
+                withGuests = std::make_shared<FeatureCollection>(*features->features());
+            }
+            withGuests->add(f);
+        }
+        if (withGuests)
+        {
+            frameEnumerator->setFeatures(withGuests);
+        }
+    }
+
+    const auto& subEnumerators = features->subEnumerators();
+    for (size_t i(0); i<subEnumerators.size(); ++i)
+    {
+        auto subGuests = guests && i < guests->subEnumerators().size() ? guests->subEnumerators()[i] : nullptr;
+        frameEnumerator->addEnumerator(frameFeatures(subEnumerators[i], subGuests, tilingScheme, renderedTiles, renderedZooms, guestsAdded));
+    }
+
+    return frameEnumerator;
+}
+
 FeaturePtr TileLayer::thinFeature(const FeaturePtr& feature, double unitsPerPixel, const Rectangle& tileArea) const
 {
     switch (feature->geometryType())
@@ -413,9 +826,12 @@ FeaturePtr TileLayer::thinFeature(const FeaturePtr& feature, double unitsPerPixe
         case GeometryType::Polygon:
         {
             auto polyGeom = feature->geometryAsPolygon();
-            auto newPoints = std::vector<Point>();
-            thinLine(newPoints, polyGeom->rings()[0], true, unitsPerPixel);
-            auto thinnedPolyGeom = std::make_shared<PolygonGeometry>(newPoints); // Placeholder, should implement actual thinning algorithm
+            auto newRings = std::vector<std::vector<Point>>(polyGeom->rings().size());
+            for (size_t i(0); i<newRings.size(); ++i)
+            {
+                thinLine(newRings[i], polyGeom->rings()[i], true, unitsPerPixel);
+            }
+            auto thinnedPolyGeom = std::make_shared<PolygonGeometry>(newRings); // Placeholder, should implement actual thinning algorithm
 
             return std::make_shared<Feature>(feature->id(), feature->crs(), thinnedPolyGeom, feature->attributes());
         }
@@ -462,6 +878,109 @@ FeaturePtr TileLayer::thinFeature(const FeaturePtr& feature, double unitsPerPixe
     }
 }
 
+bool TileLayer::isClippedToTile(GeometryType type)
+{
+    switch (type)
+    {
+        case GeometryType::Polygon:
+        case GeometryType::MultiPolygon:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool TileLayer::isHomeTile(const FeaturePtr& feature, const Tile& tile, const TilingScheme& tilingScheme)
+{
+    Tile home = tilingScheme.tileAt(feature->bounds(), tile.zoom);
+    return home.x == tile.x && home.y == tile.y;
+}
+
+void TileLayer::clipFeature(const FeaturePtr& feature, const Rectangle& tileArea, std::vector<FeaturePtr>& clipped, std::vector<FeaturePtr>& shared) const
+{
+    if (feature->geometryType() == GeometryType::Raster)
+    {
+        // Clipped to the tile by the query
+        clipped.push_back(feature);
+        return;
+    }
+    if (!isClippedToTile(feature->geometryType()) || tileArea.isInside(feature->bounds()))
+    {
+        shared.push_back(feature);
+        return;
+    }
+
+    // Only the fill is clipped, exactly to the tile such that fills of neighbouring tiles do not overlap
+    // (visible with semi transparent brushes). The pieces are not stroked, the borders of the tile are not
+    // part of the outline. The outline, and anything else drawn for the feature, is drawn once from the whole
+    // feature through its home tile.
+    auto clipPolygon = [&tileArea](const PolygonGeometry& polygon, PolygonGeometry& result)
+    {
+        const auto& rings = polygon.rings();
+        auto resultRings = result.rings();
+        resultRings.clear();
+        for (size_t i(0); i<rings.size(); ++i)
+        {
+            auto ring = Utils::clipRingToRectangle(rings[i], tileArea);
+            if (ring.empty() || Utils::polygonArea(ring) == 0.0)
+            {
+                if (i == 0)
+                {
+                    // Outer ring is outside the tile, holes are irrelevant
+                    return false;
+                }
+                continue;
+            }
+            resultRings.push_back(std::move(ring));
+        }
+
+        return true;
+    };
+
+    auto createFeature = [&feature](const GeometryPtr& geometry, const AttributeKey& part)
+    {
+        auto created = std::make_shared<Feature>(feature->id(), feature->crs(), geometry, feature->attributes());
+        created->attributes().set(part, true);
+        return created;
+    };
+
+    GeometryPtr fill;
+    if (feature->geometryType() == GeometryType::Polygon)
+    {
+        auto clippedGeom = std::make_shared<PolygonGeometry>();
+        if (clipPolygon(*feature->geometryAsPolygon(), *clippedGeom))
+        {
+            fill = clippedGeom;
+        }
+    }
+    else
+    {
+        // Const access, the source geometry is shared with other workers
+        const MultiPolygonGeometry& multiPolygon = *feature->geometryAsMultiPolygon();
+        auto clippedGeom = std::make_shared<MultiPolygonGeometry>();
+        for (const auto& polygon : multiPolygon.polygons())
+        {
+            PolygonGeometry clippedPolygon;
+            if (clipPolygon(polygon, clippedPolygon))
+            {
+                clippedGeom->polygons().push_back(clippedPolygon);
+            }
+        }
+        if (!clippedGeom->polygons().empty())
+        {
+            fill = clippedGeom;
+        }
+    }
+
+    if (fill)
+    {
+        clipped.push_back(createFeature(fill, FeatureAttributeKeys::FillOnly));
+    }
+    // Also when the fill does not reach the tile (e.g. concave polygons), the tile may be the home tile
+    // of the outline
+    shared.push_back(createFeature(feature->geometry(), FeatureAttributeKeys::NoFill));
+}
+
 void TileLayer::thinLine(std::vector<Point>& thinned, const std::vector<Point>& line, bool closed, double unitsPerPixel) const
 {
     int PIXELS_PER_POINT = 3;
@@ -503,11 +1022,7 @@ void TileLayer::drawTiles(const MapPtr &map, const FeatureQuery &featureQuery) c
     // This method can be used to draw debug information about the tiles, such as their boundaries and loading status
     // For example, we could draw a rectangle for each tile, colored based on whether it's loaded, loading, or not loaded
     auto crs = map->crs();
-    int tileSize = m_tileSize;
-    double zoom0Resolution = crs->bounds().width() / (double)tileSize;
-    double unitsPerPixel = Drawable::pixelSize() / crs->globalMetersPerUnit() / featureQuery.scale();
-    int zoom = static_cast<int>(std::floor(std::log2(zoom0Resolution/unitsPerPixel)));
-    zoom = std::clamp(zoom, 0, 20); // TODO: make these parameters configurable
+    int zoom = zoomForScale(crs, featureQuery.scale());
 
     // BMM_DEBUG() << "TileLayer::prepare() Units per pixel: " << unitsPerPixel << ", Zoom level: " << zoom << "\n";
 
@@ -0,0 +1,259 @@
+#include "BlueMarbleMaps/Core/LineTessellation.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace BlueMarble;
+using namespace BlueMarble::LineTessellation;
+
+namespace
+{
+    constexpr double Pi = 3.14159265358979323846;
+
+    // Max distance, in pixels, between a round join or cap and the polygon approximating it
+    constexpr double RoundTolerance = 0.25;
+
+    struct Direction
+    {
+        double x;
+        double y;
+    };
+
+    class Tessellator
+    {
+        public:
+            Tessellator(const double* x, const double* y, const Pen& pen, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+                : m_x(x)
+                , m_y(y)
+                , m_halfWidth(0.5*pen.getThickness())
+                , m_join(pen.getJoin())
+                , m_cap(pen.getCap())
+                , m_miterLimit(pen.getMiterLimit())
+                , m_roundStep(Pi/16.0)
+                , m_vertices(vertices)
+                , m_indices(indices)
+            {
+                if (m_halfWidth > RoundTolerance)
+                {
+                    m_roundStep = std::max(m_roundStep, 2.0*std::acos(1.0 - RoundTolerance/m_halfWidth));
+                }
+                else
+                {
+                    m_roundStep = Pi;
+                }
+            }
+
+            void tessellate(const std::vector<uint32_t>& points, bool closed)
+            {
+                size_t n = points.size();
+                size_t nSegments = closed ? n : n-1;
+
+                uint32_t startLeft, startRight;
+                uint32_t endLeft = 0, endRight = 0;
+                Direction current = direction(points, 0);
+                if (closed)
+                {
+                    // The join at the first point ends the last segment and starts the first
+                    join(points[0], direction(points, n-1), current, endLeft, endRight, startLeft, startRight);
+                }
+                else
+                {
+                    startCap(points[0], current, startLeft, startRight);
+                }
+
+                for (size_t k(0); k<nSegments; ++k)
+                {
+                    uint32_t inLeft, inRight, outLeft, outRight;
+                    if (k == nSegments-1)
+                    {
+                        if (closed)
+                        {
+                            inLeft = endLeft;
+                            inRight = endRight;
+                        }
+                        else
+                        {
+                            endCap(points[n-1], current, inLeft, inRight);
+                        }
+                        outLeft = outRight = 0;
+                    }
+                    else
+                    {
+                        Direction next = direction(points, k+1);
+                        join(points[k+1], current, next, inLeft, inRight, outLeft, outRight);
+                        current = next;
+                    }
+                    quad(startLeft, startRight, inLeft, inRight);
+                    startLeft = outLeft;
+                    startRight = outRight;
+                }
+            }
+
+        private:
+            // Unit direction of segment k, from points[k] to the next point
+            Direction direction(const std::vector<uint32_t>& points, size_t k) const
+            {
+                uint32_t a = points[k];
+                uint32_t b = points[(k+1) % points.size()];
+                double dx = m_x[b] - m_x[a];
+                double dy = m_y[b] - m_y[a];
+                double length = std::sqrt(dx*dx + dy*dy);
+                return Direction{ dx/length, dy/length };
+            }
+
+            // Offset in half widths
+            uint32_t vertex(uint32_t point, double dx, double dy)
+            {
+                m_vertices.push_back(Vertex{ point, float(dx*m_halfWidth), float(dy*m_halfWidth) });
+                return uint32_t(m_vertices.size() - 1);
+            }
+
+            void triangle(uint32_t a, uint32_t b, uint32_t c)
+            {
+                m_indices.push_back(a);
+                m_indices.push_back(b);
+                m_indices.push_back(c);
+            }
+
+            void quad(uint32_t left0, uint32_t right0, uint32_t left1, uint32_t right1)
+            {
+                triangle(left0, right0, left1);
+                triangle(right0, right1, left1);
+            }
+
+            // Triangles around center, from vertex first at startAngle over sweep radians to vertex last
+            void fan(uint32_t point, uint32_t center, uint32_t first, uint32_t last, double startAngle, double sweep)
+            {
+                int steps = std::max(1, int(std::ceil(std::abs(sweep)/m_roundStep)));
+                uint32_t previous = first;
+                for (int i(1); i<steps; ++i)
+                {
+                    double angle = startAngle + sweep*i/steps;
+                    uint32_t current = vertex(point, std::cos(angle), std::sin(angle));
+                    triangle(center, previous, current);
+                    previous = current;
+                }
+                triangle(center, previous, last);
+            }
+
+            void startCap(uint32_t point, const Direction& d, uint32_t& left, uint32_t& right)
+            {
+                // Left normal is (-d.y, d.x)
+                double back = m_cap == Pen::Cap::Square ? 1.0 : 0.0;
+                left = vertex(point, -d.y - back*d.x, d.x - back*d.y);
+                right = vertex(point, d.y - back*d.x, -d.x - back*d.y);
+                if (m_cap == Pen::Cap::Round)
+                {
+                    // Half circle from the left side, around the back, to the right side
+                    uint32_t center = vertex(point, 0.0, 0.0);
+                    fan(point, center, left, right, std::atan2(d.x, -d.y), Pi);
+                }
+            }
+
+            void endCap(uint32_t point, const Direction& d, uint32_t& left, uint32_t& right)
+            {
+                double forward = m_cap == Pen::Cap::Square ? 1.0 : 0.0;
+                left = vertex(point, -d.y + forward*d.x, d.x + forward*d.y);
+                right = vertex(point, d.y + forward*d.x, -d.x + forward*d.y);
+                if (m_cap == Pen::Cap::Round)
+                {
+                    // Half circle from the right side, around the front, to the left side
+                    uint32_t center = vertex(point, 0.0, 0.0);
+                    fan(point, center, right, left, std::atan2(-d.x, d.y), Pi);
+                }
+            }
+
+            // Vertices ending the incoming segment d0 and starting the outgoing segment d1 at point
+            void join(uint32_t point, const Direction& d0, const Direction& d1,
+                      uint32_t& inLeft, uint32_t& inRight, uint32_t& outLeft, uint32_t& outRight)
+            {
+                double cross = d0.x*d1.y - d0.y*d1.x;
+                double dot = d0.x*d1.x + d0.y*d1.y;
+                double n0x = -d0.y, n0y = d0.x;
+                double n1x = -d1.y, n1y = d1.x;
+
+                // Shared vertices on the miter, (n0 + n1)/(1 + cos(angle)) has the length 1/cos(angle/2)
+                bool straight = std::abs(cross) < 1e-9 && dot > 0.0;
+                if (straight || (m_join == Pen::Join::Miter && 1.0 + dot > 1e-9))
+                {
+                    double mx = (n0x + n1x)/(1.0 + dot);
+                    double my = (n0y + n1y)/(1.0 + dot);
+                    if (straight || mx*mx + my*my <= m_miterLimit*m_miterLimit)
+                    {
+                        inLeft = outLeft = vertex(point, mx, my);
+                        inRight = outRight = vertex(point, -mx, -my);
+                        return;
+                    }
+                }
+
+                inLeft = vertex(point, n0x, n0y);
+                inRight = vertex(point, -n0x, -n0y);
+                outLeft = vertex(point, n1x, n1y);
+                outRight = vertex(point, -n1x, -n1y);
+
+                // Fill the outer side of the corner: the right side when turning left. The sweep follows
+                // the turn, a reversal counts as a right turn so that it is capped on the far side.
+                bool leftTurn = cross > 0.0;
+                double sweep = (leftTurn ? 1.0 : -1.0)*std::atan2(std::abs(cross), dot);
+                uint32_t first = leftTurn ? inRight : inLeft;
+                uint32_t last = leftTurn ? outRight : outLeft;
+                uint32_t center = vertex(point, 0.0, 0.0);
+                if (m_join == Pen::Join::Round)
+                {
+                    double startAngle = leftTurn ? std::atan2(-n0y, -n0x) : std::atan2(n0y, n0x);
+                    fan(point, center, first, last, startAngle, sweep);
+                }
+                else
+                {
+                    triangle(center, first, last);
+                }
+            }
+
+            const double* m_x;
+            const double* m_y;
+            double m_halfWidth;
+            Pen::Join m_join;
+            Pen::Cap m_cap;
+            double m_miterLimit;
+            double m_roundStep;     // Angle between the vertices of round joins and caps
+            std::vector<Vertex>& m_vertices;
+            std::vector<uint32_t>& m_indices;
+    };
+}
+
+bool LineTessellation::tessellate(const double* x, const double* y, size_t n, bool closed, const Pen& pen,
+                                  std::vector<Vertex>& outVertices, std::vector<uint32_t>& outIndices)
+{
+    if (n < 2 || !(pen.getThickness() > 0.0))
+    {
+        return false;
+    }
+
+    // Indices of the distinct points, reused between calls
+    thread_local std::vector<uint32_t> s_points;
+    s_points.clear();
+    s_points.push_back(0);
+    for (size_t i(1); i<n; ++i)
+    {
+        uint32_t previous = s_points.back();
+        if (x[i] != x[previous] || y[i] != y[previous])
+        {
+            s_points.push_back(uint32_t(i));
+        }
+    }
+    if (closed && s_points.size() > 1 && x[s_points.back()] == x[0] && y[s_points.back()] == y[0])
+    {
+        s_points.pop_back();
+    }
+    if (s_points.size() < 2)
+    {
+        return false;
+    }
+    closed = closed && s_points.size() > 2;
+
+    outVertices.reserve(outVertices.size() + 4*s_points.size());
+    outIndices.reserve(outIndices.size() + 9*s_points.size());
+    Tessellator(x, y, pen, outVertices, outIndices).tessellate(s_points, closed);
+
+    return true;
+}
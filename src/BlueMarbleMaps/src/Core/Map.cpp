@@ -6,22 +6,45 @@
 #include "BlueMarbleMaps/Core/SoftwareDrawable.h"
 #include "BlueMarbleMaps/Logging/Logging.h"
 
+#include <chrono>
 #include <cmath>
 #include <iostream>
+#include <thread>
 #include <vector>
 #include <set>
 
 
 using namespace BlueMarble;
 
+namespace
+{
+    // Added around the screen bounds of an invalidated feature, covers line widths, symbols and labels drawn around it
+    constexpr double InvalidationMargin = 32.0;
+
+    // Tolerance in pixels when comparing views for layer render caches
+    constexpr double ViewTolerancePixels = 1e-3;
+
+    bool sameArea(const Rectangle& a, const Rectangle& b, double tolerance)
+    {
+        return std::abs(a.xMin() - b.xMin()) < tolerance && std::abs(a.yMin() - b.yMin()) < tolerance
+            && std::abs(a.xMax() - b.xMax()) < tolerance && std::abs(a.yMax() - b.yMax()) < tolerance;
+    }
+}
+
 Map::Map()
     : m_crs(Crs::wgs84LngLat())
     , m_surfaceModel(std::make_shared<PlaneSurfaceModel>(Point{0,0,0}, Point{0,0,1}))
     , m_updateRequired(true)
     , m_updateEnabled(true)
-    , m_updateAttributes()
+    , m_partialUpdateEnabled(true)
+    , m_fullUpdateRequired(true)
+    , m_layersComplete(true)
+    , m_dirtyRegion(Rectangle::undefined())
+    , m_renderStateVersion(0)
     , m_cameraController(nullptr)
     , m_lastUpdateTimeStamp(-1)
+    , m_updateAttributes()
+    , m_frameArena(nullptr)
     , m_presentationObjects()
     , m_selectedFeatures()
     , m_hoveredFeatures()
@@ -41,6 +64,11 @@ Map::Map()
 
 bool Map::update(bool forceUpdate)
 {
+    if (!forceUpdate)
+    {
+        // Requested by someone other than the map control, the change can't be told apart
+        m_fullUpdateRequired = true;
+    }
     if (!forceUpdate && m_mapControl)
     {
         // Let MapControl schedule update
@@ -66,12 +94,19 @@ bool Map::update(bool forceUpdate)
     m_updateRequired = false;
     updateUpdateAttributes(timeStampMs); // Set update attributes that contains useful information about the update
 
+    // Transient objects of the frame (temporary features, enumerators etc.) are allocated in a new
+    // arena, released in bulk when the objects are gone. The first block is sized after the previous frame.
+    size_t arenaBlockSize = m_frameArena ? std::max(m_frameArena->bytesAllocated(), FrameArena::DefaultBlockSize) : FrameArena::DefaultBlockSize;
+    m_frameArena = std::make_shared<FrameArena>(arenaBlockSize);
+    FrameArena::Scope arenaScope(m_frameArena);
+
     // Update camera using the camera controller
     if (m_cameraController)
     {
         ICameraController::ControllerStatus status = m_cameraController->updateCamera(m_camera, deltaMs);
         if (hasFlag(status, ICameraController::ControllerStatus::Updated))
         {
+            m_fullUpdateRequired = true;
             events.onCameraChanged.notify(*this);
         }
         if (hasFlag(status, ICameraController::ControllerStatus::NeedsUpdate))
@@ -86,10 +121,20 @@ bool Map::update(bool forceUpdate)
 
     events.onUpdating.notify(*this);
 
+    // Only the invalidated area is redrawn, over the previous frame, when nothing else changed
+    Rectangle updateArea = Rectangle::undefined();
+    if (m_partialUpdateEnabled && !m_fullUpdateRequired && !m_dirtyRegion.isUndefined())
+    {
+        updateArea = m_dirtyRegion.intersect(Rectangle(0, 0, m_drawable->width(), m_drawable->height()));
+    }
+    m_fullUpdateRequired = false;
+    m_dirtyRegion = Rectangle::undefined();
+    m_drawable->setClipRect(updateArea);
+
     // Set camera frustom and call clearBuffer
     
     beforeRender();
-    renderLayers(); // Let layers do their work
+    m_layersComplete = renderLayers(updateArea); // Let layers do their work
     
     auto proj = ScreenCameraProjection(m_drawable->width(), m_drawable->height());
 
@@ -115,10 +160,25 @@ bool Map::update(bool forceUpdate)
 
     // Swap buffers
     afterRender();
+    m_drawable->setClipRect(Rectangle::undefined());
 
     events.onUpdated.notify(*this);
 
     m_updateRequired |= m_updateAttributes.get<bool>(UpdateAttributeKeys::UpdateRequired); // Someone in the operator chain needs more updates (e.g. Visualization evaluations)
+    if (!m_drawable->isComplete())
+    {
+        // E.g. raster tiles left to upload, drawn coarser until then
+        m_updateRequired = true;
+        m_layersComplete = false;
+    }
+    if (m_updateRequired)
+    {
+        // More of the same, e.g. the animation of a hovered feature keeps redrawing its area only
+        if (updateArea.isUndefined())
+            m_fullUpdateRequired = true;
+        else
+            m_dirtyRegion = m_dirtyRegion.isUndefined() ? updateArea : Rectangle::mergeBounds({ m_dirtyRegion, updateArea });
+    }
 
     m_isUpdating = false;
 
@@ -131,47 +191,242 @@ bool Map::update(bool forceUpdate)
     return updateRequired;
 }
 
-void Map::renderLayer(const LayerPtr& layer, const FeatureQuery& featureQuery)
+bool Map::renderLayer(const LayerPtr& layer, const FeatureQuery& featureQuery)
 {
     auto prepared = layer->prepare(crs(), featureQuery);
     layer->update(shared_from_this(), prepared, featureQuery);
+    return prepared->isComplete();
+}
+
+bool Map::renderLayerSettled(const LayerPtr& layer, const FeatureQuery& featureQuery)
+{
+    // Rendered with a clean UpdateRequired attribute to tell whether the layer needs more updates
+    bool updateRequired = m_updateAttributes.get<bool>(UpdateAttributeKeys::UpdateRequired);
+    m_updateAttributes.set(UpdateAttributeKeys::UpdateRequired, false);
+    bool complete = false;
+    try
+    {
+        complete = renderLayer(layer, featureQuery);
+    }
+    catch (...)
+    {
+        m_updateAttributes.set(UpdateAttributeKeys::UpdateRequired, updateRequired);
+        throw;
+    }
+    bool layerUpdateRequired = m_updateAttributes.get<bool>(UpdateAttributeKeys::UpdateRequired);
+    m_updateAttributes.set(UpdateAttributeKeys::UpdateRequired, updateRequired || layerUpdateRequired);
+
+    return complete && !layerUpdateRequired;
+}
+
+bool Map::renderCachedLayer(const LayerPtr& layer, const FeatureQuery& featureQuery)
+{
+    auto& cache = layer->renderCache();
+    auto viewArea = northUpViewArea();
+    if (viewArea.isUndefined() || !layer->isActiveForQuery(featureQuery))
+    {
+        cache.settlingArea = Rectangle::undefined();
+        return renderLayer(layer, featureQuery);
+    }
+
+    int w = m_drawable->width();
+    int h = m_drawable->height();
+    double tolerance = ViewTolerancePixels*viewArea.width()/w;
+    if (cache.image && (cache.crs != m_crs || cache.dataVersion != layer->dataVersion() || cache.stateVersion != m_renderStateVersion
+        || std::abs(cache.image->bounds().width() - viewArea.width()) > tolerance
+        || std::abs(cache.image->bounds().height() - viewArea.height()) > tolerance))
+    {
+        cache.clear(); // Zoomed, rotated, resized or changed
+    }
+
+    // The image is regenerated once the view is the same as in the previous frame. Until then
+    // the image is moved for pans, and the layer is rendered as usual for any other change.
+    // A layer that is loading or animating at the settled view is rendered as usual until it is
+    // done, rather than regenerating the image every frame.
+    bool upToDate = cache.image && sameArea(cache.image->bounds(), viewArea, tolerance);
+    bool settled = !cache.settlingArea.isUndefined() && sameArea(cache.settlingArea, viewArea, tolerance);
+    if (!settled)
+    {
+        cache.busy = false;
+    }
+    if (!upToDate && settled && !cache.busy)
+    {
+        upToDate = renderLayerToCache(layer, featureQuery, viewArea);
+        cache.busy = !upToDate;
+    }
+    cache.settlingArea = upToDate ? Rectangle::undefined() : viewArea;
+    if (!upToDate && !cache.busy)
+    {
+        m_updateAttributes.set(UpdateAttributeKeys::UpdateRequired, true); // To see whether the view settles
+    }
+
+    if (!cache.image)
+    {
+        // While busy, the layer requests the updates it needs itself
+        bool complete = renderLayerSettled(layer, featureQuery);
+        if (complete && cache.busy)
+        {
+            cache.busy = false;
+            m_updateAttributes.set(UpdateAttributeKeys::UpdateRequired, true); // Done, the image is rendered in the next frame
+        }
+        return complete;
+    }
+
+    // The pixels whose centers are inside the moved image are drawn from it, the rest is rendered
+    auto imageArea = mapToScreen(cache.image->bounds());
+    auto drawnArea = Rectangle(std::ceil(imageArea.xMin() - 0.5), std::ceil(imageArea.yMin() - 0.5),
+                               std::ceil(imageArea.xMax() - 0.5), std::ceil(imageArea.yMax() - 0.5));
+    Brush brush(Color::white());
+    m_drawable->beginBatches();
+    m_drawable->drawRaster(cache.image, brush);
+    m_drawable->endBatches();
+
+    bool complete = true;
+    for (const auto& strip : Rectangle(0, 0, w, h).subtract(drawnArea))
+    {
+        auto queryArea = strip;
+        queryArea.extend(InvalidationMargin, InvalidationMargin); // Features just outside can draw into the strip
+        auto stripArea = screenToMap(queryArea).intersect(featureQuery.area());
+        if (stripArea.isUndefined())
+        {
+            continue;
+        }
+        auto stripQuery = featureQuery;
+        stripQuery.area(stripArea);
+        stripQuery.partial(true);
+        m_drawable->setClipRect(strip);
+        complete &= renderLayer(layer, stripQuery);
+    }
+    m_drawable->setClipRect(Rectangle::undefined());
+
+    return complete;
 }
 
-void Map::renderLayers()
+bool Map::renderLayerToCache(const LayerPtr& layer, const FeatureQuery& featureQuery, const Rectangle& viewArea)
+{
+    auto& cache = layer->renderCache();
+    int w = m_drawable->width();
+    int h = m_drawable->height();
+    if (!cache.drawable)
+    {
+        // Same renderer as the map, such that the image looks like the layer rendered as usual
+        cache.drawable = m_drawable->createOffscreen(w, h);
+        cache.drawable->backgroundColor(Color::transparent());
+    }
+    else if (cache.drawable->width() != w || cache.drawable->height() != h)
+    {
+        cache.drawable->resize(w, h);
+    }
+
+    auto drawable = m_drawable;
+    m_drawable = cache.drawable;
+    bool complete = false;
+    try
+    {
+        m_drawable->clearBuffer();
+        setDrawableFromCamera(m_camera);
+        complete = renderLayerSettled(layer, featureQuery) && m_drawable->isComplete();
+    }
+    catch (...)
+    {
+        m_drawable = drawable;
+        throw;
+    }
+    m_drawable = drawable;
+
+    cache.image = nullptr;
+    if (!complete)
+    {
+        return false;
+    }
+
+    // Drawn onto transparent black, the colors are premultiplied by alpha
+    auto raster = cache.drawable->getRaster();
+    raster.unpremultiplyAlpha();
+    cache.image = std::make_shared<RasterGeometry>(std::move(raster), viewArea);
+    cache.crs = m_crs;
+    cache.dataVersion = layer->dataVersion();
+    cache.stateVersion = m_renderStateVersion;
+
+    return true;
+}
+
+Rectangle Map::northUpViewArea() const
+{
+    double w = m_drawable->width();
+    double h = m_drawable->height();
+    auto topLeft = screenToMap(0, 0);
+    auto topRight = screenToMap(w, 0);
+    auto bottomLeft = screenToMap(0, h);
+    auto bottomRight = screenToMap(w, h);
+    if (topLeft.isUndefined() || topRight.isUndefined() || bottomLeft.isUndefined() || bottomRight.isUndefined()
+        || !(topRight.x() > topLeft.x()) || !(topLeft.y() > bottomLeft.y()))
+    {
+        return Rectangle::undefined();
+    }
+
+    // An axis aligned rectangle, anything else is rotated or tilted
+    double tolerance = ViewTolerancePixels*(topRight.x() - topLeft.x())/w;
+    if (std::abs(topRight.y() - topLeft.y()) > tolerance || std::abs(bottomLeft.x() - topLeft.x()) > tolerance
+        || std::abs(bottomRight.x() - topRight.x()) > tolerance || std::abs(bottomRight.y() - bottomLeft.y()) > tolerance)
+    {
+        return Rectangle::undefined();
+    }
+
+    return Rectangle(topLeft.x(), bottomLeft.y(), topRight.x(), topLeft.y());
+}
+
+bool Map::renderLayers(const Rectangle& screenArea)
 {
     m_presentationObjects.clear(); // Clear presentation objects, layers will add new
 
-    FeatureQuery featureQuery = std::move(produceUpdateQuery());
+    FeatureQuery featureQuery = std::move(produceUpdateQuery(screenArea));
 
+    bool complete = true;
     for (const auto& l : m_layers)
     {
         // TODO add "ViewInfo" as parameter to Layer::update()?
         //l->update(shared_from_this(), getCrs(), featureQuery);
-        renderLayer(l, featureQuery);
+        if (screenArea.isUndefined() && l->renderCacheEnabled())
+            complete &= renderCachedLayer(l, featureQuery); // Full frames only, partial ones are clipped already
+        else
+            complete &= renderLayer(l, featureQuery);
+    }
+
+    if (!screenArea.isUndefined())
+    {
+        return complete; // Partial update, the outline of the full update area is kept
     }
 
     // Debug draw update area
     m_drawable->beginBatches();
-    auto line = std::make_shared<LineGeometry>(featureQuery.area());
+    auto line = makeTransient<LineGeometry>(featureQuery.area());
     Pen p;
     p.setColor(Color::red());
     p.setThickness(5.0);
     //m_drawable->setTransform(Transform::screenTransform(m_drawable->width(), m_drawable->height()));
     m_drawable->drawLine(line, p);
     m_drawable->endBatches();
+
+    return complete;
 }
 
-FeatureQuery Map::produceUpdateQuery()
+FeatureQuery Map::produceUpdateQuery(const Rectangle& screenArea)
 {
     FeatureQuery featureQuery;
 
     int w = m_drawable->width();
     int h = m_drawable->height();
-    auto screenArea = Rectangle(0,0,w,h);
-    screenArea.scale(0.9); // TODO: this scaling is for debugging querying, remove
+    auto queryArea = screenArea;
+    if (queryArea.isUndefined())
+    {
+        queryArea = Rectangle(0,0,w,h);
+        queryArea.scale(0.9); // TODO: this scaling is for debugging querying, remove
+    }
 
-    auto updateArea = screenToMap(screenArea);
+    auto updateArea = screenToMap(queryArea);
     featureQuery.area(updateArea);
+    featureQuery.partial(!screenArea.isUndefined());
     // Map to camera
     auto centerMap = screenToMap(screenCenter());
     if (centerMap.isUndefined())
@@ -230,6 +485,7 @@ void Map::crs(const CrsPtr& newCrs)
     }
 
     flushCache(); // We need to flush layer caches since the crs has changed
+    m_fullUpdateRequired = true;
 
     events.onCrsChanged.notify(*this, oldCrs, newCrs);
 }
@@ -246,6 +502,7 @@ void Map::setCameraController(ICameraController* controller)
         m_cameraController = controller;
         m_camera = m_cameraController->onActivated(m_camera, m_crs, m_surfaceModel);
     }
+    m_fullUpdateRequired = true;
 }
 
 Point Map::pixelToScreen(const Point& pixel) const
@@ -410,6 +667,7 @@ void Map::addLayer(const LayerPtr& layer)
 {
     assert(layer != nullptr);
     m_layers.push_back(layer);
+    m_fullUpdateRequired = true;
 }
 
 std::vector<LayerPtr>& Map::layers()
@@ -485,6 +743,7 @@ const std::vector<PresentationObject>& Map::hitTest(const Rectangle& bounds)
     // );
 
     m_presentationObjects.clear();
+    FrameArena::Scope arenaScope(m_frameArena);
 
     // Iterate in reverse such that the last rendered layer is hittested first
     for (auto iter = m_layers.rbegin(); iter!=m_layers.rend(); ++iter)
@@ -507,6 +766,10 @@ void Map::select(FeaturePtr feature, SelectMode mode)
     switch (mode)
     {
     case SelectMode::Replace:
+        for (const auto& id : m_selectedFeatures)
+        {
+            invalidate(id);
+        }
         m_selectedFeatures.clear();
         break;
 
@@ -521,6 +784,7 @@ void Map::select(FeaturePtr feature, SelectMode mode)
     if (!isSelected(feature))
     {
         m_selectedFeatures.push_back(feature->id());
+        invalidate(feature);
 
         // Testing restartVisualizationAnimation
         if (auto dataSet = DataSet::getDataSetById(feature->id().dataSetId()))
@@ -553,6 +817,7 @@ void Map::deSelect(const Id& id)
         if(*it == id)
         {
             m_selectedFeatures.erase(it);
+            invalidate(id);
             return;
         }
     }
@@ -565,6 +830,10 @@ void Map::deSelect(FeaturePtr feature)
 
 void Map::deSelectAll()
 {
+    for (const auto& id : m_selectedFeatures)
+    {
+        invalidate(id);
+    }
     m_selectedFeatures.clear();
     m_selectedPresentationObjects.clear();
 }
@@ -589,6 +858,10 @@ void Map::hover(const Id& id)
 {
     if (isHovered(id))
         return;
+    for (const auto& hoveredId : m_hoveredFeatures)
+    {
+        invalidate(hoveredId);
+    }
     m_hoveredFeatures.clear();
     if (id != Id(0,0))
     {
@@ -601,6 +874,7 @@ void Map::hover(const Id& id)
             }
         }
         m_hoveredFeatures.push_back(id);
+        invalidate(id);
     }
         
     auto notifyId = Id(0,0);
@@ -633,15 +907,93 @@ void Map::hover(FeaturePtr feature)
 
 void Map::hover(const std::vector<Id>& ids)
 {
+    for (const auto& id : m_hoveredFeatures)
+    {
+        invalidate(id);
+    }
     m_hoveredFeatures = ids;
+    for (const auto& id : m_hoveredFeatures)
+    {
+        invalidate(id);
+    }
 }
 
 void Map::hover(const std::vector<FeaturePtr>& features)
 {
+    for (const auto& id : m_hoveredFeatures)
+    {
+        invalidate(id);
+    }
     m_hoveredFeatures.clear();
     for (auto f : features)
     {
         m_hoveredFeatures.push_back(f->id());
+        invalidate(f);
+    }
+}
+
+void Map::invalidate(const Rectangle& screenArea)
+{
+    ++m_renderStateVersion; // Layer render caches may show a hover or selection state that changed
+    if (screenArea.isUndefined())
+        return;
+
+    m_dirtyRegion = m_dirtyRegion.isUndefined() ? screenArea : Rectangle::mergeBounds({ m_dirtyRegion, screenArea });
+    m_updateRequired = true;
+    if (m_mapControl)
+    {
+        m_mapControl->updateView();
+    }
+}
+
+void Map::invalidate(const FeaturePtr& feature)
+{
+    if (!feature)
+        return;
+
+    auto bounds = feature->bounds();
+    if (feature->crs() && feature->crs() != m_crs)
+    {
+        bounds = feature->crs()->projectTo(m_crs, bounds);
+    }
+    auto screenBounds = bounds.isUndefined() ? Rectangle::undefined() : mapToScreen(bounds);
+    if (screenBounds.isUndefined())
+    {
+        invalidateAll(); // Not on screen as a rectangle, e.g. behind the camera
+        return;
+    }
+    screenBounds.extend(InvalidationMargin, InvalidationMargin);
+    invalidate(screenBounds);
+}
+
+void Map::invalidate(const Id& id)
+{
+    FeaturePtr feature;
+    try
+    {
+        auto dataSet = DataSet::getDataSetById(id.dataSetId());
+        feature = dataSet ? dataSet->getFeature(id) : nullptr;
+    }
+    catch (const std::runtime_error&)
+    {
+        // No such data set, e.g. the id of a feature created by a layer
+    }
+    if (!feature)
+    {
+        invalidateAll(); // Where it is drawn is unknown
+        return;
+    }
+    invalidate(feature);
+}
+
+void Map::invalidateAll()
+{
+    ++m_renderStateVersion;
+    m_fullUpdateRequired = true;
+    m_updateRequired = true;
+    if (m_mapControl)
+    {
+        m_mapControl->updateView();
     }
 }
 
@@ -671,6 +1023,10 @@ DrawablePtr Map::drawable()
 void Map::drawable(const DrawablePtr &drawable)
 {
     m_drawable = drawable;
+    for (const auto& l : m_layers)
+    {
+        l->renderCache() = LayerRenderCache(); // Rendered with the previous drawable
+    }
     resize(drawable->width(), drawable->height()); 
 }
 
@@ -678,6 +1034,7 @@ void Map::resize(int width, int height)
 {
     m_drawable->resize(width, height);
     m_camera->setViewPort(width, height);
+    m_fullUpdateRequired = true;
     if (m_cameraController)
     {
         m_cameraController->onActivated(m_camera, m_crs, m_surfaceModel);
@@ -690,7 +1047,106 @@ void Map::flushCache()
     for (const auto& l : m_layers)
     {
         l->flushCache();
+        l->renderCache().clear();
+    }
+    m_fullUpdateRequired = true;
+}
+
+std::vector<RenderedImage> Map::renderToImages(const std::vector<RenderJob>& jobs)
+{
+    if (m_isUpdating)
+    {
+        throw std::runtime_error("Map::renderToImages() Not allowed within an update");
+    }
+
+    // Detached from the controller and map control while rendering, such that the camera of each job is used
+    // and no update is scheduled for a window
+    auto camera = m_camera;
+    auto cameraController = m_cameraController;
+    auto mapControl = m_mapControl;
+    int width = m_drawable->width();
+    int height = m_drawable->height();
+    m_cameraController = nullptr;
+    m_mapControl = nullptr;
+
+    std::vector<RenderedImage> images;
+    images.reserve(jobs.size());
+    try
+    {
+        for (const auto& job : jobs)
+        {
+            images.push_back(renderJob(job));
+        }
+    }
+    catch (...)
+    {
+        m_isUpdating = false;
+        m_camera = camera;
+        m_cameraController = cameraController;
+        m_mapControl = mapControl;
+        resize(width, height);
+        throw;
+    }
+
+    m_camera = camera;
+    m_cameraController = cameraController;
+    m_mapControl = mapControl;
+    if (m_drawable->width() != width || m_drawable->height() != height)
+    {
+        resize(width, height);
     }
+    m_updateRequired = true; // The drawable holds the last job, not the view
+    m_fullUpdateRequired = true;
+
+    return images;
+}
+
+RenderedImage Map::renderToImage(const RenderJob& job)
+{
+    return std::move(renderToImages({ job })[0]);
+}
+
+RenderedImage Map::renderJob(const RenderJob& job)
+{
+    if (job.width <= 0 || job.height <= 0 || job.area.isUndefined() || !(job.area.width() > 0.0) || !(job.area.height() > 0.0))
+    {
+        throw std::runtime_error("Map::renderJob() Invalid render job");
+    }
+
+    auto t1 = getTimeStampMs();
+    if (m_drawable->width() != job.width || m_drawable->height() != job.height)
+    {
+        m_drawable->resize(job.width, job.height);
+    }
+
+    // Looking down at the center of the area from above the surface, near and far are set in beforeRender()
+    double unitsPerPixel = std::max(job.area.width()/job.width, job.area.height()/job.height);
+    double distance = std::max(job.area.width(), job.area.height());
+    m_camera = Camera::orthoGraphicCamera(job.width, job.height, 0.5*distance, 1.5*distance, unitsPerPixel);
+    auto center = job.area.center();
+    m_camera->setTranslation(Point(center.x(), center.y(), distance));
+    m_camera->setOrientation(glm::dquat(1.0, 0.0, 0.0, 0.0));
+    m_fullUpdateRequired = true;
+
+    // Updated until the layers are done, layers reading asynchronously draw what has loaded so far
+    bool updateRequired = update(true);
+    while ((updateRequired || !m_layersComplete) && getTimeStampMs() - t1 < job.timeoutMs)
+    {
+        if (!m_layersComplete)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1)); // Let the loading threads work
+        }
+        updateRequired = update(true);
+    }
+
+    RenderedImage image;
+    image.png = m_drawable->getRaster().encodePng();
+    image.width = job.width;
+    image.height = job.height;
+    image.renderTimeMs = getTimeStampMs() - t1;
+    image.complete = !updateRequired && m_layersComplete;
+
+    return image;
 }
 
 void Map::renderingEnabled(bool enabled)
@@ -826,6 +1282,7 @@ void Map::drawDebugInfo(int elapsedMs)
     info += "\nUpdate time: " + std::to_string(elapsedMs);
     info += "\nFPS: " + std::to_string(1000.0/elapsedMs);
     info += "\nPresentationObjects: " + std::to_string(m_presentationObjects.size());
+    info += "\nFrame allocations: " + std::to_string(m_frameArena->allocationCount()) + " (" + std::to_string(m_frameArena->bytesAllocated() / 1024) + " kB)";
 
     info += "\n";
     // auto presentationObjects = hitTest(mousePos.x, mousePos.y, 10.0);
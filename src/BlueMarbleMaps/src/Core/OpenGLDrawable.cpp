@@ -1,5 +1,7 @@
 #include "BlueMarbleMaps/Core/OpenGLDrawable.h"
 #include "BlueMarbleMaps/Core/Geometry.h"
+#include "BlueMarbleMaps/Core/LineTessellation.h"
+#include "BlueMarbleMaps/Core/Triangulation.h"
 #include "BlueMarbleMaps/Logging/Logging.h"
 
 #include "Platform/OpenGL/Shader.h"
@@ -9,21 +11,193 @@
 #include "Platform/OpenGL/Texture.h"
 #include "Platform/OpenGL/CameraPerspective.h"
 #include "Platform/OpenGL/CameraOrthographic.h"
-#include "Platform/OpenGL/Algorithms.h"
 #include "Platform/OpenGL/Line.h"
 #include "Platform/OpenGL/Polygon.h"
-#include "Platform/OpenGL/Rect.h"
 #include "Platform/OpenGL/Batch.h"
 #include "stb_image.h"
 #include "glm.hpp"
 #include "gtc/type_ptr.hpp"
 #include "gtc/matrix_transform.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 #define SEVERITY_THRESHOLD GL_DEBUG_SEVERITY_HIGH
 
 using namespace BlueMarble;
 
+namespace
+{
+    // Triangulates a single ring of vertices
+    template <typename V>
+    bool triangulateRing(const std::vector<V>& vertices, std::vector<GLuint>& indices)
+    {
+        std::vector<double> x, y;
+        x.reserve(vertices.size());
+        y.reserve(vertices.size());
+        for (const auto& v : vertices)
+        {
+            x.push_back(v.position.x);
+            y.push_back(v.position.y);
+        }
+        size_t ringOffsets[] = { 0, vertices.size() };
+        return Triangulation::triangulate(x.data(), y.data(), ringOffsets, 1, indices);
+    }
+
+    // Normalized RGBA8, red in the lowest byte
+    uint32_t packColor(const Color& color)
+    {
+        auto alpha = (uint32_t)std::lround(std::clamp(color.a(), 0.0, 1.0)*255.0);
+        return (uint32_t)color.r() | (uint32_t)color.g() << 8 | (uint32_t)color.b() << 16 | alpha << 24;
+    }
+
+    // The position is stored relative to origin, so that it fits a float without losing precision
+    ColorVertex createVertex(const Point& point, const Point& origin, uint32_t color)
+    {
+        return ColorVertex{ glm::vec3(point.x() - origin.x(), point.y() - origin.y(), point.z() - origin.z()), color };
+    }
+
+    // Hash of the colors and width of a draw call, retained buffers are recreated when it changes
+    size_t styleHash(const std::vector<Color>& colors, double width)
+    {
+        size_t hash = std::hash<double>()(width);
+        for (const auto& c : colors)
+        {
+            hash = hash*31 + (size_t(c.r()) << 16 | size_t(c.g()) << 8 | size_t(c.b()));
+            hash = hash*31 + std::hash<double>()(c.a());
+        }
+        return hash;
+    }
+
+    // Cells averaged per axis for a texel of a downsampled tile. Spread over the step x step cells of the texel
+    // in a rotated grid, such that the samples do not line up with a regular pattern of the cells.
+    constexpr int MaxSamplesPerAxis = 4;
+
+    template <int Channels>
+    inline void readCell(const uint8_t* src, uint32_t& r, uint32_t& g, uint32_t& b, uint32_t& a)
+    {
+        switch (Channels)
+        {
+        case 1: r = g = b = src[0]; a = 255; break;
+        case 2: r = g = b = src[0]; a = src[1]; break;
+        case 3: r = src[0]; g = src[1]; b = src[2]; a = 255; break;
+        default: r = src[0]; g = src[1]; b = src[2]; a = src[3]; break;
+        }
+    }
+
+    // Copies the cells [x0, x1) x [y0, y1) of an interleaved 8 bit raster with 1 (gray), 2 (gray, alpha),
+    // 3 (RGB) or 4 (RGBA) channels to an RGBA tile, a texel per step x step cells. Downsampled texels are the
+    // average of the cells (of MaxSamplesPerAxis^2 of them at most), the colors weighted by alpha such that
+    // transparent cells do not darken the edges.
+    template <int Channels>
+    void copyTile(const uint8_t* data, int width, int x0, int y0, int x1, int y1, int step, int tileSize, uint8_t* rgba)
+    {
+        int w = (x1 - x0 + step - 1)/step;
+        int h = (y1 - y0 + step - 1)/step;
+
+        // Offsets of the samples from the first cell of a texel of cellsX x cellsY cells
+        size_t offsets[MaxSamplesPerAxis*MaxSamplesPerAxis];
+        int n = 0;
+        int blockCellsX = 0, blockCellsY = 0;
+        auto sampleOffsets = [&](int cellsX, int cellsY)
+        {
+            int samplesX = std::min(cellsX, MaxSamplesPerAxis);
+            int samplesY = std::min(cellsY, MaxSamplesPerAxis);
+            n = samplesX*samplesY;
+            for (int sy = 0; sy < samplesY; sy++)
+            {
+                for (int sx = 0; sx < samplesX; sx++)
+                {
+                    // Every cell when the texel has no more cells than samples
+                    int x = (sx*samplesY + sy)*cellsX/n;
+                    int y = (sy*samplesX + sx)*cellsY/n;
+                    offsets[sy*samplesX + sx] = ((size_t)y*width + x)*Channels;
+                }
+            }
+            blockCellsX = cellsX;
+            blockCellsY = cellsY;
+        };
+
+        for (int j = 0; j < h; j++)
+        {
+            uint8_t* dst = rgba + (size_t)j*tileSize*4;
+            if (step == 1)
+            {
+                const uint8_t* src = data + ((size_t)(y0 + j)*width + x0)*Channels;
+                if (Channels == 4)
+                {
+                    std::memcpy(dst, src, (size_t)w*4);
+                    continue;
+                }
+                for (int i = 0; i < w; i++, src += Channels, dst += 4)
+                {
+                    uint32_t r, g, b, a;
+                    readCell<Channels>(src, r, g, b, a);
+                    dst[0] = (uint8_t)r; dst[1] = (uint8_t)g; dst[2] = (uint8_t)b; dst[3] = (uint8_t)a;
+                }
+                continue;
+            }
+
+            int cellY0 = y0 + j*step;
+            int cellsY = std::min(step, y1 - cellY0);
+            for (int i = 0; i < w; i++, dst += 4)
+            {
+                int cellX0 = x0 + i*step;
+                int cellsX = std::min(step, x1 - cellX0);
+                if (cellsX != blockCellsX || cellsY != blockCellsY)
+                {
+                    // The first texel, or one at the edge of the raster
+                    sampleOffsets(cellsX, cellsY);
+                }
+
+                const uint8_t* block = data + ((size_t)cellY0*width + cellX0)*Channels;
+                uint32_t sumR = 0, sumG = 0, sumB = 0, sumA = 0;
+                for (int k = 0; k < n; k++)
+                {
+                    uint32_t r, g, b, a;
+                    readCell<Channels>(block + offsets[k], r, g, b, a);
+                    sumR += r*a;
+                    sumG += g*a;
+                    sumB += b*a;
+                    sumA += a;
+                }
+                if (sumA > 0)
+                {
+                    dst[0] = (uint8_t)((sumR + sumA/2)/sumA);
+                    dst[1] = (uint8_t)((sumG + sumA/2)/sumA);
+                    dst[2] = (uint8_t)((sumB + sumA/2)/sumA);
+                }
+                else
+                {
+                    dst[0] = dst[1] = dst[2] = 0;
+                }
+                dst[3] = (uint8_t)((sumA + n/2)/(uint32_t)n);
+            }
+        }
+    }
+
+    void copyTile(const uint8_t* data, int width, int channels, int x0, int y0, int x1, int y1, int step, int tileSize, uint8_t* rgba)
+    {
+        switch (channels)
+        {
+        case 1: copyTile<1>(data, width, x0, y0, x1, y1, step, tileSize, rgba); break;
+        case 2: copyTile<2>(data, width, x0, y0, x1, y1, step, tileSize, rgba); break;
+        case 3: copyTile<3>(data, width, x0, y0, x1, y1, step, tileSize, rgba); break;
+        default: copyTile<4>(data, width, x0, y0, x1, y1, step, tileSize, rgba); break;
+        }
+    }
+
+    // Lines also depend on the joins and caps of the pen
+    size_t styleHash(const Pen& pen)
+    {
+        size_t hash = styleHash(pen.getColors(), pen.getThickness());
+        hash = hash*31 + (size_t(pen.getJoin()) << 2 | size_t(pen.getCap()));
+        hash = hash*31 + std::hash<double>()(pen.getMiterLimit());
+        return hash;
+    }
+}
+
 void GLAPIENTRY BlueMarble::OpenGLDrawable::MessageCallback(GLenum source,
     GLenum type,
     GLuint id,
@@ -91,18 +265,34 @@ void GLAPIENTRY BlueMarble::OpenGLDrawable::MessageCallback(GLenum source,
 }
 
 BlueMarble::OpenGLDrawable::OpenGLDrawable(int width, int height, int colorDepth)
-    : m_primitives()
-    , m_transform()
-    , m_width(width)
+    : m_width(width)
     , m_height(height)
+    , m_transform()
     , m_viewMatrix(glm::mat4x4(1))
     , m_projectionMatrix(glm::mat4x4(1))
     , m_renderOrigin(0.0)
     , m_color(Color::white())
+    , m_frameBuffer(0)
+    , m_frameTexture(0)
+    , m_clipRect(Rectangle::undefined())
+    , m_symbolInstances()
+    , m_rasterMemoryBudget(128*1024*1024)
+    , m_rasterUploadsPerFrame(16)
+    , m_rasterUploads(0)
+    , m_complete(true)
+    , m_retainedMode(true)
+    , m_frame(0)
+    , m_retained()
+    , m_retainedPolygons(std::make_shared<RetainedBuffer>(VertexLayout::colorVertex()))
+    , m_retainedLines(std::make_shared<RetainedBuffer>(VertexLayout::lineVertex()))
+    , m_retainedPolygonDraws()
+    , m_retainedLineDraws()
 {
     //glDisable(GL_CULL_FACE);
     glDebugMessageCallback(MessageCallback, 0);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // Alpha is accumulated such that drawing onto a transparent black background gives
+    // colors premultiplied by alpha, see Raster::unpremultiplyAlpha()
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 	glEnable(GL_BLEND);
     m_basicShader = std::make_shared<Shader>();
     m_basicShader->linkProgram("Shaders/basic.vert", "Shaders/basic.frag");
@@ -110,10 +300,48 @@ BlueMarble::OpenGLDrawable::OpenGLDrawable(int width, int height, int colorDepth
     m_polyShader->linkProgram("Shaders/polygon.vert", "Shaders/polygon.frag");
     m_lineShader = std::make_shared<Shader>();
     m_lineShader->linkProgram("Shaders/line.vert", "Shaders/line.frag");
+    m_symbolShader = std::make_shared<Shader>();
+    m_symbolShader->linkProgram("Shaders/symbol.vert", "Shaders/symbol.frag");
+    m_rasterShader = std::make_shared<Shader>();
+    m_rasterShader->linkProgram("Shaders/raster.vert", "Shaders/raster.frag");
 
     resize(m_width, m_height);
 }
 
+BlueMarble::OpenGLDrawable::~OpenGLDrawable()
+{
+    glDeleteFramebuffers(1, &m_frameBuffer);
+    glDeleteTextures(1, &m_frameTexture);
+}
+
+void BlueMarble::OpenGLDrawable::createFrameBuffer()
+{
+    if (m_frameBuffer == 0)
+    {
+        glGenFramebuffers(1, &m_frameBuffer);
+        glGenTextures(1, &m_frameTexture);
+    }
+    glBindTexture(GL_TEXTURE_2D, m_frameTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, std::max(1, m_width), std::max(1, m_height), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_frameBuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_frameTexture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        throw std::runtime_error("OpenGLDrawable::createFrameBuffer() Incomplete frame buffer");
+    }
+}
+
+void BlueMarble::OpenGLDrawable::makeCurrent()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, m_frameBuffer);
+    glViewport(0, 0, m_width, m_height);
+    setClipRect(m_clipRect);
+}
+
 int BlueMarble::OpenGLDrawable::width() const
 {
     return m_width;
@@ -146,6 +374,8 @@ void BlueMarble::OpenGLDrawable::resize(int width, int height)
     m_height = height;
     //std::cout << "I shalle be doing a glViewPort resize yes" << "\n";
     glViewport(0, 0, width, height);
+    createFrameBuffer();
+    setClipRect(Rectangle::undefined());
 
     float w2 = width * 0.5;
     float h2 = height * 0.5;
@@ -185,16 +415,19 @@ void BlueMarble::OpenGLDrawable::setTransform(const Transform &transform)
     double scaleY = m_transform.scaleY();
     double rotation = m_transform.rotation() * DEG_TO_RAD;
 
+    // The vertices are made relative to the center, map coordinates (e.g. mercator meters) are too
+    // large to be translated in float precision
     glm::mat4 view = glm::mat4(1.0f);
     view = glm::rotate(view, -(float)rotation, glm::vec3(0.0f, 0.0f, 1.0f));
     view = glm::scale(view, glm::vec3(scaleX, scaleY, 1.0f));
     view = glm::translate(view, glm::vec3(
-        -center.x(),
-        -center.y(),
+        0.0f,
+        0.0f,
         -1.0/scaleX
     ));
 
     m_viewMatrix = view;
+    m_renderOrigin = Point(center.x(), center.y(), 0.0);
     return;
 
     // Fake ortho/2.5 d camera
@@ -245,6 +478,7 @@ void BlueMarble::OpenGLDrawable::setTransform(const Transform &transform)
 
 void BlueMarble::OpenGLDrawable::beginBatches()
 {
+    makeCurrent();
     if (lineBatch)
     {
         lineBatch->begin();
@@ -258,21 +492,139 @@ void BlueMarble::OpenGLDrawable::beginBatches()
 void BlueMarble::OpenGLDrawable::endBatches()
 {
     auto mat = glm::mat4(m_projectionMatrix * m_viewMatrix);
+    if (polyBatch || !m_retainedPolygonDraws.empty())
+    {
+        flushPolygons();
+    }
+    if (lineBatch || !m_retainedLineDraws.empty())
+    {
+        flushLines();
+    }
+    if (!m_symbolInstances.empty())
+    {
+        m_symbolShader->useProgram();
+        m_symbolShader->setMat4("viewMatrix", mat);
+        m_circleSymbol->draw(m_symbolInstances);
+        m_symbolInstances.clear();
+    }
+}
+
+void BlueMarble::OpenGLDrawable::flushPolygons()
+{
+    auto mat = glm::mat4(m_projectionMatrix * m_viewMatrix);
+    m_polyShader->useProgram();
+    m_polyShader->setMat4("viewMatrix", mat);
     if (polyBatch)
     {
-        auto renderOrigin = glm::vec3(0.0f);
-        m_polyShader->useProgram();
-        m_polyShader->setMat4("viewMatrix", mat);
-        polyBatch->end();
         polyBatch->flush();
     }
+    drawRetained(*m_retainedPolygons, m_retainedPolygonDraws, m_polyShader);
+}
+
+void BlueMarble::OpenGLDrawable::flushLines()
+{
+    auto mat = glm::mat4(m_projectionMatrix * m_viewMatrix);
+    auto viewportSize = glm::vec2((float)m_width, (float)m_height);
+    m_lineShader->useProgram();
+    m_lineShader->setMat4("viewMatrix", mat);
+    m_lineShader->setVec2("viewportSize", viewportSize);
     if (lineBatch)
     {
-        m_lineShader->useProgram();
-        m_lineShader->setMat4("viewMatrix", mat);
-        lineBatch->end();
         lineBatch->flush();
     }
+    drawRetained(*m_retainedLines, m_retainedLineDraws, m_lineShader);
+}
+
+void BlueMarble::OpenGLDrawable::retainedMode(bool enabled)
+{
+    m_retainedMode = enabled;
+    if (!enabled)
+    {
+        m_retained.clear();
+        m_retainedPolygons->clear();
+        m_retainedLines->clear();
+    }
+}
+
+bool BlueMarble::OpenGLDrawable::retainedMode() const
+{
+    return m_retainedMode;
+}
+
+size_t BlueMarble::OpenGLDrawable::retainedCount() const
+{
+    size_t count = 0;
+    for (const auto& it : m_retained)
+    {
+        count += it.second.allocation.page != 0 ? 1 : 0;
+    }
+    return count;
+}
+
+RetainedBufferStats BlueMarble::OpenGLDrawable::retainedStats() const
+{
+    RetainedBufferStats stats = m_retainedPolygons->stats();
+    RetainedBufferStats lineStats = m_retainedLines->stats();
+    stats.pages += lineStats.pages;
+    stats.drawCalls += lineStats.drawCalls;
+    stats.draws += lineStats.draws;
+    return stats;
+}
+
+BatchStats BlueMarble::OpenGLDrawable::batchStats() const
+{
+    BatchStats stats;
+    if (polyBatch)
+    {
+        stats += polyBatch->stats();
+    }
+    if (lineBatch)
+    {
+        stats += lineBatch->stats();
+    }
+    return stats;
+}
+
+BlueMarble::OpenGLDrawable::RetainedGeometry* BlueMarble::OpenGLDrawable::findRetained(const GeometryPtr& geometry, size_t style, bool isPolygon)
+{
+    auto& entry = m_retained[RetainedKey{ geometry.get(), style, isPolygon }];
+
+    bool sameGeometry = !entry.geometry.expired() && !entry.geometry.owner_before(geometry) && !geometry.owner_before(entry.geometry);
+    if (!sameGeometry || entry.version != geometry->version())
+    {
+        // New or modified, drawn through the batches until it is seen unchanged in a later frame
+        entry.geometry = geometry;
+        entry.version = geometry->version();
+        entry.firstFrame = m_frame;
+        releaseRetained(entry, isPolygon);
+    }
+    else if ((isPolygon ? m_retainedPolygons : m_retainedLines)->isStale(entry.allocation))
+    {
+        // Added again right away, such that the mostly unused page it is in can be freed
+        releaseRetained(entry, isPolygon);
+    }
+    entry.lastFrame = m_frame;
+
+    return &entry;
+}
+
+void BlueMarble::OpenGLDrawable::releaseRetained(RetainedGeometry& retained, bool isPolygon)
+{
+    (isPolygon ? m_retainedPolygons : m_retainedLines)->release(retained.allocation);
+    retained.allocation = RetainedBuffer::Allocation();
+}
+
+void BlueMarble::OpenGLDrawable::drawRetained(RetainedBuffer& buffer, std::vector<RetainedBuffer::Allocation>& draws, const ShaderPtr& shader)
+{
+    // The retained vertices are relative to the origin of their page, the offset to the render origin
+    // is added to the matrix in double precision
+    buffer.draw(draws, [this, &shader](const glm::dvec3& origin)
+    {
+        glm::dvec3 offset(origin.x - m_renderOrigin.x(), origin.y - m_renderOrigin.y(), origin.z - m_renderOrigin.z());
+        glm::mat4 mat = glm::mat4(m_projectionMatrix * m_viewMatrix * glm::translate(glm::dmat4(1.0), offset));
+        shader->setMat4("viewMatrix", mat);
+    });
+    draws.clear();
 }
 
 void BlueMarble::OpenGLDrawable::drawCircle(double cx, double cy, double radius, const Pen& pen, const Brush& brush)
@@ -284,10 +636,10 @@ void BlueMarble::OpenGLDrawable::drawArc(double cx, double cy, double rx, double
 {
     if (polyBatch == nullptr)
     {
-        polyBatch = std::make_shared<Batch>(true);
+        polyBatch = std::make_shared<Batch>(GL_TRIANGLES, VertexLayout::colorVertex());
         polyBatch->begin();
     }
-    std::vector<Vertice> vertices;
+    std::vector<ColorVertex> vertices;
     std::vector<GLuint> indices;
     std::vector<Color>  colors = brush.getColors();
     if (colors.empty())
@@ -308,9 +660,7 @@ void BlueMarble::OpenGLDrawable::drawArc(double cx, double cy, double rx, double
     for (int i = 0; i < 32; i++)
     {
         Color color = getColorFromList(colors, i);
-        auto v = createPoint(Point(x * rx + cx, y * ry + cy, 0), color);
-        v.texCoord = glm::vec2(0, 0);
-        vertices.push_back(v);
+        vertices.push_back(createVertex(Point(x * rx + cx, y * ry + cy, 0), m_renderOrigin, packColor(color)));
 
         t = x;
         x = c * x - s * y;
@@ -318,15 +668,42 @@ void BlueMarble::OpenGLDrawable::drawArc(double cx, double cy, double rx, double
     }
 
     if (vertices.empty()) return;
-    std::vector<Vertice> holes, triangles;
-    vertices.push_back(vertices[0]);
-    if (Algorithms::triangulatePolygon(vertices, holes, triangles, indices, false) == false)
+    // Points on an ellipse make a convex ring, a fan covers it without triangulating
+    for (size_t i = 1; i + 1 < vertices.size(); i++)
     {
-        std::cout << "Couldn't draw object due to not being able to triangulate it" << std::endl;
-        return;
+        indices.push_back(0);
+        indices.push_back((GLuint)i);
+        indices.push_back((GLuint)i + 1);
+    }
+    if (!m_retainedPolygonDraws.empty())
+    {
+        flushPolygons();
     }
     polyBatch->submit(vertices, indices);
-    lineBatch->submit(vertices, indices);
+
+    // Outline
+    if (pen.getThickness() > 0.0 && pen.getColor().a() > 0.0)
+    {
+        if (lineBatch == nullptr)
+        {
+            lineBatch = std::make_shared<Batch>(GL_TRIANGLES, VertexLayout::lineVertex());
+            lineBatch->begin();
+        }
+        std::vector<double> ringX, ringY;
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            ringX.push_back(vertices[i].position.x);
+            ringY.push_back(vertices[i].position.y);
+        }
+        if (tessellateLine(ringX.data(), ringY.data(), nullptr, ringX.size(), true, pen, Point(0.0, 0.0), m_lineVertices, m_lineIndices))
+        {
+            if (!m_retainedLineDraws.empty())
+            {
+                flushLines();
+            }
+            lineBatch->submit(m_lineVertices, m_lineIndices);
+        }
+    }
     //drawLine(lineGeom, pen);
     // #define ARC_SEGMENTS 32
 
@@ -446,61 +823,150 @@ void BlueMarble::OpenGLDrawable::drawArc(double cx, double cy, double rx, double
     // glEnd(); 
 }
 
+void BlueMarble::OpenGLDrawable::drawSymbols(const std::vector<SymbolInstance>& symbols)
+{
+    if (m_circleSymbol == nullptr)
+    {
+        std::vector<glm::vec2> vertices;
+        std::vector<GLuint> indices;
+        InstancedMesh::circle(32, vertices, indices);
+        m_circleSymbol = std::make_shared<InstancedMesh>(vertices, indices, VertexLayout::symbolInstance());
+    }
+    // Only the instance attributes are written here, all symbols are drawn with one call in endBatches()
+    m_symbolInstances.reserve(m_symbolInstances.size() + symbols.size());
+    for (const auto& symbol : symbols)
+    {
+        ColorVertex vertex = createVertex(symbol.position, m_renderOrigin, packColor(symbol.color));
+        m_symbolInstances.push_back(SymbolVertex{ vertex.position, (float)symbol.size, (float)(symbol.rotation*DEG_TO_RAD), vertex.color });
+    }
+}
+
+bool BlueMarble::OpenGLDrawable::tessellateLine(const double* x, const double* y, const double* z, size_t n, bool closed,
+                                                const Pen& pen, const Point& origin, std::vector<LineVertex>& vertices, std::vector<GLuint>& indices)
+{
+    vertices.clear();
+    indices.clear();
+    m_tessellation.clear();
+    if (!LineTessellation::tessellate(x, y, n, closed, pen, m_tessellation, indices))
+    {
+        return false;
+    }
+
+    const std::vector<Color>& colors = pen.getColors();
+    vertices.reserve(m_tessellation.size());
+    for (const auto& v : m_tessellation)
+    {
+        Point point(x[v.point], y[v.point], z != nullptr ? z[v.point] : 0.0);
+        ColorVertex vertex = createVertex(point, origin, packColor(getColorFromList(colors, v.point)));
+        vertices.push_back(LineVertex{ vertex.position, vertex.color, glm::vec2(v.offsetX, v.offsetY) });
+    }
+    return true;
+}
+
 void BlueMarble::OpenGLDrawable::drawLine(const LineGeometryPtr& geometry, const Pen& pen)
 {
     if (lineBatch == nullptr)
     {
-        lineBatch = std::make_shared<Batch>(false);
+        lineBatch = std::make_shared<Batch>(GL_TRIANGLES, VertexLayout::lineVertex());
         lineBatch->begin();
     }
-    std::vector<Vertice> vertices;
-    vertices.reserve(geometry->isClosed() ? geometry->points().size()+1 : geometry->points().size());
+    // Read directly from the coordinate buffer, avoids copying the points
+    const CoordinateBuffer& coordinates = geometry->coordinates();
+    if (coordinates.empty()) return;
 
-    const std::vector<Point>& bounds = geometry->points();
-    const std::vector<Color>& colors = pen.getColors();
+    RetainedGeometry* retained = m_retainedMode ? findRetained(geometry, styleHash(pen), false) : nullptr;
+    if (retained != nullptr && retained->allocation.page != 0)
+    {
+        m_retainedLineDraws.push_back(retained->allocation);
+        return;
+    }
 
-    for (int i = 0; i < bounds.size(); i++)
+    // Retained vertices are relative to the origin of their page, batched ones to the render origin
+    bool retain = retained != nullptr && retained->firstFrame < m_frame;
+    RetainedBuffer::Placement placement;
+    Point origin = m_renderOrigin;
+    if (retain)
     {
-        Color bmColor = getColorFromList(colors, i);
-        vertices.push_back(createPoint(bounds.at(i), bmColor));
+        auto bounds = geometry->calculateBounds();
+        placement = m_retainedLines->place(bounds.xMin(), bounds.yMin(), bounds.xMax(), bounds.yMax());
+        origin = Point(placement.origin.x, placement.origin.y, placement.origin.z);
+    }
+    const double* z = coordinates.hasZ() ? coordinates.z().data() : nullptr;
+    if (!tessellateLine(coordinates.x().data(), coordinates.y().data(), z, coordinates.size(), geometry->isClosed(),
+                        pen, origin, m_lineVertices, m_lineIndices))
+    {
+        return;
     }
 
-    if (geometry->isClosed())
+    if (retain)
     {
-        vertices.push_back(vertices[0]);
+        // Unchanged since an earlier frame, upload once and draw from the retained buffers from now on
+        retained->allocation = m_retainedLines->add(placement, m_lineVertices, m_lineIndices);
+        m_retainedLineDraws.push_back(retained->allocation);
+        return;
     }
-    if (vertices.empty()) return;
-    lineBatch->submit(vertices);
+    if (!m_retainedLineDraws.empty())
+    {
+        flushLines();
+    }
+    lineBatch->submit(m_lineVertices, m_lineIndices);
 }
 
 void BlueMarble::OpenGLDrawable::drawPolygon(const PolygonGeometryPtr& geometry, const Pen& pen, const Brush& brush)
 {
     if (polyBatch == nullptr)
     {
-        polyBatch = std::make_shared<Batch>(true);
+        polyBatch = std::make_shared<Batch>(GL_TRIANGLES, VertexLayout::colorVertex());
         polyBatch->begin();
     }
-    std::vector<Vertice> vertices;
-    std::vector<GLuint> indices;
+    const CoordinateBuffer& coordinates = geometry->coordinates();
+    if (coordinates.empty()) return;
 
-    const std::vector<Point>& bounds = geometry->outerRing();
-    const std::vector<Color>& colors = brush.getColors();
+    RetainedGeometry* retained = m_retainedMode ? findRetained(geometry, styleHash(brush.getColors(), 0.0), true) : nullptr;
+    if (retained != nullptr && retained->allocation.page != 0)
+    {
+        m_retainedPolygonDraws.push_back(retained->allocation);
+        return;
+    }
 
-    for (int i = 0; i < bounds.size(); i++)
+    // Triangulated once per version of the geometry, the indices cover all rings
+    auto indices = geometry->triangulation();
+    if (indices->empty())
+    {
+        std::cout << "Couldn't draw object due to not being able to triangulate it" << std::endl;
+        return;
+    }
+
+    bool retain = retained != nullptr && retained->firstFrame < m_frame;
+    RetainedBuffer::Placement placement;
+    Point origin = m_renderOrigin;
+    if (retain)
+    {
+        auto bounds = geometry->calculateBounds();
+        placement = m_retainedPolygons->place(bounds.xMin(), bounds.yMin(), bounds.xMax(), bounds.yMax());
+        origin = Point(placement.origin.x, placement.origin.y, placement.origin.z);
+    }
+    const std::vector<Color>& colors = brush.getColors();
+    std::vector<ColorVertex> vertices;
+    vertices.reserve(coordinates.size());
+    for (size_t i = 0; i < coordinates.size(); i++)
     {
         Color bmColor = getColorFromList(colors, i);
-        vertices.push_back(createPoint(bounds[i], bmColor));
+        vertices.push_back(createVertex(coordinates.point(i), origin, packColor(bmColor)));
     }
-    if (vertices.empty()) return;
-    std::vector<Vertice> triangles;
-    std::vector<Vertice> holes;
-    if (Algorithms::triangulatePolygon(vertices, holes, triangles, indices, false) == false)
+
+    if (retain)
     {
-        std::cout << "Couldn't draw object due to not being able to triangulate it" << std::endl;
+        // Unchanged since an earlier frame, upload once and draw from the retained buffers from now on
+        retained->allocation = m_retainedPolygons->add(placement, vertices, *indices);
+        m_retainedPolygonDraws.push_back(retained->allocation);
         return;
     }
-    if (vertices.empty()) return;
-    polyBatch->submit(vertices,indices);
+    if (!m_retainedPolygonDraws.empty())
+    {
+        flushPolygons();
+    }
+    polyBatch->submit(vertices, *indices);
 }
 
 void BlueMarble::OpenGLDrawable::drawRect(const Point& topLeft, const Point& bottomRight, const Color& color)
@@ -528,122 +994,150 @@ unsigned char* readImage(std::string path, int* width, int* height, int* nrOfCha
 
 void BlueMarble::OpenGLDrawable::drawRaster(const RasterGeometryPtr& raster, const Brush& brush, const Rectangle& clip)
 {
-    if (m_primitives.find(raster->getID()) == m_primitives.end())
-    {
-        #define MAX_TEXTURE_SIZE 16384
-        
-        int W = raster->raster().width();
-        int H = raster->raster().height();
-        RasterGeometryPtr raceter = raster;
-        if (W > MAX_TEXTURE_SIZE || H > MAX_TEXTURE_SIZE)
-        {
-            BMM_DEBUG() << "Resizing raster that is too large to put in a texture!\n";
-            raceter = std::dynamic_pointer_cast<RasterGeometry>(raster->deepClone()); // Keeps unique id
-            int newW = std::min(W, MAX_TEXTURE_SIZE);
-            int newH = std::min(H, MAX_TEXTURE_SIZE);
-            raceter->raster().resize(newW, newH);
-        }
-        
-
-        const std::vector<Point>& bounds = raster->bounds().corners();
-        const std::vector<Color>& colors = brush.getColors();
-        std::vector<Vertice> vertices;
+    const Raster& r = raster->raster();
+    int width = r.width();
+    int height = r.height();
+    if (width <= 0 || height <= 0 || r.data() == nullptr) return;
 
-        for (int i = 0; i < bounds.size(); i++)
-        {
-            glm::vec3 pos(bounds[i].x(), bounds[i].y(), 0);
-
-            Color bmColor = getColorFromList(brush.getColors(), i);
-            glm::vec4 glColor((float)bmColor.r()/255, (float)bmColor.g() / 255, (float)bmColor.b() / 255, bmColor.a());
-
-            float texCoordX = i == 0 || i == 3 ? 0.0 : 1.0;
-            float texCoordY = i < 2 ? 1.0 : 0.0;
-            
-            glm::vec2 textureCoords(texCoordX, texCoordY);
-
-            vertices.push_back(Vertice{ pos, glColor, textureCoords});
-        }
-        if (vertices.empty()) return;
-
-        std::vector<GLuint> indices;
-        std::vector<Vertice> triangles;
-        std::vector<Vertice> holes;
-        if (Algorithms::triangulatePolygon(vertices, holes, triangles, indices,false) == false)
-        {
-            std::cout << "Couldn't draw object due to not being able to triangulate it" << std::endl;
-            return;
-        }
-
-        RectGeometryInfoPtr info = std::make_shared<RectGeometryInfo>();
-        info->m_hasFill = true;
-
-        info->m_shader = m_basicShader;
-
-        GLint texIndex = 0;
-        info->m_texture = std::make_shared<Texture>();
-        
-        Raster& r = raceter->raster();
-        info->m_texture->init((unsigned char*)r.data(), r.width(), r.height(), r.channels(), GL_UNSIGNED_BYTE, texIndex);
-
-        info->m_shader->useProgram();
-        info->m_shader->setInt("texture0", texIndex);
-
-        RectPtr rect = std::make_shared<Rect>(info, vertices, indices);
-        m_primitives[raster->getID()] = rect;
+    if (m_rasterAtlas == nullptr)
+    {
+        m_rasterAtlas = std::make_shared<TextureAtlas>(RasterTileSize, m_rasterMemoryBudget);
     }
-    //std::cout << "Drawing raster with id: " << raster->getID() << "\n";
-    RectPtr rect = std::static_pointer_cast<Rect>(m_primitives[raster->getID()]);
-    if (rect == nullptr) 
+    if (m_rasterBatch == nullptr)
     {
-        std::cout << "Couldn't find rect primitive for raster with id: " << raster->getID() << "\n";
-        return;
+        m_rasterBatch = std::make_shared<Batch>(GL_TRIANGLES, VertexLayout::rasterVertex());
     }
-    
+    int tileSize = m_rasterAtlas->tileSize();
+
+    // Level of detail, tiles of level n hold every 2^n:th cell, such that a cell is about a pixel or larger.
+    // Large rasters are drawn from a few coarse tiles when zoomed out, and from the visible full resolution tiles
+    // when zoomed in, instead of being resized to fit one texture.
+    glm::dmat4 mat = m_projectionMatrix*m_viewMatrix;
+    double pixelsPerUnit = glm::length(glm::dvec2(mat[0][0]*m_width*0.5, mat[0][1]*m_height*0.5));
+    double cellsPerPixel = 1.0/(raster->cellWidth()*pixelsPerUnit);
+    int maxLevel = 0;
+    while ((std::max(width, height) >> maxLevel) > tileSize)
+    {
+        maxLevel++;
+    }
+    int level = std::isfinite(cellsPerPixel) && cellsPerPixel >= 2.0 ? std::min((int)std::log2(cellsPerPixel), maxLevel) : 0;
+    int span = tileSize << level; // Cells per tile side
+
+    // Tiles overlapping the clip area
+    Rectangle bounds = raster->bounds();
+    Rectangle area = clip.isUndefined() ? bounds : clip;
+    if (!area.overlap(bounds)) return;
+    double cellWidth = raster->cellWidth();
+    double cellHeight = raster->cellHeight();
+    int cols = (width + span - 1)/span;
+    int rows = (height + span - 1)/span;
+    int col0 = std::clamp((int)std::floor((area.xMin() - bounds.xMin())/cellWidth/span), 0, cols - 1);
+    int col1 = std::clamp((int)std::floor((area.xMax() - bounds.xMin())/cellWidth/span), 0, cols - 1);
+    int row0 = std::clamp((int)std::floor((bounds.yMax() - area.yMax())/cellHeight/span), 0, rows - 1);
+    int row1 = std::clamp((int)std::floor((bounds.yMax() - area.yMin())/cellHeight/span), 0, rows - 1);
+
+    glm::mat4 viewMatrix = glm::mat4(mat);
+    GLint unit = 0;
+    m_rasterShader->useProgram();
+    m_rasterShader->setMat4("viewMatrix", viewMatrix);
+    m_rasterShader->setInt("atlas", unit);
+    m_rasterAtlas->bind(unit);
+
+    uint32_t color = packColor(getColorFromList(brush.getColors(), 0));
+    const uint8_t* data = (const uint8_t*)r.data();
+    int channels = r.channels();
+    auto flush = [this]() { m_rasterBatch->flush(); };
+
+    m_rasterIndices = { 0, 1, 2, 0, 2, 3 };
+    m_rasterBatch->begin();
+    m_rasterAtlas->beginUse();
+    for (int row = row0; row <= row1; row++)
+    {
+        for (int col = col0; col <= col1; col++)
+        {
+            int x0 = col*span;
+            int y0 = row*span;
+            int x1 = std::min(x0 + span, width);
+            int y1 = std::min(y0 + span, height);
+
+            // Uploaded through the staging buffer of the atlas when not resident, up to the uploads per frame.
+            // Then drawn from the tile of a coarser level holding the cells, the coarsest level is one tile that
+            // is always uploaded, such that the whole raster is drawn.
+            GLint layer = -1;
+            int tileLevel = level;
+            for (; tileLevel <= maxLevel && layer < 0; tileLevel++)
+            {
+                int tileSpan = tileSize << tileLevel;
+                int tileCol = x0/tileSpan;
+                int tileRow = y0/tileSpan;
+                AtlasKey key{ raster->getID(), raster->version(), tileLevel, tileCol, tileRow };
+                layer = m_rasterAtlas->acquireResident(key);
+                if (layer < 0 && (tileLevel == maxLevel || (tileLevel == level && m_rasterUploads < m_rasterUploadsPerFrame)))
+                {
+                    int tileX0 = tileCol*tileSpan;
+                    int tileY0 = tileRow*tileSpan;
+                    layer = m_rasterAtlas->acquire(key, [&](uint8_t* rgba)
+                    {
+                        copyTile(data, width, channels, tileX0, tileY0, std::min(tileX0 + tileSpan, width),
+                                 std::min(tileY0 + tileSpan, height), 1 << tileLevel, tileSize, rgba);
+                    }, flush);
+                    m_rasterUploads++;
+                }
+            }
+            tileLevel--;
+            if (tileLevel != level)
+            {
+                m_complete = false;
+            }
 
-    // Renderorigin test
-    std::vector<Vertice> vertices;
-    auto rasterBounds = raster->bounds();
-    auto clipped = clip.isUndefined() ? raster->bounds() : clip;
-    clipped = raster->bounds(); // Commentout to use provided "clip" rectangle
-    
-    const std::vector<Point>& bounds = clipped.corners();
-    const std::vector<Color>& colors = brush.getColors();
+            // The part of the tile covering the cells
+            int tileSpan = tileSize << tileLevel;
+            float s0 = float(double(x0 % tileSpan)/tileSpan);
+            float t0 = float(double(y0 % tileSpan)/tileSpan);
+            float s1 = s0 + float(double(x1 - x0)/tileSpan);
+            float t1 = t0 + float(double(y1 - y0)/tileSpan);
+            Point topLeft(bounds.xMin() + x0*cellWidth, bounds.yMax() - y0*cellHeight);
+            Point bottomRight(bounds.xMin() + x1*cellWidth, bounds.yMax() - y1*cellHeight);
+            auto vertex = [&](double x, double y, float s, float t)
+            {
+                ColorVertex corner = createVertex(Point(x, y), m_renderOrigin, color);
+                return RasterVertex{ corner.position, corner.color, glm::vec3(s, t, (float)layer) };
+            };
+            m_rasterVertices.clear();
+            m_rasterVertices.push_back(vertex(topLeft.x(), topLeft.y(), s0, t0));
+            m_rasterVertices.push_back(vertex(bottomRight.x(), topLeft.y(), s1, t0));
+            m_rasterVertices.push_back(vertex(bottomRight.x(), bottomRight.y(), s1, t1));
+            m_rasterVertices.push_back(vertex(topLeft.x(), bottomRight.y(), s0, t1));
+            m_rasterBatch->submit(m_rasterVertices, m_rasterIndices);
+        }
+    }
+    m_rasterBatch->end();
+}
 
-    double ratioW = clipped.width() / rasterBounds.width();
-    double ratioH = clipped.height() / rasterBounds.height();
-    
-    double xMinTex = (clipped.xMin()-rasterBounds.xMin()) / rasterBounds.width();
-    double yMaxTex = 1.0-(clipped.yMax()-rasterBounds.yMax()) / rasterBounds.height();
-    double xMaxTex = xMinTex + ratioW;
-    double yMinTex = yMaxTex + ratioH;
-    
-    // BMM_DEBUG() << "Raster bounds: " << raster->bounds().toString() << "\n";
-    for (int i = 0; i < bounds.size(); i++)
-    {
-        float texCoordX = i == 0 || i == 3 ? 0.0 : 1.0;
-        float texCoordY = i < 2 ? 1.0 : 0.0;
-        // double texCoordX = i == 0 || i == 3 ? xMinTex : xMaxTex;
-        // double texCoordY = i < 2 ? yMinTex : yMaxTex;
+void BlueMarble::OpenGLDrawable::rasterMemoryBudget(size_t bytes)
+{
+    m_rasterMemoryBudget = bytes;
+    m_rasterAtlas = nullptr; // Recreated with the new size
+}
 
-        glm::vec2 textureCoords((float)texCoordX, (float)texCoordY);
-        
-        // BMM_DEBUG() << "Tex coords: " << texCoordX << ", " << texCoordY << "\n";
+size_t BlueMarble::OpenGLDrawable::rasterMemoryBudget() const
+{
+    return m_rasterMemoryBudget;
+}
 
-        Color bmColor = getColorFromList(brush.getColors(), i);
-        Vertice v = createPoint(bounds[i], bmColor);
-        v.texCoord = textureCoords;
+void BlueMarble::OpenGLDrawable::rasterUploadsPerFrame(int uploads)
+{
+    m_rasterUploadsPerFrame = std::max(1, uploads);
+}
 
-        vertices.push_back(v);
-    }
+int BlueMarble::OpenGLDrawable::rasterUploadsPerFrame() const
+{
+    return m_rasterUploadsPerFrame;
+}
 
-    auto mat = glm::mat4(m_projectionMatrix*m_viewMatrix);
-    if (rect->getShader() != nullptr)
-    {
-        rect->getVbo().bufferData(vertices);
-        rect->getShader()->useProgram();
-        rect->getShader()->setMat4("viewMatrix", mat);
-    }
-    rect->drawIndex(6);
+TextureAtlasStats BlueMarble::OpenGLDrawable::rasterStats() const
+{
+    return m_rasterAtlas != nullptr ? m_rasterAtlas->stats() : TextureAtlasStats();
 }
 
 void BlueMarble::OpenGLDrawable::drawText(int x, int y, const std::string& text, const Color& color, int fontSize, const Color& backgroundColor)
@@ -654,8 +1148,9 @@ void BlueMarble::OpenGLDrawable::drawText(int x, int y, const std::string& text,
 
 Color BlueMarble::OpenGLDrawable::readPixel(int x, int y)
 {
+    makeCurrent();
     unsigned char data[4];
-    glReadBuffer(GL_BACK); // FIXME: front or back?
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
     glReadPixels(x, 
                 height()-y-1,
                 1, 
@@ -679,11 +1174,53 @@ void BlueMarble::OpenGLDrawable::setPixel(int x, int y, const Color& color)
 
 void BlueMarble::OpenGLDrawable::swapBuffers()
 {
+    // The whole frame buffer to the window, it keeps its content for the next frame
+    glDisable(GL_SCISSOR_TEST);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_frameBuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, m_width, m_height, 0, 0, m_width, m_height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
     glfwSwapBuffers(m_window);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_frameBuffer);
+    if (!m_clipRect.isUndefined())
+    {
+        glEnable(GL_SCISSOR_TEST);
+    }
 }
 
 void BlueMarble::OpenGLDrawable::clearBuffer()
 {
+    // A new frame. Release the retained buffers of geometries not drawn in the previous frame.
+    // A clipped frame redraws only some of the geometries, it is not counted as a frame of its own.
+    if (m_clipRect.isUndefined())
+    {
+        for (auto it = m_retained.begin(); it != m_retained.end();)
+        {
+            if (it->second.lastFrame < m_frame)
+            {
+                releaseRetained(it->second, it->first.isPolygon);
+                it = m_retained.erase(it);
+            }
+            else
+                ++it;
+        }
+        ++m_frame;
+    }
+    if (polyBatch)
+    {
+        polyBatch->nextFrame();
+    }
+    if (lineBatch)
+    {
+        lineBatch->nextFrame();
+    }
+    if (m_rasterBatch)
+    {
+        m_rasterBatch->nextFrame();
+    }
+    m_rasterUploads = 0;
+    m_complete = true;
+
+    makeCurrent();
     glClearColor(m_color.r()/255.0f, 
                  m_color.g()/255.0f, 
                  m_color.b()/255.0f, 
@@ -691,11 +1228,30 @@ void BlueMarble::OpenGLDrawable::clearBuffer()
     glClear(GL_COLOR_BUFFER_BIT);
 }
 
+void BlueMarble::OpenGLDrawable::setClipRect(const Rectangle& pixels)
+{
+    m_clipRect = pixels;
+    if (pixels.isUndefined())
+    {
+        glDisable(GL_SCISSOR_TEST);
+        return;
+    }
+
+    // Window coordinates have their origin at the bottom left
+    int x0 = std::clamp((int)std::floor(pixels.xMin()), 0, m_width);
+    int x1 = std::clamp((int)std::ceil(pixels.xMax()), x0, m_width);
+    int y0 = std::clamp((int)std::floor(pixels.yMin()), 0, m_height);
+    int y1 = std::clamp((int)std::ceil(pixels.yMax()), y0, m_height);
+    glScissor(x0, m_height - y1, x1 - x0, y1 - y0);
+    glEnable(GL_SCISSOR_TEST);
+}
+
 Raster BlueMarble::OpenGLDrawable::getRaster()
 {
+    makeCurrent();
     Raster raster(m_width, m_height, 4);
     unsigned char* data = (unsigned char*)(raster.data());
-    glReadBuffer(GL_FRONT); // FIXME: front or back?
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
     glReadPixels(0, 0, m_width, m_height,
                 GL_RGBA, GL_UNSIGNED_BYTE,
                 data);
@@ -707,9 +1263,27 @@ RendererImplementation BlueMarble::OpenGLDrawable::renderer()
     return RendererImplementation();
 }
 
+std::shared_ptr<Drawable> BlueMarble::OpenGLDrawable::createOffscreen(int width, int height)
+{
+    auto drawable = std::make_shared<BitmapOpenGLDrawable>(width, height);
+    makeCurrent(); // Creating the frame buffer of the new drawable bound it
+    return drawable;
+}
+
+bool BlueMarble::OpenGLDrawable::isComplete() const
+{
+    return m_complete;
+}
+
 void BlueMarble::OpenGLDrawable::flushCache()
 {
-    m_primitives.clear();
+    m_retained.clear();
+    m_retainedPolygons->clear();
+    m_retainedLines->clear();
+    if (m_rasterAtlas)
+    {
+        m_rasterAtlas->clear();
+    }
 }
 
 glm::mat4x4 BlueMarble::OpenGLDrawable::transformToMatrix(const Transform &transform)
@@ -725,14 +1299,6 @@ glm::mat4x4 BlueMarble::OpenGLDrawable::transformToMatrix(const Transform &trans
     return mat;
 }
 
-Vertice BlueMarble::OpenGLDrawable::createPoint(const Point& point, Color color)
-{
-    auto p = point - m_renderOrigin;
-    glm::vec3 pos(p.x(), p.y(), p.z());
-    glm::vec4 glColor((float)color.r() / 255, (float)color.g() / 255, (float)color.b() / 255, color.a());
-    return Vertice{ pos, glColor };
-}
-
 Color BlueMarble::OpenGLDrawable::getColorFromList(const std::vector<Color>& colors, int index)
 {
     if (index < colors.size())
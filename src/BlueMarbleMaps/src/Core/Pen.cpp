@@ -14,6 +14,9 @@ namespace BlueMarble
         , m_thickness(thickness)
         , m_properties(properties)
 		, m_antiAlias(false)
+		, m_join(Join::Miter)
+		, m_cap(Cap::Butt)
+		, m_miterLimit(4.0)
     {
 		m_colors.push_back(color);
 	}
@@ -23,6 +26,9 @@ namespace BlueMarble
 		, m_thickness(thickness)
 		, m_properties(properties)
 		, m_antiAlias(false)
+		, m_join(Join::Miter)
+		, m_cap(Cap::Butt)
+		, m_miterLimit(4.0)
 	{
 		
 	}
@@ -93,4 +99,34 @@ namespace BlueMarble
 	{
 		return m_properties;
 	}
+
+	void Pen::setJoin(Pen::Join join)
+	{
+		m_join = join;
+	}
+
+	Pen::Join Pen::getJoin() const
+	{
+		return m_join;
+	}
+
+	void Pen::setCap(Pen::Cap cap)
+	{
+		m_cap = cap;
+	}
+
+	Pen::Cap Pen::getCap() const
+	{
+		return m_cap;
+	}
+
+	void Pen::setMiterLimit(double miterLimit)
+	{
+		m_miterLimit = miterLimit;
+	}
+
+	double Pen::getMiterLimit() const
+	{
+		return m_miterLimit;
+	}
 }
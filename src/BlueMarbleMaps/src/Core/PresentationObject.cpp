@@ -1,5 +1,6 @@
 #include "BlueMarbleMaps/Core/PresentationObject.h"
 #include "BlueMarbleMaps/Utility/Utils.h"
+#include "BlueMarbleMaps/Core/GeometryPredicates.h"
 #include "BlueMarbleMaps/Core/Map.h"
 
 using namespace BlueMarble;
@@ -78,17 +79,13 @@ bool BlueMarble::hitTestPoint(double x, double y, double pointerRadius, PointGeo
 bool BlueMarble::hitTestLine(double x, double y, double pointerRadius, LineGeometryPtr geometry)
 {
     // std::cout << "hitTestLine\n";
-    auto& line = geometry->points();
-    auto p = Point(x, y);
-    for (int i(0); i < line.size()-1; i++)
+    const auto& coordinates = geometry->coordinates();
+    if (coordinates.size() < 2)
     {
-        if (Utils::distanceToLine(p, line[i], line[i+1]) < pointerRadius)
-        {
-            return true;
-        }
+        return false;
     }
 
-    return false;
+    return GeometryPredicates::distanceToPolyline(x, y, coordinates.x().data(), coordinates.y().data(), coordinates.size()) < pointerRadius;
 }
 
 bool BlueMarble::hitTestPolygon(double x, double y, double pointerRadius, PolygonGeometryPtr geometry)
@@ -97,8 +94,9 @@ bool BlueMarble::hitTestPolygon(double x, double y, double pointerRadius, Polygo
     // TOOD: take pointerRadius into account
 
     // First check if the point is inside the outer ring
-    auto polygon = geometry->outerRing();
-    if (!Utils::pointInsidePolygon(Point(x,y), polygon)) return false;
+    const auto& coordinates = geometry->coordinates();
+    size_t outerSize = coordinates.partCount() > 0 ? coordinates.partSize(0) : 0;
+    if (!GeometryPredicates::pointInPolygon(x, y, coordinates.x().data(), coordinates.y().data(), outerSize)) return false;
 
     // Then check that the point is not inside any of the inner rings
     // for (size_t i=1; i<geometry->rings().size(); i++)
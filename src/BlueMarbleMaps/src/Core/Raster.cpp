@@ -104,6 +104,11 @@ void Raster::blur(double sigmaX, double sigmaY, double sigmaZ, bool isGaussian)
     m_impl->blur(sigmaX, sigmaY, sigmaZ, isGaussian);
 }
 
+void Raster::unpremultiplyAlpha()
+{
+    m_impl->unpremultiplyAlpha();
+}
+
 Raster Raster::getCrop(int x0, int y0, int x1, int y1) const
 {
     return m_impl->getCrop(x0, y0, x1, y1);
@@ -119,6 +124,11 @@ void Raster::save(const std::string& filePath) const
     m_impl->save(filePath);
 }
 
+std::vector<unsigned char> Raster::encodePng() const
+{
+    return m_impl->encodePng();
+}
+
 Raster& Raster::operator=(const Raster& raster)
 {
     if (this != &raster) // Protect against self-assignment
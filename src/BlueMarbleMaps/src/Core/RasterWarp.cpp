@@ -0,0 +1,386 @@
+#include "BlueMarbleMaps/Core/RasterWarp.h"
+#include "BlueMarbleMaps/System/Thread.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+
+using namespace BlueMarble;
+
+namespace
+{
+    constexpr int MinRowsPerThread = 64;
+
+    // Threads shared by all reprojections, started on first use. Rows are taken in ranges by the workers
+    // and the calling thread until none are left. One reprojection uses them at a time.
+    class RowWorkers
+    {
+        public:
+            explicit RowWorkers(int threads)
+                : m_workers()
+                , m_runMutex()
+                , m_mutex()
+                , m_wake()
+                , m_done()
+                , m_func(nullptr)
+                , m_height(0)
+                , m_rowsPerRange(0)
+                , m_nextRow(0)
+                , m_generation(0)
+                , m_busy(0)
+                , m_stop(false)
+            {
+                for (int i(0); i<threads; ++i)
+                {
+                    m_workers.emplace_back([this]() { workerLoop(); });
+                }
+            }
+
+            ~RowWorkers()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stop = true;
+                }
+                m_wake.notify_all();
+                for (auto& worker : m_workers)
+                {
+                    worker.join();
+                }
+            }
+
+            // Returns false without calling func if the workers are in use by another thread
+            bool run(int height, int rowsPerRange, const std::function<void(int, int)>& func)
+            {
+                std::unique_lock<std::mutex> runLock(m_runMutex, std::try_to_lock);
+                if (!runLock.owns_lock())
+                {
+                    return false;
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_func = &func;
+                    m_height = height;
+                    m_rowsPerRange = rowsPerRange;
+                    m_nextRow = 0;
+                    m_busy = (int)m_workers.size();
+                    ++m_generation;
+                }
+                m_wake.notify_all();
+                takeRanges();
+
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_done.wait(lock, [this]() { return m_busy == 0; });
+                m_func = nullptr;
+
+                return true;
+            }
+
+        private:
+            void takeRanges()
+            {
+                for (;;)
+                {
+                    int begin = m_nextRow.fetch_add(m_rowsPerRange);
+                    if (begin >= m_height)
+                    {
+                        return;
+                    }
+                    (*m_func)(begin, std::min(m_height, begin + m_rowsPerRange));
+                }
+            }
+
+            void workerLoop()
+            {
+                uint64_t generation = 0;
+                for (;;)
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_wake.wait(lock, [&]() { return m_stop || m_generation != generation; });
+                    if (m_stop)
+                    {
+                        return;
+                    }
+                    generation = m_generation;
+                    lock.unlock();
+
+                    takeRanges();
+
+                    lock.lock();
+                    if (--m_busy == 0)
+                    {
+                        m_done.notify_one();
+                    }
+                }
+            }
+
+            std::vector<std::thread>                m_workers;
+            std::mutex                              m_runMutex;
+            std::mutex                              m_mutex;
+            std::condition_variable                 m_wake;
+            std::condition_variable                 m_done;
+            const std::function<void(int, int)>*    m_func;
+            int                                     m_height;
+            int                                     m_rowsPerRange;
+            std::atomic<int>                        m_nextRow;
+            uint64_t                                m_generation;
+            int                                     m_busy;
+            bool                                    m_stop;
+    };
+
+    // Calls func(rowBegin, rowEnd) for ranges of rows, on the shared workers as well as the calling thread.
+    // Serially on thread pool workers (tile loads, async layer reads), they are already one per core,
+    // and while another reprojection uses the shared workers.
+    void forEachRowRange(int height, const std::function<void(int, int)>& func)
+    {
+        int maxThreads = std::max(1, (int)std::thread::hardware_concurrency());
+        if (maxThreads == 1 || height < 2*MinRowsPerThread || System::ThreadPool::isWorkerThread())
+        {
+            func(0, height);
+            return;
+        }
+
+        static RowWorkers workers(maxThreads - 1);
+        if (!workers.run(height, MinRowsPerThread, func))
+        {
+            func(0, height);
+        }
+    }
+
+    // Cell index from a position relative to the raster origin (in cells), -1 if outside
+    inline int cellIndex(double relative, int size)
+    {
+        // Tolerance for floating point errors at the borders
+        constexpr double Epsilon = 1e-6;
+        if (!(relative >= -Epsilon && relative <= size + Epsilon)) // Also catches nan
+        {
+            return -1;
+        }
+
+        // Truncation equals floor, negative values are within the tolerance
+        return std::min((int)relative, size - 1);
+    }
+
+    inline void copyCell(unsigned char* dst, const unsigned char* src, int channels)
+    {
+        switch (channels)
+        {
+            case 4: std::memcpy(dst, src, 4); break;
+            case 3: std::memcpy(dst, src, 3); break;
+            case 1: *dst = *src; break;
+            default: std::memcpy(dst, src, channels); break;
+        }
+    }
+
+    struct WarpContext
+    {
+        const unsigned char* src;
+        unsigned char*       dst;
+        int                  srcWidth;
+        int                  srcHeight;
+        int                  width;
+        int                  height;
+        int                  channels;
+        Rectangle            srcBounds;
+        Rectangle            dstBounds;
+        double               srcCellsPerUnitX;
+        double               srcCellsPerUnitY;
+
+        inline double targetX(int i) const { return dstBounds.xMin() + dstBounds.width()/width*(i + 0.5); }
+        inline double targetY(int j) const { return dstBounds.yMax() - dstBounds.height()/height*(j + 0.5); }
+        inline int sourceColumn(double x) const { return cellIndex((x - srcBounds.xMin())*srcCellsPerUnitX, srcWidth); }
+        inline int sourceRow(double y) const { return cellIndex((srcBounds.yMax() - y)*srcCellsPerUnitY, srcHeight); }
+    };
+
+    void warpSeparable(const WarpContext& c, const CrsPtr& sourceCrs, const CrsPtr& targetCrs)
+    {
+        // The source column only depends on the target column, and the source row on the target row
+        std::vector<double> x(c.width);
+        std::vector<double> y(c.width, c.dstBounds.center().y());
+        for (int i(0); i<c.width; ++i)
+        {
+            x[i] = c.targetX(i);
+        }
+        targetCrs->projectTo(sourceCrs, x.data(), y.data(), c.width);
+        std::vector<int> columns(c.width);
+        for (int i(0); i<c.width; ++i)
+        {
+            columns[i] = c.sourceColumn(x[i]);
+        }
+
+        x.assign(c.height, c.dstBounds.center().x());
+        y.resize(c.height);
+        for (int j(0); j<c.height; ++j)
+        {
+            y[j] = c.targetY(j);
+        }
+        targetCrs->projectTo(sourceCrs, x.data(), y.data(), c.height);
+        std::vector<int> rows(c.height);
+        for (int j(0); j<c.height; ++j)
+        {
+            rows[j] = c.sourceRow(y[j]);
+        }
+
+        size_t srcRowBytes = (size_t)c.srcWidth*c.channels;
+        size_t dstRowBytes = (size_t)c.width*c.channels;
+        forEachRowRange(c.height, [&](int rowBegin, int rowEnd)
+        {
+            for (int j=rowBegin; j<rowEnd; ++j)
+            {
+                int row = rows[j];
+                if (row < 0)
+                {
+                    continue;
+                }
+
+                unsigned char* dst = c.dst + j*dstRowBytes;
+                if (j > rowBegin && rows[j-1] == row)
+                {
+                    // Same source row as the previous one (magnification)
+                    std::memcpy(dst, dst - dstRowBytes, dstRowBytes);
+                    continue;
+                }
+
+                const unsigned char* src = c.src + row*srcRowBytes;
+                for (int i(0); i<c.width; ++i)
+                {
+                    if (columns[i] >= 0)
+                    {
+                        copyCell(dst + (size_t)i*c.channels, src + (size_t)columns[i]*c.channels, c.channels);
+                    }
+                }
+            }
+        });
+    }
+
+    void warpGrid(const WarpContext& c, const CrsPtr& sourceCrs, const CrsPtr& targetCrs, int gridStep)
+    {
+        // Grid nodes every gridStep cells, including the last column and row
+        auto nodes = [gridStep](int size)
+        {
+            std::vector<int> indices;
+            for (int i=0; i<size-1; i+=gridStep)
+            {
+                indices.push_back(i);
+            }
+            indices.push_back(size-1);
+            return indices;
+        };
+        auto nodeColumns = nodes(c.width);
+        auto nodeRows = nodes(c.height);
+        size_t nx = nodeColumns.size();
+        size_t ny = nodeRows.size();
+
+        // Exact source coordinates at the nodes
+        std::vector<double> nodeX(nx*ny);
+        std::vector<double> nodeY(nx*ny);
+        for (size_t r(0); r<ny; ++r)
+        {
+            for (size_t k(0); k<nx; ++k)
+            {
+                nodeX[r*nx + k] = c.targetX(nodeColumns[k]);
+                nodeY[r*nx + k] = c.targetY(nodeRows[r]);
+            }
+        }
+        targetCrs->projectTo(sourceCrs, nodeX.data(), nodeY.data(), nodeX.size());
+
+        // Interpolate source cell positions instead of coordinates
+        for (size_t i(0); i<nodeX.size(); ++i)
+        {
+            nodeX[i] = (nodeX[i] - c.srcBounds.xMin())*c.srcCellsPerUnitX;
+            nodeY[i] = (c.srcBounds.yMax() - nodeY[i])*c.srcCellsPerUnitY;
+        }
+
+        size_t srcRowBytes = (size_t)c.srcWidth*c.channels;
+        size_t dstRowBytes = (size_t)c.width*c.channels;
+        forEachRowRange(c.height, [&](int rowBegin, int rowEnd)
+        {
+            std::vector<double> rowX(nx);
+            std::vector<double> rowY(nx);
+            for (int j=rowBegin; j<rowEnd; ++j)
+            {
+                // Interpolate the node coordinates to this row
+                size_t r = std::min((size_t)(j / gridStep), ny > 1 ? ny - 2 : 0);
+                size_t r1 = std::min(r + 1, ny - 1);
+                double t = r1 > r ? double(j - nodeRows[r]) / (nodeRows[r1] - nodeRows[r]) : 0.0;
+                for (size_t k(0); k<nx; ++k)
+                {
+                    rowX[k] = nodeX[r*nx + k] + (nodeX[r1*nx + k] - nodeX[r*nx + k])*t;
+                    rowY[k] = nodeY[r*nx + k] + (nodeY[r1*nx + k] - nodeY[r*nx + k])*t;
+                }
+
+                // Interpolate along the row, one grid cell at a time
+                unsigned char* dst = c.dst + j*dstRowBytes;
+                for (size_t k(0); k<nx; ++k)
+                {
+                    size_t k1 = std::min(k + 1, nx - 1);
+                    int begin = nodeColumns[k];
+                    int end = k1 > k ? nodeColumns[k1] : c.width;
+                    double dx = k1 > k ? (rowX[k1] - rowX[k]) / (end - begin) : 0.0;
+                    double dy = k1 > k ? (rowY[k1] - rowY[k]) / (end - begin) : 0.0;
+                    for (int i=begin; i<end; ++i)
+                    {
+                        double cellX = rowX[k] + dx*(i - begin);
+                        double cellY = rowY[k] + dy*(i - begin);
+                        int column = cellIndex(cellX, c.srcWidth);
+                        int row = cellIndex(cellY, c.srcHeight);
+                        if (column >= 0 && row >= 0)
+                        {
+                            copyCell(dst + (size_t)i*c.channels, c.src + row*srcRowBytes + (size_t)column*c.channels, c.channels);
+                        }
+                    }
+                }
+            }
+        });
+    }
+}
+
+RasterGeometryPtr RasterWarp::reProject(RasterGeometry& source, const CrsPtr& sourceCrs, const CrsPtr& targetCrs, Method method, int gridStep)
+{
+    if (gridStep < 1)
+    {
+        throw std::runtime_error("RasterWarp::reProject() Grid step must be positive, got " + std::to_string(gridStep));
+    }
+
+    auto& sourceRaster = source.raster();
+    auto newBounds = sourceCrs->projectTo(targetCrs, source.bounds());
+    auto newRaster = std::make_shared<RasterGeometry>(Raster(sourceRaster.width(), sourceRaster.height(), sourceRaster.channels()), newBounds);
+    if (sourceRaster.width() == 0 || sourceRaster.height() == 0)
+    {
+        return newRaster;
+    }
+
+    WarpContext context;
+    context.src = (const unsigned char*)sourceRaster.data();
+    context.dst = (unsigned char*)newRaster->raster().data();
+    context.srcWidth = sourceRaster.width();
+    context.srcHeight = sourceRaster.height();
+    context.width = newRaster->raster().width();
+    context.height = newRaster->raster().height();
+    context.channels = sourceRaster.channels();
+    context.srcBounds = source.bounds();
+    context.dstBounds = newBounds;
+    context.srcCellsPerUnitX = context.srcWidth / context.srcBounds.width();
+    context.srcCellsPerUnitY = context.srcHeight / context.srcBounds.height();
+
+    // The raster is allocated uninitialized, the cells not mapped to the source are never written
+    std::memset(context.dst, 0, (size_t)context.width*context.height*context.channels);
+
+    bool separable = sourceCrs->projection()->isSeparable() && targetCrs->projection()->isSeparable();
+    if (method == Method::Automatic && separable)
+    {
+        warpSeparable(context, sourceCrs, targetCrs);
+    }
+    else
+    {
+        warpGrid(context, sourceCrs, targetCrs, gridStep);
+    }
+
+    return newRaster;
+}
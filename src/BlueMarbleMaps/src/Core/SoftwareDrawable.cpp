@@ -36,6 +36,21 @@ namespace BlueMarble
     //     m_impl->setTransform(transform);
     // }
 
+    void SoftwareDrawable::setProjectionMatrix(const glm::dmat4& proj)
+    {
+        m_impl->setProjectionMatrix(proj);
+    }
+
+    void SoftwareDrawable::setViewMatrix(const glm::dmat4& viewMatrix)
+    {
+        m_impl->setViewMatrix(viewMatrix);
+    }
+
+    void SoftwareDrawable::setRenderOrigin(const Point& origin)
+    {
+        m_impl->setRenderOrigin(origin);
+    }
+
     void SoftwareDrawable::beginBatches()
     {
         m_impl->beginBatches();
@@ -81,6 +96,16 @@ namespace BlueMarble
         m_impl->drawCircle(x, y, radius, pen, brush);
     }
 
+    void SoftwareDrawable::drawSymbols(const std::vector<SymbolInstance>& symbols)
+    {
+        Brush brush;
+        for (const auto& symbol : symbols)
+        {
+            brush.setColor(symbol.color);
+            m_impl->drawCircle(symbol.position.x(), symbol.position.y(), symbol.size, Pen::transparent(), brush);
+        }
+    }
+
     void SoftwareDrawable::drawLine(const LineGeometryPtr& geometry, const Pen& pen)
     {
         m_impl->drawLine(geometry, pen);
@@ -121,6 +146,11 @@ namespace BlueMarble
         return m_impl->renderer();
     }
 
+    std::shared_ptr<Drawable> SoftwareDrawable::createOffscreen(int width, int height)
+    {
+        return std::make_shared<SoftwareBitmapDrawable>(width, height, 4);
+    }
+
     Color SoftwareDrawable::readPixel(int x, int y)
     {
         return m_impl->readPixel(x, y);
@@ -131,11 +161,21 @@ namespace BlueMarble
         m_impl->setPixel(x, y, color);
     }
 
+    Raster SoftwareDrawable::getRaster()
+    {
+        return m_impl->getRaster();
+    }
+
     void SoftwareDrawable::clearBuffer()
     {
         m_impl->clearBuffer();
     }
 
+    void SoftwareDrawable::setClipRect(const Rectangle& pixels)
+    {
+        m_impl->setClipRect(pixels);
+    }
+
     void SoftwareWindowDrawable::setWindow(void *window)
     {
         m_impl->setWindow(window);
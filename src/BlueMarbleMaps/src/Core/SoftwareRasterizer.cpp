@@ -0,0 +1,511 @@
+#include "BlueMarbleMaps/Core/SoftwareRasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace BlueMarble;
+
+namespace
+{
+    // dst = (value*alpha + dst*(255 - alpha))/255 over n bytes, x/255 computed as (x + (x >> 8)) >> 8 after rounding
+    inline void blendSpan(uint8_t* dst, int n, uint8_t value, uint8_t alpha)
+    {
+        if (alpha == 255)
+        {
+            std::memset(dst, value, n);
+            return;
+        }
+        int i = 0;
+#if defined(__SSE2__)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i inverse = _mm_set1_epi16(short(255 - alpha));
+        const __m128i source = _mm_set1_epi16(short(value*alpha + 128));
+        for (; i + 16 <= n; i += 16)
+        {
+            __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+            __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inverse), source);
+            __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inverse), source);
+            lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+            hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+            _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+        }
+#endif
+        for (; i < n; i++)
+        {
+            unsigned int x = dst[i]*(255u - alpha) + value*alpha + 128u;
+            dst[i] = uint8_t((x + (x >> 8)) >> 8);
+        }
+    }
+
+    inline uint8_t blend(uint8_t dst, uint8_t value, unsigned int alpha)
+    {
+        unsigned int x = dst*(255u - alpha) + value*alpha + 128u;
+        return uint8_t((x + (x >> 8)) >> 8);
+    }
+
+    // First pixel whose center is at or right of x
+    inline int firstPixel(double x)
+    {
+        return (int)std::ceil(x - 0.5);
+    }
+}
+
+SoftwareRasterizer::SoftwareRasterizer(unsigned int threads)
+    : m_data(nullptr)
+    , m_width(0)
+    , m_height(0)
+    , m_channels(4)
+    , m_tilesX(0)
+    , m_tilesY(0)
+    , m_clipX0(0)
+    , m_clipY0(0)
+    , m_clipX1(0)
+    , m_clipY1(0)
+    , m_edges()
+    , m_primitives()
+    , m_images()
+    , m_bins()
+    , m_workers()
+    , m_generation(0)
+    , m_busy(0)
+    , m_stop(false)
+    , m_nextTile(0)
+    , m_scratch()
+{
+    if (threads == 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned int i(1); i<threads; ++i)
+    {
+        m_workers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+SoftwareRasterizer::~SoftwareRasterizer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+void SoftwareRasterizer::setTarget(uint8_t* data, int width, int height, int channels)
+{
+    discard();
+    m_data = data;
+    m_width = std::max(0, width);
+    m_height = std::max(0, height);
+    m_channels = channels;
+    m_tilesX = (m_width + TileSize - 1)/TileSize;
+    m_tilesY = (m_height + TileSize - 1)/TileSize;
+    m_bins.assign(size_t(m_tilesX)*m_tilesY, std::vector<uint32_t>());
+    setClip(0, 0, m_width, m_height);
+}
+
+void SoftwareRasterizer::setClip(int x0, int y0, int x1, int y1)
+{
+    m_clipX0 = std::clamp(x0, 0, m_width);
+    m_clipY0 = std::clamp(y0, 0, m_height);
+    m_clipX1 = std::clamp(x1, m_clipX0, m_width);
+    m_clipY1 = std::clamp(y1, m_clipY0, m_height);
+}
+
+unsigned int SoftwareRasterizer::threadCount() const
+{
+    return (unsigned int)m_workers.size() + 1;
+}
+
+void SoftwareRasterizer::fillPolygon(const double* x, const double* y, const size_t* ringOffsets, size_t ringCount,
+                                     const Color& color, FillRule rule)
+{
+    size_t firstEdge = m_edges.size();
+    double xMin = INFINITY, yMin = INFINITY, xMax = -INFINITY, yMax = -INFINITY;
+    for (size_t r(0); r<ringCount; ++r)
+    {
+        size_t begin = ringOffsets[r];
+        size_t end = ringOffsets[r+1];
+        for (size_t i(begin); i<end; ++i)
+        {
+            size_t next = i+1 < end ? i+1 : begin;
+            addEdge(x[i], y[i], x[next], y[next]);
+            xMin = std::min(xMin, x[i]);
+            xMax = std::max(xMax, x[i]);
+            yMin = std::min(yMin, y[i]);
+            yMax = std::max(yMax, y[i]);
+        }
+    }
+    addPrimitive(firstEdge, xMin, yMin, xMax, yMax, color, rule, -1);
+}
+
+void SoftwareRasterizer::fillTriangles(const double* x, const double* y, const uint32_t* indices, size_t indexCount, const Color& color)
+{
+    // Triangles of the same orientation add up to a union with the nonzero rule
+    size_t firstEdge = m_edges.size();
+    double xMin = INFINITY, yMin = INFINITY, xMax = -INFINITY, yMax = -INFINITY;
+    for (size_t i(0); i+2<indexCount; i+=3)
+    {
+        uint32_t a = indices[i], b = indices[i+1], c = indices[i+2];
+        double cross = (x[b] - x[a])*(y[c] - y[a]) - (y[b] - y[a])*(x[c] - x[a]);
+        if (cross < 0.0)
+        {
+            std::swap(b, c);
+        }
+        addEdge(x[a], y[a], x[b], y[b]);
+        addEdge(x[b], y[b], x[c], y[c]);
+        addEdge(x[c], y[c], x[a], y[a]);
+        for (uint32_t k : { a, b, c })
+        {
+            xMin = std::min(xMin, x[k]);
+            xMax = std::max(xMax, x[k]);
+            yMin = std::min(yMin, y[k]);
+            yMax = std::max(yMax, y[k]);
+        }
+    }
+    addPrimitive(firstEdge, xMin, yMin, xMax, yMax, color, FillRule::NonZero, -1);
+}
+
+void SoftwareRasterizer::drawImage(const uint8_t* data, int width, int height, int channels, size_t pixelStride, size_t rowStride,
+                                   size_t channelStride, const Point& topLeft, const Point& topRight, const Point& bottomLeft, double alpha)
+{
+    if (data == nullptr || width <= 0 || height <= 0 || alpha <= 0.0)
+    {
+        return;
+    }
+
+    // Inverse of the map from image (column, row) to pixels
+    double ax = (topRight.x() - topLeft.x())/width, ay = (topRight.y() - topLeft.y())/width;
+    double bx = (bottomLeft.x() - topLeft.x())/height, by = (bottomLeft.y() - topLeft.y())/height;
+    double det = ax*by - bx*ay;
+    if (!(std::abs(det) > 0.0))
+    {
+        return;
+    }
+    Image image;
+    image.data = data;
+    image.width = width;
+    image.height = height;
+    image.channels = channels;
+    image.pixelStride = pixelStride;
+    image.rowStride = rowStride;
+    image.channelStride = channelStride;
+    image.ux = by/det;
+    image.uy = -bx/det;
+    image.u0 = -(image.ux*topLeft.x() + image.uy*topLeft.y());
+    image.vx = -ay/det;
+    image.vy = ax/det;
+    image.v0 = -(image.vx*topLeft.x() + image.vy*topLeft.y());
+    image.alpha = (int)std::lround(std::clamp(alpha, 0.0, 1.0)*255.0);
+    m_images.push_back(image);
+
+    Point bottomRight = topRight + (bottomLeft - topLeft);
+    double x[] = { topLeft.x(), topRight.x(), bottomRight.x(), bottomLeft.x() };
+    double y[] = { topLeft.y(), topRight.y(), bottomRight.y(), bottomLeft.y() };
+    size_t firstEdge = m_edges.size();
+    for (int i(0); i<4; ++i)
+    {
+        addEdge(x[i], y[i], x[(i+1) % 4], y[(i+1) % 4]);
+    }
+    addPrimitive(firstEdge, *std::min_element(x, x+4), *std::min_element(y, y+4), *std::max_element(x, x+4), *std::max_element(y, y+4),
+                 Color::white(), FillRule::NonZero, (int)m_images.size() - 1);
+}
+
+void SoftwareRasterizer::addEdge(double x0, double y0, double x1, double y1)
+{
+    if (y0 == y1 || !std::isfinite(x0) || !std::isfinite(y0) || !std::isfinite(x1) || !std::isfinite(y1))
+    {
+        return; // Horizontal edges never cross a scanline
+    }
+    int winding = 1;
+    if (y0 > y1)
+    {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+        winding = -1;
+    }
+    m_edges.push_back(Edge{ (float)x0, (float)y0, (float)y1, (float)((x1 - x0)/(y1 - y0)), winding });
+}
+
+void SoftwareRasterizer::addPrimitive(size_t firstEdge, double xMin, double yMin, double xMax, double yMax, const Color& color, FillRule rule, int image)
+{
+    Primitive primitive;
+    primitive.firstEdge = firstEdge;
+    primitive.edgeCount = m_edges.size() - firstEdge;
+    primitive.x0 = std::max(m_clipX0, firstPixel(std::max(xMin, -1.0)));
+    primitive.y0 = std::max(m_clipY0, firstPixel(std::max(yMin, -1.0)));
+    primitive.x1 = std::min(m_clipX1, firstPixel(std::min(xMax, (double)m_width + 1.0)));
+    primitive.y1 = std::min(m_clipY1, firstPixel(std::min(yMax, (double)m_height + 1.0)));
+    primitive.color[0] = (uint8_t)color.r();
+    primitive.color[1] = (uint8_t)color.g();
+    primitive.color[2] = (uint8_t)color.b();
+    primitive.color[3] = (uint8_t)std::lround(std::clamp(color.a(), 0.0, 1.0)*255.0);
+    primitive.rule = rule;
+    primitive.image = image;
+
+    if (primitive.edgeCount == 0 || primitive.x0 >= primitive.x1 || primitive.y0 >= primitive.y1 || (image < 0 && primitive.color[3] == 0))
+    {
+        m_edges.resize(firstEdge);
+        return;
+    }
+
+    // Sorted by their top once, for all tiles to walk the scanlines with a list of active edges
+    std::sort(m_edges.begin() + firstEdge, m_edges.end(), [](const Edge& a, const Edge& b) { return a.y0 < b.y0; });
+
+    uint32_t index = (uint32_t)m_primitives.size();
+    m_primitives.push_back(primitive);
+    for (int ty(primitive.y0/TileSize); ty<=(primitive.y1 - 1)/TileSize; ++ty)
+    {
+        for (int tx(primitive.x0/TileSize); tx<=(primitive.x1 - 1)/TileSize; ++tx)
+        {
+            m_bins[size_t(ty)*m_tilesX + tx].push_back(index);
+        }
+    }
+}
+
+void SoftwareRasterizer::flush()
+{
+    if (m_primitives.empty() || m_data == nullptr)
+    {
+        discard();
+        return;
+    }
+
+    m_nextTile = 0;
+    if (!m_workers.empty())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_generation++;
+            m_busy = (unsigned int)m_workers.size();
+        }
+        m_wake.notify_all();
+    }
+    rasterizeTiles(m_scratch);
+    if (!m_workers.empty())
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this]() { return m_busy == 0; });
+    }
+
+    discard();
+}
+
+void SoftwareRasterizer::discard()
+{
+    m_edges.clear();
+    m_primitives.clear();
+    m_images.clear();
+    for (auto& bin : m_bins)
+    {
+        bin.clear();
+    }
+}
+
+size_t SoftwareRasterizer::pendingCount() const
+{
+    return m_primitives.size();
+}
+
+void SoftwareRasterizer::workerLoop()
+{
+    Scratch scratch;
+    uint64_t generation = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&]() { return m_stop || m_generation != generation; });
+            if (m_stop)
+            {
+                return;
+            }
+            generation = m_generation;
+        }
+        rasterizeTiles(scratch);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_busy == 0)
+            {
+                m_done.notify_all();
+            }
+        }
+    }
+}
+
+void SoftwareRasterizer::rasterizeTiles(Scratch& scratch)
+{
+    int tileCount = m_tilesX*m_tilesY;
+    for (int tile = m_nextTile++; tile < tileCount; tile = m_nextTile++)
+    {
+        rasterizeTile(tile, scratch);
+    }
+}
+
+void SoftwareRasterizer::rasterizeTile(int tile, Scratch& scratch)
+{
+    int tx0 = (tile % m_tilesX)*TileSize;
+    int ty0 = (tile / m_tilesX)*TileSize;
+    int tx1 = std::min(tx0 + TileSize, m_width);
+    int ty1 = std::min(ty0 + TileSize, m_height);
+    for (uint32_t index : m_bins[tile])
+    {
+        rasterizePrimitive(m_primitives[index], tx0, ty0, tx1, ty1, scratch);
+    }
+}
+
+void SoftwareRasterizer::rasterizePrimitive(const Primitive& primitive, int tx0, int ty0, int tx1, int ty1, Scratch& scratch)
+{
+    int x0 = std::max(tx0, primitive.x0);
+    int x1 = std::min(tx1, primitive.x1);
+    int y0 = std::max(ty0, primitive.y0);
+    int y1 = std::min(ty1, primitive.y1);
+    if (x0 >= x1 || y0 >= y1)
+    {
+        return;
+    }
+
+    // Edges crossing the scanlines of the tile, in the order of their top. Edges right of the tile
+    // are left out, they don't change the winding of any pixel in it, a span still open after the
+    // last crossing runs to the right of the tile.
+    float top = y0 + 0.5f, bottom = y1 - 0.5f, right = x1 + 0.5f;
+    scratch.edges.clear();
+    const Edge* edges = m_edges.data() + primitive.firstEdge;
+    for (size_t i(0); i<primitive.edgeCount; ++i)
+    {
+        const Edge& edge = edges[i];
+        if (edge.y1 > top && edge.y0 <= bottom && std::min(edge.x0, edge.x0 + (edge.y1 - edge.y0)*edge.dxdy) < right)
+        {
+            scratch.edges.push_back(&edge);
+        }
+    }
+
+    // Active edges, those crossing the current scanline
+    auto& active = scratch.active;
+    active.clear();
+    size_t next = 0;
+    auto& crossings = scratch.crossings;
+    for (int row(y0); row<y1; ++row)
+    {
+        float yc = row + 0.5f;
+        while (next < scratch.edges.size() && scratch.edges[next]->y0 <= yc)
+        {
+            active.push_back(scratch.edges[next++]);
+        }
+        crossings.clear();
+        size_t kept = 0;
+        for (const Edge* edge : active)
+        {
+            if (yc < edge->y1)
+            {
+                active[kept++] = edge;
+                crossings.emplace_back(edge->x0 + (yc - edge->y0)*edge->dxdy, edge->winding);
+            }
+        }
+        active.resize(kept);
+        if (crossings.empty())
+        {
+            continue;
+        }
+        std::sort(crossings.begin(), crossings.end());
+
+        // Spans between the crossings where the winding says inside
+        int winding = 0;
+        float spanStart = 0.0f;
+        for (const auto& crossing : crossings)
+        {
+            bool wasInside = primitive.rule == FillRule::EvenOdd ? (winding & 1) != 0 : winding != 0;
+            winding += crossing.second;
+            bool inside = primitive.rule == FillRule::EvenOdd ? (winding & 1) != 0 : winding != 0;
+            if (!wasInside && inside)
+            {
+                spanStart = crossing.first;
+            }
+            else if (wasInside && !inside)
+            {
+                int from = std::max(x0, firstPixel(spanStart));
+                int to = std::min(x1, firstPixel(crossing.first));
+                if (from < to)
+                {
+                    fillSpan(primitive, row, from, to);
+                }
+            }
+        }
+        bool inside = primitive.rule == FillRule::EvenOdd ? (winding & 1) != 0 : winding != 0;
+        if (inside)
+        {
+            int from = std::max(x0, firstPixel(spanStart));
+            if (from < x1)
+            {
+                fillSpan(primitive, row, from, x1);
+            }
+        }
+    }
+}
+
+void SoftwareRasterizer::fillSpan(const Primitive& primitive, int row, int x0, int x1)
+{
+    size_t planeSize = size_t(m_width)*m_height;
+    size_t offset = size_t(row)*m_width + x0;
+    int n = x1 - x0;
+    if (primitive.image < 0)
+    {
+        uint8_t alpha = primitive.color[3];
+        for (int c(0); c<std::min(m_channels, 3); ++c)
+        {
+            blendSpan(m_data + c*planeSize + offset, n, primitive.color[c], alpha);
+        }
+        if (m_channels > 3)
+        {
+            blendSpan(m_data + 3*planeSize + offset, n, 255, alpha);
+        }
+        return;
+    }
+
+    const Image& image = m_images[primitive.image];
+    double yc = row + 0.5;
+    double u = image.ux*(x0 + 0.5) + image.uy*yc + image.u0;
+    double v = image.vx*(x0 + 0.5) + image.vy*yc + image.v0;
+    for (int i(0); i<n; ++i, u += image.ux, v += image.vx)
+    {
+        int column = std::clamp((int)std::floor(u), 0, image.width - 1);
+        int line = std::clamp((int)std::floor(v), 0, image.height - 1);
+        const uint8_t* source = image.data + line*image.rowStride + column*image.pixelStride;
+        uint8_t r, g, b;
+        unsigned int a = 255;
+        if (image.channels >= 3)
+        {
+            r = source[0];
+            g = source[image.channelStride];
+            b = source[2*image.channelStride];
+            a = image.channels == 4 ? source[3*image.channelStride] : 255;
+        }
+        else
+        {
+            r = g = b = source[0];
+            a = image.channels == 2 ? source[image.channelStride] : 255;
+        }
+        a = (a*image.alpha + 127)/255;
+        if (a == 0)
+        {
+            continue;
+        }
+        uint8_t* pixel = m_data + offset + i;
+        pixel[0] = blend(pixel[0], r, a);
+        pixel[planeSize] = blend(pixel[planeSize], g, a);
+        pixel[2*planeSize] = blend(pixel[2*planeSize], b, a);
+        if (m_channels > 3)
+        {
+            pixel[3*planeSize] = blend(pixel[3*planeSize], 255, a);
+        }
+    }
+}
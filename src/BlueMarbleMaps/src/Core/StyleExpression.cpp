@@ -0,0 +1,404 @@
+#include "BlueMarbleMaps/Core/StyleExpression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace BlueMarble;
+
+namespace
+{
+    typedef StyleExpression::Stops Stops;
+
+    inline double interpolateStops(const Stops& stops, double x)
+    {
+        if (!(x > stops.front().first)) // Also catches nan
+            return stops.front().second;
+        if (x >= stops.back().first)
+            return stops.back().second;
+
+        auto upper = std::upper_bound(stops.begin(), stops.end(), x,
+            [](double x, const std::pair<double, double>& stop) { return x < stop.first; });
+        auto lower = std::prev(upper);
+        double t = (x - lower->first) / (upper->first - lower->first);
+        return lower->second + (upper->second - lower->second)*t;
+    }
+
+    inline double stepStops(const Stops& stops, double base, double x)
+    {
+        auto upper = std::upper_bound(stops.begin(), stops.end(), x,
+            [](double x, const std::pair<double, double>& stop) { return x < stop.first; });
+        return upper == stops.begin() ? base : std::prev(upper)->second;
+    }
+
+    inline bool isSorted(const Stops& stops)
+    {
+        return std::is_sorted(stops.begin(), stops.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+    }
+}
+
+StyleExpression::StyleExpression(double value)
+    : m_node(std::make_shared<Node>(Node{ Operator::Constant, value, AttributeKey(), {}, {}, {} }))
+{
+}
+
+StyleExpression::StyleExpression(const NodePtr& node)
+    : m_node(node)
+{
+}
+
+StyleExpression StyleExpression::constant(double value)
+{
+    return StyleExpression(value);
+}
+
+StyleExpression StyleExpression::attribute(const AttributeKey& key, double defaultValue)
+{
+    return StyleExpression(std::make_shared<Node>(Node{ Operator::Attribute, defaultValue, key, {}, {}, {} }));
+}
+
+StyleExpression StyleExpression::viewScale()
+{
+    return StyleExpression(std::make_shared<Node>(Node{ Operator::ViewScale, 0.0, AttributeKey(), {}, {}, {} }));
+}
+
+StyleExpression StyleExpression::interpolate(const StyleExpression& input, const Stops& stops)
+{
+    if (stops.empty() || !isSorted(stops))
+    {
+        throw std::runtime_error("StyleExpression::interpolate() Stops must be non empty and sorted by input");
+    }
+
+    return StyleExpression(std::make_shared<Node>(Node{ Operator::Interpolate, 0.0, AttributeKey(), stops, {}, { input.m_node } }));
+}
+
+StyleExpression StyleExpression::step(const StyleExpression& input, double base, const Stops& stops)
+{
+    if (!isSorted(stops))
+    {
+        throw std::runtime_error("StyleExpression::step() Stops must be sorted by input");
+    }
+
+    return StyleExpression(std::make_shared<Node>(Node{ Operator::Step, base, AttributeKey(), stops, {}, { input.m_node } }));
+}
+
+StyleExpression StyleExpression::match(const AttributeKey& key, const Cases& cases, double defaultValue)
+{
+    return StyleExpression(std::make_shared<Node>(Node{ Operator::Match, defaultValue, key, {}, cases, {} }));
+}
+
+StyleExpression StyleExpression::min(const StyleExpression& a, const StyleExpression& b)
+{
+    return binary(Operator::Min, a, b);
+}
+
+StyleExpression StyleExpression::max(const StyleExpression& a, const StyleExpression& b)
+{
+    return binary(Operator::Max, a, b);
+}
+
+StyleExpression StyleExpression::binary(Operator op, const StyleExpression& a, const StyleExpression& b)
+{
+    return StyleExpression(std::make_shared<Node>(Node{ op, 0.0, AttributeKey(), {}, {}, { a.m_node, b.m_node } }));
+}
+
+StyleExpression BlueMarble::operator+(const StyleExpression& a, const StyleExpression& b)
+{
+    return StyleExpression::binary(StyleExpression::Operator::Add, a, b);
+}
+
+StyleExpression BlueMarble::operator-(const StyleExpression& a, const StyleExpression& b)
+{
+    return StyleExpression::binary(StyleExpression::Operator::Subtract, a, b);
+}
+
+StyleExpression BlueMarble::operator*(const StyleExpression& a, const StyleExpression& b)
+{
+    return StyleExpression::binary(StyleExpression::Operator::Multiply, a, b);
+}
+
+StyleExpression BlueMarble::operator/(const StyleExpression& a, const StyleExpression& b)
+{
+    return StyleExpression::binary(StyleExpression::Operator::Divide, a, b);
+}
+
+
+namespace
+{
+    typedef StyleExpression::Operator Operator;
+
+    template <typename Node>
+    bool uses(const Node& node, Operator op1, Operator op2)
+    {
+        if (node.op == op1 || node.op == op2)
+            return true;
+        for (const auto& argument : node.arguments)
+        {
+            if (uses(*argument, op1, op2))
+                return true;
+        }
+        return false;
+    }
+}
+
+CompiledStyleExpression::CompiledStyleExpression(const StyleExpression& expression)
+    : m_program()
+    , m_dependsOnFeature(uses(*expression.m_node, Operator::Attribute, Operator::Match))
+    , m_dependsOnViewScale(uses(*expression.m_node, Operator::ViewScale, Operator::ViewScale))
+    , m_cache()
+{
+    auto program = std::make_shared<Program>();
+    emit(*program, expression.m_node, 0, true);
+    m_program = program;
+}
+
+size_t CompiledStyleExpression::instructionCount() const
+{
+    return m_program->instructions.size();
+}
+
+void CompiledStyleExpression::emit(Program& program, const StyleExpression::NodePtr& node, size_t depth, bool fold)
+{
+    if (depth >= MaxStackDepth)
+    {
+        throw std::runtime_error("CompiledStyleExpression::emit() Expression too deeply nested, max stack depth is " + std::to_string(MaxStackDepth));
+    }
+    program.stackDepth = std::max(program.stackDepth, depth + 1);
+
+    bool isConstant = !uses(*node, Operator::Attribute, Operator::Match) && !uses(*node, Operator::ViewScale, Operator::ViewScale);
+    if (fold && isConstant && node->op != Operator::Constant)
+    {
+        // Evaluate the sub expression once, at compile time
+        Program constantProgram;
+        emit(constantProgram, node, 0, false);
+        Attributes empty;
+        program.constants.push_back(execute(constantProgram, empty, empty));
+        program.instructions.push_back({ Operator::Constant, uint32_t(program.constants.size() - 1) });
+        return;
+    }
+
+    // Arguments are pushed in order, such that the last one is on top of the stack
+    for (size_t i(0); i<node->arguments.size(); ++i)
+    {
+        emit(program, node->arguments[i], depth + i, fold);
+    }
+
+    uint32_t index = 0;
+    switch (node->op)
+    {
+        case Operator::Constant:
+            program.constants.push_back(node->value);
+            index = uint32_t(program.constants.size() - 1);
+            break;
+        case Operator::Attribute:
+            program.attributes.push_back({ node->key, node->value });
+            index = uint32_t(program.attributes.size() - 1);
+            break;
+        case Operator::Interpolate:
+        case Operator::Step:
+            program.stops.push_back({ node->stops, node->value });
+            index = uint32_t(program.stops.size() - 1);
+            break;
+        case Operator::Match:
+            program.matches.push_back({ node->key, node->cases, node->value });
+            index = uint32_t(program.matches.size() - 1);
+            break;
+        default:
+            break;
+    }
+    program.instructions.push_back({ node->op, index });
+}
+
+const AttributeValue* CompiledStyleExpression::findAttribute(const AttributeKey& key, const Attributes& featureAttributes, const Attributes& updateAttributes)
+{
+    auto value = featureAttributes.find(key);
+    return value ? value : updateAttributes.find(key);
+}
+
+double CompiledStyleExpression::attributeValue(const AttributeRef& ref, const Attributes& featureAttributes, const Attributes& updateAttributes)
+{
+    if (auto value = findAttribute(ref.key, featureAttributes, updateAttributes))
+    {
+        switch (value->type())
+        {
+            case AttributeValueType::Integer: return value->getInteger();
+            case AttributeValueType::Double: return value->getDouble();
+            case AttributeValueType::Boolean: return value->getBoolean() ? 1.0 : 0.0;
+            default: break;
+        }
+    }
+
+    return ref.defaultValue;
+}
+
+double CompiledStyleExpression::viewScale(const Attributes& updateAttributes)
+{
+    auto scale = updateAttributes.getIf<double>(UpdateAttributeKeys::UpdateViewScale);
+    return scale ? *scale : 1.0;
+}
+
+double CompiledStyleExpression::execute(const Program& program, const Attributes& featureAttributes, const Attributes& updateAttributes)
+{
+    double stack[MaxStackDepth];
+    size_t top = 0; // Number of values on the stack
+
+    for (const auto& instruction : program.instructions)
+    {
+        switch (instruction.op)
+        {
+            case Operator::Constant:
+                stack[top++] = program.constants[instruction.index];
+                break;
+            case Operator::Attribute:
+                stack[top++] = attributeValue(program.attributes[instruction.index], featureAttributes, updateAttributes);
+                break;
+            case Operator::ViewScale:
+                stack[top++] = viewScale(updateAttributes);
+                break;
+            case Operator::Add:
+                --top; stack[top-1] += stack[top];
+                break;
+            case Operator::Subtract:
+                --top; stack[top-1] -= stack[top];
+                break;
+            case Operator::Multiply:
+                --top; stack[top-1] *= stack[top];
+                break;
+            case Operator::Divide:
+                --top; stack[top-1] /= stack[top];
+                break;
+            case Operator::Min:
+                --top; stack[top-1] = std::min(stack[top-1], stack[top]);
+                break;
+            case Operator::Max:
+                --top; stack[top-1] = std::max(stack[top-1], stack[top]);
+                break;
+            case Operator::Interpolate:
+                stack[top-1] = interpolateStops(program.stops[instruction.index].stops, stack[top-1]);
+                break;
+            case Operator::Step:
+            {
+                const auto& ref = program.stops[instruction.index];
+                stack[top-1] = stepStops(ref.stops, ref.base, stack[top-1]);
+                break;
+            }
+            case Operator::Match:
+            {
+                const auto& ref = program.matches[instruction.index];
+                double result = ref.defaultValue;
+                if (auto value = findAttribute(ref.key, featureAttributes, updateAttributes))
+                {
+                    for (const auto& [match, output] : ref.cases)
+                    {
+                        if (*value == match)
+                        {
+                            result = output;
+                            break;
+                        }
+                    }
+                }
+                stack[top++] = result;
+                break;
+            }
+        }
+    }
+
+    return stack[0];
+}
+
+double CompiledStyleExpression::evaluate(const Attributes& featureAttributes, const Attributes& updateAttributes) const
+{
+    return execute(*m_program, featureAttributes, updateAttributes);
+}
+
+double CompiledStyleExpression::operator()(const FeaturePtr& feature, Attributes& updateAttributes) const
+{
+    if (m_dependsOnFeature)
+    {
+        return execute(*m_program, feature->attributes(), updateAttributes);
+    }
+
+    // Feature independent, evaluated once per view scale
+    double scale = m_dependsOnViewScale ? viewScale(updateAttributes) : 0.0;
+    double value;
+    if (!m_cache.get(scale, value))
+    {
+        value = execute(*m_program, feature->attributes(), updateAttributes);
+        m_cache.set(scale, value);
+    }
+
+    return value;
+}
+
+
+CompiledStyleExpression::Cache::Cache()
+    : m_sequence(0)
+    , m_viewScale(NAN)
+    , m_value(0.0)
+{
+}
+
+CompiledStyleExpression::Cache& CompiledStyleExpression::Cache::operator=(const Cache&)
+{
+    // The value is of another program
+    set(NAN, 0.0);
+    return *this;
+}
+
+bool CompiledStyleExpression::Cache::get(double viewScale, double& value) const
+{
+    uint64_t sequence = m_sequence.load(std::memory_order_acquire);
+    if ((sequence & 1) != 0)
+    {
+        return false;
+    }
+    double cachedViewScale = m_viewScale.load(std::memory_order_relaxed);
+    double cachedValue = m_value.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (m_sequence.load(std::memory_order_relaxed) != sequence || cachedViewScale != viewScale)
+    {
+        return false;
+    }
+
+    value = cachedValue;
+    return true;
+}
+
+void CompiledStyleExpression::Cache::set(double viewScale, double value) const
+{
+    uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+    if ((sequence & 1) != 0 || !m_sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed))
+    {
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    m_viewScale.store(viewScale, std::memory_order_relaxed);
+    m_value.store(value, std::memory_order_relaxed);
+    m_sequence.store(sequence + 2, std::memory_order_release);
+}
+
+
+ColorStyleExpression::ColorStyleExpression(const StyleExpression& r, const StyleExpression& g, const StyleExpression& b, const StyleExpression& a)
+    : m_r(r)
+    , m_g(g)
+    , m_b(b)
+    , m_a(a)
+{
+}
+
+Color ColorStyleExpression::evaluate(const Attributes& featureAttributes, const Attributes& updateAttributes) const
+{
+    return Color((int)std::lround(m_r.evaluate(featureAttributes, updateAttributes)),
+                 (int)std::lround(m_g.evaluate(featureAttributes, updateAttributes)),
+                 (int)std::lround(m_b.evaluate(featureAttributes, updateAttributes)),
+                 m_a.evaluate(featureAttributes, updateAttributes));
+}
+
+Color ColorStyleExpression::operator()(const FeaturePtr& feature, Attributes& updateAttributes) const
+{
+    return Color((int)std::lround(m_r(feature, updateAttributes)),
+                 (int)std::lround(m_g(feature, updateAttributes)),
+                 (int)std::lround(m_b(feature, updateAttributes)),
+                 m_a(feature, updateAttributes));
+}
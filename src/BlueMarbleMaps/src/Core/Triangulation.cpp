@@ -0,0 +1,740 @@
+#include "BlueMarbleMaps/Core/Triangulation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+using namespace BlueMarble;
+
+namespace
+{
+    struct Node
+    {
+        uint32_t i;         // Vertex index
+        double   x;
+        double   y;
+        Node*    prev;      // Ring order
+        Node*    next;
+        int32_t  z;         // Z-order curve value
+        Node*    prevZ;     // Z-order
+        Node*    nextZ;
+        bool     steiner;   // Hole consisting of a single point
+    };
+
+    // Node storage in fixed size blocks, such that nodes never move. The blocks are kept
+    // between triangulations (see s_earcut below), so allocation is only a pointer increment.
+    class NodePool
+    {
+        public:
+            static constexpr size_t BlockSize = 4096;
+
+            NodePool() : m_blocks(), m_block(0), m_used(0) {}
+
+            Node* create(uint32_t i, double x, double y)
+            {
+                if (m_blocks.empty() || m_used == BlockSize)
+                {
+                    if (!m_blocks.empty())
+                        ++m_block;
+                    if (m_block == m_blocks.size())
+                        m_blocks.emplace_back(new Node[BlockSize]);
+                    m_used = 0;
+                }
+                Node* node = &m_blocks[m_block][m_used++];
+                *node = Node{ i, x, y, nullptr, nullptr, 0, nullptr, nullptr, false };
+                return node;
+            }
+
+            void reset()
+            {
+                m_block = 0;
+                m_used = 0;
+                if (m_blocks.size() > 16)
+                    m_blocks.resize(16); // Release the memory of exceptionally large polygons
+            }
+        private:
+            std::vector<std::unique_ptr<Node[]>> m_blocks;
+            size_t                               m_block;
+            size_t                               m_used;
+    };
+
+    class Earcut
+    {
+        public:
+            bool triangulate(const double* x, const double* y, const size_t* ringOffsets, size_t ringCount, std::vector<uint32_t>& outIndices)
+            {
+                if (ringCount == 0)
+                    return false;
+
+                m_x = x;
+                m_y = y;
+                m_out = &outIndices;
+                m_hashing = false;
+                m_nodes.reset();
+                size_t before = outIndices.size();
+
+                size_t outerBegin = ringOffsets[0];
+                size_t outerEnd = ringOffsets[1];
+                Node* outer = linkedList(outerBegin, outerEnd, true);
+                if (outer == nullptr || outer->next == outer->prev)
+                    return false;
+
+                if (ringCount > 1)
+                    outer = eliminateHoles(ringOffsets, ringCount, outer);
+
+                // The z-order index only pays off for polygons with more than a few vertices
+                if (ringOffsets[ringCount] - outerBegin > 80)
+                {
+                    double minX = x[outerBegin], maxX = minX;
+                    double minY = y[outerBegin], maxY = minY;
+                    for (size_t i(outerBegin+1); i<outerEnd; ++i)
+                    {
+                        minX = std::min(minX, x[i]);
+                        minY = std::min(minY, y[i]);
+                        maxX = std::max(maxX, x[i]);
+                        maxY = std::max(maxY, y[i]);
+                    }
+                    double size = std::max(maxX - minX, maxY - minY);
+                    m_minX = minX;
+                    m_minY = minY;
+                    m_invSize = size != 0.0 ? 32767.0 / size : 0.0;
+                    m_hashing = m_invSize != 0.0;
+                }
+
+                earcutLinked(outer, 0);
+
+                return outIndices.size() > before;
+            }
+
+        private:
+            // Creates a circular doubly linked list of the ring, in the given winding order
+            Node* linkedList(size_t begin, size_t end, bool clockwise)
+            {
+                Node* last = nullptr;
+                if (clockwise == (signedArea(begin, end) > 0))
+                {
+                    for (size_t i(begin); i<end; ++i)
+                        last = insertNode(uint32_t(i), last);
+                }
+                else
+                {
+                    for (size_t i(end); i-- > begin;)
+                        last = insertNode(uint32_t(i), last);
+                }
+
+                if (last != nullptr && equals(last, last->next))
+                {
+                    removeNode(last);
+                    last = last->next;
+                }
+
+                return last;
+            }
+
+            // Removes duplicate and collinear points
+            Node* filterPoints(Node* start, Node* end = nullptr)
+            {
+                if (start == nullptr)
+                    return start;
+                if (end == nullptr)
+                    end = start;
+
+                Node* p = start;
+                bool again;
+                do
+                {
+                    again = false;
+                    if (!p->steiner && (equals(p, p->next) || area(p->prev, p, p->next) == 0.0))
+                    {
+                        removeNode(p);
+                        p = end = p->prev;
+                        if (p == p->next)
+                            break;
+                        again = true;
+                    }
+                    else
+                    {
+                        p = p->next;
+                    }
+                } while (again || p != end);
+
+                return end;
+            }
+
+            // Main ear slicing loop. Passes: 0 normal, 1 after filtering points, 2 after curing
+            // local self intersections, then the remaining polygon is split in two.
+            void earcutLinked(Node* ear, int pass)
+            {
+                if (ear == nullptr)
+                    return;
+
+                if (pass == 0 && m_hashing)
+                    indexCurve(ear);
+
+                Node* stop = ear;
+                while (ear->prev != ear->next)
+                {
+                    Node* prev = ear->prev;
+                    Node* next = ear->next;
+
+                    if (m_hashing ? isEarHashed(ear) : isEar(ear))
+                    {
+                        addTriangle(prev, ear, next);
+                        removeNode(ear);
+
+                        // Skipping the next vertex leads to fewer sliver triangles
+                        ear = next->next;
+                        stop = next->next;
+                        continue;
+                    }
+
+                    ear = next;
+
+                    if (ear == stop)
+                    {
+                        if (pass == 0)
+                        {
+                            earcutLinked(filterPoints(ear), 1);
+                        }
+                        else if (pass == 1)
+                        {
+                            ear = cureLocalIntersections(filterPoints(ear));
+                            earcutLinked(ear, 2);
+                        }
+                        else if (pass == 2)
+                        {
+                            splitEarcut(ear);
+                        }
+                        break;
+                    }
+                }
+            }
+
+            bool isEar(Node* ear) const
+            {
+                const Node* a = ear->prev;
+                const Node* b = ear;
+                const Node* c = ear->next;
+                if (area(a, b, c) >= 0.0)
+                    return false; // Reflex
+
+                double x0 = std::min({ a->x, b->x, c->x });
+                double y0 = std::min({ a->y, b->y, c->y });
+                double x1 = std::max({ a->x, b->x, c->x });
+                double y1 = std::max({ a->y, b->y, c->y });
+
+                // No other point may be inside the ear
+                for (const Node* p = c->next; p != a; p = p->next)
+                {
+                    if (p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1 &&
+                        pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) &&
+                        area(p->prev, p, p->next) >= 0.0)
+                        return false;
+                }
+
+                return true;
+            }
+
+            bool isEarHashed(Node* ear) const
+            {
+                const Node* a = ear->prev;
+                const Node* b = ear;
+                const Node* c = ear->next;
+                if (area(a, b, c) >= 0.0)
+                    return false;
+
+                double x0 = std::min({ a->x, b->x, c->x });
+                double y0 = std::min({ a->y, b->y, c->y });
+                double x1 = std::max({ a->x, b->x, c->x });
+                double y1 = std::max({ a->y, b->y, c->y });
+                int32_t minZ = zOrder(x0, y0);
+                int32_t maxZ = zOrder(x1, y1);
+
+                auto blocks = [&](const Node* p)
+                {
+                    return p != a && p != c &&
+                        p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1 &&
+                        pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) &&
+                        area(p->prev, p, p->next) >= 0.0;
+                };
+
+                // Look for points inside the triangle in both directions of the z-order
+                const Node* p = ear->prevZ;
+                const Node* n = ear->nextZ;
+                while (p != nullptr && p->z >= minZ && n != nullptr && n->z <= maxZ)
+                {
+                    if (blocks(p))
+                        return false;
+                    p = p->prevZ;
+                    if (blocks(n))
+                        return false;
+                    n = n->nextZ;
+                }
+                for (; p != nullptr && p->z >= minZ; p = p->prevZ)
+                {
+                    if (blocks(p))
+                        return false;
+                }
+                for (; n != nullptr && n->z <= maxZ; n = n->nextZ)
+                {
+                    if (blocks(n))
+                        return false;
+                }
+
+                return true;
+            }
+
+            // Removes small self intersections by clipping the triangle around them
+            Node* cureLocalIntersections(Node* start)
+            {
+                Node* p = start;
+                do
+                {
+                    Node* a = p->prev;
+                    Node* b = p->next->next;
+                    if (!equals(a, b) && intersects(a, p, p->next, b) && locallyInside(a, b) && locallyInside(b, a))
+                    {
+                        addTriangle(a, p, b);
+                        removeNode(p);
+                        removeNode(p->next);
+                        p = start = b;
+                    }
+                    p = p->next;
+                } while (p != start);
+
+                return filterPoints(p);
+            }
+
+            // Splits the polygon along a valid diagonal and triangulates both halves
+            void splitEarcut(Node* start)
+            {
+                Node* a = start;
+                do
+                {
+                    for (Node* b = a->next->next; b != a->prev; b = b->next)
+                    {
+                        if (a->i != b->i && isValidDiagonal(a, b))
+                        {
+                            Node* c = splitPolygon(a, b);
+                            a = filterPoints(a, a->next);
+                            c = filterPoints(c, c->next);
+                            earcutLinked(a, 0);
+                            earcutLinked(c, 0);
+                            return;
+                        }
+                    }
+                    a = a->next;
+                } while (a != start);
+            }
+
+            // Links the holes into the outer ring, from left to right
+            Node* eliminateHoles(const size_t* ringOffsets, size_t ringCount, Node* outer)
+            {
+                m_holes.clear();
+                for (size_t r(1); r<ringCount; ++r)
+                {
+                    Node* list = linkedList(ringOffsets[r], ringOffsets[r+1], false);
+                    if (list == nullptr)
+                        continue;
+                    if (list == list->next)
+                        list->steiner = true;
+                    m_holes.push_back(leftmost(list));
+                }
+                std::sort(m_holes.begin(), m_holes.end(), [](const Node* a, const Node* b) { return a->x < b->x; });
+
+                for (Node* hole : m_holes)
+                {
+                    outer = eliminateHole(hole, outer);
+                }
+
+                return outer;
+            }
+
+            Node* eliminateHole(Node* hole, Node* outer)
+            {
+                Node* bridge = findHoleBridge(hole, outer);
+                if (bridge == nullptr)
+                    return outer;
+
+                Node* bridgeReverse = splitPolygon(bridge, hole);
+                filterPoints(bridgeReverse, bridgeReverse->next);
+                return filterPoints(bridge, bridge->next);
+            }
+
+            // Finds a vertex of the outer ring that the leftmost vertex of the hole can be connected to
+            // without crossing any edge (David Eberly, Triangulation by Ear Clipping)
+            Node* findHoleBridge(Node* hole, Node* outer) const
+            {
+                double hx = hole->x;
+                double hy = hole->y;
+                double qx = -HUGE_VAL;
+                Node* m = nullptr;
+
+                // Segment intersected by a ray from the hole point to the left, the endpoint with the smaller x is the candidate
+                Node* p = outer;
+                do
+                {
+                    if (hy <= p->y && hy >= p->next->y && p->next->y != p->y)
+                    {
+                        double x = p->x + (hy - p->y)*(p->next->x - p->x)/(p->next->y - p->y);
+                        if (x <= hx && x > qx)
+                        {
+                            qx = x;
+                            m = p->x < p->next->x ? p : p->next;
+                            if (x == hx)
+                                return m; // The hole touches the outer segment
+                        }
+                    }
+                    p = p->next;
+                } while (p != outer);
+
+                if (m == nullptr)
+                    return nullptr;
+
+                // Points inside the triangle of the hole point, the intersection and the candidate may block the bridge,
+                // use the one with the smallest angle to the ray instead
+                Node* stop = m;
+                double mx = m->x;
+                double my = m->y;
+                double tanMin = HUGE_VAL;
+                p = m;
+                do
+                {
+                    if (hx >= p->x && p->x >= mx && hx != p->x &&
+                        pointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, p->x, p->y))
+                    {
+                        double tan = std::abs(hy - p->y) / (hx - p->x);
+                        if (locallyInside(p, hole) &&
+                            (tan < tanMin || (tan == tanMin && (p->x > m->x || (p->x == m->x && sectorContainsSector(m, p))))))
+                        {
+                            m = p;
+                            tanMin = tan;
+                        }
+                    }
+                    p = p->next;
+                } while (p != stop);
+
+                return m;
+            }
+
+            static bool sectorContainsSector(const Node* m, const Node* p)
+            {
+                return area(m->prev, m, p->prev) < 0.0 && area(p->next, m, m->next) < 0.0;
+            }
+
+            // Links the nodes in z-order
+            void indexCurve(Node* start)
+            {
+                Node* p = start;
+                do
+                {
+                    if (p->z == 0)
+                        p->z = zOrder(p->x, p->y);
+                    p->prevZ = p->prev;
+                    p->nextZ = p->next;
+                    p = p->next;
+                } while (p != start);
+
+                p->prevZ->nextZ = nullptr;
+                p->prevZ = nullptr;
+
+                sortLinked(p);
+            }
+
+            // Merge sort of the z-order list (Simon Tatham), O(n log n) without extra memory
+            static Node* sortLinked(Node* list)
+            {
+                size_t inSize = 1;
+                size_t numMerges;
+                do
+                {
+                    Node* p = list;
+                    Node* tail = nullptr;
+                    list = nullptr;
+                    numMerges = 0;
+
+                    while (p != nullptr)
+                    {
+                        ++numMerges;
+                        Node* q = p;
+                        size_t pSize = 0;
+                        for (size_t i(0); i<inSize; ++i)
+                        {
+                            ++pSize;
+                            q = q->nextZ;
+                            if (q == nullptr)
+                                break;
+                        }
+                        size_t qSize = inSize;
+
+                        while (pSize > 0 || (qSize > 0 && q != nullptr))
+                        {
+                            Node* e;
+                            if (pSize != 0 && (qSize == 0 || q == nullptr || p->z <= q->z))
+                            {
+                                e = p;
+                                p = p->nextZ;
+                                --pSize;
+                            }
+                            else
+                            {
+                                e = q;
+                                q = q->nextZ;
+                                --qSize;
+                            }
+
+                            if (tail != nullptr)
+                                tail->nextZ = e;
+                            else
+                                list = e;
+
+                            e->prevZ = tail;
+                            tail = e;
+                        }
+
+                        p = q;
+                    }
+
+                    tail->nextZ = nullptr;
+                    inSize *= 2;
+                } while (numMerges > 1);
+
+                return list;
+            }
+
+            // Interleaved bits of the coordinates, relative to the bounds of the outer ring (15 bits each)
+            int32_t zOrder(double px, double py) const
+            {
+                int32_t x = int32_t((px - m_minX)*m_invSize);
+                int32_t y = int32_t((py - m_minY)*m_invSize);
+
+                x = (x | (x << 8)) & 0x00FF00FF;
+                x = (x | (x << 4)) & 0x0F0F0F0F;
+                x = (x | (x << 2)) & 0x33333333;
+                x = (x | (x << 1)) & 0x55555555;
+
+                y = (y | (y << 8)) & 0x00FF00FF;
+                y = (y | (y << 4)) & 0x0F0F0F0F;
+                y = (y | (y << 2)) & 0x33333333;
+                y = (y | (y << 1)) & 0x55555555;
+
+                return x | (y << 1);
+            }
+
+            static Node* leftmost(Node* start)
+            {
+                Node* p = start;
+                Node* result = start;
+                do
+                {
+                    if (p->x < result->x || (p->x == result->x && p->y < result->y))
+                        result = p;
+                    p = p->next;
+                } while (p != start);
+
+                return result;
+            }
+
+            static bool pointInTriangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py)
+            {
+                return (cx - px)*(ay - py) >= (ax - px)*(cy - py) &&
+                       (ax - px)*(by - py) >= (bx - px)*(ay - py) &&
+                       (bx - px)*(cy - py) >= (cx - px)*(by - py);
+            }
+
+            // Whether a diagonal between a and b can be used to split the polygon
+            static bool isValidDiagonal(const Node* a, const Node* b)
+            {
+                return a->next->i != b->i && a->prev->i != b->i && !intersectsPolygon(a, b) &&
+                       ((locallyInside(a, b) && locallyInside(b, a) && middleInside(a, b) &&
+                         (area(a->prev, a, b->prev) != 0.0 || area(a, b->prev, b) != 0.0)) ||
+                        (equals(a, b) && area(a->prev, a, a->next) > 0.0 && area(b->prev, b, b->next) > 0.0));
+            }
+
+            // Signed area of the triangle, negative for a convex corner in the winding used
+            static double area(const Node* p, const Node* q, const Node* r)
+            {
+                return (q->y - p->y)*(r->x - q->x) - (q->x - p->x)*(r->y - q->y);
+            }
+
+            static bool equals(const Node* a, const Node* b)
+            {
+                return a->x == b->x && a->y == b->y;
+            }
+
+            static int sign(double value)
+            {
+                return value > 0.0 ? 1 : (value < 0.0 ? -1 : 0);
+            }
+
+            // Whether q lies on segment pr, given that the points are collinear
+            static bool onSegment(const Node* p, const Node* q, const Node* r)
+            {
+                return q->x <= std::max(p->x, r->x) && q->x >= std::min(p->x, r->x) &&
+                       q->y <= std::max(p->y, r->y) && q->y >= std::min(p->y, r->y);
+            }
+
+            static bool intersects(const Node* p1, const Node* q1, const Node* p2, const Node* q2)
+            {
+                int o1 = sign(area(p1, q1, p2));
+                int o2 = sign(area(p1, q1, q2));
+                int o3 = sign(area(p2, q2, p1));
+                int o4 = sign(area(p2, q2, q1));
+
+                if (o1 != o2 && o3 != o4)
+                    return true;
+
+                return (o1 == 0 && onSegment(p1, p2, q1)) ||
+                       (o2 == 0 && onSegment(p1, q2, q1)) ||
+                       (o3 == 0 && onSegment(p2, p1, q2)) ||
+                       (o4 == 0 && onSegment(p2, q1, q2));
+            }
+
+            // Whether the diagonal ab intersects any edge of the polygon
+            static bool intersectsPolygon(const Node* a, const Node* b)
+            {
+                const Node* p = a;
+                do
+                {
+                    if (p->i != a->i && p->next->i != a->i && p->i != b->i && p->next->i != b->i && intersects(p, p->next, a, b))
+                        return true;
+                    p = p->next;
+                } while (p != a);
+
+                return false;
+            }
+
+            // Whether the diagonal ab leaves a towards the inside of the polygon
+            static bool locallyInside(const Node* a, const Node* b)
+            {
+                return area(a->prev, a, a->next) < 0.0 ?
+                    area(a, b, a->next) >= 0.0 && area(a, a->prev, b) >= 0.0 :
+                    area(a, b, a->prev) < 0.0 || area(a, a->next, b) < 0.0;
+            }
+
+            // Whether the middle of the diagonal ab is inside the polygon
+            static bool middleInside(const Node* a, const Node* b)
+            {
+                const Node* p = a;
+                bool inside = false;
+                double px = (a->x + b->x)*0.5;
+                double py = (a->y + b->y)*0.5;
+                do
+                {
+                    if (((p->y > py) != (p->next->y > py)) && p->next->y != p->y &&
+                        (px < (p->next->x - p->x)*(py - p->y)/(p->next->y - p->y) + p->x))
+                        inside = !inside;
+                    p = p->next;
+                } while (p != a);
+
+                return inside;
+            }
+
+            // Splits the polygon in two by the diagonal ab, both a and b are duplicated. Returns the copy of b,
+            // which is in the other polygon than a.
+            Node* splitPolygon(Node* a, Node* b)
+            {
+                Node* a2 = m_nodes.create(a->i, a->x, a->y);
+                Node* b2 = m_nodes.create(b->i, b->x, b->y);
+                Node* an = a->next;
+                Node* bp = b->prev;
+
+                a->next = b;
+                b->prev = a;
+
+                a2->next = an;
+                an->prev = a2;
+
+                b2->next = a2;
+                a2->prev = b2;
+
+                bp->next = b2;
+                b2->prev = bp;
+
+                return b2;
+            }
+
+            Node* insertNode(uint32_t i, Node* last)
+            {
+                Node* p = m_nodes.create(i, m_x[i], m_y[i]);
+                if (last == nullptr)
+                {
+                    p->prev = p;
+                    p->next = p;
+                }
+                else
+                {
+                    p->next = last->next;
+                    p->prev = last;
+                    last->next->prev = p;
+                    last->next = p;
+                }
+
+                return p;
+            }
+
+            static void removeNode(Node* p)
+            {
+                p->next->prev = p->prev;
+                p->prev->next = p->next;
+
+                if (p->prevZ != nullptr)
+                    p->prevZ->nextZ = p->nextZ;
+                if (p->nextZ != nullptr)
+                    p->nextZ->prevZ = p->prevZ;
+            }
+
+            double signedArea(size_t begin, size_t end) const
+            {
+                double sum = 0.0;
+                for (size_t i(begin), j(end-1); i<end; j=i++)
+                {
+                    sum += (m_x[j] - m_x[i])*(m_y[i] + m_y[j]);
+                }
+
+                return sum;
+            }
+
+            void addTriangle(const Node* a, const Node* b, const Node* c)
+            {
+                m_out->push_back(a->i);
+                m_out->push_back(b->i);
+                m_out->push_back(c->i);
+            }
+
+            NodePool               m_nodes;
+            std::vector<Node*>     m_holes;
+            const double*          m_x = nullptr;
+            const double*          m_y = nullptr;
+            std::vector<uint32_t>* m_out = nullptr;
+            bool                   m_hashing = false;
+            double                 m_minX = 0.0;
+            double                 m_minY = 0.0;
+            double                 m_invSize = 0.0;
+    };
+
+    // One triangulator per thread, to reuse the node memory
+    thread_local Earcut s_earcut;
+}
+
+bool Triangulation::triangulate(const double* x, const double* y, const size_t* ringOffsets, size_t ringCount, std::vector<uint32_t>& outIndices)
+{
+    return s_earcut.triangulate(x, y, ringOffsets, ringCount, outIndices);
+}
+
+bool Triangulation::triangulate(const CoordinateBuffer& coordinates, std::vector<uint32_t>& outIndices)
+{
+    size_t ringCount = coordinates.partCount();
+    if (ringCount == 0)
+        return false;
+
+    thread_local std::vector<size_t> ringOffsets;
+    ringOffsets.resize(ringCount + 1);
+    for (size_t r(0); r<ringCount; ++r)
+    {
+        ringOffsets[r] = coordinates.partBegin(r);
+    }
+    ringOffsets[ringCount] = coordinates.partEnd(ringCount - 1);
+
+    return triangulate(coordinates.x().data(), coordinates.y().data(), ringOffsets.data(), ringCount, outIndices);
+}
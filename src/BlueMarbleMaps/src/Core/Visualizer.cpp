@@ -1,4 +1,5 @@
 #include "BlueMarbleMaps/Core/Visualizer.h"
+#include "BlueMarbleMaps/Core/FrameArena.h"
 
 using namespace BlueMarble;
 
@@ -100,6 +101,8 @@ void PointVisualizer::renderFeature(Drawable& drawable, const FeaturePtr& featur
     auto cond = condition();
     if (!isValidGeometry(feature->geometryType()) || !cond(feature, updateAttributes))
         return;
+    if (feature->attributes().contains(FeatureAttributeKeys::FillOnly))
+        return; // Drawn from another part of the feature
 
     auto points = std::vector<Point>();
     if (atCenter())
@@ -117,9 +120,9 @@ void PointVisualizer::renderFeature(Drawable& drawable, const FeaturePtr& featur
             points = feature->geometryAsLine()->points();
             break;
         case GeometryType::Polygon:
-            for (auto& ring : feature->geometryAsPolygon()->rings())
+            for (const auto& ring : feature->geometryAsPolygon()->rings())
             {
-                for (auto& p : ring)
+                for (const auto& p : ring)
                     points.push_back(p);
             }
             break;
@@ -164,9 +167,9 @@ void PointVisualizer::toPointFeature(const FeaturePtr& feature, Attributes& upda
             points = feature->geometryAsLine()->points();
             break;
         case GeometryType::Polygon:
-            for (auto& ring : feature->geometryAsPolygon()->rings())
+            for (const auto& ring : feature->geometryAsPolygon()->rings())
             {
-                for (auto& p : ring)
+                for (const auto& p : ring)
                     points.push_back(p);
             }
             break;
@@ -181,8 +184,8 @@ void PointVisualizer::toPointFeature(const FeaturePtr& feature, Attributes& upda
         int offsetX = m_offsetXEval(feature, updateAttributes);
         int offsetY = m_offsetXEval(feature, updateAttributes);
         p += Point(offsetX, offsetY);
-        auto geometry = std::make_shared<PointGeometry>(p);
-        outPointFeatures.push_back(std::make_shared<Feature>(feature->id(), feature->crs(), geometry, feature->attributes()));
+        auto geometry = makeTransient<PointGeometry>(p);
+        outPointFeatures.push_back(makeTransient<Feature>(feature->id(), feature->crs(), geometry, feature->attributes()));
     }
 }
 
@@ -198,6 +201,17 @@ void SymbolVisualizer::renderPoints(Drawable& drawable, const std::vector<Point>
     Color color = m_colorEval(feature, updateAttributes);
     
     double rotation = m_rotationEval(feature, updateAttributes);
+    if (m_symbol.builtInSymbol() == BuiltInSymbol::Circle)
+    {
+        // Collected by the drawable and drawn together, instanced where supported
+        m_instances.clear();
+        for (auto& point : points)
+        {
+            m_instances.push_back(SymbolInstance{ point, radius, rotation, color });
+        }
+        drawable.drawSymbols(m_instances);
+        return;
+    }
     for (auto& point : points)
     {
         //drawable.drawCircle(point.x(), point.y(), radius-3, color);
@@ -248,6 +262,8 @@ void TextVisualizer::renderPoints(Drawable &drawable, const std::vector<Point> &
 LineVisualizer::LineVisualizer()
     : Visualizer()
     , m_widthEval([](auto, auto) { return 1.0; })
+    , m_lineCache()
+    , m_lineCachePruneSize(1024)
 {
 }
 
@@ -265,7 +281,7 @@ void LineVisualizer::generatePresentationObjects(const FeaturePtr& feature, cons
         {
             return;
         }
-        for (auto& line : poly->rings())
+        for (const auto& line : poly->rings())
         {
             auto lineFeature = std::make_shared<Feature>(
                 feature->id(), 
@@ -305,36 +321,79 @@ void LineVisualizer::renderFeature(Drawable& drawable, const FeaturePtr& feature
     auto cond = condition();
     if (!isValidGeometry(feature->geometryType()) || !cond(feature, updateAttributes))
         return;
+    if (feature->attributes().contains(FeatureAttributeKeys::FillOnly))
+        return; // Drawn from another part of the feature
+
+    double offsetZ = m_offsetZEval(feature, updateAttributes);
+    offsetZ /= feature->crs()->globalMetersPerUnit(); // Meters
+
+    Pen pen(m_colorEval(feature, updateAttributes), m_widthEval(feature, updateAttributes));
+    if (feature->geometryType() == GeometryType::Line && offsetZ == 0.0)
+    {
+        // Drawn as is, no copy needed
+        drawable.drawLine(feature->geometryAsLine(), pen);
+        return;
+    }
 
-    auto lines = std::vector<std::vector<Point>>();
+    for (const auto& line : linesToDraw(feature, offsetZ))
+    {
+        drawable.drawLine(line, pen);
+    }
+}
+
+const std::vector<LineGeometryPtr>& LineVisualizer::linesToDraw(const FeaturePtr& feature, double offsetZ)
+{
+    const auto& geometry = feature->geometry();
+    auto& entry = m_lineCache[geometry.get()];
+
+    bool sameGeometry = !entry.source.expired() && !entry.source.owner_before(geometry) && !geometry.owner_before(entry.source);
+    if (sameGeometry && entry.version == geometry->version() && entry.offsetZ == offsetZ)
+    {
+        return entry.lines;
+    }
+
+    entry.source = geometry;
+    entry.version = geometry->version();
+    entry.offsetZ = offsetZ;
+    entry.lines.clear();
     switch (feature->geometryType())
     {
     case GeometryType::Line:
-        lines.push_back(feature->geometryAsLine()->points());
+        entry.lines.push_back(std::make_shared<LineGeometry>(feature->geometryAsLine()->points()));
         break;
     case GeometryType::Polygon:
-        for (auto ring : feature->geometryAsPolygon()->rings())
+        for (std::vector<Point> ring : feature->geometryAsPolygon()->rings())
         {
-            // Note: ring as copy!!!
-            // TODO: use line geometry with isClosed=true
-            ring.push_back(ring[0]); // Make a closed loop
-            lines.push_back(ring);
+            // Closed by repeating the first point, and marked closed so that wide lines get a join there
+            ring.push_back(ring[0]);
+            auto line = std::make_shared<LineGeometry>(ring);
+            line->isClosed(true);
+            entry.lines.push_back(line);
         }
         break;
     default:
         std::cout << "LineVisualizer::renderFeature() Unhandled GeometryType: " << (int)feature->geometryType() << "\n";
         throw std::exception();
     }
+    for (auto& line : entry.lines)
+    {
+        line->move(Point(0,0,offsetZ));
+    }
 
-    double offsetZ = m_offsetZEval(feature, updateAttributes);
-    offsetZ /= feature->crs()->globalMetersPerUnit(); // Meters
-
-    for (auto& line : lines)
+    // Drop the entries of released geometries now and then
+    if (m_lineCache.size() > 2*m_lineCachePruneSize)
     {
-        LineGeometryPtr linePtr = std::make_shared<LineGeometry>(line);
-        linePtr->move(Point(0,0,offsetZ));
-        drawable.drawLine(linePtr, Pen(m_colorEval(feature, updateAttributes), m_widthEval(feature, updateAttributes)));
+        for (auto it = m_lineCache.begin(); it != m_lineCache.end();)
+        {
+            if (it->second.source.expired())
+                it = m_lineCache.erase(it);
+            else
+                ++it;
+        }
+        m_lineCachePruneSize = std::max<size_t>(m_lineCache.size(), 1024);
     }
+
+    return entry.lines; // Erasing other entries keeps references to this one valid
 }
 
 bool LineVisualizer::hitTest(const FeaturePtr &feature, const DrawablePtr &drawable, const Rectangle &area, std::vector<PresentationObject> &outPresentation)
@@ -372,6 +431,8 @@ void PolygonVisualizer::renderFeature(Drawable& drawable, const FeaturePtr& feat
     auto cond = condition();
     if (!isValidGeometry(feature->geometryType()) || !cond(feature, updateAttributes))
         return;
+    if (feature->attributes().contains(FeatureAttributeKeys::NoFill))
+        return; // Drawn from another part of the feature
 
     auto geometry = feature->geometryAsPolygon();
     
@@ -389,41 +450,44 @@ void PolygonVisualizer::renderFeature(Drawable& drawable, const FeaturePtr& feat
     {
         // Need to clone the geometry if we intent modify it, otherwise hittesting for previous visualizers will mess up
         geometry = std::dynamic_pointer_cast<PolygonGeometry>(geometry->clone());
-    }
-    auto& polygonPoints = geometry->outerRing();
 
-    double epsilon = 0.000001;
-    if (scale != 1.0)
-    {
-        // TODO: should we do this?
-        // if (abs(scale) < epsilon)
-        //     scale = epsilon;
-        polygonPoints = Utils::scalePoints(polygonPoints, scale);
-    }
+        // Modify a copy of the ring and write it back once
+        std::vector<Point> polygonPoints = geometry->outerRing();
 
-    if (extend != 1.0)
-    {
-        // TODO: should we do this?
-        // if (abs(extend) < epsilon)
-        //     extend = epsilon;
-        polygonPoints = Utils::extendPolygon(polygonPoints, extend);
-    }
+        double epsilon = 0.000001;
+        if (scale != 1.0)
+        {
+            // TODO: should we do this?
+            // if (abs(scale) < epsilon)
+            //     scale = epsilon;
+            polygonPoints = Utils::scalePoints(polygonPoints, scale);
+        }
 
-    if (rotation != 0.0)
-    {
-        polygonPoints = Utils::rotatePoints(polygonPoints, rotation);
-    }
+        if (extend != 1.0)
+        {
+            // TODO: should we do this?
+            // if (abs(extend) < epsilon)
+            //     extend = epsilon;
+            polygonPoints = Utils::extendPolygon(polygonPoints, extend);
+        }
 
-    if (offX != 0.0 || offY != 0.0)
-    {
-        double incScale = 1.0 / updateAttributes.get<double>(UpdateAttributeKeys::UpdateViewScale);
-        offX *= incScale;
-        offY *= incScale;
-        Utils::movePoints(polygonPoints, Point(offX, offY));
+        if (rotation != 0.0)
+        {
+            polygonPoints = Utils::rotatePoints(polygonPoints, rotation);
+        }
+
+        if (offX != 0.0 || offY != 0.0)
+        {
+            double incScale = 1.0 / updateAttributes.get<double>(UpdateAttributeKeys::UpdateViewScale);
+            offX *= incScale;
+            offY *= incScale;
+            Utils::movePoints(polygonPoints, Point(offX, offY));
+        }
+
+        geometry->outerRing() = polygonPoints;
     }
 
     // Draw the polygon
-    //geometry->outerRing() = polygonPoints;
     drawable.drawPolygon(geometry, Pen::transparent(), createBrush(feature, updateAttributes));
 }
 
@@ -6,6 +6,11 @@
 
 using namespace BlueMarble::System;
 
+namespace
+{
+    thread_local bool t_isWorkerThread = false;
+}
+
 ThreadPool::ThreadPool(size_t numThreads, size_t maxQueueSize, QueuePolicy queuePolicy)
     : m_workers(numThreads)
     , m_tasks()
@@ -55,6 +60,7 @@ void ThreadPool::start(size_t numThreads, size_t maxQueueSize, QueuePolicy queue
     {
         worker = std::thread([this] 
         {
+            t_isWorkerThread = true;
             for (;;)
             {
                 std::unique_lock<std::mutex> lock(m_queueMutex);
@@ -82,24 +88,22 @@ void ThreadPool::start(size_t numThreads, size_t maxQueueSize, QueuePolicy queue
     }
 }
 
+bool ThreadPool::isWorkerThread()
+{
+    return t_isWorkerThread;
+}
+
 void ThreadPool::stop(bool dropQueuedTasks)
 {
     assert(isValidThreadAccess());
     BMM_DEBUG() << "ThreadPool::stop()\n";
+    std::queue<Task> dropped;
     {
         std::unique_lock<std::mutex> lock(m_queueMutex);
         m_stop = true;
         if (dropQueuedTasks)
         {
-            BMM_DEBUG() << "ThreadPool::stop() dropping queued tasks\n";
-            while (!m_tasks.empty())
-            {
-                auto t = std::move(m_tasks.front());
-                m_tasks.pop();
-                lock.unlock();
-                t.onDropped();
-                lock.lock();
-            }
+            std::swap(dropped, m_tasks);
         }
     }
     m_condition.notify_all();
@@ -110,7 +114,18 @@ void ThreadPool::stop(bool dropQueuedTasks)
             worker.join();
         }
     }
-    
+
+    // Called once the workers have been joined, such that onDropped does not run
+    // concurrently with the tasks in progress, which may share resources with it
+    if (!dropped.empty())
+    {
+        BMM_DEBUG() << "ThreadPool::stop() dropping queued tasks\n";
+    }
+    while (!dropped.empty())
+    {
+        dropped.front().onDropped();
+        dropped.pop();
+    }
 }
 
 void ThreadPool::enqueue(Task&& task)
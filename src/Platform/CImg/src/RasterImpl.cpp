@@ -1,4 +1,6 @@
 #include "RasterImpl.h"
+#include "stb_image_write.h"
+#include <fstream>
 
 using namespace BlueMarble;
 
@@ -60,6 +62,59 @@ int Raster::Impl::channels() const
     return m_img.spectrum();
 }
 
+int Raster::Impl::getCellIndexAt(int x, int y) const
+{
+    // Planar, the index of the first channel
+    assert(x >= 0); assert(x < m_img.width());
+    assert(y >= 0); assert(y < m_img.height());
+    return y * m_img.width() + x;
+}
+
+int Raster::Impl::getIntegerAt(int x, int y) const
+{
+    if (m_img.spectrum() != 1)
+    {
+        throw std::runtime_error("Raster::getIntegerAt() called for a raster that does not have 1 channels. (I have " + std::to_string(m_img.spectrum()) + ")");
+    }
+
+    return m_img(x, y);
+}
+
+float Raster::Impl::getFloatAt(int x, int y) const
+{
+    if (m_img.spectrum() != 1)
+    {
+        throw std::runtime_error("Raster::getFloatAt() called for a raster that does not have 1 channels. (I have " + std::to_string(m_img.spectrum()) + ")");
+    }
+
+    return m_img(x, y);
+}
+
+Color Raster::Impl::getColorAt(int x, int y) const
+{
+    if (m_img.spectrum() != 3 && m_img.spectrum() != 4)
+    {
+        throw std::runtime_error("Raster::getColorAt() called for a raster that does not have 3 or 4 channgels. (I have " + std::to_string(m_img.spectrum()) + ")");
+    }
+
+    unsigned char a = (m_img.spectrum() == 4) ? m_img(x, y, 0, 3) : 255;
+    return Color(m_img(x, y, 0, 0), m_img(x, y, 0, 1), m_img(x, y, 0, 2), a/255.0);
+}
+
+void Raster::Impl::setColorAt(int x, int y, const Color& c)
+{
+    if (m_img.spectrum() != 3 && m_img.spectrum() != 4)
+    {
+        throw std::runtime_error("Raster::setColorAt() called for a raster that does not have 3 or 4 channgels. (I have " + std::to_string(m_img.spectrum()) + ")");
+    }
+
+    m_img(x, y, 0, 0) = c.r();
+    m_img(x, y, 0, 1) = c.g();
+    m_img(x, y, 0, 2) = c.b();
+    if (m_img.spectrum() == 4)
+        m_img(x, y, 0, 3) = int(c.a()*255.0);
+}
+
 void Raster::Impl::resize(int width, int height, ResizeInterpolation interpolation)
 {
     int interpolationType = (int)interpolation;
@@ -89,6 +144,29 @@ void Raster::Impl::blur(double sigmaX, double sigmaY, double sigmaZ, bool isGaus
     m_img.blur(sigmaX, sigmaY, sigmaZ, isGaussian);
 }
 
+void Raster::Impl::unpremultiplyAlpha()
+{
+    if (m_img.spectrum() != 4)
+    {
+        return;
+    }
+
+    // Planar, one channel after the other
+    cimg_forXY(m_img, x, y)
+    {
+        unsigned int a = m_img(x, y, 0, 3);
+        if (a == 0 || a == 255)
+        {
+            continue;
+        }
+        for (int c(0); c<3; ++c)
+        {
+            unsigned int value = (m_img(x, y, 0, c)*255u + a/2)/a;
+            m_img(x, y, 0, c) = (unsigned char)std::min(value, 255u);
+        }
+    }
+}
+
 Raster Raster::Impl::getCrop(int x0, int y0, int x1, int y1)
 {
     auto raster = Raster(0,0,0,0); // prevent warning
@@ -97,6 +175,42 @@ Raster Raster::Impl::getCrop(int x0, int y0, int x1, int y1)
     return raster;
 }
 
+void Raster::Impl::save(const std::string& filePath) const
+{
+    auto png = encodePng();
+    std::ofstream file(filePath, std::ios::binary);
+    file.write((const char*)png.data(), png.size());
+}
+
+std::vector<unsigned char> Raster::Impl::encodePng() const
+{
+    // CImg only saves PNG files, through libpng or an external tool. Interleaved for stb_image_write instead.
+    int w = m_img.width();
+    int h = m_img.height();
+    int c = m_img.spectrum();
+    std::vector<unsigned char> pixels(size_t(w)*h*c);
+    cimg_forXYC(m_img, x, y, v)
+    {
+        pixels[(size_t(y)*w + x)*c + v] = m_img(x, y, 0, v);
+    }
+
+    std::vector<unsigned char> png;
+    auto write = [](void* context, void* data, int size)
+    {
+        auto* out = static_cast<std::vector<unsigned char>*>(context);
+        out->insert(out->end(), (unsigned char*)data, (unsigned char*)data + size);
+    };
+
+    // Top row first, as stored
+    stbi_flip_vertically_on_write(0);
+    if (stbi_write_png_to_func(write, &png, w, h, c, pixels.data(), w*c) == 0)
+    {
+        throw std::runtime_error("Raster::Impl::encodePng() Failed to encode the raster");
+    }
+
+    return png;
+}
+
 void* Raster::Impl::data() const
 {
     return (void*)m_img.data();
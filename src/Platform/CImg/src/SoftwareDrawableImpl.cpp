@@ -1,22 +1,31 @@
 #include "SoftwareDrawableImpl.h"
 
 #ifndef BLUEMARBLE_USE_CIMG_RASTER_IMPL
-// If opengl compatible raster implementation is used,
-// we need ImageDataOperations to convert image data in e.g.
-// drawRaster.
+// The stb_image Raster implementation is interleaved, with the
+// first row at the bottom (OpenGL), see getRaster()
 #include "BlueMarbleMaps/Utility/ImageDataOperations.h"
-#define OPENGL_TO_CIMG interleavedToPlanarFlipY
 #endif
- 
+#include "gtc/matrix_transform.hpp"
 
 using namespace BlueMarble;
 
 SoftwareDrawable::Impl::Impl(int width, int height, int channels)
-    : m_img(width, height, 1, channels, 0)
+    : m_transform()
+    , m_img(width, height, 1, channels, 0)
     , m_backGroundColor(Color::blue(0.0))
     , m_disp(nullptr)
-    , m_transform()
+    , m_projectionMatrix(glm::ortho(0.0, (double)width, (double)height, 0.0, -1.0, 1.0))
+    , m_viewMatrix(1.0)
+    , m_renderOrigin(0.0, 0.0)
+    , m_pixelMatrix(1.0)
+    , m_clipX0(0)
+    , m_clipY0(0)
+    , m_clipX1(width)
+    , m_clipY1(height)
+    , m_rasterizer()
 {
+    m_rasterizer.setTarget(m_img.data(), m_img.width(), m_img.height(), m_img.spectrum());
+    updatePixelMatrix();
 }
 
 const Transform& SoftwareDrawable::Impl::getTransform()
@@ -29,6 +38,41 @@ void SoftwareDrawable::Impl::setTransform(const Transform &transform)
     m_transform = transform;
 }
 
+void SoftwareDrawable::Impl::setProjectionMatrix(const glm::dmat4& proj)
+{
+    m_projectionMatrix = proj;
+    updatePixelMatrix();
+}
+
+void SoftwareDrawable::Impl::setViewMatrix(const glm::dmat4& viewMatrix)
+{
+    m_viewMatrix = viewMatrix;
+    m_renderOrigin = Point(0.0, 0.0, 0.0);
+}
+
+void SoftwareDrawable::Impl::setRenderOrigin(const Point& origin)
+{
+    m_renderOrigin = origin;
+}
+
+void SoftwareDrawable::Impl::updatePixelMatrix()
+{
+    // Normalized device coordinates to pixels, y down
+    glm::dmat4 viewport(1.0);
+    viewport[0][0] = 0.5*width();
+    viewport[1][1] = -0.5*height();
+    viewport[3][0] = 0.5*width();
+    viewport[3][1] = 0.5*height();
+    m_pixelMatrix = viewport*m_projectionMatrix;
+}
+
+Point SoftwareDrawable::Impl::toPixel(double x, double y, double z) const
+{
+    // Relative to the render origin before the view, as the OpenGL drawable does
+    glm::dvec4 p = m_pixelMatrix*(m_viewMatrix*glm::dvec4(x - m_renderOrigin.x(), y - m_renderOrigin.y(), z - m_renderOrigin.z(), 1.0));
+    return Point(p.x/p.w, p.y/p.w);
+}
+
 void BlueMarble::SoftwareDrawable::Impl::beginBatches()
 {
     //Facka you
@@ -41,7 +85,14 @@ void BlueMarble::SoftwareDrawable::Impl::endBatches()
 
 void SoftwareDrawable::Impl::resize(int width, int height)
 {
+    m_rasterizer.flush();
+    m_pendingRasters.clear();
     m_img.resize(width, height);
+    m_rasterizer.setTarget(m_img.data(), m_img.width(), m_img.height(), m_img.spectrum());
+    m_clipX0 = m_clipY0 = 0;
+    m_clipX1 = m_img.width();
+    m_clipY1 = m_img.height();
+    updatePixelMatrix();
 }
 
 int SoftwareDrawable::Impl::width() const
@@ -66,162 +117,157 @@ void SoftwareDrawable::Impl::backgroundColor(const Color& color)
 
 void SoftwareDrawable::Impl::fill(int val)
 {
+    m_rasterizer.discard();
+    m_pendingRasters.clear();
     m_img.fill(val);
 }
 
-void SoftwareDrawable::Impl::drawArc(float cx, float cy, float rx, float ry, double theta, const Pen& pen, const Brush& brush)
+void SoftwareDrawable::Impl::fillRing(const std::vector<double>& x, const std::vector<double>& y, const Color& color)
 {
-    std::cout << "SoftwareDrawable::Impl::drawArc Not implemented\n";
+    size_t offsets[] = { 0, x.size() };
+    m_rasterizer.fillPolygon(x.data(), y.data(), offsets, 1, color);
 }
 
-void SoftwareDrawable::Impl::drawCircle(int x, int y, double radius, const Pen& pen, const Brush& brush)
+void SoftwareDrawable::Impl::strokeLine(const std::vector<double>& x, const std::vector<double>& y, bool closed, const Pen& pen)
 {
-    // m_renderer->drawCircle(x, y,radius,color);
-    auto color = brush.getColor();
-    unsigned char c[] = {color.r(), color.g(), color.b(), (unsigned char)(color.a()*255)};
-    m_img.draw_circle(x, y, radius, c, color.a());
+    if (!(pen.getThickness() > 0.0) || !(pen.getColor().a() > 0.0))
+    {
+        return;
+    }
+    m_lineVertices.clear();
+    m_lineIndices.clear();
+    if (!LineTessellation::tessellate(x.data(), y.data(), x.size(), closed, pen, m_lineVertices, m_lineIndices))
+    {
+        return;
+    }
+    m_vertexX.resize(m_lineVertices.size());
+    m_vertexY.resize(m_lineVertices.size());
+    for (size_t i(0); i<m_lineVertices.size(); ++i)
+    {
+        const auto& vertex = m_lineVertices[i];
+        m_vertexX[i] = x[vertex.point] + vertex.offsetX;
+        m_vertexY[i] = y[vertex.point] + vertex.offsetY;
+    }
+    m_rasterizer.fillTriangles(m_vertexX.data(), m_vertexY.data(), m_lineIndices.data(), m_lineIndices.size(), pen.getColor());
 }
 
-void SoftwareDrawable::Impl::drawLine(const LineGeometryPtr& geometry, const Pen& pen)
+void SoftwareDrawable::Impl::drawArc(double cx, double cy, double rx, double ry, double theta, const Pen& pen, const Brush& brush)
 {
-    int size = geometry->points().size();
-    if (size == 0)
+    // Same 32 point ring as the OpenGL drawable, in map units
+    if (theta == 0)
     {
-        return;
+        theta = 2*M_PI;
     }
-    auto color = pen.getColor();
-    double width = pen.getThickness();
-    // m_renderer->drawLine(points, color, width);
-    unsigned char c[] = {color.r(), color.g(), color.b(), (unsigned char)(color.a()*255)};
-    auto line = geometry->points();
-    for (int i(0); i < size-1; ++i)
+    m_x.clear();
+    m_y.clear();
+    for (int i(0); i<32; ++i)
     {
-        auto& p1 = line[i];
-        auto& p2 = line[i+1];
-        int x0 = std::round(p1.x());
-        int y0 = std::round(p1.y());
-        int x1 = std::round(p2.x());
-        int y1 = std::round(p2.y());
-        if (width <= 1.0)
-            m_img.draw_line(x0, y0, x1, y1, c, color.a());
-        else
-        {
-            // Draw the line as a polygon
-            auto start = Point(x0, y0);
-            auto end = Point(x1, y1);
-            auto v = (end-start).norm();    // unit vector parallell to line
-            auto v2 = Point(-v.y(), v.x()); // unit vector norm to the line
-            
-            std::vector<Point> polygon;
-            polygon.push_back(start + v2*width*0.5);
-            polygon.push_back(start - v2*width*0.5);
-            polygon.push_back(end - v2*width*0.5);
-            polygon.push_back(end + v2*width*0.5);
-            PolygonGeometryPtr polygonPtr = std::make_shared<PolygonGeometry>(PolygonGeometry(polygon));
-            auto brush = Brush();
-            brush.setColor(color);
-            drawPolygon(polygonPtr, Pen(), brush);
-        }
+        double angle = theta*i/32.0;
+        Point p = toPixel(cx + rx*std::cos(angle), cy + ry*std::sin(angle));
+        m_x.push_back(p.x());
+        m_y.push_back(p.y());
     }
+    fillRing(m_x, m_y, brush.getColor());
+    strokeLine(m_x, m_y, true, pen);
 }
 
-void SoftwareDrawable::Impl::drawPolygon(const PolygonGeometryPtr& geometry, const Pen& pen, const Brush& brush)
+void SoftwareDrawable::Impl::drawCircle(double x, double y, double radius, const Pen& pen, const Brush& brush)
 {
-    auto color = brush.getColor();
+    drawArc(x, y, radius, radius, 0.0, pen, brush);
+}
 
-    assert(geometry->outerRing().size() > 2);
-    auto iterator = geometry->outerRing().begin();
-    cimg_library::CImg<int> pointsCImg(geometry->outerRing().size(), 2);
-    cimg_forX(pointsCImg,i) 
-    { 
-        auto& p = *(iterator++);
-        pointsCImg(i,0) = p.x(); 
-        pointsCImg(i,1) = p.y(); 
+void SoftwareDrawable::Impl::drawLine(const LineGeometryPtr& geometry, const Pen& pen)
+{
+    const CoordinateBuffer& coordinates = geometry->coordinates();
+    m_x.clear();
+    m_y.clear();
+    for (size_t i(0); i<coordinates.size(); ++i)
+    {
+        Point p = toPixel(coordinates.x()[i], coordinates.y()[i], coordinates.hasZ() ? coordinates.z()[i] : 0.0);
+        m_x.push_back(p.x());
+        m_y.push_back(p.y());
     }
-    
-    unsigned char c[] = {color.r(), color.g(), color.b(), (unsigned char)(color.a()*255)};
-    m_img.draw_polygon(pointsCImg, c, color.a()); // .display();
+    strokeLine(m_x, m_y, geometry->isClosed(), pen);
 }
 
-void SoftwareDrawable::Impl::drawRect(const Point& topLeft, const Point& bottomRight, const Color& color)
+void SoftwareDrawable::Impl::drawPolygon(const PolygonGeometryPtr& geometry, const Pen& pen, const Brush& brush)
 {
-    // m_renderer->drawRect(topLeft, bottomRight, color);
-    auto topLeftRounded = topLeft.round();
-    auto bottomRightRounded = bottomRight.round();
-    unsigned char c[] = {color.r(), color.g(), color.b(), (unsigned char)(color.a()*255)};
-    m_img.draw_rectangle(topLeftRounded.x(), 
-                            topLeftRounded.y(), 
-                            bottomRightRounded.x(), 
-                            bottomRightRounded.y(), 
-                            c, 
-                            (float)color.a());
+    // All rings at once, the holes are cut out by the even-odd rule
+    const CoordinateBuffer& coordinates = geometry->coordinates();
+    if (coordinates.empty())
+    {
+        return;
+    }
+    m_x.clear();
+    m_y.clear();
+    m_ringOffsets.clear();
+    for (size_t part(0); part<coordinates.partCount(); ++part)
+    {
+        m_ringOffsets.push_back(m_x.size());
+        for (size_t i(coordinates.partBegin(part)); i<coordinates.partEnd(part); ++i)
+        {
+            Point p = toPixel(coordinates.x()[i], coordinates.y()[i], coordinates.hasZ() ? coordinates.z()[i] : 0.0);
+            m_x.push_back(p.x());
+            m_y.push_back(p.y());
+        }
+    }
+    m_ringOffsets.push_back(m_x.size());
+    m_rasterizer.fillPolygon(m_x.data(), m_y.data(), m_ringOffsets.data(), m_ringOffsets.size() - 1, brush.getColor());
 }
 
-void SoftwareDrawable::Impl::drawRaster(const RasterGeometryPtr& geometry, const Brush& brush, const Rectangle& clip)
+void SoftwareDrawable::Impl::drawRect(const Point& topLeft, const Point& bottomRight, const Color& color)
 {
-    auto center = m_transform.translation();
-    double scaleX = m_transform.scaleX();
-    double scaleY = m_transform.scaleY();
-    double rotation = m_transform.rotation();
-
-    // TODO: This is the entire screen and might not be the update area that the view provided during the update.
-    // This will result in raster features that have info outside the update area provided by the view will be visible
-    Rectangle updateArea
-    (
-        center.x() - (width() / scaleX)*0.5,
-        center.y() - (height() / scaleY)*0.5,
-        center.x() + (width() / scaleX)*0.5,
-        center.y() + (height() / scaleY)*0.5
-    );
-
-    auto subGeometry = geometry->getSubRasterGeometry(updateArea);
-
-    Raster& subRaster = subGeometry->raster();
-
-    int screenWidth = subGeometry->bounds().width()*scaleX;
-    int screenHeight = subGeometry->bounds().height()*scaleY;
+    Point corners[] = { topLeft, Point(bottomRight.x(), topLeft.y()), bottomRight, Point(topLeft.x(), bottomRight.y()) };
+    m_x.clear();
+    m_y.clear();
+    for (const auto& corner : corners)
+    {
+        Point p = toPixel(corner.x(), corner.y());
+        m_x.push_back(p.x());
+        m_y.push_back(p.y());
+    }
+    fillRing(m_x, m_y, color);
+}
 
-    if (screenWidth == 0 || screenHeight == 0)
+void SoftwareDrawable::Impl::drawRaster(const RasterGeometryPtr& geometry, const Brush& brush, const Rectangle& /*clip*/)
+{
+    // Only the covered pixels are sampled, straight from the raster data, so there is no need
+    // to cut out and resize the part of the raster on screen
+    const Raster& raster = geometry->raster();
+    int w = raster.width();
+    int h = raster.height();
+    int channels = raster.channels();
+    if (w <= 0 || h <= 0 || raster.data() == nullptr)
     {
-        std::cout << "SoftwareDrawable::Impl::drawRaster - Raster resize dimensions are too small, ignoring draw (" << screenWidth << ", " << screenHeight << ")\n";
         return;
     }
 
-    auto minCorner = subGeometry->bounds().minCorner();
-
-    auto screenC = screenCenter();
-    auto delta = minCorner - center;
-    int x = delta.x()*scaleX + screenC.x();
-    int y = delta.y()*scaleY + screenC.y();
-    
-    subRaster.resize(screenWidth, screenHeight, Raster::ResizeInterpolation::NearestNeighbor);
+    // The opacity is the alpha of the first brush color, as for the OpenGL drawable
+    const auto& colors = brush.getColors();
+    double alpha = colors.empty() ? 1.0 : colors[0].a();
 
+    const Rectangle& bounds = geometry->bounds();
 #ifdef BLUEMARBLE_USE_CIMG_RASTER_IMPL
-    // CImg raster implementation
-    auto rasterImg = cimg_library::CImg<unsigned char>(raster.data(), raster.width(), raster.height(), 1, raster.channels(), true);
+    // CImg raster implementation, one plane per channel, the first row on top
+    size_t pixelStride = 1, rowStride = w, channelStride = size_t(w)*h;
+    double firstRowY = bounds.yMax(), lastRowY = bounds.yMin();
 #else
-    // stb_image Raster implementation, need to convert
-    auto rasterImg = cimg_library::CImg<unsigned char>((unsigned char*)subRaster.data(), subRaster.width(), subRaster.height(), 1, subRaster.channels());
-    OPENGL_TO_CIMG(rasterImg.data(), (unsigned char*)subRaster.data(), subRaster.width(), subRaster.height(), subRaster.channels());
+    // stb_image Raster implementation, interleaved, the first row at the bottom (OpenGL)
+    size_t pixelStride = channels, rowStride = size_t(w)*channels, channelStride = 1;
+    double firstRowY = bounds.yMin(), lastRowY = bounds.yMax();
 #endif
-
-    double alpha = brush.getColor().a();
-    if (rasterImg.spectrum() == 4)
-    {
-        //img.draw_image(x, y, rasterImg.get_shared_channels(0,2), rasterImg.get_shared_channel(3), 1.0, 255);
-        //img.draw_image(x, y, rasterImg, rasterImg.get_shared_channel(3), 1.0, 255);
-        m_img.draw_image(x, y, rasterImg, rasterImg.get_shared_channel(3), alpha, 255);
-    }
-    else
-    {
-        m_img.draw_image(x, y, 0, 0, rasterImg, alpha);
-    }
+    m_rasterizer.drawImage((const uint8_t*)raster.data(), w, h, channels, pixelStride, rowStride, channelStride,
+                           toPixel(bounds.xMin(), firstRowY), toPixel(bounds.xMax(), firstRowY), toPixel(bounds.xMin(), lastRowY),
+                           alpha);
+    m_pendingRasters.push_back(geometry);
 }
 
 void SoftwareDrawable::Impl::drawText(int x, int y, const std::string& text, const Color& color, int fontSize, const Color& bcolor)
 {
     // m_renderer->drawText(x, y, text, color, fontSize, bcolor);
     // TODO: fix opacity/alpha stuff
+    m_rasterizer.flush();
+    m_pendingRasters.clear();
     unsigned char c[] = {color.r(), color.g(), color.b(), (unsigned char)(color.a()*255)};
     if (bcolor.a() > 0)
     {
@@ -239,32 +285,54 @@ void SoftwareDrawable::Impl::drawText(int x, int y, const std::string& text, con
 
 void SoftwareDrawable::Impl::swapBuffers()
 {
-    // Update the image and save new black draw image
-    auto drawImg = cimg_library::CImg<unsigned char>(m_img.data(), m_img.width(), m_img.height(), 1, m_img.spectrum(), true);
+    m_rasterizer.flush();
+    m_pendingRasters.clear();
 
-    if (m_transform.rotation() != 0)
+    if (m_disp == nullptr)
     {
-        cimg_library::CImg<unsigned char> fixed_size_canvas(drawImg.width(), drawImg.height(), 1, drawImg.spectrum(), 0);
-
-        // Rotate the image by 45 degrees, centered at the middle of the canvas
-        cimg_library::CImg<unsigned char> rotated = drawImg.get_rotate(m_transform.rotation(), drawImg.width() / 2.0f, drawImg.height() / 2.0f);
-        //cimg_library::CImg<unsigned char> rotated = drawImg.get_rotate(m_transform.rotation(), 0, 0);
-
-        auto center1 = Point(drawImg.width() / 2.0, drawImg.height() / 2.0);
-        auto center2 = Point(rotated.width() / 2.0, rotated.height() / 2.0);
-        auto offset = center1 - center2;
-        // Draw the rotated image onto the fixed-size canvas
-        fixed_size_canvas.draw_image(offset.x(), offset.y(), 0, 0, rotated, 1.0f);
-        m_disp->display(fixed_size_canvas);
-        return;
+        return; // Offscreen, the image is read with getRaster()
     }
 
+    // The view rotation is applied when drawing, the image is displayed as is
+    auto drawImg = cimg_library::CImg<unsigned char>(m_img.data(), m_img.width(), m_img.height(), 1, m_img.spectrum(), true);
     m_disp->display(drawImg);
 }
 
 void SoftwareDrawable::Impl::clearBuffer()
 {
-    // No need?
+    m_rasterizer.discard();
+    m_pendingRasters.clear();
+    const Color& c = m_backGroundColor;
+    unsigned char values[] = { (unsigned char)c.r(), (unsigned char)c.g(), (unsigned char)c.b(), (unsigned char)std::lround(c.a()*255.0) };
+    for (int channel(0); channel<m_img.spectrum(); ++channel)
+    {
+        for (int y(m_clipY0); y<m_clipY1; ++y)
+        {
+            std::memset(m_img.data(m_clipX0, y, 0, channel), values[std::min(channel, 3)], m_clipX1 - m_clipX0);
+        }
+    }
+}
+
+void SoftwareDrawable::Impl::setClipRect(const Rectangle& pixels)
+{
+    // What is recorded so far is drawn with the previous clip
+    m_rasterizer.flush();
+    m_pendingRasters.clear();
+
+    if (pixels.isUndefined())
+    {
+        m_clipX0 = m_clipY0 = 0;
+        m_clipX1 = width();
+        m_clipY1 = height();
+    }
+    else
+    {
+        m_clipX0 = std::clamp((int)std::floor(pixels.xMin()), 0, width());
+        m_clipY0 = std::clamp((int)std::floor(pixels.yMin()), 0, height());
+        m_clipX1 = std::clamp((int)std::ceil(pixels.xMax()), m_clipX0, width());
+        m_clipY1 = std::clamp((int)std::ceil(pixels.yMax()), m_clipY0, height());
+    }
+    m_rasterizer.setClip(m_clipX0, m_clipY0, m_clipX1, m_clipY1);
 }
 
 void SoftwareDrawable::Impl::setWindow(void* window)
@@ -289,6 +357,8 @@ Color SoftwareDrawable::Impl::readPixel(int x, int y)
         std::cout << "Warning: Trying to read pixel outside buffer: " << x << ", " << y << "\n";
         return Color::black();
     }
+    m_rasterizer.flush();
+    m_pendingRasters.clear();
     auto img = cimg_library::CImg<unsigned char>(m_img.data(), m_img.width(), m_img.height(), 1, m_img.spectrum(), true);
     unsigned char r = img(x, y, 0, 0);
     unsigned char g = img(x, y, 0, 1);
@@ -305,6 +375,8 @@ void SoftwareDrawable::Impl::setPixel(int x, int y, const Color& color)
         std::cout << "Warning: Trying to set pixel outside buffer: " << x << ", " << y << "\n";
         return;
     }
+    m_rasterizer.flush();
+    m_pendingRasters.clear();
     auto img = cimg_library::CImg<unsigned char>(m_img.data(), m_img.width(), m_img.height(), 1, m_img.spectrum(), true);
     img(x, y, 0, 0) = (unsigned char)color.r();
     img(x, y, 0, 1) = (unsigned char)color.g();
@@ -312,7 +384,19 @@ void SoftwareDrawable::Impl::setPixel(int x, int y, const Color& color)
     img(x, y, 0, 3) = (unsigned char)(color.a()*255.0);
 }
 
-Point SoftwareDrawable::Impl::screenCenter()
+Raster SoftwareDrawable::Impl::getRaster()
 {
-    return Point((width()-1)*0.5, (height()-1)*0.5);
+    m_rasterizer.flush();
+    m_pendingRasters.clear();
+
+    // The buffer as is. Drawn onto a transparent black background, the colors are premultiplied by alpha,
+    // see Raster::unpremultiplyAlpha().
+    Raster raster(m_img.width(), m_img.height(), m_img.spectrum());
+#ifdef BLUEMARBLE_USE_CIMG_RASTER_IMPL
+    std::memcpy(raster.data(), m_img.data(), m_img.size());
+#else
+    planarToInterleavedFlipY((unsigned char*)raster.data(), m_img.data(), m_img.width(), m_img.height(), m_img.spectrum());
+#endif
+
+    return raster;
 }
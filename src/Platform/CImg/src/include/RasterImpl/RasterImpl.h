@@ -24,12 +24,20 @@ class Raster::Impl
         int width() const;
         int height() const;
         int channels() const;
+        int getCellIndexAt(int x, int y) const;
+        int getIntegerAt(int x, int y) const;
+        float getFloatAt(int x, int y) const;
+        Color getColorAt(int x, int y) const;
+        void setColorAt(int x, int y, const Color& c);
         void resize(int width, int height, ResizeInterpolation interpolation);
         void resize(float scaleRatio, ResizeInterpolation interpolation);
         void rotate(double angle, int cx, int cy, ResizeInterpolation interpolation);
         void fill(int val);
         void blur(double sigmaX, double sigmaY, double sigmaZ, bool isGaussian);
+        void unpremultiplyAlpha();
         Raster getCrop(int x0, int y0, int x1, int y1);
+        void save(const std::string& filePath) const;
+        std::vector<unsigned char> encodePng() const;
         void* data() const;
         Impl& operator=(const Impl& impl);
         Impl& operator=(Impl&& impl) noexcept;
@@ -3,6 +3,8 @@
 #endif
 
 #include "BlueMarbleMaps/Core/SoftwareDrawable.h"
+#include "BlueMarbleMaps/Core/SoftwareRasterizer.h"
+#include "BlueMarbleMaps/Core/LineTessellation.h"
 #include "CImg.h"
 
 namespace BlueMarble
@@ -13,6 +15,9 @@ namespace BlueMarble
             Impl(int width, int height, int channels);
             const Transform& getTransform();
             void setTransform(const Transform &transform);
+            void setProjectionMatrix(const glm::dmat4& proj);
+            void setViewMatrix(const glm::dmat4& viewMatrix);
+            void setRenderOrigin(const Point& origin);
             void beginBatches();
             void endBatches();
             void resize(int width, int height);
@@ -21,25 +26,48 @@ namespace BlueMarble
             const Color& backgroundColor() const;
             void backgroundColor(const Color& color);
             void fill(int val);
-            void drawArc(float cx, float cy, float rx, float ry, double theta, const Pen& pen, const Brush& brush);
-            void drawCircle(int x, int y, double radius, const Pen& pen, const Brush& brush);
+            void drawArc(double cx, double cy, double rx, double ry, double theta, const Pen& pen, const Brush& brush);
+            void drawCircle(double x, double y, double radius, const Pen& pen, const Brush& brush);
             void drawLine(const LineGeometryPtr& points, const Pen& pen);
             void drawPolygon(const PolygonGeometryPtr& points, const Pen& pen, const Brush& brush);
             void drawRect(const Point& topLeft, const Point& bottomRight, const Color& color);
             void drawRaster(const RasterGeometryPtr& geometry, const Brush& brush, const Rectangle& clip);
             void drawText(int x, int y, const std::string& text, const Color& color, int fontSize, const Color& bcolor);
             void clearBuffer();
+            void setClipRect(const Rectangle& pixels);
             void swapBuffers();
             void setWindow(void* window);
             RendererImplementation renderer();
             Color readPixel(int x, int y);
             void setPixel(int x, int y, const Color& color);
+            Raster getRaster();
         private:
-            Point screenCenter();
+            // Map coordinates to pixels, through the projection and view matrices
+            Point toPixel(double x, double y, double z = 0.0) const;
+            void updatePixelMatrix();
+            void fillRing(const std::vector<double>& x, const std::vector<double>& y, const Color& color);
+            void strokeLine(const std::vector<double>& x, const std::vector<double>& y, bool closed, const Pen& pen);
 
             Transform m_transform;
             cimg_library::CImg<unsigned char> m_img;
             Color  m_backGroundColor;
             cimg_library::CImgDisplay* m_disp;
+
+            glm::dmat4 m_projectionMatrix;
+            glm::dmat4 m_viewMatrix;
+            Point      m_renderOrigin;
+            glm::dmat4 m_pixelMatrix;       // Viewport * projection * view
+            int        m_clipX0, m_clipY0, m_clipX1, m_clipY1;   // Pixels drawn to, [x0, x1) x [y0, y1)
+
+            // Drawing is recorded by the rasterizer and drawn in parallel when the image is needed
+            SoftwareRasterizer              m_rasterizer;
+            std::vector<RasterGeometryPtr>  m_pendingRasters;   // Kept alive until drawn
+            std::vector<double>             m_x;
+            std::vector<double>             m_y;
+            std::vector<size_t>             m_ringOffsets;
+            std::vector<LineTessellation::Vertex> m_lineVertices;
+            std::vector<uint32_t>           m_lineIndices;
+            std::vector<double>             m_vertexX;
+            std::vector<double>             m_vertexY;
     };
 }
\ No newline at end of file
@@ -1,129 +1,307 @@
 #include "Batch.h"
-#include <iostream>
+#include <algorithm>
+#include <cstring>
 
-Batch::Batch(bool isPolygon)
+namespace
+{
+	const GLbitfield PersistentMapFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+	// Doubles the capacity until the required size fits, to keep the number of reallocations low
+	size_t grownCapacity(size_t capacity, size_t required)
+	{
+		while (capacity < required)
+		{
+			capacity *= 2;
+		}
+		return capacity;
+	}
+}
+
+BatchStats& BatchStats::operator+=(const BatchStats& other)
+{
+	vertices += other.vertices;
+	indices += other.indices;
+	bytes += other.bytes;
+	drawCalls += other.drawCalls;
+	flushes += other.flushes;
+	grows += other.grows;
+	waits += other.waits;
+	return *this;
+}
+
+Batch::Batch(GLenum drawType, const VertexLayout& layout, size_t vertexCapacity, size_t indexCapacity)
 	:m_vao()
 	,m_vbo()
 	,m_ibo()
-	,m_vertBuffer()
-	,m_indexBuffer()
+	,m_drawType(drawType)
+	,m_layout(layout)
+	,m_persistent(GLAD_GL_VERSION_4_4 && glBufferStorage != nullptr)
+	,m_mappedVertices(nullptr)
+	,m_mappedIndices(nullptr)
+	,m_stagingVertices()
+	,m_stagingIndices()
+	,m_vertexCapacity(0)
+	,m_indexCapacity(0)
+	,m_fences()
+	,m_region(0)
+	,m_vertexCount(0)
 	,m_indexCount(0)
-	,m_verticeCounter(0)
-	,m_isPolygon(isPolygon)
-{
-	m_vao.init();
-	m_vbo.init();
-	m_ibo.init();
-	m_vao.bind();
-	m_ibo.allocateDynamicBuffer(sizeof(GLuint)*600000);
-	m_vbo.allocateDynamicBuffer(sizeof(Vertice)*600000);
-	m_vao.link(m_vbo, 0, 3, GL_FLOAT, sizeof(Vertice), (void*)offsetof(Vertice, position));
-	m_vao.link(m_vbo, 1, 4, GL_FLOAT, sizeof(Vertice), (void*)offsetof(Vertice, color));
-	m_vao.link(m_vbo, 2, 2, GL_FLOAT, sizeof(Vertice), (void*)offsetof(Vertice, texCoord));
-	m_vbo.unbind();
-	m_vao.unbind();
+	,m_vertexDrawStart(0)
+	,m_indexDrawStart(0)
+	,m_frameVertexCount(0)
+	,m_frameIndexCount(0)
+	,m_stats()
+	,m_lastFrameStats()
+{
+	allocate(vertexCapacity, indexCapacity);
+	m_stats.grows = 0;
 }
 
 Batch::~Batch()
 {
-	delete m_vertBuffer;
-	delete m_indexBuffer;
+	// Deleting the buffers unmaps them
+	releaseFences();
+}
+
+void Batch::nextFrame()
+{
+	m_lastFrameStats = m_stats;
+	m_stats = BatchStats();
+
+	if (m_frameVertexCount > m_vertexCapacity || m_frameIndexCount > m_indexCapacity)
+	{
+		// The last frame did not fit in one region, grow so that the next one does
+		allocate(grownCapacity(m_vertexCapacity, m_frameVertexCount), grownCapacity(m_indexCapacity, m_frameIndexCount));
+	}
+	else if (m_indexCount > 0)
+	{
+		nextRegion();
+	}
+	m_frameVertexCount = 0;
+	m_frameIndexCount = 0;
 }
 
 void Batch::begin()
 {
-	m_vbo.bind();
-	m_vertBuffer = (Vertice*)glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
-	m_ibo.bind();
-	m_indexBuffer = (GLuint*)glMapBuffer(GL_ELEMENT_ARRAY_BUFFER, GL_WRITE_ONLY);
+	m_vertexDrawStart = m_vertexCount;
+	m_indexDrawStart = m_indexCount;
 }
-//Issue, on extremely large polygons how should we handle magix_number.
-//the "flush end begin should also be moved to a continuous check every time we draw something"
-void Batch::submit(std::vector<Vertice> &vertices)
+
+void Batch::submitVertices(const void* vertices, size_t vertexCount, const GLuint* indices, size_t indexCount)
 {
-	if (vertices.size() == 0) return;
-	if (m_indexCount + vertices.size()+1 >= (600000) - 1)
-	{
-		std::cout << "flushing in submit" << "\n";
-		end();
-		flush();
-		begin();
-	}
-	if (m_indexCount != 0)
+	if (vertexCount == 0 || indexCount == 0) return;
+	reserve(vertexCount, indexCount + 1);
+
+	GLuint* indexBuffer = indexData() + m_region*m_indexCapacity + m_indexCount;
+	if (m_indexCount != m_indexDrawStart)
 	{
-		*m_indexBuffer = (GLuint)MAGIX_NUMBER;
-		m_indexBuffer++;
+		*indexBuffer++ = (GLuint)MAGIX_NUMBER;
 		m_indexCount++;
 	}
-	for (int i = 0; i < vertices.size(); i++)
+	size_t firstVertex = m_region*m_vertexCapacity + m_vertexCount;
+	std::memcpy(vertexData() + m_layout.stride*firstVertex, vertices, m_layout.stride*vertexCount);
+	for (size_t i = 0; i < indexCount; i++)
 	{
-		m_vertBuffer->position = vertices[i].position;
-		m_vertBuffer->color = vertices[i].color;
-		m_vertBuffer->texCoord = vertices[i].texCoord;
-		m_vertBuffer++;
-		*m_indexBuffer = (GLuint)(i + m_verticeCounter);
-		m_indexBuffer++;
+		*indexBuffer++ = (GLuint)firstVertex + (indices != nullptr ? indices[i] : (GLuint)i);
 	}
-	m_indexCount += vertices.size();
-	m_verticeCounter += vertices.size();
+	m_indexCount += indexCount;
+	m_vertexCount += vertexCount;
+	m_stats.vertices += vertexCount;
 }
 
-void Batch::submit(std::vector<Vertice>& vertices, std::vector<GLuint> &indices)
+void Batch::end()
+{
+	flush();
+}
+
+void Batch::flush()
 {
-	if (vertices.size() == 0 || indices.size() == 0) return;
-	if (m_indexCount + indices.size() + 1 >= (600000) - 1) 
+	if (m_indexCount == m_indexDrawStart) return;
+
+	size_t firstIndex = m_region*m_indexCapacity + m_indexDrawStart;
+	size_t indexCount = m_indexCount - m_indexDrawStart;
+	if (!m_persistent)
 	{
-		std::cout << "flushing in submit" << "\n";
-		flush();
-		end();
-		begin();
+		size_t firstVertex = m_region*m_vertexCapacity + m_vertexDrawStart;
+		m_vbo->bind();
+		glBufferSubData(GL_ARRAY_BUFFER, m_layout.stride*firstVertex, m_layout.stride*(m_vertexCount - m_vertexDrawStart), m_stagingVertices.data() + m_layout.stride*firstVertex);
+		m_vbo->unbind();
+		m_ibo->bind();
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*firstIndex, sizeof(GLuint)*indexCount, m_stagingIndices.data() + firstIndex);
 	}
-	if (m_indexCount != 0)
+
+	m_vao->bind();
+	m_ibo->bind();
+	glEnable(GL_PRIMITIVE_RESTART);
+	glPrimitiveRestartIndex(MAGIX_NUMBER);
+	glDrawElements(m_drawType, (GLsizei)indexCount, GL_UNSIGNED_INT, (void*)(sizeof(GLuint)*firstIndex));
+	glDisable(GL_PRIMITIVE_RESTART);
+	m_vao->unbind();
+
+	m_stats.indices += indexCount;
+	m_stats.bytes += m_layout.stride*(m_vertexCount - m_vertexDrawStart) + sizeof(GLuint)*indexCount;
+	m_stats.drawCalls++;
+	m_vertexDrawStart = m_vertexCount;
+	m_indexDrawStart = m_indexCount;
+}
+
+const BatchStats& Batch::stats() const
+{
+	return m_stats;
+}
+
+const BatchStats& Batch::lastFrameStats() const
+{
+	return m_lastFrameStats;
+}
+
+size_t Batch::vertexCapacity() const
+{
+	return m_vertexCapacity;
+}
+
+size_t Batch::indexCapacity() const
+{
+	return m_indexCapacity;
+}
+
+bool Batch::persistentlyMapped() const
+{
+	return m_persistent;
+}
+
+void Batch::allocate(size_t vertexCapacity, size_t indexCapacity)
+{
+	// Buffers still used by queued draws are kept alive by the driver until they are done
+	releaseFences();
+	m_vao = std::make_unique<VAO>();
+	m_vbo = std::make_unique<VBO>();
+	m_ibo = std::make_unique<IBO>();
+	m_vao->init();
+	m_vbo->init();
+	m_ibo->init();
+
+	size_t vertexBytes = m_layout.stride*vertexCapacity*RegionCount;
+	size_t indexBytes = sizeof(GLuint)*indexCapacity*RegionCount;
+	m_vao->bind();
+	if (m_persistent)
 	{
-		*m_indexBuffer = (GLuint)MAGIX_NUMBER;
-		m_indexBuffer++;
-		m_indexCount++;
+		m_vbo->bind();
+		glBufferStorage(GL_ARRAY_BUFFER, vertexBytes, nullptr, PersistentMapFlags);
+		m_mappedVertices = (uint8_t*)glMapBufferRange(GL_ARRAY_BUFFER, 0, vertexBytes, PersistentMapFlags);
+		m_ibo->bind();
+		glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, indexBytes, nullptr, PersistentMapFlags);
+		m_mappedIndices = (GLuint*)glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, indexBytes, PersistentMapFlags);
+		if (m_mappedVertices == nullptr || m_mappedIndices == nullptr)
+		{
+			// Storage is immutable, start over with plain buffers
+			m_vao->unbind();
+			m_persistent = false;
+			allocate(vertexCapacity, indexCapacity);
+			return;
+		}
+		m_stagingVertices = std::vector<uint8_t>();
+		m_stagingIndices = std::vector<GLuint>();
 	}
-	for (int i = 0; i < vertices.size(); i++)
+	else
 	{
-		m_vertBuffer->position = vertices[i].position;
-		m_vertBuffer->color = vertices[i].color;
-		m_vertBuffer->texCoord = vertices[i].texCoord;
-		m_vertBuffer++;
+		m_ibo->allocateDynamicBuffer(indexBytes);
+		m_vbo->allocateDynamicBuffer(vertexBytes);
+		m_mappedVertices = nullptr;
+		m_mappedIndices = nullptr;
+		m_stagingVertices.resize(vertexBytes);
+		m_stagingIndices.resize(indexCapacity*RegionCount);
 	}
-	for (int i = 0; i < indices.size(); i++)
+	m_vbo->bind();
+	m_vao->link(*m_vbo, m_layout);
+	m_vbo->unbind();
+	m_vao->unbind();
+
+	m_vertexCapacity = vertexCapacity;
+	m_indexCapacity = indexCapacity;
+	m_region = 0;
+	m_vertexCount = 0;
+	m_indexCount = 0;
+	m_vertexDrawStart = 0;
+	m_indexDrawStart = 0;
+	m_stats.grows++;
+}
+
+void Batch::releaseFences()
+{
+	for (auto& fence : m_fences)
 	{
-		*m_indexBuffer = (GLuint)(indices[i] + m_verticeCounter);
-		m_indexBuffer++;
+		if (fence != nullptr)
+		{
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
 	}
-    m_indexCount += indices.size();
-	m_verticeCounter += vertices.size();
 }
 
-void Batch::end()
+void Batch::reserve(size_t vertexCount, size_t indexCount)
 {
-	m_vbo.bind();
-	glUnmapBuffer(GL_ARRAY_BUFFER);
-	m_ibo.bind();
-	glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
-	m_ibo.unbind();
+	m_frameVertexCount += vertexCount;
+	m_frameIndexCount += indexCount;
+	if (m_vertexCount + vertexCount <= m_vertexCapacity && m_indexCount + indexCount <= m_indexCapacity)
+	{
+		return;
+	}
+
+	// The region is full, draw what is pending and continue in the next one
+	flush();
+	m_stats.flushes++;
+	if (vertexCount > m_vertexCapacity || indexCount > m_indexCapacity)
+	{
+		allocate(grownCapacity(m_vertexCapacity, vertexCount), grownCapacity(m_indexCapacity, indexCount));
+	}
+	else
+	{
+		nextRegion();
+	}
 }
 
-void Batch::flush()
+void Batch::nextRegion()
 {
-	if (m_indexCount == 0) return;
+	// Everything drawn from the current region so far has to complete before it is written again
+	if (m_fences[m_region] != nullptr)
+	{
+		glDeleteSync(m_fences[m_region]);
+	}
+	m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 
-	GLuint drawType;
-	if (!m_isPolygon) drawType = GL_LINE_STRIP;
-	else drawType = GL_TRIANGLES;
-	m_vao.bind();
-	m_ibo.bind();
-	glEnable(GL_PRIMITIVE_RESTART);
-	glPrimitiveRestartIndex(MAGIX_NUMBER);
-	glDrawElements(drawType, m_indexCount, GL_UNSIGNED_INT, NULL);
-	glDisable(GL_PRIMITIVE_RESTART);
-	m_ibo.unbind();
-	m_vao.unbind();
+	m_region = (m_region + 1) % RegionCount;
+	waitForRegion();
+	m_vertexCount = 0;
 	m_indexCount = 0;
-	m_verticeCounter = 0;
+	m_vertexDrawStart = 0;
+	m_indexDrawStart = 0;
+}
+
+void Batch::waitForRegion()
+{
+	GLsync& fence = m_fences[m_region];
+	if (fence == nullptr)
+	{
+		return;
+	}
+
+	GLenum result = glClientWaitSync(fence, 0, 0);
+	if (result == GL_TIMEOUT_EXPIRED)
+	{
+		m_stats.waits++;
+		while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED);
+	}
+	glDeleteSync(fence);
+	fence = nullptr;
+}
+
+uint8_t* Batch::vertexData()
+{
+	return m_persistent ? m_mappedVertices : m_stagingVertices.data();
+}
+
+GLuint* Batch::indexData()
+{
+	return m_persistent ? m_mappedIndices : m_stagingIndices.data();
 }
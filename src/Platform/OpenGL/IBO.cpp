@@ -8,17 +8,16 @@ IBO::IBO()
 }
 IBO::~IBO()
 {
-	std::cout << "Deleting IBO with id: " << m_id << "\n";
 	glDeleteBuffers(1, &m_id);
 }
 void IBO::init()
 {
 	glGenBuffers(1, &m_id);
 }
-void IBO::bufferData(std::vector<GLuint> indicies)
+void IBO::bufferData(const std::vector<GLuint>& indicies)
 {
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indicies), &indicies[0], GL_STATIC_DRAW);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * indicies.size(), &indicies[0], GL_STATIC_DRAW);
 }
 void IBO::allocateDynamicBuffer(GLuint size)
 {
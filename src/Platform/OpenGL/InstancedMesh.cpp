@@ -0,0 +1,67 @@
+#include "InstancedMesh.h"
+#include <cmath>
+
+InstancedMesh::InstancedMesh(const std::vector<glm::vec2>& vertices, const std::vector<GLuint>& indices, const VertexLayout& instanceLayout)
+	:m_vao()
+	,m_meshVbo()
+	,m_ibo()
+	,m_instanceVbo()
+	,m_instanceLayout(instanceLayout)
+	,m_indexCount((GLsizei)indices.size())
+	,m_instanceCapacity(1024)
+{
+	m_vao.init();
+	m_meshVbo.init();
+	m_ibo.init();
+	m_instanceVbo.init();
+
+	m_vao.bind();
+	m_meshVbo.bind();
+	glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec2)*vertices.size(), vertices.data(), GL_STATIC_DRAW);
+	m_vao.link(m_meshVbo, VertexLayout::symbolMesh());
+	m_ibo.bufferData(indices);
+
+	m_instanceVbo.allocateDynamicBuffer(GLuint(m_instanceLayout.stride*m_instanceCapacity));
+	m_vao.link(m_instanceVbo, m_instanceLayout);
+	m_vao.unbind();
+	m_instanceVbo.unbind();
+}
+
+void InstancedMesh::draw(const void* instances, size_t instanceCount)
+{
+	if (instanceCount == 0 || m_indexCount == 0) return;
+
+	m_instanceVbo.bind();
+	while (m_instanceCapacity < instanceCount)
+	{
+		m_instanceCapacity *= 2;
+	}
+	// Orphan the previous contents, the GPU may still be drawing from them
+	glBufferData(GL_ARRAY_BUFFER, m_instanceLayout.stride*m_instanceCapacity, NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, m_instanceLayout.stride*instanceCount, instances);
+
+	m_vao.bind();
+	glDrawElementsInstanced(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT, (void*)0, (GLsizei)instanceCount);
+	m_vao.unbind();
+	m_instanceVbo.unbind();
+}
+
+size_t InstancedMesh::instanceCapacity() const
+{
+	return m_instanceCapacity;
+}
+
+void InstancedMesh::circle(int nSegments, std::vector<glm::vec2>& outVertices, std::vector<GLuint>& outIndices)
+{
+	outVertices.clear();
+	outIndices.clear();
+	outVertices.push_back(glm::vec2(0.0f));
+	for (int i = 0; i < nSegments; i++)
+	{
+		double angle = 2.0*3.14159265358979323846*i/nSegments;
+		outVertices.push_back(glm::vec2((float)std::cos(angle), (float)std::sin(angle)));
+		outIndices.push_back(0);
+		outIndices.push_back(GLuint(1 + i));
+		outIndices.push_back(GLuint(1 + (i + 1) % nSegments));
+	}
+}
@@ -5,7 +5,7 @@ Line::Line()
 {
 }
 
-Line::Line(LineGeometryInfoPtr info, std::vector<Vertice>& vertices)
+Line::Line(LineGeometryInfoPtr info, const std::vector<Vertice>& vertices)
 	:m_lineGeometryInfo(info)
 {
 	if (vertices.empty()) return;
@@ -22,6 +22,21 @@ Line::Line(LineGeometryInfoPtr info, std::vector<Vertice>& vertices)
 	m_lineGeometryInfo->m_vbo.unbind();
 }
 
+Line::Line(LineGeometryInfoPtr info, const std::vector<ColorVertex>& vertices)
+	:m_lineGeometryInfo(info)
+{
+	if (vertices.empty()) return;
+
+	m_lineGeometryInfo->m_vbo.init();
+	m_lineGeometryInfo->m_vbo.bufferData(vertices);
+	m_lineGeometryInfo->m_vao.init();
+
+	m_lineGeometryInfo->m_vao.bind();
+	m_lineGeometryInfo->m_vbo.bind();
+	m_lineGeometryInfo->m_vao.link(m_lineGeometryInfo->m_vbo, VertexLayout::colorVertex());
+	m_lineGeometryInfo->m_vbo.unbind();
+}
+
 void Line::setVao(VAO& vao)
 {
 	m_lineGeometryInfo->m_vao = vao;
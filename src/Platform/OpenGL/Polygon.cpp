@@ -5,7 +5,7 @@ Polygon::Polygon()
 {
 }
 
-Polygon::Polygon(PolygonGeometryInfoPtr info, std::vector<Vertice>& vertices, std::vector<GLuint>& indices)
+Polygon::Polygon(PolygonGeometryInfoPtr info, const std::vector<Vertice>& vertices, const std::vector<GLuint>& indices)
 	:m_polygonGeometryInfo(info)
 {
 	if (vertices.empty() || indices.empty()) return;
@@ -24,6 +24,40 @@ Polygon::Polygon(PolygonGeometryInfoPtr info, std::vector<Vertice>& vertices, st
 	m_polygonGeometryInfo->m_vbo.unbind();
 }
 
+Polygon::Polygon(PolygonGeometryInfoPtr info, const std::vector<ColorVertex>& vertices, const std::vector<GLuint>& indices)
+	:m_polygonGeometryInfo(info)
+{
+	if (vertices.empty() || indices.empty()) return;
+
+	m_polygonGeometryInfo->m_vbo.init();
+	m_polygonGeometryInfo->m_vbo.bufferData(vertices);
+	m_polygonGeometryInfo->m_ibo.init();
+	m_polygonGeometryInfo->m_ibo.bufferData(indices);
+	m_polygonGeometryInfo->m_vao.init();
+
+	m_polygonGeometryInfo->m_vao.bind();
+	m_polygonGeometryInfo->m_vbo.bind();
+	m_polygonGeometryInfo->m_vao.link(m_polygonGeometryInfo->m_vbo, VertexLayout::colorVertex());
+	m_polygonGeometryInfo->m_vbo.unbind();
+}
+
+Polygon::Polygon(PolygonGeometryInfoPtr info, const std::vector<LineVertex>& vertices, const std::vector<GLuint>& indices)
+	:m_polygonGeometryInfo(info)
+{
+	if (vertices.empty() || indices.empty()) return;
+
+	m_polygonGeometryInfo->m_vbo.init();
+	m_polygonGeometryInfo->m_vbo.bufferData(vertices);
+	m_polygonGeometryInfo->m_ibo.init();
+	m_polygonGeometryInfo->m_ibo.bufferData(indices);
+	m_polygonGeometryInfo->m_vao.init();
+
+	m_polygonGeometryInfo->m_vao.bind();
+	m_polygonGeometryInfo->m_vbo.bind();
+	m_polygonGeometryInfo->m_vao.link(m_polygonGeometryInfo->m_vbo, VertexLayout::lineVertex());
+	m_polygonGeometryInfo->m_vbo.unbind();
+}
+
 void Polygon::setVao(VAO& vao)
 {
 	m_polygonGeometryInfo->m_vao = vao;
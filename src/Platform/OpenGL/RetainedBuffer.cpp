@@ -0,0 +1,206 @@
+#include "RetainedBuffer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// The vertices of a geometry are within this many times its size from the origin of its page
+	const double MaxOriginDistance = 32.0;
+	// Pages geometries are added to at a time
+	const size_t OpenPageCount = 8;
+}
+
+RetainedBuffer::RetainedBuffer(const VertexLayout& layout, size_t pageVertexCapacity, size_t pageIndexCapacity)
+	:m_layout(layout)
+	,m_pageVertexCapacity(pageVertexCapacity)
+	,m_pageIndexCapacity(pageIndexCapacity)
+	,m_pages()
+	,m_openPages()
+	,m_nextPage(1)
+	,m_counts()
+	,m_offsets()
+	,m_stats()
+{
+}
+
+RetainedBuffer::Placement RetainedBuffer::place(double xMin, double yMin, double xMax, double yMax)
+{
+	double maxDistance = MaxOriginDistance*std::max(xMax - xMin, yMax - yMin);
+	for (size_t i = 0; i < m_openPages.size(); i++)
+	{
+		Page& page = *m_pages[m_openPages[i]];
+		double distance = std::max({ std::abs(xMin - page.origin.x), std::abs(xMax - page.origin.x),
+									 std::abs(yMin - page.origin.y), std::abs(yMax - page.origin.y) });
+		if (distance <= maxDistance)
+		{
+			// Most recently used first, consecutive geometries tend to be near each other
+			std::rotate(m_openPages.begin(), m_openPages.begin() + i, m_openPages.begin() + i + 1);
+			return Placement{ page.id, page.origin };
+		}
+	}
+
+	Page& page = createPage(glm::dvec3(xMin, yMin, 0.0), m_pageVertexCapacity, m_pageIndexCapacity);
+	return Placement{ page.id, page.origin };
+}
+
+RetainedBuffer::Allocation RetainedBuffer::add(const Placement& placement, const void* vertices, size_t vertexCount, const GLuint* indices, size_t indexCount)
+{
+	auto it = m_pages.find(placement.page);
+	if (vertexCount == 0 || indexCount == 0 || it == m_pages.end()) return Allocation();
+
+	Page* page = it->second.get();
+	if (page->vertexCount + vertexCount > page->vertexCapacity || page->indexCount + indexCount > page->indexCapacity)
+	{
+		// Continued in a new page with the same origin, geometries larger than a page get one of their own
+		page->full = true;
+		m_openPages.erase(std::remove(m_openPages.begin(), m_openPages.end(), page->id), m_openPages.end());
+		page = &createPage(placement.origin, std::max(m_pageVertexCapacity, vertexCount), std::max(m_pageIndexCapacity, indexCount));
+		if (page->vertexCapacity > m_pageVertexCapacity || page->indexCapacity > m_pageIndexCapacity)
+		{
+			page->full = true;
+			m_openPages.erase(m_openPages.begin());
+		}
+	}
+
+	// Indices are stored relative to the start of the page
+	std::vector<GLuint> pageIndices(indices, indices + indexCount);
+	for (auto& index : pageIndices)
+	{
+		index += (GLuint)page->vertexCount;
+	}
+
+	// Not through the vertex array, that would change its element buffer
+	glBindVertexArray(0);
+	page->vbo.bind();
+	glBufferSubData(GL_ARRAY_BUFFER, m_layout.stride*page->vertexCount, m_layout.stride*vertexCount, vertices);
+	page->vbo.unbind();
+	page->ibo.bind();
+	glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*page->indexCount, sizeof(GLuint)*indexCount, pageIndices.data());
+	page->ibo.unbind();
+
+	Allocation allocation{ page->id, (GLuint)page->indexCount, (GLuint)indexCount };
+	page->vertexCount += vertexCount;
+	page->indexCount += indexCount;
+	page->liveIndexCount += indexCount;
+
+	return allocation;
+}
+
+RetainedBuffer::Page& RetainedBuffer::createPage(const glm::dvec3& origin, size_t vertexCapacity, size_t indexCapacity)
+{
+	uint32_t id = m_nextPage++;
+	auto& page = m_pages[id];
+	page = std::make_unique<Page>();
+	page->id = id;
+	page->origin = origin;
+	page->vertexCapacity = vertexCapacity;
+	page->indexCapacity = indexCapacity;
+	page->vao.init();
+	page->vbo.init();
+	page->ibo.init();
+
+	page->vao.bind();
+	page->vbo.bind();
+	glBufferData(GL_ARRAY_BUFFER, m_layout.stride*vertexCapacity, nullptr, GL_STATIC_DRAW);
+	page->ibo.bind();
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*indexCapacity, nullptr, GL_STATIC_DRAW);
+	page->vao.link(page->vbo, m_layout);
+	page->vao.unbind();
+	page->vbo.unbind();
+
+	if (m_openPages.size() == OpenPageCount)
+	{
+		auto last = m_pages.find(m_openPages.back());
+		last->second->full = true;
+		if (last->second->liveIndexCount == 0)
+		{
+			m_pages.erase(last);
+		}
+		m_openPages.pop_back();
+	}
+	m_openPages.insert(m_openPages.begin(), id);
+	m_stats.pages = m_pages.size();
+
+	return *page;
+}
+
+void RetainedBuffer::release(const Allocation& allocation)
+{
+	auto it = m_pages.find(allocation.page);
+	if (it == m_pages.end()) return;
+
+	Page& page = *it->second;
+	page.liveIndexCount -= std::min((size_t)allocation.indexCount, page.liveIndexCount);
+	if (page.liveIndexCount == 0)
+	{
+		auto open = std::find(m_openPages.begin(), m_openPages.end(), allocation.page);
+		if (open != m_openPages.end())
+		{
+			m_openPages.erase(open);
+		}
+		m_pages.erase(it);
+		m_stats.pages = m_pages.size();
+	}
+}
+
+bool RetainedBuffer::isStale(const Allocation& allocation) const
+{
+	auto it = m_pages.find(allocation.page);
+	if (it == m_pages.end()) return false;
+
+	const Page& page = *it->second;
+	return page.full && page.liveIndexCount*4 < page.indexCount;
+}
+
+void RetainedBuffer::clear()
+{
+	m_pages.clear();
+	m_openPages.clear();
+	m_stats.pages = 0;
+}
+
+void RetainedBuffer::draw(const std::vector<Allocation>& allocations, const std::function<void(const glm::dvec3&)>& setOrigin)
+{
+	size_t i = 0;
+	while (i < allocations.size())
+	{
+		auto it = m_pages.find(allocations[i].page);
+		if (it == m_pages.end())
+		{
+			// Released since it was queued
+			i++;
+			continue;
+		}
+
+		// Consecutive draws from the same page in one call, those next to each other in the page as one
+		m_counts.clear();
+		m_offsets.clear();
+		GLuint nextIndex = 0;
+		for (; i < allocations.size() && allocations[i].page == it->first; i++)
+		{
+			if (!m_counts.empty() && allocations[i].firstIndex == nextIndex)
+			{
+				m_counts.back() += (GLsizei)allocations[i].indexCount;
+			}
+			else
+			{
+				m_counts.push_back((GLsizei)allocations[i].indexCount);
+				m_offsets.push_back((const void*)(sizeof(GLuint)*allocations[i].firstIndex));
+			}
+			nextIndex = allocations[i].firstIndex + allocations[i].indexCount;
+			m_stats.draws++;
+		}
+
+		Page& page = *it->second;
+		setOrigin(page.origin);
+		page.vao.bind();
+		glMultiDrawElements(GL_TRIANGLES, m_counts.data(), GL_UNSIGNED_INT, m_offsets.data(), (GLsizei)m_counts.size());
+		page.vao.unbind();
+		m_stats.drawCalls++;
+	}
+}
+
+RetainedBufferStats RetainedBuffer::stats() const
+{
+	return m_stats;
+}
@@ -1,8 +1,10 @@
 #version 330 core
 layout (location = 0) in vec3 pos;
 layout (location = 1) in vec4 color;
+layout (location = 2) in vec2 offset;
 
 uniform mat4 viewMatrix;
+uniform vec2 viewportSize;
 
 out DATA
 {
@@ -14,6 +16,17 @@ out DATA
 void main()
 {
     vec4 mPos = viewMatrix * vec4(pos, 1.0f);
+    // The offset is in pixels in the direction it has in map coordinates, extrude in screen space
+    // so that the line keeps its width at any zoom
+    float width = length(offset);
+    if (width > 0.0)
+    {
+        vec2 direction = (viewMatrix * vec4(offset, 0.0, 0.0)).xy * viewportSize;
+        if (dot(direction, direction) > 0.0)
+        {
+            mPos.xy += normalize(direction) * width * 2.0 / viewportSize * mPos.w;
+        }
+    }
     gl_Position = mPos;
     vert_out.position = mPos;
     vert_out.color = color;
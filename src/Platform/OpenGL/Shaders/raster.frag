@@ -0,0 +1,17 @@
+#version 330 core
+out vec4 FragColor;
+
+// Tiles of the rasters, one per layer
+uniform sampler2DArray atlas;
+
+in DATA
+{
+	vec4 position;
+	vec4 color;
+	vec3 texCoord;
+}frag_in;
+
+void main()
+{
+	FragColor = frag_in.color * texture(atlas, frag_in.texCoord);
+}
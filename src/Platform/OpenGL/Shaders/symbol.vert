@@ -0,0 +1,27 @@
+#version 330 core
+layout (location = 0) in vec2 corner;
+layout (location = 1) in vec3 pos;
+layout (location = 2) in float size;
+layout (location = 3) in float rotation;
+layout (location = 4) in vec4 color;
+
+uniform mat4 viewMatrix;
+
+out DATA
+{
+    vec4 position;
+    vec4 color;
+    vec2 texCoord;
+}vert_out;
+
+void main()
+{
+    // The symbol mesh is of unit size around the origin, place it at the instance
+    float c = cos(rotation);
+    float s = sin(rotation);
+    vec2 offset = mat2(c, s, -s, c) * corner * size;
+    vec4 mPos = viewMatrix * vec4(pos + vec3(offset, 0.0f), 1.0f);
+    gl_Position = mPos;
+    vert_out.position = mPos;
+    vert_out.color = color;
+}
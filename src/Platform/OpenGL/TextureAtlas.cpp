@@ -0,0 +1,164 @@
+#include "TextureAtlas.h"
+#include <algorithm>
+
+TextureAtlas::TextureAtlas(int tileSize, size_t memoryBudget)
+	:m_texture(0)
+	,m_pixelBuffer(0)
+	,m_tileSize(tileSize)
+	,m_layerCount(1)
+	,m_use(0)
+	,m_layers()
+	,m_lru()
+	,m_tiles()
+	,m_stats()
+{
+	GLint maxLayers = 256;
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+	size_t tileBytes = (size_t)tileSize*tileSize*4;
+	m_layerCount = (int)std::clamp<size_t>(memoryBudget/tileBytes, 1, (size_t)maxLayers);
+
+	glGenTextures(1, &m_texture);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, m_tileSize, m_tileSize, m_layerCount, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	glGenBuffers(1, &m_pixelBuffer);
+
+	m_layers.resize(m_layerCount);
+	for (GLint i = 0; i < m_layerCount; i++)
+	{
+		m_layers[i].resident = false;
+		m_layers[i].lastUse = 0;
+		m_layers[i].lruPosition = m_lru.insert(m_lru.end(), i);
+	}
+}
+
+TextureAtlas::~TextureAtlas()
+{
+	glDeleteBuffers(1, &m_pixelBuffer);
+	glDeleteTextures(1, &m_texture);
+}
+
+void TextureAtlas::beginUse()
+{
+	m_use++;
+}
+
+GLint TextureAtlas::acquire(const AtlasKey& key, const std::function<void(uint8_t* rgba)>& fill, const std::function<void()>& flush)
+{
+	GLint layer;
+	auto it = m_tiles.find(key);
+	if (it != m_tiles.end())
+	{
+		layer = it->second;
+	}
+	else
+	{
+		layer = m_lru.back();
+		Layer& replaced = m_layers[layer];
+		if (replaced.resident)
+		{
+			if (replaced.lastUse == m_use)
+			{
+				// More tiles in one draw than layers, draw what we have before reusing a layer
+				flush();
+				m_use++;
+				m_stats.flushes++;
+			}
+			m_tiles.erase(replaced.key);
+			m_stats.evictions++;
+		}
+		upload(layer, fill);
+		replaced.key = key;
+		replaced.resident = true;
+		m_tiles[key] = layer;
+	}
+
+	use(layer);
+	return layer;
+}
+
+GLint TextureAtlas::acquireResident(const AtlasKey& key)
+{
+	auto it = m_tiles.find(key);
+	if (it == m_tiles.end())
+	{
+		return -1;
+	}
+
+	use(it->second);
+	return it->second;
+}
+
+void TextureAtlas::use(GLint layer)
+{
+	Layer& entry = m_layers[layer];
+	entry.lastUse = m_use;
+	m_lru.splice(m_lru.begin(), m_lru, entry.lruPosition);
+}
+
+void TextureAtlas::clear()
+{
+	m_tiles.clear();
+	for (auto& layer : m_layers)
+	{
+		layer.resident = false;
+	}
+}
+
+void TextureAtlas::upload(GLint layer, const std::function<void(uint8_t* rgba)>& fill)
+{
+	GLsizeiptr size = (GLsizeiptr)m_tileSize*m_tileSize*4;
+
+	// Orphan the staging buffer, the previous upload may still be reading from it
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pixelBuffer);
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+	auto data = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (data != nullptr)
+	{
+		fill(data);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+		glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, m_tileSize, m_tileSize, 1, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+		m_stats.uploads++;
+	}
+	// Unbound, other texture uploads read from client memory
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void TextureAtlas::bind(GLuint unit)
+{
+	glActiveTexture(GL_TEXTURE0 + unit);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture);
+}
+
+int TextureAtlas::tileSize() const
+{
+	return m_tileSize;
+}
+
+int TextureAtlas::layerCount() const
+{
+	return m_layerCount;
+}
+
+size_t TextureAtlas::residentCount() const
+{
+	return m_tiles.size();
+}
+
+size_t TextureAtlas::memoryUsage() const
+{
+	return (size_t)m_tileSize*m_tileSize*4*m_layerCount;
+}
+
+const TextureAtlasStats& TextureAtlas::stats() const
+{
+	return m_stats;
+}
@@ -8,7 +8,6 @@ VAO::VAO()
 }
 VAO::~VAO()
 {
-	std::cout << "Deleting VAO with id: " << m_id << "\n";
 	glDeleteVertexArrays(1, &m_id);
 }
 void VAO::init()
@@ -19,10 +18,21 @@ void VAO::bind()
 {
 	glBindVertexArray(m_id);
 }
-void VAO::link(VBO& vbo, GLuint layout, GLuint nrOfComponents, GLenum type, GLsizeiptr stride, GLvoid* offset)
+void VAO::link(VBO& vbo, GLuint layout, GLuint nrOfComponents, GLenum type, GLsizeiptr stride, GLvoid* offset, GLboolean normalized)
 {
 	glEnableVertexAttribArray(layout);
-	glVertexAttribPointer(layout,nrOfComponents,type,GL_FALSE,stride,offset);
+	glVertexAttribPointer(layout,nrOfComponents,type,normalized,stride,offset);
+}
+void VAO::link(VBO& vbo, const VertexLayout& layout)
+{
+	for (const auto& attribute : layout.attributes)
+	{
+		link(vbo, attribute.location, attribute.components, attribute.type, layout.stride, (void*)attribute.offset, attribute.normalized);
+		if (attribute.divisor != 0)
+		{
+			glVertexAttribDivisor(attribute.location, attribute.divisor);
+		}
+	}
 }
 void VAO::linkInt(VBO& vbo, GLuint layout, GLuint nrOfComponents, GLenum type, GLsizeiptr stride, GLvoid* offset)
 {
@@ -32,4 +42,42 @@ void VAO::linkInt(VBO& vbo, GLuint layout, GLuint nrOfComponents, GLenum type, G
 void VAO::unbind()
 {
 	glBindVertexArray(0);
-}
\ No newline at end of file
+}
+
+VertexLayout VertexLayout::colorVertex()
+{
+	return VertexLayout{ sizeof(ColorVertex), {
+		{ 0, 3, GL_FLOAT, GL_FALSE, offsetof(ColorVertex, position) },
+		{ 1, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(ColorVertex, color) } } };
+}
+
+VertexLayout VertexLayout::lineVertex()
+{
+	return VertexLayout{ sizeof(LineVertex), {
+		{ 0, 3, GL_FLOAT, GL_FALSE, offsetof(LineVertex, position) },
+		{ 1, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(LineVertex, color) },
+		{ 2, 2, GL_FLOAT, GL_FALSE, offsetof(LineVertex, offset) } } };
+}
+
+VertexLayout VertexLayout::rasterVertex()
+{
+	return VertexLayout{ sizeof(RasterVertex), {
+		{ 0, 3, GL_FLOAT, GL_FALSE, offsetof(RasterVertex, position) },
+		{ 1, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(RasterVertex, color) },
+		{ 2, 3, GL_FLOAT, GL_FALSE, offsetof(RasterVertex, texCoord) } } };
+}
+
+VertexLayout VertexLayout::symbolMesh()
+{
+	return VertexLayout{ sizeof(glm::vec2), {
+		{ 0, 2, GL_FLOAT, GL_FALSE, 0 } } };
+}
+
+VertexLayout VertexLayout::symbolInstance()
+{
+	return VertexLayout{ sizeof(SymbolVertex), {
+		{ 1, 3, GL_FLOAT, GL_FALSE, offsetof(SymbolVertex, position), 1 },
+		{ 2, 1, GL_FLOAT, GL_FALSE, offsetof(SymbolVertex, size), 1 },
+		{ 3, 1, GL_FLOAT, GL_FALSE, offsetof(SymbolVertex, rotation), 1 },
+		{ 4, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(SymbolVertex, color), 1 } } };
+}
@@ -9,7 +9,6 @@ VBO::VBO()
 }
 VBO::~VBO()
 {
-	std::cout << "Deleting VAO with id: " << m_id << "\n";
 	glDeleteBuffers(1, &m_id);
 }
 
@@ -18,13 +17,27 @@ void VBO::init()
 	glGenBuffers(1, &m_id);
 }
 
-void VBO::bufferData(std::vector<Vertice>& vertices)
+void VBO::bufferData(const std::vector<Vertice>& vertices)
 {
 	m_vertexCount = vertices.size();
 	glBindBuffer(GL_ARRAY_BUFFER, m_id);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(Vertice) * vertices.size(), &vertices[0], GL_STATIC_DRAW);
 }
 
+void VBO::bufferData(const std::vector<ColorVertex>& vertices)
+{
+	m_vertexCount = vertices.size();
+	glBindBuffer(GL_ARRAY_BUFFER, m_id);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(ColorVertex) * vertices.size(), &vertices[0], GL_STATIC_DRAW);
+}
+
+void VBO::bufferData(const std::vector<LineVertex>& vertices)
+{
+	m_vertexCount = vertices.size();
+	glBindBuffer(GL_ARRAY_BUFFER, m_id);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(LineVertex) * vertices.size(), &vertices[0], GL_STATIC_DRAW);
+}
+
 void VBO::allocateDynamicBuffer(GLuint size)
 {
 	glBindBuffer(GL_ARRAY_BUFFER, m_id);
@@ -226,6 +226,30 @@ void Raster::Impl::blur(double sigmaX, double sigmaY, double sigmaZ, bool isGaus
     std::cout << "Raster::Impl::blur() not implemented!\n";
 }
 
+void Raster::Impl::unpremultiplyAlpha()
+{
+    if (m_channels != 4)
+    {
+        return;
+    }
+
+    size_t pixelCount = size_t(m_width)*m_height;
+    for (size_t i(0); i<pixelCount; ++i)
+    {
+        unsigned char* pixel = m_data + i*4;
+        unsigned int a = pixel[3];
+        if (a == 0 || a == 255)
+        {
+            continue;
+        }
+        for (int c(0); c<3; ++c)
+        {
+            unsigned int value = (pixel[c]*255u + a/2)/a;
+            pixel[c] = (unsigned char)std::min(value, 255u);
+        }
+    }
+}
+
 Raster Raster::Impl::getCrop(int x0, int y0, int x1, int y1) const
 {
     // Validate input coordinates
@@ -273,6 +297,25 @@ void Raster::Impl::save(const std::string& filePath) const
     stbi_write_png(filePath.c_str(), width(), height(), channels(), data(), width() * channels());
 }
 
+std::vector<unsigned char> Raster::Impl::encodePng() const
+{
+    std::vector<unsigned char> png;
+    auto write = [](void* context, void* data, int size)
+    {
+        auto* out = static_cast<std::vector<unsigned char>*>(context);
+        out->insert(out->end(), (unsigned char*)data, (unsigned char*)data + size);
+    };
+
+    // Same orientation as save()
+    stbi_flip_vertically_on_write(1);
+    if (stbi_write_png_to_func(write, &png, width(), height(), channels(), data(), width() * channels()) == 0)
+    {
+        throw std::runtime_error("Raster::Impl::encodePng() Failed to encode the raster");
+    }
+
+    return png;
+}
+
 void* Raster::Impl::data() const
 {
     return m_data;
@@ -34,8 +34,10 @@ class Raster::Impl
         void rotate(double angle, int cx, int cy, ResizeInterpolation interpolation);
         void fill(int val);
         void blur(double sigmaX, double sigmaY, double sigmaZ, bool isGaussian);
+        void unpremultiplyAlpha();
         Raster getCrop(int x0, int y0, int x1, int y1) const;
         void save(const std::string& filePath) const;
+        std::vector<unsigned char> encodePng() const;
         void* data() const;
 
         Impl& operator=(const Impl& impl);